@@ -0,0 +1,413 @@
+#include "assetCache.hpp"
+#include "log.hpp"
+#include "memory/accounting.hpp"
+#include "pico/stdlib.h"
+#include <cstring>
+
+namespace PicoPixel
+{
+    namespace Assets
+    {
+        // FilePosition when a failed read left the file position unknown.
+        static constexpr uint32_t POSITION_UNKNOWN = UINT32_MAX;
+
+        bool AssetCache::Open(const char* path, size_t capacity)
+        {
+            Close();
+
+            uint32_t heapBefore = Memory::GetHeapUsed();
+            FILE* file = fopen(path, "rb");
+            if (!file)
+            {
+                LOG("Assets: No streamed pack at %s, using the built-in pack only\n", path);
+                return false;
+            }
+            // Chunks go straight into the cache; a stdio buffer would only copy them again.
+            setvbuf(file, nullptr, _IONBF, 0);
+            uint32_t heapAfter = Memory::GetHeapUsed();
+
+            PackHeader header;
+            if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.Magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0
+                || header.Version != PACK_VERSION || header.Size < sizeof(PackHeader) + header.Count * sizeof(AssetEntry))
+            {
+                LOG_ERROR("Assets: %s is not a version %d asset pack\n", path, PACK_VERSION);
+                fclose(file);
+                return false;
+            }
+
+            // The index stays in RAM so lookups never touch the filesystem; the data is what gets streamed.
+            size_t indexSize = header.Count * sizeof(AssetEntry);
+            AssetEntry* entries = (AssetEntry*)Memory::Allocate(Memory::Tag::Assets, indexSize ? indexSize : 1);
+            uint8_t* storage = (uint8_t*)Memory::Allocate(Memory::Tag::Assets, capacity);
+            bool valid = entries && storage && fread(entries, 1, indexSize, file) == indexSize;
+            for (uint16_t i = 0; valid && i < header.Count; i++)
+                valid = entries[i].Offset % ASSET_ALIGNMENT == 0 && entries[i].Offset <= header.Size
+                    && entries[i].Size <= header.Size - entries[i].Offset && (i == 0 || entries[i - 1].Id < entries[i].Id);
+            if (!valid)
+            {
+                LOG_ERROR("Assets: Could not load the index of %s\n", path);
+                Memory::Free(entries);
+                Memory::Free(storage);
+                fclose(file);
+                return false;
+            }
+
+            File = file;
+            FilePosition = sizeof(PackHeader) + (uint32_t)indexSize;
+            FileHeapBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+            Memory::TrackAllocation(Memory::Tag::Filesystem, FileHeapBytes);
+            Header = header;
+            Entries = entries;
+            Storage = storage;
+            Capacity = (uint32_t)capacity;
+            memset(Slots, 0, sizeof(Slots));
+            LOG("Assets: Streaming %u assets (%lu bytes) from %s through a %lu byte cache\n", header.Count,
+                (unsigned long)header.Size, path, (unsigned long)capacity);
+            return true;
+        }
+
+        void AssetCache::Close()
+        {
+            if (!File)
+                return;
+
+            for (const Slot& slot : Slots)
+                if (slot.State != SlotState::Free && slot.References > 0)
+                    LOG_WARN("Assets: Closing with %08lx still acquired %u times\n", (unsigned long)slot.Entry->Id,
+                        slot.References);
+
+            fclose(File);
+            File = nullptr;
+            Memory::TrackFree(Memory::Tag::Filesystem, FileHeapBytes);
+            FileHeapBytes = 0;
+            Memory::Free(Entries);
+            Entries = nullptr;
+            Memory::Free(Storage);
+            Storage = nullptr;
+            Capacity = 0;
+            Header = {};
+            memset(Slots, 0, sizeof(Slots));
+        }
+
+        const AssetEntry* AssetCache::FindEntry(uint32_t id) const
+        {
+            if (!File)
+                return nullptr;
+
+            uint32_t low = 0;
+            uint32_t high = Header.Count;
+            while (low < high)
+            {
+                uint32_t middle = (low + high) / 2;
+                if (Entries[middle].Id < id)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low < Header.Count && Entries[low].Id == id ? &Entries[low] : nullptr;
+        }
+
+        AssetCache::Slot* AssetCache::FindSlot(uint32_t id)
+        {
+            for (Slot& slot : Slots)
+                if (slot.State != SlotState::Free && slot.Entry->Id == id)
+                    return &slot;
+            return nullptr;
+        }
+
+        bool AssetCache::FindSpace(uint32_t size, uint32_t& offset) const
+        {
+            // First fit between the resident assets, in address order. There are only ASSET_CACHE_SLOTS of them.
+            const Slot* used[ASSET_CACHE_SLOTS];
+            uint32_t count = 0;
+            for (const Slot& slot : Slots)
+            {
+                if (slot.State == SlotState::Free)
+                    continue;
+                uint32_t i = count++;
+                for (; i > 0 && used[i - 1]->Offset > slot.Offset; i--)
+                    used[i] = used[i - 1];
+                used[i] = &slot;
+            }
+
+            uint32_t start = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (used[i]->Offset - start >= size)
+                    break;
+                start = used[i]->Offset + AlignAsset(used[i]->Entry->Size);
+            }
+            if (Capacity - start < size)
+                return false;
+            offset = start;
+            return true;
+        }
+
+        AssetCache::Slot* AssetCache::Reserve(const AssetEntry* entry, bool keepPrefetched)
+        {
+            uint32_t size = AlignAsset(entry->Size);
+            if (size > Capacity)
+                return nullptr;
+
+            while (true)
+            {
+                Slot* free = nullptr;
+                for (Slot& slot : Slots)
+                {
+                    if (slot.State == SlotState::Free)
+                    {
+                        free = &slot;
+                        break;
+                    }
+                }
+                uint32_t offset;
+                if (free && FindSpace(size, offset))
+                {
+                    *free = {};
+                    free->Entry = entry;
+                    free->Offset = offset;
+                    free->LastUse = UseCounter;
+                    free->State = SlotState::Queued;
+                    return free;
+                }
+
+                // Make room: the least recently used asset nobody holds. Evicting may still leave the free space in
+                // pieces too small for this one, in which case the next oldest goes too.
+                Slot* oldest = nullptr;
+                for (Slot& slot : Slots)
+                {
+                    if (slot.State == SlotState::Free || slot.References > 0 || (keepPrefetched && slot.Prefetched))
+                        continue;
+                    if (!oldest || slot.LastUse < oldest->LastUse)
+                        oldest = &slot;
+                }
+                if (!oldest)
+                    return nullptr;
+                Evict(*oldest);
+                Stats.Evictions++;
+            }
+        }
+
+        void AssetCache::Evict(Slot& slot)
+        {
+            slot = {};
+        }
+
+        bool AssetCache::LoadChunk(Slot& slot)
+        {
+            uint32_t position = slot.Entry->Offset + slot.Loaded;
+            if (position != FilePosition && fseek(File, position, SEEK_SET) != 0)
+            {
+                FilePosition = POSITION_UNKNOWN;
+                return false;
+            }
+
+            // Up to the next chunk boundary in the file, so every read after an asset's first is aligned.
+            uint32_t size = ASSET_CACHE_CHUNK_SIZE - position % ASSET_CACHE_CHUNK_SIZE;
+            if (size > slot.Entry->Size - slot.Loaded)
+                size = slot.Entry->Size - slot.Loaded;
+            if (fread(Storage + slot.Offset + slot.Loaded, 1, size, File) != size)
+            {
+                FilePosition = POSITION_UNKNOWN;
+                return false;
+            }
+
+            FilePosition = position + size;
+            slot.Loaded += size;
+            Stats.BytesLoaded += size;
+            if (slot.Loaded == slot.Entry->Size)
+                slot.State = SlotState::Ready;
+            return true;
+        }
+
+        const uint8_t* AssetCache::Acquire(uint32_t id, const AssetEntry** entry)
+        {
+            const AssetEntry* streamed = FindEntry(id);
+            Slot* slot = streamed ? FindSlot(id) : nullptr;
+            if (slot && slot->State == SlotState::Ready)
+            {
+                Stats.Hits++;
+                if (slot->Prefetched)
+                    Stats.PrefetchHits++;
+            }
+            else if (streamed)
+            {
+                // A stall: the caller waits on the filesystem for whatever isn't in yet.
+                Stats.Misses++;
+                uint64_t start = time_us_64();
+                if (!slot)
+                    slot = Reserve(streamed, false);
+                while (slot && slot->State != SlotState::Ready)
+                {
+                    if (!LoadChunk(*slot))
+                    {
+                        LOG_ERROR("Assets: Reading %08lx from the streamed pack failed\n", (unsigned long)id);
+                        Evict(*slot);
+                        slot = nullptr;
+                    }
+                }
+                uint32_t stallUs = (uint32_t)(time_us_64() - start);
+                Stats.StallUs += stallUs;
+                if (stallUs > Stats.MaxStallUs)
+                    Stats.MaxStallUs = stallUs;
+                if (slot)
+                    LOG_DEFERRED(LOG_LEVEL_DEBUG, "Assets: Stalled %lu us loading %08lx (%lu bytes)\n",
+                        (unsigned long)stallUs, (unsigned long)id, (unsigned long)streamed->Size);
+                else
+                    LOG_WARN("Assets: No room for %08lx (%lu bytes), everything cached is in use\n", (unsigned long)id,
+                        (unsigned long)streamed->Size);
+            }
+
+            if (!slot)
+            {
+                const AssetPack& pack = GetBuiltinPack();
+                const AssetEntry* builtin = pack.Find(id);
+                if (!builtin)
+                {
+                    Stats.Failures++;
+                    return nullptr;
+                }
+                // Flash is always mapped, so there is nothing to count.
+                Stats.FlashHits++;
+                if (entry)
+                    *entry = builtin;
+                return pack.GetData(*builtin);
+            }
+
+            slot->Prefetched = false;
+            slot->References++;
+            slot->LastUse = ++UseCounter;
+            if (entry)
+                *entry = slot->Entry;
+            return Storage + slot->Offset;
+        }
+
+        void AssetCache::Release(uint32_t id)
+        {
+            // Ids served from flash have no slot.
+            Slot* slot = FindSlot(id);
+            if (slot && slot->References > 0)
+                slot->References--;
+        }
+
+        bool AssetCache::AcquireSprite(uint32_t id, SpriteView& sprite)
+        {
+            const AssetEntry* entry;
+            const uint8_t* data = Acquire(id, &entry);
+            if (!data || entry->Type != AssetType::Sprite)
+            {
+                LOG_WARN("Assets: No sprite with id %08lx\n", (unsigned long)id);
+                if (data)
+                    Release(id);
+                return false;
+            }
+            sprite = AssetPack::MakeSprite(*entry, data);
+            return true;
+        }
+
+        bool AssetCache::AcquireFont(uint32_t id, FontView& font)
+        {
+            const AssetEntry* entry;
+            const uint8_t* data = Acquire(id, &entry);
+            if (!data || entry->Type != AssetType::Font)
+            {
+                LOG_WARN("Assets: No font with id %08lx\n", (unsigned long)id);
+                if (data)
+                    Release(id);
+                return false;
+            }
+            font = AssetPack::MakeFont(data);
+            return true;
+        }
+
+        void AssetCache::Prefetch(uint32_t id)
+        {
+            const AssetEntry* entry = FindEntry(id);
+            if (!entry || FindSlot(id))
+                return;
+
+            Slot* slot = Reserve(entry, true);
+            if (!slot)
+            {
+                LOG_DEBUG("Assets: No room to prefetch %08lx\n", (unsigned long)id);
+                return;
+            }
+            slot->Prefetched = true;
+            slot->LastUse = ++UseCounter;
+        }
+
+        void AssetCache::Service(uint32_t budgetUs)
+        {
+            uint64_t start = time_us_64();
+            while (true)
+            {
+                // Oldest hint first, so assets arrive in the order they were asked for.
+                Slot* next = nullptr;
+                for (Slot& slot : Slots)
+                    if (slot.State == SlotState::Queued && (!next || slot.LastUse < next->LastUse))
+                        next = &slot;
+                if (!next)
+                    return;
+
+                do
+                {
+                    if (!LoadChunk(*next))
+                    {
+                        LOG_ERROR("Assets: Prefetching %08lx from the streamed pack failed\n", (unsigned long)next->Entry->Id);
+                        Evict(*next);
+                        break;
+                    }
+                    if (time_us_64() - start >= budgetUs)
+                        return;
+                } while (next->State == SlotState::Queued);
+            }
+        }
+
+        bool AssetCache::IsLoading() const
+        {
+            for (const Slot& slot : Slots)
+                if (slot.State == SlotState::Queued)
+                    return true;
+            return false;
+        }
+
+        void AssetCache::ResetStats()
+        {
+            Stats = {};
+        }
+
+        void AssetCache::Report() const
+        {
+            uint32_t acquires = Stats.Hits + Stats.Misses;
+            LOG("Assets: %lu acquires from the streamed pack, %lu%% hits (%lu prefetched), %lu misses\n", (unsigned long)acquires,
+                (unsigned long)(acquires ? (uint64_t)Stats.Hits * 100 / acquires : 0), (unsigned long)Stats.PrefetchHits,
+                (unsigned long)Stats.Misses);
+            LOG("Assets: %lu acquires from flash, %lu failed\n", (unsigned long)Stats.FlashHits, (unsigned long)Stats.Failures);
+            LOG("Assets: Stalled %lu us in total, %lu us at worst; %lu bytes loaded, %lu evictions\n",
+                (unsigned long)Stats.StallUs, (unsigned long)Stats.MaxStallUs, (unsigned long)Stats.BytesLoaded,
+                (unsigned long)Stats.Evictions);
+
+            uint32_t resident = 0;
+            for (const Slot& slot : Slots)
+            {
+                if (slot.State == SlotState::Free)
+                    continue;
+                resident += AlignAsset(slot.Entry->Size);
+                // The state is part of the format, to keep within a deferred record's arguments.
+                if (slot.State == SlotState::Ready)
+                    LOG("  %08lx %6lu bytes at %6lu  ready, %u references\n", (unsigned long)slot.Entry->Id,
+                        (unsigned long)slot.Entry->Size, (unsigned long)slot.Offset, slot.References);
+                else
+                    LOG("  %08lx %6lu bytes at %6lu  loading, %u references\n", (unsigned long)slot.Entry->Id,
+                        (unsigned long)slot.Entry->Size, (unsigned long)slot.Offset, slot.References);
+            }
+            LOG("Assets: %lu/%lu cache bytes in use\n", (unsigned long)resident, (unsigned long)Capacity);
+        }
+
+        AssetCache& GetAssetCache()
+        {
+            static AssetCache cache;
+            return cache;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "assetPack.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// The streamed asset pack on the filesystem: a pack built by tools/assetc, like the one linked into flash.
+#ifndef ASSET_STREAM_PATH
+    #define ASSET_STREAM_PATH "/assets.ppak"
+#endif
+
+// RAM set aside for streamed assets. Loading past it evicts the least recently used unreferenced assets.
+#ifndef ASSET_CACHE_SIZE
+    #define ASSET_CACHE_SIZE (16 * 1024)
+#endif
+
+// Most assets the cache holds (or has queued) at once.
+#ifndef ASSET_CACHE_SLOTS
+    #define ASSET_CACHE_SLOTS 16
+#endif
+
+// Bytes read from the filesystem at a time. Reads after the first in an asset start on a multiple of this in the
+// file, so they line up with littlefs's cache and its program/read granularity.
+#ifndef ASSET_CACHE_CHUNK_SIZE
+    #define ASSET_CACHE_CHUNK_SIZE 512
+#endif
+
+// How long Service() may spend loading prefetched assets per call, in microseconds.
+#ifndef ASSET_CACHE_SERVICE_BUDGET_US
+    #define ASSET_CACHE_SERVICE_BUDGET_US 1000
+#endif
+
+namespace PicoPixel
+{
+    namespace Assets
+    {
+        struct CacheStats
+        {
+            uint32_t Hits;              // Acquired and already loaded.
+            uint32_t PrefetchHits;      // Of those, loaded ahead of time by Prefetch() and not used before.
+            uint32_t Misses;            // Acquired before they were (fully) loaded, so the caller waited.
+            uint32_t FlashHits;         // Not in the streamed pack, served from the pack in flash.
+            uint32_t Failures;          // Missing from both packs, or no room even after evicting.
+            uint32_t Evictions;
+            uint32_t BytesLoaded;
+            uint32_t StallUs;           // Total time callers waited on the filesystem.
+            uint32_t MaxStallUs;
+        };
+
+        // Streams assets from a pack on the filesystem into a fixed block of RAM, for art that doesn't fit in flash
+        // next to the firmware (or that is updated without reflashing).
+        //
+        // Assets are acquired by id and reference counted; only unreferenced ones are evicted, least recently used
+        // first, when a load needs room. Prefetch() queues an asset to be loaded a chunk at a time by Service(), so
+        // a game's assets can come in while the menu is up and Acquire() finds them ready. An Acquire() that has to
+        // go to the filesystem is a stall, and is timed and counted.
+        //
+        // Ids the streamed pack doesn't have are looked up in the built-in pack in flash, so games acquire everything
+        // the same way. Without a streamed pack (nothing at ASSET_STREAM_PATH) that is all there is.
+        //
+        // Only core0 acquires, releases and services. Views stay valid until their asset is released.
+        class AssetCache
+        {
+        public:
+            // Reads the pack's header and index and sets aside capacity bytes. Files are opened with stdio, like
+            // snapshots, so this is littlefs on the device and a plain file on the host.
+            bool Open(const char* path, size_t capacity = ASSET_CACHE_SIZE);
+            void Close();
+            bool IsOpen() const { return File != nullptr; }
+
+            // Load an asset, blocking if it isn't in RAM yet, and take a reference. Null if there is no such asset
+            // or no room for it. Every successful Acquire() needs a Release().
+            const uint8_t* Acquire(uint32_t id, const AssetEntry** entry = nullptr);
+            void Release(uint32_t id);
+
+            // Acquire() for a sprite or font, as views. False (and logs) when missing or of another type.
+            bool AcquireSprite(uint32_t id, SpriteView& sprite);
+            bool AcquireFont(uint32_t id, FontView& font);
+
+            // A hint that an asset will be acquired soon. Queues it for Service() if it is in the streamed pack and
+            // there is room, evicting only unreferenced assets that weren't prefetched themselves, so a list of hints
+            // larger than the cache doesn't push out its own start. Ids only in flash are ignored.
+            void Prefetch(uint32_t id);
+
+            // Load queued assets for up to budgetUs. Call once per frame, and while waiting in the menu.
+            void Service(uint32_t budgetUs = ASSET_CACHE_SERVICE_BUDGET_US);
+            bool IsLoading() const;
+
+            const CacheStats& GetStats() const { return Stats; }
+            void ResetStats();
+
+            // Prints hit rates, stalls and what is resident.
+            void Report() const;
+
+        private:
+            enum class SlotState : uint8_t
+            {
+                Free,
+                Queued,     // Prefetched, Loaded bytes in so far.
+                Ready,
+            };
+
+            struct Slot
+            {
+                const AssetEntry* Entry;
+                uint32_t Offset;            // Into Storage.
+                uint32_t Loaded;
+                uint32_t LastUse;
+                uint16_t References;
+                SlotState State;
+                bool Prefetched;            // Loaded by Prefetch() and not acquired since.
+            };
+
+            const AssetEntry* FindEntry(uint32_t id) const;
+            Slot* FindSlot(uint32_t id);
+            Slot* Reserve(const AssetEntry* entry, bool keepPrefetched);
+            bool FindSpace(uint32_t size, uint32_t& offset) const;
+            bool LoadChunk(Slot& slot);
+            void Evict(Slot& slot);
+
+        private:
+            FILE* File = nullptr;
+            uint32_t FilePosition = 0;
+            uint32_t FileHeapBytes = 0;     // Heap littlefs holds for the open file.
+
+            PackHeader Header = {};
+            AssetEntry* Entries = nullptr;  // The pack's index, sorted by id.
+            uint8_t* Storage = nullptr;
+            uint32_t Capacity = 0;
+            uint32_t UseCounter = 0;
+
+            Slot Slots[ASSET_CACHE_SLOTS] = {};
+            CacheStats Stats = {};
+        };
+
+        // The cache main() opens on ASSET_STREAM_PATH once the filesystem is mounted.
+        AssetCache& GetAssetCache();
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout of an asset pack, shared by the firmware and the host asset compiler (tools/assetc), so it must not
+// include anything from the SDK. Everything is little endian and every asset starts on an ASSET_ALIGNMENT boundary,
+// so the firmware reads pixels, palettes and offsets in place, straight out of XIP flash.
+//
+//   PackHeader
+//   AssetEntry[Count]     sorted by Id, for a binary search
+//   asset data...
+//
+// Sprite data, by format (Width x Height pixels, rows top to bottom):
+//   RGB565     uint16_t pixels[Width * Height]
+//   Indexed8   uint16_t palette[PaletteSize], padded to 4 bytes, then uint8_t indices[Width * Height]
+//   Indexed4   uint16_t palette[PaletteSize], padded to 4 bytes, then rows of (Width + 1) / 2 bytes, left pixel in the
+//              high nibble
+//   Rle565     uint32_t rowOffsets[Height] (bytes from the start of the data), then per row a stream of uint16_t
+//              packets: the top two bits are an RLE_* kind and the low 14 bits a pixel count. RLE_RUN is followed by
+//              one colour, RLE_LITERAL by count colours and RLE_SKIP by nothing (transparent pixels).
+//
+// Font data: FontHeader, uint8_t advances[GlyphCount] padded to 4 bytes, then each glyph's CellHeight rows of
+// (CellWidth + 7) / 8 bytes, one bit per pixel, MSB on the left.
+namespace PicoPixel
+{
+    namespace Assets
+    {
+        static constexpr char PACK_MAGIC[4] = { 'P', 'P', 'A', 'K' };
+        static constexpr uint16_t PACK_VERSION = 1;
+        static constexpr uint32_t ASSET_ALIGNMENT = 4;
+
+        enum class AssetType : uint8_t
+        {
+            Sprite,
+            Font,
+            Raw,        // Bytes copied from the source file as they are.
+        };
+
+        enum class PixelFormat : uint8_t
+        {
+            None,
+            RGB565,
+            Indexed8,
+            Indexed4,
+            Rle565,
+        };
+
+        enum AssetFlags : uint8_t
+        {
+            ASSET_TRANSPARENT = 1 << 0,     // Sprites: TransparentColor (RGB565) or palette index 0 (indexed) is skipped.
+        };
+
+        enum RlePacket : uint16_t
+        {
+            RLE_SKIP = 0 << 14,
+            RLE_RUN = 1 << 14,
+            RLE_LITERAL = 2 << 14,
+            RLE_KIND_MASK = 3 << 14,
+            RLE_COUNT_MASK = (1 << 14) - 1,
+        };
+
+        struct PackHeader
+        {
+            char Magic[4];
+            uint16_t Version;
+            uint16_t Count;
+            uint32_t Size;          // Whole pack, header included.
+            uint32_t Crc;           // CRC-32 of everything after the header.
+        };
+
+        struct AssetEntry
+        {
+            uint32_t Id;            // HashAssetName() of the name in the manifest.
+            uint32_t Offset;        // From the start of the pack.
+            uint32_t Size;
+            AssetType Type;
+            PixelFormat Format;
+            uint8_t Flags;
+            uint8_t Reserved;
+            uint16_t Width;
+            uint16_t Height;
+            uint16_t TransparentColor;
+            uint16_t PaletteSize;
+        };
+
+        struct FontHeader
+        {
+            uint8_t FirstChar;
+            uint8_t GlyphCount;
+            uint8_t CellWidth;
+            uint8_t CellHeight;
+        };
+
+        static_assert(sizeof(PackHeader) == 16, "PackHeader layout is part of the pack format");
+        static_assert(sizeof(AssetEntry) == 24, "AssetEntry layout is part of the pack format");
+        static_assert(sizeof(FontHeader) == 4, "FontHeader layout is part of the pack format");
+
+        // FNV-1a, so asset ids can be written as AssetId("ship") and folded at compile time.
+        constexpr uint32_t HashAssetName(const char* name)
+        {
+            uint32_t hash = 2166136261u;
+            for (; *name; name++)
+                hash = (hash ^ (uint8_t)*name) * 16777619u;
+            return hash;
+        }
+
+        constexpr uint32_t AlignAsset(uint32_t offset)
+        {
+            return (offset + ASSET_ALIGNMENT - 1) & ~(ASSET_ALIGNMENT - 1);
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#include "assetPack.hpp"
+#include "log.hpp"
+#include "utils/crc.hpp"
+#include <cstring>
+
+// Defined by assetPackData.S around the .incbin of the compiled pack.
+extern "C" const uint8_t PicoPixelAssetPack[];
+
+namespace PicoPixel
+{
+    namespace Assets
+    {
+        bool AssetPack::Open(const void* data, size_t size)
+        {
+            Data = nullptr;
+            Header = nullptr;
+            Entries = nullptr;
+
+            const PackHeader* header = (const PackHeader*)data;
+            if (!data || (size && size < sizeof(PackHeader)) || memcmp(header->Magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0
+                || header->Version != PACK_VERSION || (size && size < header->Size)
+                || header->Size < sizeof(PackHeader) + header->Count * sizeof(AssetEntry))
+            {
+                LOG_ERROR("Assets: Not a version %d asset pack\n", PACK_VERSION);
+                return false;
+            }
+
+            Data = (const uint8_t*)data;
+            Header = header;
+            Entries = (const AssetEntry*)(Data + sizeof(PackHeader));
+            return true;
+        }
+
+        bool AssetPack::Verify() const
+        {
+            return Header && Utils::Crc32(Data + sizeof(PackHeader), Header->Size - sizeof(PackHeader)) == Header->Crc;
+        }
+
+        const AssetEntry* AssetPack::Find(uint32_t id) const
+        {
+            uint32_t low = 0;
+            uint32_t high = GetCount();
+            while (low < high)
+            {
+                uint32_t middle = (low + high) / 2;
+                if (Entries[middle].Id < id)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low < GetCount() && Entries[low].Id == id ? &Entries[low] : nullptr;
+        }
+
+        SpriteView AssetPack::MakeSprite(const AssetEntry& entry, const uint8_t* data)
+        {
+            SpriteView sprite;
+            sprite.Format = entry.Format;
+            sprite.Flags = entry.Flags;
+            sprite.Width = entry.Width;
+            sprite.Height = entry.Height;
+            sprite.TransparentColor = entry.TransparentColor;
+            if (entry.Format == PixelFormat::Indexed8 || entry.Format == PixelFormat::Indexed4)
+            {
+                sprite.Palette = (const uint16_t*)data;
+                sprite.Data = data + AlignAsset(entry.PaletteSize * sizeof(uint16_t));
+            }
+            else
+            {
+                sprite.Data = data;
+            }
+            return sprite;
+        }
+
+        FontView AssetPack::MakeFont(const uint8_t* data)
+        {
+            const FontHeader* header = (const FontHeader*)data;
+            FontView font;
+            font.FirstChar = header->FirstChar;
+            font.GlyphCount = header->GlyphCount;
+            font.CellWidth = header->CellWidth;
+            font.CellHeight = header->CellHeight;
+            font.BytesPerRow = (uint8_t)((header->CellWidth + 7) / 8);
+            font.Advances = data + sizeof(FontHeader);
+            font.Glyphs = data + AlignAsset(sizeof(FontHeader) + header->GlyphCount);
+            return font;
+        }
+
+        bool AssetPack::GetSprite(uint32_t id, SpriteView& sprite) const
+        {
+            const AssetEntry* entry = Find(id);
+            if (!entry || entry->Type != AssetType::Sprite)
+            {
+                LOG_WARN("Assets: No sprite with id %08lx\n", (unsigned long)id);
+                return false;
+            }
+            sprite = MakeSprite(*entry, GetData(*entry));
+            return true;
+        }
+
+        bool AssetPack::GetFont(uint32_t id, FontView& font) const
+        {
+            const AssetEntry* entry = Find(id);
+            if (!entry || entry->Type != AssetType::Font)
+            {
+                LOG_WARN("Assets: No font with id %08lx\n", (unsigned long)id);
+                return false;
+            }
+            font = MakeFont(GetData(*entry));
+            return true;
+        }
+
+        const AssetPack& GetBuiltinPack()
+        {
+            static AssetPack pack;
+            static bool opened = false;
+            if (!opened)
+            {
+                pack.Open(PicoPixelAssetPack);
+                opened = true;
+            }
+            return pack;
+        }
+
+        bool GetSprite(uint32_t id, SpriteView& sprite)
+        {
+            return GetBuiltinPack().GetSprite(id, sprite);
+        }
+
+        bool GetFont(uint32_t id, FontView& font)
+        {
+            return GetBuiltinPack().GetFont(id, font);
+        }
+    }
+}
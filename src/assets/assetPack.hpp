@@ -0,0 +1,94 @@
+#pragma once
+
+#include "assetFormat.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Assets
+    {
+        // Asset ids are hashes of the manifest names, so AssetId("logo") costs nothing at run time.
+        constexpr uint32_t AssetId(const char* name)
+        {
+            return HashAssetName(name);
+        }
+
+        // A sprite's pixels where they are (flash for the built-in pack). Only valid while the pack is.
+        struct SpriteView
+        {
+            PixelFormat Format = PixelFormat::None;
+            uint8_t Flags = 0;
+            uint16_t Width = 0;
+            uint16_t Height = 0;
+            uint16_t TransparentColor = 0;
+            const uint16_t* Palette = nullptr;  // Indexed formats.
+            const uint8_t* Data = nullptr;      // Pixels, indices or RLE rows, see assetFormat.hpp.
+
+            bool IsTransparent() const { return Flags & ASSET_TRANSPARENT; }
+        };
+
+        struct FontView
+        {
+            uint8_t FirstChar = 0;
+            uint8_t GlyphCount = 0;
+            uint8_t CellWidth = 0;
+            uint8_t CellHeight = 0;
+            uint8_t BytesPerRow = 0;
+            const uint8_t* Advances = nullptr;
+            const uint8_t* Glyphs = nullptr;
+
+            // Null for characters the font doesn't have.
+            const uint8_t* GetGlyph(char c) const
+            {
+                uint8_t index = (uint8_t)c - FirstChar;
+                return index < GlyphCount ? Glyphs + index * CellHeight * BytesPerRow : nullptr;
+            }
+            uint8_t GetAdvance(char c) const
+            {
+                uint8_t index = (uint8_t)c - FirstChar;
+                return index < GlyphCount ? Advances[index] : (uint8_t)(CellWidth / 2);
+            }
+        };
+
+        // A compiled asset pack (tools/assetc), used in place: Open() only checks the header, lookups binary-search
+        // the sorted index, and every view points straight into the pack's memory.
+        class AssetPack
+        {
+        public:
+            // size 0 trusts the header's size, for packs linked into flash.
+            bool Open(const void* data, size_t size = 0);
+            bool IsOpen() const { return Header != nullptr; }
+
+            // CRC over the whole pack. Not needed for the linked-in pack; for packs that came from storage.
+            bool Verify() const;
+
+            uint16_t GetCount() const { return Header ? Header->Count : 0; }
+            uint32_t GetSize() const { return Header ? Header->Size : 0; }
+            const AssetEntry* GetEntry(uint16_t index) const { return &Entries[index]; }
+
+            // Null when the pack has no such asset.
+            const AssetEntry* Find(uint32_t id) const;
+            const uint8_t* GetData(const AssetEntry& entry) const { return Data + entry.Offset; }
+
+            // False (and logs) when the id is missing or is a different type of asset.
+            bool GetSprite(uint32_t id, SpriteView& sprite) const;
+            bool GetFont(uint32_t id, FontView& font) const;
+
+            // Views over an entry whose data is somewhere else, e.g. loaded from a file into RAM.
+            static SpriteView MakeSprite(const AssetEntry& entry, const uint8_t* data);
+            static FontView MakeFont(const uint8_t* data);
+
+        private:
+            const uint8_t* Data = nullptr;
+            const PackHeader* Header = nullptr;
+            const AssetEntry* Entries = nullptr;
+        };
+
+        // The pack built from the ASSET_MANIFEST at compile time and linked into flash. Opened on first use.
+        const AssetPack& GetBuiltinPack();
+
+        bool GetSprite(uint32_t id, SpriteView& sprite);
+        bool GetFont(uint32_t id, FontView& font);
+    }
+}
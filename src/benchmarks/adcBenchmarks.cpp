@@ -0,0 +1,55 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "drivers/adc/adcSampler.hpp"
+#include "hardware/adc.h"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // A blocking select + adc_read() per reading, as input used to be read, vs a filtered reading from the
+        // sampler's DMA ring. Spread is the range of 256 back-to-back readings of a knob that isn't moving.
+        void RunAdcBenchmarks()
+        {
+            constexpr uint32_t Iterations = 256;
+            constexpr uint8_t Input = 2;    // Pong's paddle (GPIO 28)
+
+            if (AdcSampler::IsEnabled(Input))
+            {
+                LOG("ADC: skipped, input %u is already being sampled\n", Input);
+                return;
+            }
+
+            LOG("ADC: blocking adc_read() vs AdcSampler::Read() (input %u)\n", Input);
+            AdcSampler::Init();
+            adc_gpio_init(26 + Input);
+            uint16_t low = 0xFFFF, high = 0;
+            uint32_t blockingNs = Measure(Iterations, [&](uint32_t)
+            {
+                adc_select_input(Input);
+                uint16_t value = adc_read();
+                low = value < low ? value : low;
+                high = value > high ? value : high;
+            });
+            uint32_t blockingSpread = high - low;
+
+            // Let the ring fill before reading from it.
+            AdcSampler::Enable(Input);
+            sleep_ms(10);
+            low = 0xFFFF;
+            high = 0;
+            uint32_t sampledNs = Measure(Iterations, [&](uint32_t)
+            {
+                uint16_t value = AdcSampler::Read(Input);
+                low = value < low ? value : low;
+                high = value > high ? value : high;
+            });
+            uint32_t sampledSpread = high - low;
+            AdcSampler::Disable(Input);
+
+            Report("Read", blockingNs, sampledNs);
+            LOG("ADC: spread %lu -> %lu counts\n", (unsigned long)blockingSpread, (unsigned long)sampledSpread);
+            Sink = low;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "assets/assetPack.hpp"
+#include "graphics/graphics.hpp"
+#include "graphics/sprites.hpp"
+#include "memory/accounting.hpp"
+#include <cstdio>
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // Each sprite in the built-in pack, blitted from flash in its packed format, vs DrawBitmap() from a decoded
+        // RGB565 copy in RAM (what the game would need without the pack). Times are per blit.
+        void RunAssetBenchmarks()
+        {
+            constexpr uint16_t Width = 240;
+            constexpr uint16_t Height = 64;
+            constexpr uint32_t Iterations = 64;
+            static const char* const Formats[] = { "?", "rgb565", "idx8", "idx4", "rle" };
+
+            const Assets::AssetPack& pack = Assets::GetBuiltinPack();
+            LOG("Assets: RAM bitmap vs sprites from the asset pack (%u assets, %lu bytes)\n", pack.GetCount(), (unsigned long)pack.GetSize());
+
+            Driver::Buffer buffer;
+            buffer.Width = Width;
+            buffer.Height = Height;
+            buffer.Data = (uint16_t*)Memory::Allocate(Memory::Tag::Other, Width * Height * sizeof(uint16_t));
+            if (!buffer.Data)
+            {
+                LOG("Assets: skipped, not enough memory for the target buffer\n");
+                return;
+            }
+
+            for (uint16_t i = 0; i < pack.GetCount(); i++)
+            {
+                const Assets::AssetEntry& entry = *pack.GetEntry(i);
+                if (entry.Type != Assets::AssetType::Sprite || entry.Width > Width || entry.Height > Height)
+                    continue;
+                Assets::SpriteView sprite = Assets::AssetPack::MakeSprite(entry, pack.GetData(entry));
+
+                // Decode into the top-left of the buffer to get the RAM copy.
+                uint16_t* copy = (uint16_t*)Memory::Allocate(Memory::Tag::Other, entry.Width * entry.Height * sizeof(uint16_t));
+                if (!copy)
+                    continue;
+                Graphics::FillBuffer(&buffer, sprite.TransparentColor);
+                Graphics::DrawSprite(&buffer, 0, 0, sprite);
+                for (uint16_t row = 0; row < entry.Height; row++)
+                {
+                    for (uint16_t column = 0; column < entry.Width; column++)
+                        copy[row * entry.Width + column] = buffer.Data[row * Width + column];
+                }
+
+                uint32_t bitmapNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    Graphics::DrawBitmap(&buffer, iteration % (Width - entry.Width + 1), 0, copy, entry.Width, entry.Height);
+                    Sink = Sink + buffer.Data[Width / 2];
+                });
+                uint32_t spriteNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    Graphics::DrawSprite(&buffer, iteration % (Width - entry.Width + 1), 0, sprite);
+                    Sink = Sink + buffer.Data[Width / 2];
+                });
+
+                char name[48];
+                snprintf(name, sizeof(name), "%ux%u %s%s", entry.Width, entry.Height, Formats[(uint8_t)entry.Format < 5 ? (uint8_t)entry.Format : 0],
+                    sprite.IsTransparent() ? " (keyed)" : "");
+                Report(name, bitmapNs, spriteNs);
+                Memory::Free(copy);
+            }
+
+            Memory::Free(buffer.Data);
+        }
+    }
+}
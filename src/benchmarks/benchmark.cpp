@@ -0,0 +1,35 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        volatile uint32_t Sink = 0;
+
+        void Report(const char* name, uint32_t baselineNs, uint32_t candidateNs)
+        {
+            uint32_t speedup100 = candidateNs ? baselineNs * 100 / candidateNs : 0;
+            // Two records: deferred logging stores at most LOG_DEFERRED_MAX_ARGS arguments each.
+            LOG("%-28s %8lu ns -> %8lu ns\n", name, (unsigned long)baselineNs, (unsigned long)candidateNs);
+            LOG("%-28s x%lu.%02lu\n", name, (unsigned long)(speedup100 / 100), (unsigned long)(speedup100 % 100));
+        }
+
+        void RunAll()
+        {
+            LOG("Running benchmarks (baseline -> candidate)\n");
+            RunMathBenchmarks();
+            RunTrigBenchmarks();
+            RunPointCloudBenchmarks();
+            RunRandomBenchmarks();
+            RunEntityBenchmarks();
+            RunCollisionBenchmarks();
+            RunParticleBenchmarks();
+            RunAssetBenchmarks();
+            RunColorBenchmarks();
+            RunAdcBenchmarks();
+            RunClockBenchmarks();
+            LOG("Benchmarks finished\n");
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Driver
+    {
+        struct Buffer;
+    }
+
+    namespace Benchmarks
+    {
+        // Results are written here so the compiler can't optimise the measured work away.
+        extern volatile uint32_t Sink;
+
+        // Run fn(i) for i in [0, iterations) and return the average time per call in nanoseconds.
+        template<typename Fn>
+        uint32_t Measure(uint32_t iterations, Fn&& fn)
+        {
+            uint64_t start = time_us_64();
+            for (uint32_t i = 0; i < iterations; i++)
+                fn(i);
+            uint64_t elapsed = time_us_64() - start;
+            return (uint32_t)(elapsed * 1000 / iterations);
+        }
+
+        // Log one comparison line: name, baseline and candidate ns/op, and the speedup.
+        void Report(const char* name, uint32_t baselineNs, uint32_t candidateNs);
+
+        void RunMathBenchmarks();
+        void RunTrigBenchmarks();
+        void RunPointCloudBenchmarks();
+        void RunRandomBenchmarks();
+        void RunEntityBenchmarks();
+        void RunCollisionBenchmarks();
+        void RunParticleBenchmarks();
+        void RunAssetBenchmarks();
+        void RunColorBenchmarks();
+        void RunAdcBenchmarks();
+        void RunClockBenchmarks();
+
+        // Run every benchmark suite. Enabled with the RUN_BENCHMARKS CMake option.
+        void RunAll();
+
+        // Play a Replay recording through its game without presenting frames, and log update/render timings.
+        // With perFrame, also prints "#PPRB frame updateUs renderUs" lines for diffing two builds.
+        bool RunReplay(const char* path, PicoPixel::Driver::Buffer* buffer, bool perFrame = false);
+    }
+}
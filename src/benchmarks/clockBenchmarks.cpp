@@ -0,0 +1,102 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "clockGovernor.hpp"
+#include "games/gameLoop.hpp"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // One stretch of a synthetic game: CPU work (as it takes at 125 MHz) and bytes sent to the display per frame.
+        struct LoadPhase
+        {
+            const char* Name;
+            uint32_t CpuUsAt125;
+            uint32_t SpiBytes;
+            uint32_t Frames;
+        };
+
+        // Runs the clock governor's policy over a simulated load trace, no clocks touched: frame costs at whatever
+        // profile the policy picked are worked out from the phase, fed back in, and compared with staying at 125 MHz.
+        // Shows where it settles for each kind of load, how quickly, and what that costs in missed frames.
+        void RunClockBenchmarks()
+        {
+            using ClockGovernor::ClockPolicy;
+            using ClockGovernor::ClockProfile;
+
+            constexpr uint32_t SpiHz = 62500000;
+            constexpr uint32_t FullFrame = 320 * 240 * 2;
+#if GAME_LOOP_FRAME_CAP_HZ > 0
+            constexpr uint32_t BudgetUs = 1000000u / GAME_LOOP_FRAME_CAP_HZ;
+#else
+            constexpr uint32_t BudgetUs = 1000000u / 60;
+#endif
+            static const LoadPhase Trace[] =
+            {
+                { "Light", 1500, FullFrame / 8, 600 },
+                { "CPU bound", 10000, FullFrame / 4, 600 },
+                { "SPI bound", 2000, FullFrame, 600 },
+                { "Spiky", 0, FullFrame / 4, 600 },
+                { "Light", 1500, FullFrame / 8, 600 },
+            };
+
+            const ClockProfile* profiles = ClockGovernor::GetProfiles();
+            uint8_t count = ClockGovernor::GetProfileCount();
+            ClockPolicy policy(profiles, count, 1, BudgetUs);
+            policy.SetSpiHz(SpiHz);
+            uint32_t fixedSpiHz = ClockPolicy::GetSpiBaudrate(125000000, SpiHz);
+
+            LOG("Clock: governor policy over a simulated load trace (%lu us budget, SPI %lu Hz)\n",
+                (unsigned long)BudgetUs, (unsigned long)SpiHz);
+            uint64_t startUs = time_us_64();
+            uint32_t totalFrames = 0;
+            for (const LoadPhase& phase : Trace)
+            {
+                uint64_t phaseStartUs[ClockPolicy::MAX_PROFILES] = {};
+                for (uint8_t i = 0; i < count; i++)
+                    phaseStartUs[i] = policy.GetTimeUs(i);
+                uint32_t switches = policy.GetSwitchCount();
+                uint32_t missed = 0;
+                uint32_t fixedMissed = 0;
+                uint32_t settledFrame = 0;
+                uint8_t lastProfile = policy.GetProfile();
+
+                for (uint32_t frame = 0; frame < phase.Frames; frame++)
+                {
+                    // "Spiky": a heavy frame every half second on an otherwise light load.
+                    uint32_t cpuUsAt125 = phase.CpuUsAt125 ? phase.CpuUsAt125 : (frame % 30 == 0 ? 20000 : 1000);
+
+                    const ClockProfile& profile = profiles[policy.GetProfile()];
+                    uint32_t spiHz = ClockPolicy::GetSpiBaudrate(profile.Khz * 1000, SpiHz);
+                    uint32_t cpuUs = (uint32_t)((uint64_t)cpuUsAt125 * 125000 / profile.Khz);
+                    uint32_t spiUs = (uint32_t)((uint64_t)phase.SpiBytes * 8 * 1000000 / spiHz);
+                    uint32_t busyUs = cpuUs + spiUs;
+                    missed += busyUs > BudgetUs;
+                    fixedMissed += cpuUsAt125 + (uint32_t)((uint64_t)phase.SpiBytes * 8 * 1000000 / fixedSpiHz) > BudgetUs;
+
+                    policy.Account(busyUs > BudgetUs ? busyUs : BudgetUs);
+                    if (policy.Update(busyUs, spiUs) != lastProfile)
+                    {
+                        lastProfile = policy.GetProfile();
+                        settledFrame = frame + 1;
+                    }
+                }
+                totalFrames += phase.Frames;
+
+                LOG("Clock: %-10s -> %-7s after %4lu frames, %lu switches\n", phase.Name, profiles[policy.GetProfile()].Name,
+                    (unsigned long)settledFrame, (unsigned long)(policy.GetSwitchCount() - switches));
+                LOG("Clock:            missed %4lu frames (%4lu at 125 MHz)\n", (unsigned long)missed, (unsigned long)fixedMissed);
+                for (uint8_t i = 0; i < count; i++)
+                {
+                    uint64_t us = policy.GetTimeUs(i) - phaseStartUs[i];
+                    if (us)
+                        LOG("Clock:            %-7s %6lu ms\n", profiles[i].Name, (unsigned long)(us / 1000));
+                }
+            }
+            uint64_t elapsedUs = time_us_64() - startUs;
+            Sink = policy.GetSwitchCount();
+            LOG("Clock: %lu frames decided in %lu us (%lu ns per frame)\n", (unsigned long)totalFrames,
+                (unsigned long)elapsedUs, (unsigned long)(elapsedUs * 1000 / totalFrames));
+        }
+    }
+}
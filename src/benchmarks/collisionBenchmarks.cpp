@@ -0,0 +1,141 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "memory/accounting.hpp"
+#include "memory/arena.hpp"
+#include "physics/collisionGrid.hpp"
+#include <cstdio>
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        struct MovingBody
+        {
+            Physics::Aabb Box;
+            float VelocityX, VelocityY;
+        };
+
+        static void Step(MovingBody& body, float width, float height)
+        {
+            Physics::Aabb& box = body.Box;
+            if ((box.MinX + body.VelocityX < 0.0f) || (box.MaxX + body.VelocityX > width))
+                body.VelocityX = -body.VelocityX;
+            if ((box.MinY + body.VelocityY < 0.0f) || (box.MaxY + body.VelocityY > height))
+                body.VelocityY = -body.VelocityY;
+            box.MinX += body.VelocityX;
+            box.MaxX += body.VelocityX;
+            box.MinY += body.VelocityY;
+            box.MaxY += body.VelocityY;
+        }
+
+        // Brute-force all-pairs tests vs the uniform grid, for small boxes bouncing around the screen. Each iteration
+        // moves every body one step and then collects all overlapping pairs. Times are per whole step.
+        void RunCollisionBenchmarks()
+        {
+            constexpr float Width = 320.0f;
+            constexpr float Height = 240.0f;
+            constexpr float CellSize = 16.0f;
+            constexpr uint16_t BodyCounts[] = { 100, 500, 1000, 2000 };
+
+            LOG("Collision: brute force vs CollisionGrid (320x240, 4-8px boxes, 16px cells)\n");
+
+            for (uint16_t count : BodyCounts)
+            {
+                // Bodies, plus the grid: per-body arrays and four cell entries each, plus the cell heads.
+                size_t bodiesSize = count * sizeof(MovingBody);
+                size_t gridSize = count * 64u + 20u * 15u * sizeof(uint16_t) + 256u;
+                void* storage = Memory::Allocate(Memory::Tag::Other, bodiesSize + gridSize);
+                if (!storage)
+                {
+                    LOG("  %u bodies: skipped, not enough memory\n", count);
+                    continue;
+                }
+
+                MovingBody* bodies = (MovingBody*)storage;
+                Memory::Arena arena("Benchmark", Memory::Tag::Other, (uint8_t*)storage + bodiesSize, gridSize);
+                Physics::CollisionGrid grid;
+                grid.Init(arena, count, Width, Height, CellSize);
+
+                Physics::BodyId* ids = arena.NewArray<Physics::BodyId>(count);
+                for (uint16_t i = 0; i < count; i++)
+                {
+                    float size = 4.0f + (float)(i % 5);
+                    float x = (float)(i * 37 % 312);
+                    float y = (float)(i * 53 % 232);
+                    bodies[i] = { Physics::Aabb::FromRect(x, y, size, size), (float)(i % 7) * 0.25f - 0.75f, (float)(i % 5) * 0.25f - 0.5f };
+                    if (ids)
+                        ids[i] = grid.AddBox(bodies[i].Box, i);
+                }
+                if (!ids)
+                {
+                    LOG("  %u bodies: skipped, not enough memory\n", count);
+                    arena.Reset();
+                    Memory::Free(storage);
+                    continue;
+                }
+
+                // Fewer iterations for the quadratic baseline as the count grows, so the run stays short on device.
+                uint32_t iterations = count <= 500 ? 16 : 4;
+                uint32_t pairs = 0;
+                uint32_t bruteNs = Measure(iterations, [&](uint32_t)
+                {
+                    pairs = 0;
+                    for (uint16_t i = 0; i < count; i++)
+                        Step(bodies[i], Width, Height);
+                    for (uint16_t i = 0; i < count; i++)
+                    {
+                        for (uint16_t j = i + 1; j < count; j++)
+                            pairs += Physics::Overlaps(bodies[i].Box, bodies[j].Box);
+                    }
+                    Sink = Sink + pairs;
+                });
+                uint32_t gridPairs = 0;
+                uint32_t gridNs = Measure(iterations, [&](uint32_t)
+                {
+                    gridPairs = 0;
+                    for (uint16_t i = 0; i < count; i++)
+                    {
+                        Step(bodies[i], Width, Height);
+                        grid.MoveBox(ids[i], bodies[i].Box);
+                    }
+                    grid.ForEachPair([&](Physics::BodyId, Physics::BodyId) { gridPairs++; });
+                    Sink = Sink + gridPairs;
+                });
+
+                char name[48];
+                snprintf(name, sizeof(name), "Move + pairs (%u)", count);
+                Report(name, bruteNs, gridNs);
+
+                {
+                    // Screen-wide rays: every body vs walking the cells under the segment.
+                    constexpr uint32_t Rays = 64;
+                    uint32_t bruteRayNs = Measure(Rays, [&](uint32_t ray)
+                    {
+                        float y0 = (float)(ray * 7 % 240);
+                        float y1 = 239.0f - y0;
+                        float nearest = 2.0f;
+                        for (uint16_t i = 0; i < count; i++)
+                        {
+                            float fraction;
+                            if (Physics::IntersectSegment(bodies[i].Box, 0.0f, y0, Width, y1 - y0, fraction) && fraction < nearest)
+                                nearest = fraction;
+                        }
+                        Sink = Sink + (uint32_t)(nearest * 100.0f);
+                    });
+                    uint32_t gridRayNs = Measure(Rays, [&](uint32_t ray)
+                    {
+                        float y0 = (float)(ray * 7 % 240);
+                        Physics::RayHit hit;
+                        bool found = grid.Raycast(0.0f, y0, Width, 239.0f - y0, hit);
+                        Sink = Sink + (found ? (uint32_t)(hit.Fraction * 100.0f) : 200u);
+                    });
+                    snprintf(name, sizeof(name), "Raycast (%u)", count);
+                    Report(name, bruteRayNs, gridRayNs);
+                }
+
+                arena.Reset();
+                Memory::Free(storage);
+            }
+        }
+    }
+}
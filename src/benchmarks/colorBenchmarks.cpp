@@ -0,0 +1,85 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "utils/color.hpp"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // RGBto16bit() and friends one pixel at a time vs the word-at-a-time bulk kernels, over a 240 pixel row.
+        void RunColorBenchmarks()
+        {
+            constexpr uint32_t Iterations = 64;
+            constexpr uint32_t PixelCount = 240;
+            static uint8_t rgb[PixelCount * 3];
+            static uint8_t rgba[PixelCount * 4];
+            static uint16_t pixels[PixelCount];
+            static uint16_t wire[PixelCount];
+            for (uint32_t i = 0; i < PixelCount; i++)
+            {
+                // A gradient with every alpha class: opaque, transparent and in between.
+                uint8_t value = (uint8_t)i;
+                uint8_t alpha = i % 3 == 0 ? 0xFF : (i % 3 == 1 ? 0x00 : 0x80);
+                rgb[i * 3] = rgba[i * 4] = value;
+                rgb[i * 3 + 1] = rgba[i * 4 + 1] = (uint8_t)(255 - value);
+                rgb[i * 3 + 2] = rgba[i * 4 + 2] = (uint8_t)(value * 3);
+                rgba[i * 4 + 3] = alpha;
+            }
+
+            LOG("Color: per pixel vs bulk, %lu pixels\n", (unsigned long)PixelCount);
+
+            uint32_t rgbPixelNs = Measure(Iterations, [&](uint32_t)
+            {
+                for (uint32_t i = 0; i < PixelCount; i++)
+                    pixels[i] = Utils::RGBto16bit(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+                Sink = Sink + pixels[PixelCount - 1];
+            });
+            uint32_t rgbBulkNs = Measure(Iterations, [&](uint32_t)
+            {
+                Utils::RGB888toRGB565(rgb, pixels, PixelCount);
+                Sink = Sink + pixels[PixelCount - 1];
+            });
+            Report("RGB888 to RGB565", rgbPixelNs, rgbBulkNs);
+
+            uint32_t rgbaPixelNs = Measure(Iterations, [&](uint32_t)
+            {
+                for (uint32_t i = 0; i < PixelCount; i++)
+                    pixels[i] = Utils::RGBAto16bit(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+                Sink = Sink + pixels[PixelCount - 1];
+            });
+            uint32_t rgbaBulkNs = Measure(Iterations, [&](uint32_t)
+            {
+                Utils::RGBA8888toRGB565(rgba, pixels, PixelCount);
+                Sink = Sink + pixels[PixelCount - 1];
+            });
+            Report("RGBA8888 to RGB565", rgbaPixelNs, rgbaBulkNs);
+
+            uint32_t wirePixelNs = Measure(Iterations, [&](uint32_t)
+            {
+                for (uint32_t i = 0; i < PixelCount; i++)
+                    wire[i] = Utils::RGB565toWireOrder(pixels[i]);
+                Sink = Sink + wire[PixelCount - 1];
+            });
+            uint32_t wireBulkNs = Measure(Iterations, [&](uint32_t)
+            {
+                Utils::RGB565toWireOrder(pixels, wire, PixelCount);
+                Sink = Sink + wire[PixelCount - 1];
+            });
+            Report("RGB565 to wire order", wirePixelNs, wireBulkNs);
+
+            // The kernels have to agree with the per-pixel functions, or the speedup means nothing.
+            uint32_t mismatches = 0;
+            Utils::RGB888toRGB565(rgb, pixels, PixelCount);
+            for (uint32_t i = 0; i < PixelCount; i++)
+                mismatches += pixels[i] != Utils::RGBto16bit(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+            Utils::RGBA8888toRGB565(rgba, pixels, PixelCount);
+            for (uint32_t i = 0; i < PixelCount; i++)
+                mismatches += pixels[i] != Utils::RGBAto16bit(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+            Utils::RGB565toWireOrder(pixels, wire, PixelCount);
+            for (uint32_t i = 0; i < PixelCount; i++)
+                mismatches += wire[i] != Utils::RGB565toWireOrder(pixels[i]);
+            if (mismatches)
+                LOG_ERROR("Color: %lu pixels differ between the bulk and per-pixel conversions\n", (unsigned long)mismatches);
+        }
+    }
+}
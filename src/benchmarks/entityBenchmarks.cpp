@@ -0,0 +1,140 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "memory/arena.hpp"
+#include "utils/entityStorage.hpp"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // A typical bullet as a game would write it by hand: hot and cold fields together, plus an alive flag.
+        struct BulletAoS
+        {
+            float X, Y;
+            float VelocityX, VelocityY;
+            float Lifetime;
+            uint16_t Color;
+            uint8_t Sprite;
+            uint8_t Alive;
+            uint32_t Owner;
+            uint32_t Flags;
+        };
+
+        struct Position { float X, Y; };
+        struct Velocity { float X, Y; };
+        struct Lifetime { float Seconds; };
+        struct Appearance { uint16_t Color; uint8_t Sprite; uint32_t Owner; uint32_t Flags; };
+
+        // Hand-rolled array of structs with holes vs EntityStorage's packed component arrays. Times are per whole batch.
+        void RunEntityBenchmarks()
+        {
+            constexpr uint16_t Capacity = 512;
+            constexpr uint32_t Iterations = 32;
+            constexpr float Dt = 1.0f / 60.0f;
+
+            static BulletAoS bullets[Capacity];
+            alignas(8) static uint8_t arenaStorage[Capacity * (sizeof(Position) + sizeof(Velocity) + sizeof(Lifetime) + sizeof(Appearance) + 4 * sizeof(uint16_t)) + 64];
+            Memory::Arena arena("Benchmark", Memory::Tag::Other, arenaStorage, sizeof(arenaStorage));
+            Utils::EntityStorage<Position, Velocity, Lifetime, Appearance> storage;
+            storage.Init(arena, Capacity);
+
+            // Three quarters alive, with the holes spread out as they would be after a while of spawning and despawning.
+            uint32_t alive = 0;
+            for (uint16_t i = 0; i < Capacity; i++)
+            {
+                float x = (float)(i % 320);
+                float y = (float)(i * 7 % 240);
+                float vx = (float)(i % 13) - 6.0f;
+                float vy = (float)(i % 11) - 5.0f;
+                bullets[i] = { x, y, vx, vy, 2.0f, 0xFFFF, 1, (uint8_t)(i % 4 != 0), 0, 0 };
+                if (i % 4 == 0)
+                    continue;
+
+                Utils::Entity entity = storage.Create();
+                storage.Get<Position>(entity) = { x, y };
+                storage.Get<Velocity>(entity) = { vx, vy };
+                storage.Get<Lifetime>(entity) = { 2.0f };
+                alive++;
+            }
+
+            LOG("Entities: AoS with alive flags vs SoA EntityStorage (%lu of %u alive)\n", (unsigned long)alive, Capacity);
+
+            {
+                uint32_t aosNs = Measure(Iterations, [&](uint32_t)
+                {
+                    for (uint16_t i = 0; i < Capacity; i++)
+                    {
+                        BulletAoS& bullet = bullets[i];
+                        if (!bullet.Alive)
+                            continue;
+                        bullet.X += bullet.VelocityX * Dt;
+                        bullet.Y += bullet.VelocityY * Dt;
+                    }
+                    Sink = Sink + (uint32_t)bullets[1].X;
+                });
+                uint32_t soaNs = Measure(Iterations, [&](uint32_t)
+                {
+                    storage.Each<Position, Velocity>([](Position& position, const Velocity& velocity)
+                    {
+                        position.X += velocity.X * Dt;
+                        position.Y += velocity.Y * Dt;
+                    });
+                    Sink = Sink + (uint32_t)storage.Data<Position>()[0].X;
+                });
+                Report("Move (pos += vel * dt)", aosNs, soaNs);
+            }
+
+            {
+                // Count bullets inside a screen band: reads positions only, so SoA touches a third of the memory.
+                uint32_t aosNs = Measure(Iterations, [&](uint32_t)
+                {
+                    uint32_t inside = 0;
+                    for (uint16_t i = 0; i < Capacity; i++)
+                        inside += bullets[i].Alive && bullets[i].Y >= 60.0f && bullets[i].Y < 180.0f;
+                    Sink = Sink + inside;
+                });
+                uint32_t soaNs = Measure(Iterations, [&](uint32_t)
+                {
+                    uint32_t inside = 0;
+                    const Position* positions = storage.Data<Position>();
+                    for (uint16_t i = 0; i < storage.Count(); i++)
+                        inside += positions[i].Y >= 60.0f && positions[i].Y < 180.0f;
+                    Sink = Sink + inside;
+                });
+                Report("Query (position band)", aosNs, soaNs);
+            }
+
+            {
+                // Despawn and respawn a quarter of the bullets: a free-slot scan vs the free list and swap-remove.
+                uint32_t aosNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    for (uint16_t n = 0; n < Capacity / 4; n++)
+                    {
+                        bullets[(iteration * 97 + n * 5) % Capacity].Alive = 0;
+                        for (uint16_t i = 0; i < Capacity; i++)
+                        {
+                            if (!bullets[i].Alive)
+                            {
+                                bullets[i].Alive = 1;
+                                bullets[i].Lifetime = 2.0f;
+                                break;
+                            }
+                        }
+                    }
+                    Sink = Sink + bullets[0].Alive;
+                });
+                uint32_t soaNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    for (uint16_t n = 0; n < Capacity / 4; n++)
+                    {
+                        storage.DestroyAt((uint16_t)((iteration * 97 + n * 5) % storage.Count()));
+                        Utils::Entity entity = storage.Create();
+                        storage.Get<Lifetime>(entity).Seconds = 2.0f;
+                    }
+                    Sink = Sink + storage.Count();
+                });
+                Report("Despawn + respawn (x128)", aosNs, soaNs);
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "utils/math.hpp"
+#include "utils/fixed.hpp"
+#include <cmath>
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // Float vs Q16.16 on the operations games actually do per particle / per object,
+        // plus the worst error of each fixed-point result against the float one.
+        void RunMathBenchmarks()
+        {
+            using Utils::Q16_16;
+            using FixedVec3 = Utils::Fixed::Vec3<>;
+            using FixedMat3 = Utils::Fixed::Mat3<>;
+
+            constexpr uint32_t Count = 256;
+            constexpr uint32_t Iterations = 2048;
+            static Utils::Vec3 floatPoints[Count];
+            static FixedVec3 fixedPoints[Count];
+            for (uint32_t i = 0; i < Count; i++)
+            {
+                float x = (float)((i * 37) % 200) - 100.0f;
+                float y = (float)((i * 91) % 200) - 100.0f;
+                float z = (float)(i % 100) + 1.5f;
+                floatPoints[i] = Utils::Vec3(x, y, z);
+                fixedPoints[i] = FixedVec3(Q16_16::FromFloat(x), Q16_16::FromFloat(y), Q16_16::FromFloat(z));
+            }
+
+            LOG("Math: float vs Q16.16\n");
+
+            // Vec3 integrate: p += v * dt
+            {
+                Utils::Vec3 velocity(1.5f, -2.25f, 3.0f);
+                float dt = 0.016f;
+                uint32_t floatNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Utils::Vec3 p = floatPoints[i % Count] + velocity * dt;
+                    Sink = Sink + (uint32_t)(int32_t)p.z;
+                });
+
+                FixedVec3 fixedVelocity(Q16_16::FromFloat(1.5f), Q16_16::FromFloat(-2.25f), Q16_16::FromFloat(3.0f));
+                Q16_16 fixedDt = Q16_16::FromFloat(dt);
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    FixedVec3 p = fixedPoints[i % Count] + fixedVelocity * fixedDt;
+                    Sink = Sink + (uint32_t)p.z.Raw;
+                });
+                Report("Vec3 p += v * dt", floatNs, fixedNs);
+            }
+
+            // Mat3 transform
+            {
+                Utils::Mat3 floatMatrix;
+                floatMatrix.RotateX(0.3f);
+                FixedMat3 fixedMatrix;
+                for (int r = 0; r < 3; r++)
+                    for (int c = 0; c < 3; c++)
+                        fixedMatrix.m[r][c] = Q16_16::FromFloat(floatMatrix.m[r][c]);
+
+                uint32_t floatNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Utils::Vec3 p = floatMatrix.Transform(floatPoints[i % Count]);
+                    Sink = Sink + (uint32_t)(int32_t)p.y;
+                });
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    FixedVec3 p = fixedMatrix.Transform(fixedPoints[i % Count]);
+                    Sink = Sink + (uint32_t)p.y.Raw;
+                });
+                Report("Mat3 transform", floatNs, fixedNs);
+
+                float maxError = 0.0f;
+                for (uint32_t i = 0; i < Count; i++)
+                {
+                    float error = fabsf(fixedMatrix.Transform(fixedPoints[i]).y.ToFloat() - floatMatrix.Transform(floatPoints[i]).y);
+                    if (error > maxError) maxError = error;
+                }
+                LOG("  Mat3 transform max error: %f\n", maxError);
+            }
+
+            // Perspective divide: x / z
+            {
+                uint32_t floatNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    const Utils::Vec3& p = floatPoints[i % Count];
+                    Sink = Sink + (uint32_t)(int32_t)(p.x * (1.0f / p.z) * 120.0f);
+                });
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    const FixedVec3& p = fixedPoints[i % Count];
+                    Sink = Sink + (uint32_t)(p.x * Utils::Reciprocal(p.z) * 120).ToInt();
+                });
+                Report("x / z (reciprocal)", floatNs, fixedNs);
+
+                float maxError = 0.0f;
+                for (uint32_t i = 0; i < Count; i++)
+                {
+                    float error = fabsf(Utils::Reciprocal(fixedPoints[i].z).ToFloat() - 1.0f / floatPoints[i].z);
+                    if (error > maxError) maxError = error;
+                }
+                LOG("  Reciprocal max error: %f\n", maxError);
+            }
+
+            // Length (sqrt)
+            {
+                uint32_t floatNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    const Utils::Vec3& p = floatPoints[i % Count];
+                    Sink = Sink + (uint32_t)sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+                });
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (uint32_t)fixedPoints[i % Count].Length().Raw;
+                });
+                Report("Vec3 length (sqrt)", floatNs, fixedNs);
+
+                float maxError = 0.0f;
+                for (uint32_t i = 0; i < Count; i++)
+                {
+                    const Utils::Vec3& p = floatPoints[i];
+                    float error = fabsf(fixedPoints[i].Length().ToFloat() - sqrtf(p.x * p.x + p.y * p.y + p.z * p.z));
+                    if (error > maxError) maxError = error;
+                }
+                LOG("  Length max error: %f\n", maxError);
+            }
+
+            // Squared-length range check, which needs no sqrt at all in fixed point.
+            {
+                const float Range = 120.0f;
+                uint32_t floatNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (floatPoints[i % Count] > Range ? 1u : 0u);
+                });
+                const Q16_16 RangeSquared = Q16_16(120 * 120);
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (fixedPoints[i % Count].LengthSquared() > RangeSquared ? 1u : 0u);
+                });
+                Report("Range check", floatNs, fixedNs);
+            }
+        }
+    }
+}
@@ -0,0 +1,204 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "graphics/graphics.hpp"
+#include "graphics/particles.hpp"
+#include "memory/accounting.hpp"
+#include "memory/arena.hpp"
+#include "utils/pointCloud.hpp"
+#include "utils/random.hpp"
+#include "utils/trig.hpp"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // Hand-written particles the way a game would do it without the particle system.
+        struct SparkAoS
+        {
+            float X, Y;
+            float VelocityX, VelocityY;
+            float Lifetime;
+        };
+
+        // Game-specific particle code (float integration, DrawPixel, a colour conversion per particle) vs the pooled
+        // particle system. No game is running yet, so the game arena holds the particles; the target buffer is a
+        // small one from the heap. Times are per whole batch.
+        void RunParticleBenchmarks()
+        {
+            constexpr uint16_t Width = 128;
+            constexpr uint16_t Height = 96;
+            constexpr uint32_t Iterations = 16;
+            constexpr float Dt = 1.0f / 60.0f;
+
+            Driver::Buffer buffer;
+            buffer.Width = Width;
+            buffer.Height = Height;
+            buffer.Data = (uint16_t*)Memory::Allocate(Memory::Tag::Other, Width * Height * sizeof(uint16_t));
+            if (!buffer.Data)
+            {
+                LOG("Particles: skipped, not enough memory for the target buffer\n");
+                return;
+            }
+
+            Memory::Arena& arena = Memory::GetGameArena();
+            Utils::RandomStream rng(1);
+
+            {
+                // 2D sparks bouncing around inside the buffer, drawn as points.
+                constexpr uint16_t Count = 1024;
+                LOG("Particles: per-particle floats + DrawPixel vs ParticlePool (%u sparks, %ux%u)\n", Count, Width, Height);
+
+                SparkAoS* sparks = arena.NewArray<SparkAoS>(Count);
+                for (uint16_t i = 0; i < Count; i++)
+                    sparks[i] = { rng.Float(8.0f, Width - 8.0f), rng.Float(8.0f, Height - 8.0f), rng.Float(-20.0f, 20.0f), rng.Float(-20.0f, 20.0f), 1000.0f };
+                uint32_t baselineNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    // Turn around every few frames so everything stays on screen.
+                    float direction = (iteration / 4) % 2 ? -1.0f : 1.0f;
+                    for (uint16_t i = 0; i < Count; i++)
+                    {
+                        SparkAoS& spark = sparks[i];
+                        spark.X += spark.VelocityX * direction * Dt;
+                        spark.Y += spark.VelocityY * direction * Dt;
+                        spark.Lifetime -= Dt;
+                        if (spark.Lifetime <= 0.0f)
+                            continue;
+                        Graphics::DrawPixel(&buffer, (uint16_t)spark.X, (uint16_t)spark.Y, Utils::RGBAto16bit(255, 160, 64, 200));
+                    }
+                    Sink = Sink + buffer.Data[Width * Height / 2];
+                });
+                arena.Reset();
+
+                Graphics::ParticlePool pool;
+                pool.Init(arena, Count, Graphics::PARTICLE_VELOCITY | Graphics::PARTICLE_LIFETIME);
+                Graphics::EmitterSettings settings;
+                settings.SpawnShape = Graphics::EmitterSettings::Shape::Box;
+                settings.X = Utils::Q16_16(Width / 2);
+                settings.Y = Utils::Q16_16(Height / 2);
+                settings.ExtentX = Utils::Q16_16(Width / 2 - 8);
+                settings.ExtentY = Utils::Q16_16(Height / 2 - 8);
+                settings.VelocitySpread = Utils::Q16_16(20);
+                settings.MinLifetimeMs = 60000;
+                settings.MaxLifetimeMs = 60000;
+                Graphics::ParticleEmitter emitter;
+                emitter.Init(settings, rng);
+                emitter.Fill(pool);
+                uint32_t poolNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    if (iteration % 4 == 0 && iteration != 0)
+                    {
+                        for (uint16_t i = 0; i < pool.GetCount(); i++)
+                        {
+                            pool.VX[i] = -pool.VX[i];
+                            pool.VY[i] = -pool.VY[i];
+                        }
+                    }
+                    pool.Update(Dt);
+                    Graphics::DrawParticlePoints(&buffer, pool, Utils::RGBAto16bit(255, 160, 64, 200), Graphics::ParticleBlend::Opaque);
+                    Sink = Sink + buffer.Data[Width * Height / 2];
+                });
+                Report("Update + draw points", baselineNs, poolNs);
+
+                uint32_t additiveNs = Measure(Iterations, [&](uint32_t)
+                {
+                    pool.Update(Dt);
+                    Graphics::DrawParticlePoints(&buffer, pool, Utils::RGBto16bit(64, 32, 16), Graphics::ParticleBlend::Additive);
+                    Sink = Sink + buffer.Data[Width * Height / 2];
+                });
+                Report("  opaque -> additive", poolNs, additiveNs);
+
+                uint32_t streakNs = Measure(Iterations, [&](uint32_t)
+                {
+                    pool.Update(Dt);
+                    Graphics::DrawParticleStreaks(&buffer, pool, Utils::RGBto16bit(255, 160, 64), Graphics::ParticleBlend::Opaque, Utils::Q16_16::FromRatio(1, 8));
+                    Sink = Sink + buffer.Data[Width * Height / 2];
+                });
+                Report("  points -> streaks", poolNs, streakNs);
+                arena.Reset();
+            }
+
+            {
+                // PicoSpace's starfield: the float PointCloud kernels it used before vs the integer particle pool.
+                constexpr uint16_t Count = 2048;
+                LOG("Particles: PointCloud floats vs projected ParticlePool (%u stars)\n", Count);
+
+                float* xs = arena.NewArray<float>(Count);
+                float* ys = arena.NewArray<float>(Count);
+                float* zs = arena.NewArray<float>(Count);
+                uint16_t* screenX = arena.NewArray<uint16_t>(Count);
+                uint16_t* screenY = arena.NewArray<uint16_t>(Count);
+                uint32_t* mask = arena.NewArray<uint32_t>(Utils::PointCloud::MaskWords(Count));
+                for (uint16_t i = 0; i < Count; i++)
+                {
+                    xs[i] = rng.Float(-700.0f, 700.0f);
+                    ys[i] = rng.Float(-700.0f, 700.0f);
+                    zs[i] = rng.Float(-700.0f, 700.0f);
+                }
+                Utils::PointCloud::Projection cloudProjection = Utils::PointCloud::Projection::ForScreen(Width, Height, 0.1f, 10000.0f);
+                uint32_t cloudNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    float speed = (iteration / 4) % 2 ? -2.0f : 2.0f;
+                    Utils::PointCloud::Translate(xs, ys, zs, Count, Utils::Vec3(0.0f, 0.0f, speed));
+                    Sink = Sink + Utils::PointCloud::CullOutsideRange(xs, ys, zs, Count, 1000.0f * 1000.0f, mask);
+                    Utils::PointCloud::Project(xs, ys, zs, Count, cloudProjection, screenX, screenY, mask);
+                    for (uint16_t word = 0; word < Utils::PointCloud::MaskWords(Count); word++)
+                    {
+                        for (uint32_t bits = mask[word]; bits; bits &= bits - 1)
+                        {
+                            uint16_t i = word * 32 + __builtin_ctz(bits);
+                            buffer.Data[screenY[i] * Width + screenX[i]] = 0xFFFF;
+                        }
+                    }
+                });
+                arena.Reset();
+
+                Graphics::ParticlePool stars;
+                stars.Init(arena, Count, Graphics::PARTICLE_DEPTH);
+                Graphics::EmitterSettings settings;
+                settings.SpawnShape = Graphics::EmitterSettings::Shape::Shell;
+                settings.InnerRadius = Utils::Q16_16(10);
+                settings.OuterRadius = Utils::Q16_16(1000);
+                Graphics::ParticleEmitter emitter;
+                emitter.Init(settings, rng);
+                emitter.Fill(stars);
+                Graphics::ParticleProjection projection = Graphics::ParticleProjection::ForScreen(Width, Height, Utils::Q16_16::FromFloat(0.1f), Utils::Q16_16(10000));
+                uint32_t poolNs = Measure(Iterations, [&](uint32_t iteration)
+                {
+                    int speed = (iteration / 4) % 2 ? -2 : 2;
+                    stars.Translate(Utils::Q16_16(), Utils::Q16_16(), Utils::Q16_16(speed));
+                    if (stars.KillOutsideRange(Utils::Q16_16(1000)))
+                        emitter.Fill(stars);
+                    Sink = Sink + Graphics::DrawProjectedParticles(&buffer, stars, projection, 0xFFFF, Graphics::ParticleBlend::Opaque);
+                });
+                Report("Starfield move + draw", cloudNs, poolNs);
+
+                uint32_t respawnFloatNs = Measure(Iterations, [&](uint32_t)
+                {
+                    // PicoSpace's old respawn: a random distance and two angles through sin/cos.
+                    for (uint16_t i = 0; i < 64; i++)
+                    {
+                        float distance = rng.Float(10.0f, 1000.0f);
+                        uint32_t angleBits = rng.Next();
+                        float sinRotation, cosRotation, sinElevation, cosElevation;
+                        Utils::FastSinCos(Utils::BinaryAngle((uint16_t)angleBits).ToRadians(), sinRotation, cosRotation);
+                        Utils::FastSinCos(Utils::BinaryAngle((uint16_t)(angleBits >> 17)).ToRadians(), sinElevation, cosElevation);
+                        float x = distance * sinRotation * cosElevation;
+                        float y = distance * sinRotation * sinElevation;
+                        float z = distance * cosRotation;
+                        Sink = Sink + (uint32_t)(x + y + z);
+                    }
+                });
+                uint32_t respawnPoolNs = Measure(Iterations, [&](uint32_t)
+                {
+                    for (uint16_t i = 0; i < 64; i++)
+                        stars.Kill(i);
+                    Sink = Sink + emitter.Fill(stars);
+                });
+                Report("Respawn 64 stars", respawnFloatNs, respawnPoolNs);
+                arena.Reset();
+            }
+
+            Memory::Free(buffer.Data);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "utils/math.hpp"
+#include "utils/pointCloud.hpp"
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // Per-point Vec3 code (as PicoSpace used to do it) vs the SoA PointCloud kernels. Times are per whole batch.
+        void RunPointCloudBenchmarks()
+        {
+            constexpr uint32_t Count = 1024;
+            constexpr uint32_t Iterations = 16;
+            constexpr uint16_t Width = 320;
+            constexpr uint16_t Height = 240;
+            static Utils::Vec3 points[Count];
+            static float xs[Count];
+            static float ys[Count];
+            static float zs[Count];
+            static uint16_t screenX[Count];
+            static uint16_t screenY[Count];
+            static uint32_t mask[Utils::PointCloud::MaskWords(Count)];
+            for (uint32_t i = 0; i < Count; i++)
+            {
+                xs[i] = (float)((int32_t)(i * 37 % 1600) - 800);
+                ys[i] = (float)((int32_t)(i * 91 % 1600) - 800);
+                zs[i] = (float)((int32_t)(i * 53 % 1800) - 900);
+                points[i] = Utils::Vec3(xs[i], ys[i], zs[i]);
+            }
+
+            LOG("Point cloud: AoS Vec3 vs SoA kernels (%lu points)\n", (unsigned long)Count);
+
+            {
+                uint32_t aosNs = Measure(Iterations, [&](uint32_t)
+                {
+                    uint32_t outside = 0;
+                    for (uint32_t i = 0; i < Count; i++)
+                    {
+                        points[i].z += -0.5f;
+                        if (points[i] > 1000.0f)
+                            outside++;
+                    }
+                    Sink = Sink + outside;
+                });
+                uint32_t soaNs = Measure(Iterations, [&](uint32_t)
+                {
+                    Utils::PointCloud::Translate(xs, ys, zs, Count, Utils::Vec3(0.0f, 0.0f, -0.5f));
+                    Sink = Sink + Utils::PointCloud::CullOutsideRange(xs, ys, zs, Count, 1000.0f * 1000.0f, mask);
+                });
+                Report("Translate + range cull", aosNs, soaNs);
+            }
+
+            {
+                uint32_t aosNs = Measure(Iterations, [&](uint32_t)
+                {
+                    uint32_t visible = 0;
+                    for (uint32_t i = 0; i < Count; i++)
+                    {
+                        const Utils::Vec3& p = points[i];
+                        if (p.z < 0.1f)
+                            continue;
+                        float aspect = (float)Width / (float)Height;
+                        float inverseZ = 1.0f / p.z;
+                        float sx = (p.x * inverseZ) * (Height / 2.0f) * aspect + Width / 2.0f;
+                        float sy = (p.y * inverseZ) * (Height / 2.0f) + Height / 2.0f;
+                        if ((int16_t)sx < 0 || (int16_t)sx >= (int16_t)Width || (int16_t)sy < 0 || (int16_t)sy >= (int16_t)Height)
+                            continue;
+                        screenX[i] = (uint16_t)sx;
+                        screenY[i] = (uint16_t)sy;
+                        visible++;
+                    }
+                    Sink = Sink + visible;
+                });
+                Utils::PointCloud::Projection projection = Utils::PointCloud::Projection::ForScreen(Width, Height, 0.1f, 0.0f);
+                uint32_t soaNs = Measure(Iterations, [&](uint32_t)
+                {
+                    Sink = Sink + Utils::PointCloud::Project(xs, ys, zs, Count, projection, screenX, screenY, mask);
+                });
+                Report("Project", aosNs, soaNs);
+            }
+
+            {
+                Utils::Mat3 matrix;
+                matrix.RotateX(0.01f);
+                uint32_t aosNs = Measure(Iterations, [&](uint32_t)
+                {
+                    for (uint32_t i = 0; i < Count; i++)
+                        points[i] = matrix.Transform(points[i]);
+                    Sink = Sink + (uint32_t)(int32_t)points[0].y;
+                });
+                uint32_t soaNs = Measure(Iterations, [&](uint32_t)
+                {
+                    Utils::PointCloud::Rotate(xs, ys, zs, Count, matrix);
+                    Sink = Sink + (uint32_t)(int32_t)ys[0];
+                });
+                Report("Rotate (Mat3)", aosNs, soaNs);
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "utils/random.hpp"
+#include <cstdlib>
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // newlib rand() (locked, 31-bit LCG) vs the xoshiro128++ RandomStream.
+        void RunRandomBenchmarks()
+        {
+            constexpr uint32_t Iterations = 4096;
+            constexpr uint32_t FillCount = 256;
+            static uint32_t fill[FillCount];
+            Utils::RandomStream stream(12345);
+
+            LOG("Random: rand() vs RandomStream\n");
+
+            uint32_t randNs = Measure(Iterations, [&](uint32_t)
+            {
+                Sink = Sink + (uint32_t)rand();
+            });
+            uint32_t nextNs = Measure(Iterations, [&](uint32_t)
+            {
+                Sink = Sink + stream.Next();
+            });
+            Report("32-bit value", randNs, nextNs);
+
+            uint32_t moduloNs = Measure(Iterations, [&](uint32_t)
+            {
+                Sink = Sink + (uint32_t)rand() % 990;
+            });
+            uint32_t rangeNs = Measure(Iterations, [&](uint32_t)
+            {
+                Sink = Sink + stream.Range(990);
+            });
+            Report("Range (rand % n vs Lemire)", moduloNs, rangeNs);
+
+            uint32_t randFloatNs = Measure(Iterations, [&](uint32_t)
+            {
+                Sink = Sink + (uint32_t)((float)rand() * (1.0f / RAND_MAX) * 1000.0f);
+            });
+            uint32_t floatNs = Measure(Iterations, [&](uint32_t)
+            {
+                Sink = Sink + (uint32_t)(stream.Float01() * 1000.0f);
+            });
+            Report("Float in [0, 1)", randFloatNs, floatNs);
+
+            uint32_t randFillNs = Measure(Iterations / FillCount, [&](uint32_t)
+            {
+                for (uint32_t i = 0; i < FillCount; i++)
+                    fill[i] = (uint32_t)rand();
+                Sink = Sink + fill[FillCount - 1];
+            });
+            uint32_t fillNs = Measure(Iterations / FillCount, [&](uint32_t)
+            {
+                stream.Fill(fill, FillCount);
+                Sink = Sink + fill[FillCount - 1];
+            });
+            Report("Fill 256 values", randFillNs, fillNs);
+        }
+    }
+}
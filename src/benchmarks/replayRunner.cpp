@@ -0,0 +1,104 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "replay.hpp"
+#include "memory/arena.hpp"
+#include "games/gameRegistry.hpp"
+#include "games/game.hpp"
+#include "games/gameLoop.hpp"
+#include <cstdio>
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        struct TimingStats
+        {
+            uint32_t MinUs = UINT32_MAX;
+            uint32_t MaxUs = 0;
+            uint64_t TotalUs = 0;
+
+            void Add(uint32_t us)
+            {
+                if (us < MinUs) MinUs = us;
+                if (us > MaxUs) MaxUs = us;
+                TotalUs += us;
+            }
+        };
+
+        static void LogStats(const char* name, const TimingStats& stats, uint32_t frames)
+        {
+            LOG("  %-8s min %6lu us  avg %6lu us  max %6lu us\n", name, (unsigned long)(frames ? stats.MinUs : 0),
+                (unsigned long)(frames ? stats.TotalUs / frames : 0), (unsigned long)stats.MaxUs);
+        }
+
+        bool RunReplay(const char* path, PicoPixel::Driver::Buffer* buffer, bool perFrame)
+        {
+            char gameName[24];
+            if (!Replay::StartReplay(path, gameName, sizeof(gameName)))
+            {
+                LOG("Replay: No recording at %s, skipping\n", path);
+                return false;
+            }
+
+            const PicoPixel::Games::GameDescriptor* descriptor = PicoPixel::Games::GameRegistry::Find(gameName);
+            if (!descriptor)
+            {
+                LOG_ERROR("Replay: Recorded game '%s' is not registered\n", gameName);
+                Replay::Stop();
+                return false;
+            }
+
+            // Headless: the buffer is rendered into but never sent to the display.
+            PicoPixel::Games::Game* game = descriptor->Create(buffer);
+            if (!game)
+            {
+                LOG_ERROR("Replay: %s doesn't fit in the game arena\n", gameName);
+                Memory::GetGameArena().Reset();
+                Replay::Stop();
+                return false;
+            }
+            game->OnInit();
+            PicoPixel::Games::GameLoop loop(game);
+            TimingStats update;
+            TimingStats render;
+            uint32_t frames = 0;
+            bool exitGame = false;
+            while (!exitGame)
+            {
+                float dt = Replay::FrameDelta(0.0f);
+                if (Replay::IsFinished())
+                    break;
+
+                uint64_t start = time_us_64();
+                // The events the game was handed this frame, as the menu does before updating.
+                Input::Event event;
+                while (Replay::ReplayEvent(event))
+                    game->OnInput(event);
+                exitGame = loop.Update(dt);
+                uint64_t updated = time_us_64();
+                loop.Publish();
+                loop.Render();
+                uint64_t rendered = time_us_64();
+
+                uint32_t updateUs = (uint32_t)(updated - start);
+                uint32_t renderUs = (uint32_t)(rendered - updated);
+                update.Add(updateUs);
+                render.Add(renderUs);
+                if (perFrame)
+                    printf("#PPRB %lu %lu %lu\n", (unsigned long)frames, (unsigned long)updateUs, (unsigned long)renderUs);
+                frames++;
+
+                Log::Drain(LOG_DEFERRED_CAPACITY);
+            }
+            game->OnShutdown();
+            game->~Game();
+            Memory::GetGameArena().Reset();
+            Replay::Stop();
+
+            LOG("Replay: %s, %lu frames\n", gameName, (unsigned long)frames);
+            LogStats("Update", update, frames);
+            LogStats("Render", render, frames);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#include "benchmark.hpp"
+#include "log.hpp"
+#include "utils/trig.hpp"
+#include <cmath>
+
+namespace PicoPixel
+{
+    namespace Benchmarks
+    {
+        // newlib sinf/cosf/atan2f vs the table-driven versions, plus the worst error seen over the sweep.
+        void RunTrigBenchmarks()
+        {
+            constexpr uint32_t Count = 256;
+            constexpr uint32_t Iterations = 2048;
+            static float angles[Count];
+            static float xs[Count];
+            static float ys[Count];
+            for (uint32_t i = 0; i < Count; i++)
+            {
+                // Spread over a few turns, including negative angles.
+                angles[i] = (float)((int32_t)(i * 97 % 2000) - 1000) * 0.0157f;
+                xs[i] = (float)((int32_t)(i * 37 % 200) - 100) + 0.5f;
+                ys[i] = (float)((int32_t)(i * 91 % 200) - 100) + 0.25f;
+            }
+
+            LOG("Trig: libm vs tables\n");
+
+            {
+                uint32_t libmNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (uint32_t)(int32_t)(sinf(angles[i % Count]) * 1000.0f);
+                });
+                uint32_t tableNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (uint32_t)(int32_t)(Utils::FastSin(angles[i % Count]) * 1000.0f);
+                });
+                Report("sin (float)", libmNs, tableNs);
+
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (uint32_t)Utils::Sin(Utils::BinaryAngle((uint16_t)(i * 257))).Raw;
+                });
+                Report("sin (BinaryAngle, Q16.16)", libmNs, fixedNs);
+            }
+
+            {
+                uint32_t libmNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    float angle = angles[i % Count];
+                    Sink = Sink + (uint32_t)(int32_t)((sinf(angle) + cosf(angle)) * 1000.0f);
+                });
+                uint32_t tableNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    float s, c;
+                    Utils::FastSinCos(angles[i % Count], s, c);
+                    Sink = Sink + (uint32_t)(int32_t)((s + c) * 1000.0f);
+                });
+                Report("sincos (float)", libmNs, tableNs);
+            }
+
+            {
+                uint32_t libmNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (uint32_t)(int32_t)(atan2f(ys[i % Count], xs[i % Count]) * 1000.0f);
+                });
+                uint32_t tableNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + (uint32_t)(int32_t)(Utils::FastAtan2(ys[i % Count], xs[i % Count]) * 1000.0f);
+                });
+                Report("atan2 (float)", libmNs, tableNs);
+
+                uint32_t fixedNs = Measure(Iterations, [&](uint32_t i)
+                {
+                    Sink = Sink + Utils::Atan2((int32_t)(i * 37 % 200) - 100, (int32_t)(i * 91 % 200) - 100).Raw;
+                });
+                Report("atan2 (int -> BinaryAngle)", libmNs, fixedNs);
+            }
+
+            // Error sweeps. The float versions include the radians -> BinaryAngle quantisation.
+            float maxSinError = 0.0f;
+            float maxFixedError = 0.0f;
+            float maxAtanError = 0.0f;
+            for (uint32_t i = 0; i < Count; i++)
+            {
+                float error = fabsf(Utils::FastSin(angles[i]) - sinf(angles[i]));
+                if (error > maxSinError) maxSinError = error;
+
+                Utils::BinaryAngle angle((uint16_t)(i * 257));
+                error = fabsf(Utils::Sin(angle).ToFloat() - sinf(angle.ToRadians()));
+                if (error > maxFixedError) maxFixedError = error;
+
+                float reference = atan2f(ys[i], xs[i]);
+                if (reference < 0.0f)
+                    reference += 2.0f * 3.14159265f;
+                error = fabsf(Utils::FastAtan2(ys[i], xs[i]) - reference);
+                if (error > 3.14159265f)
+                    error = 2.0f * 3.14159265f - error;
+                if (error > maxAtanError) maxAtanError = error;
+            }
+            LOG("  FastSin max error: %f\n", maxSinError);
+            LOG("  Sin (Q16.16) max error: %f\n", maxFixedError);
+            LOG("  FastAtan2 max error: %f rad\n", maxAtanError);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "boot.hpp"
+#include "log.hpp"
+#include "pico/stdlib.h"
+
+namespace PicoPixel
+{
+    namespace Boot
+    {
+        struct Event
+        {
+            const char* Name;
+            uint64_t StartUs;
+            uint64_t EndUs;
+            bool IsMark;
+        };
+
+        static Event Events[BOOT_MAX_EVENTS];
+        static size_t EventCount = 0;
+        static uint32_t DroppedEvents = 0;
+
+        static void Add(const char* name, uint64_t startUs, uint64_t endUs, bool isMark)
+        {
+            if (EventCount == BOOT_MAX_EVENTS)
+            {
+                DroppedEvents++;
+                return;
+            }
+            Events[EventCount++] = { name, startUs, endUs, isMark };
+        }
+
+        void Record(const char* name, uint64_t startUs, uint64_t endUs)
+        {
+            Add(name, startUs, endUs, false);
+        }
+
+        void Mark(const char* name)
+        {
+            uint64_t now = time_us_64();
+            Add(name, now, now, true);
+        }
+
+        // "123.4" for a microsecond count, without dragging float printf in.
+        #define BOOT_MS_FORMAT "%5lu.%lu"
+        #define BOOT_MS(us) (unsigned long)((us) / 1000), (unsigned long)((us) / 100 % 10)
+
+        void Report()
+        {
+            // Spans are recorded when they end, so put them back in start order. There are only a handful.
+            for (size_t i = 1; i < EventCount; i++)
+            {
+                Event event = Events[i];
+                size_t j = i;
+                for (; j > 0 && Events[j - 1].StartUs > event.StartUs; j--)
+                    Events[j] = Events[j - 1];
+                Events[j] = event;
+            }
+
+            // In microseconds: a span as start, end and length fits a deferred record's four arguments that way.
+            LOG("Boot: Timeline, in us since reset\n");
+            for (size_t i = 0; i < EventCount; i++)
+            {
+                const Event& event = Events[i];
+                if (event.IsMark)
+                    LOG("Boot: %8lu                      %s\n", (unsigned long)event.StartUs, event.Name);
+                else
+                    LOG("Boot: %8lu - %8lu %8lu  %s\n", (unsigned long)event.StartUs, (unsigned long)event.EndUs,
+                        (unsigned long)(event.EndUs - event.StartUs), event.Name);
+            }
+            if (DroppedEvents)
+                LOG_WARN("Boot: %lu events didn't fit in the timeline (BOOT_MAX_EVENTS)\n", (unsigned long)DroppedEvents);
+
+            for (size_t i = 0; i < EventCount; i++)
+                if (Events[i].IsMark)
+                    LOG("Boot: %s at " BOOT_MS_FORMAT " ms\n", Events[i].Name, BOOT_MS(Events[i].StartUs));
+        }
+
+        void InitScheduler::Add(const char* name, StepFunction step, void* context, bool required)
+        {
+            if (StepCount == BOOT_MAX_STEPS)
+            {
+                LOG_ERROR("Boot: No room for step %s (BOOT_MAX_STEPS)\n", name);
+                return;
+            }
+            Steps[StepCount++] = { name, step, context, required };
+        }
+
+        bool InitScheduler::RunStep(const Step& step)
+        {
+            uint64_t start = time_us_64();
+            bool succeeded = step.Function(step.Context);
+            Record(step.Name, start, time_us_64());
+            if (!succeeded)
+            {
+                if (step.Required)
+                    LOG_ERROR("Boot: %s failed\n", step.Name);
+                else
+                    LOG_WARN("Boot: %s failed, carrying on without it\n", step.Name);
+            }
+            return succeeded || !step.Required;
+        }
+
+        bool InitScheduler::Run(const char* deviceName, uint64_t readyAt, PollFunction poll, void* context)
+        {
+            uint64_t deviceStart = time_us_64();
+            bool succeeded = true;
+            size_t next = 0;
+            while (readyAt || next < StepCount)
+            {
+                uint64_t now = time_us_64();
+#ifndef BOOT_SEQUENTIAL
+                if (readyAt && now >= readyAt)
+                {
+                    readyAt = poll(context);
+                    if (!readyAt)
+                        Record(deviceName, deviceStart, time_us_64());
+                }
+                else if (next < StepCount)
+                {
+                    succeeded &= RunStep(Steps[next++]);
+                }
+                else
+                {
+                    // Nothing left to overlap with the delay.
+                    sleep_until(from_us_since_boot(readyAt));
+                    Record("Idle", now, time_us_64());
+                }
+#else
+                if (readyAt)
+                {
+                    sleep_until(from_us_since_boot(readyAt));
+                    if (time_us_64() > now)
+                        Record("Idle", now, time_us_64());
+                    readyAt = poll(context);
+                    if (!readyAt)
+                        Record(deviceName, deviceStart, time_us_64());
+                }
+                else
+                {
+                    succeeded &= RunStep(Steps[next++]);
+                }
+#endif
+            }
+            StepCount = 0;
+            return succeeded;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Timeline entries kept until Report(). Later ones are dropped.
+#ifndef BOOT_MAX_EVENTS
+    #define BOOT_MAX_EVENTS 24
+#endif
+
+// Steps one InitScheduler can hold.
+#ifndef BOOT_MAX_STEPS
+    #define BOOT_MAX_STEPS 8
+#endif
+
+namespace PicoPixel
+{
+    // Start-up timeline, and a scheduler that overlaps independent start-up work with hardware that spends most of
+    // its initialization waiting (the display's reset and sleep-out delays).
+    //
+    // Times are microseconds since reset (time_us_64()). The timeline is kept in RAM and printed by Report(), since
+    // nothing is listening on USB serial yet for most of the boot.
+    namespace Boot
+    {
+        // A span of the timeline. Names must be string literals (the pointer is kept).
+        void Record(const char* name, uint64_t startUs, uint64_t endUs);
+
+        // A milestone, e.g. the first frame on screen. Report() sums these up at the end.
+        void Mark(const char* name);
+
+        // The timeline, in start order, then every milestone.
+        void Report();
+
+        // Does a device's next initialization step and returns when the one after is due, or 0 once it is done.
+        using PollFunction = uint64_t (*)(void* context);
+        using StepFunction = bool (*)(void* context);
+
+        // Runs steps that don't depend on the device (or each other, beyond the order they were added in) whenever
+        // the device is waiting out a delay, one step at a time. A step that outlasts the delay only pushes the
+        // device's next step back, which is safe because its delays are minimums. With BOOT_SEQUENTIAL the device is
+        // finished first and the steps run after it, as boot used to, for comparing the two.
+        class InitScheduler
+        {
+        public:
+            // A required step that fails makes Run() fail; other failures are only logged. Every step runs either way.
+            void Add(const char* name, StepFunction step, void* context = nullptr, bool required = false);
+
+            // readyAt is when the device's first step is due, as returned by whatever started it. Returns once the
+            // device is done and every step has run.
+            bool Run(const char* deviceName, uint64_t readyAt, PollFunction poll, void* context);
+
+        private:
+            struct Step
+            {
+                const char* Name;
+                StepFunction Function;
+                void* Context;
+                bool Required;
+            };
+
+            bool RunStep(const Step& step);
+
+        private:
+            Step Steps[BOOT_MAX_STEPS];
+            size_t StepCount = 0;
+        };
+    }
+}
@@ -0,0 +1,137 @@
+#include "clockGovernor.hpp"
+#include "log.hpp"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+// After the SDK headers: the display driver's headers define kHz and MHz as macros.
+#include "games/gameLoop.hpp"
+
+namespace PicoPixel
+{
+    namespace ClockGovernor
+    {
+        static const ClockProfile Profiles[] =
+        {
+            { "Eco", 62500, false },
+            { "Normal", 125000, false },
+#ifdef CLOCK_GOVERNOR_OVERCLOCK
+            { "Turbo", 250000, true },
+#endif
+        };
+        static constexpr uint8_t PROFILE_COUNT = sizeof(Profiles) / sizeof(Profiles[0]);
+        static constexpr uint8_t NORMAL_PROFILE = 1;
+
+        const ClockProfile* GetProfiles()
+        {
+            return Profiles;
+        }
+
+        uint8_t GetProfileCount()
+        {
+            return PROFILE_COUNT;
+        }
+
+#if GAME_LOOP_FRAME_CAP_HZ > 0
+        static ClockPolicy Policy(Profiles, PROFILE_COUNT, NORMAL_PROFILE, 1000000u / GAME_LOOP_FRAME_CAP_HZ);
+#else
+        // Uncapped games have no budget to keep headroom in, so anything slower than the fastest profile is too slow.
+        static ClockPolicy Policy(Profiles, PROFILE_COUNT, NORMAL_PROFILE, 0);
+#endif
+        static spi_inst_t* SpiPort = nullptr;
+        static uint32_t RequestedSpiHz = 0;
+        static uint32_t AppliedKhz = 0;
+        static bool Overvolted = false;
+        static uint64_t LastAccountUs = 0;
+
+        // Charge the time since the last call to the profile that was running.
+        static void Account()
+        {
+            uint64_t now = time_us_64();
+            Policy.Account((uint32_t)(now - LastAccountUs));
+            LastAccountUs = now;
+        }
+
+        void Init(spi_inst_t* spiPort, uint32_t spiHz)
+        {
+            SpiPort = spiPort;
+            RequestedSpiHz = spiHz;
+            Policy.SetSpiHz(spiHz);
+            AppliedKhz = clock_get_hz(clk_sys) / 1000;
+            LastAccountUs = time_us_64();
+            for (uint8_t i = 0; i < PROFILE_COUNT; i++)
+                LOG("Clock: %s profile, %lu kHz, SPI %lu Hz\n", Profiles[i].Name, (unsigned long)Profiles[i].Khz,
+                    (unsigned long)ClockPolicy::GetSpiBaudrate(Profiles[i].Khz * 1000, spiHz));
+        }
+
+        void StartGame()
+        {
+            Account();
+            Policy.SetProfile(NORMAL_PROFILE);
+            Policy.ResetLoad();
+            Apply();
+        }
+
+        void SetIdle()
+        {
+            Account();
+            Policy.SetProfile(0);
+            Apply();
+        }
+
+        bool Update(uint32_t busyUs, uint32_t presentUs)
+        {
+            Account();
+            return Profiles[Policy.Update(busyUs, presentUs)].Khz != AppliedKhz;
+        }
+
+        void Apply()
+        {
+            const ClockProfile& profile = Profiles[Policy.GetProfile()];
+            if (profile.Khz == AppliedKhz || !SpiPort)
+                return;
+
+            // Voltage goes up before the clock does and comes down after it.
+            if (profile.Overvolt && !Overvolted)
+            {
+                vreg_set_voltage(VREG_VOLTAGE_1_20);
+                sleep_us(CLOCK_GOVERNOR_VREG_SETTLE_US);
+                Overvolted = true;
+            }
+            if (!set_sys_clock_khz(profile.Khz, false))
+            {
+                LOG_WARN("Clock: %lu kHz can't be reached from the crystal\n", (unsigned long)profile.Khz);
+                return;
+            }
+            // clk_peri follows clk_sys, so the SPI divider has to be worked out again for the display's rate.
+            uint32_t spiHz = spi_set_baudrate(SpiPort, RequestedSpiHz);
+            if (!profile.Overvolt && Overvolted)
+            {
+                vreg_set_voltage(VREG_VOLTAGE_DEFAULT);
+                Overvolted = false;
+            }
+            AppliedKhz = profile.Khz;
+            LOG_DEFERRED(LOG_LEVEL_DEBUG, "Clock: %s, %lu kHz, SPI %lu Hz\n", profile.Name, (unsigned long)profile.Khz,
+                (unsigned long)spiHz);
+        }
+
+        uint32_t GetKhz()
+        {
+            return AppliedKhz;
+        }
+
+        void Report()
+        {
+            Account();
+            uint64_t totalUs = 0;
+            for (uint8_t i = 0; i < PROFILE_COUNT; i++)
+                totalUs += Policy.GetTimeUs(i);
+            LOG("Clock: %lu switches\n", (unsigned long)Policy.GetSwitchCount());
+            for (uint8_t i = 0; i < PROFILE_COUNT; i++)
+            {
+                uint64_t us = Policy.GetTimeUs(i);
+                LOG("Clock: %-8s %8lu ms %3lu%%\n", Profiles[i].Name, (unsigned long)(us / 1000),
+                    (unsigned long)(totalUs ? us * 100 / totalUs : 0));
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "clockPolicy.hpp"
+#include "hardware/spi.h"
+#include <cstdint>
+
+// Time for the regulator to settle after raising the core voltage, before clocking up.
+#ifndef CLOCK_GOVERNOR_VREG_SETTLE_US
+    #define CLOCK_GOVERNOR_VREG_SETTLE_US 1000
+#endif
+
+namespace PicoPixel
+{
+    // Runs clk_sys only as fast as the current game needs: slow in the menu and for light games, faster (with
+    // CLOCK_GOVERNOR_OVERCLOCK, overclocked) for heavy ones.
+    namespace ClockGovernor
+    {
+        // Built-in profiles, slowest first: Eco (62.5 MHz), Normal (125 MHz, the SDK default) and, with
+        // CLOCK_GOVERNOR_OVERCLOCK, Turbo (250 MHz at 1.20 V).
+        const ClockProfile* GetProfiles();
+        uint8_t GetProfileCount();
+
+        // Start governing. spiHz is the display's requested baud rate, restored on spiPort after every change.
+        void Init(spi_inst_t* spiPort, uint32_t spiHz);
+
+        // A game is starting: back to Normal with a fresh load estimate.
+        void StartGame();
+
+        // Nothing to draw (the menu is waiting): drop to the slowest profile.
+        void SetIdle();
+
+        // Feed one frame. True when the policy wants a different clock; call Apply() once the SPI bus is idle.
+        bool Update(uint32_t busyUs, uint32_t presentUs);
+        void Apply();
+
+        uint32_t GetKhz();
+
+        // Time spent in each profile and how often the clock changed.
+        void Report();
+    }
+}
@@ -0,0 +1,144 @@
+#include "clockPolicy.hpp"
+
+namespace PicoPixel
+{
+    namespace ClockGovernor
+    {
+        ClockPolicy::ClockPolicy(const ClockProfile* profiles, uint8_t count, uint8_t initial, uint32_t frameBudgetUs)
+            : Profiles(profiles)
+            , Count(count < MAX_PROFILES ? count : MAX_PROFILES)
+            , Current(initial)
+            , BudgetUs(frameBudgetUs)
+        {
+            for (uint8_t i = 0; i < MAX_PROFILES; i++)
+                SpiHz[i] = 1;
+        }
+
+        uint32_t ClockPolicy::GetSpiBaudrate(uint32_t peripheralHz, uint32_t requestedHz)
+        {
+            // Same search as spi_set_baudrate(): the smallest even prescale that leaves the post-divider in range,
+            // then the largest post-divider that still doesn't go over the request.
+            uint32_t prescale = 2;
+            for (; prescale <= 254; prescale += 2)
+                if (peripheralHz < (prescale + 2) * 256ull * requestedHz)
+                    break;
+            uint32_t postdiv = 256;
+            for (; postdiv > 1; postdiv--)
+                if (peripheralHz / (prescale * (postdiv - 1)) > requestedHz)
+                    break;
+            return peripheralHz / (prescale * postdiv);
+        }
+
+        void ClockPolicy::SetSpiHz(uint32_t spiHz)
+        {
+            // clk_peri runs off clk_sys, so each profile gets whatever its own divider search lands on.
+            for (uint8_t i = 0; i < Count; i++)
+                SpiHz[i] = GetSpiBaudrate(Profiles[i].Khz * 1000, spiHz);
+        }
+
+        void ClockPolicy::SetProfile(uint8_t index)
+        {
+            if (index != Current)
+                Switch(index);
+        }
+
+        void ClockPolicy::ResetLoad()
+        {
+            CpuUs = 0;
+            SpiUs = 0;
+            HasSamples = false;
+            UpFrames = 0;
+            DownFrames = 0;
+        }
+
+        uint32_t ClockPolicy::Predict(uint32_t cpuUs, uint32_t spiUs, uint8_t index) const
+        {
+            uint64_t scaledCpuUs = (uint64_t)cpuUs * Profiles[Current].Khz / Profiles[index].Khz;
+            uint64_t scaledSpiUs = (uint64_t)spiUs * SpiHz[Current] / SpiHz[index];
+            return (uint32_t)(scaledCpuUs + scaledSpiUs);
+        }
+
+        uint32_t ClockPolicy::PredictUs(uint8_t index) const
+        {
+            return Predict(CpuUs, SpiUs, index);
+        }
+
+        uint32_t ClockPolicy::GetLimitUs(uint32_t cpuUs, uint32_t spiUs, uint32_t marginPercent) const
+        {
+            uint32_t targetUs = BudgetUs * CLOCK_GOVERNOR_TARGET_LOAD / 100 * marginPercent / 100;
+            uint32_t bestUs = Predict(cpuUs, spiUs, Count - 1) * (100 + CLOCK_GOVERNOR_SLACK * marginPercent / 100) / 100;
+            return targetUs > bestUs ? targetUs : bestUs;
+        }
+
+        uint8_t ClockPolicy::Fit(uint32_t cpuUs, uint32_t spiUs) const
+        {
+            uint32_t limitUs = GetLimitUs(cpuUs, spiUs, 100);
+            for (uint8_t i = 0; i < Count; i++)
+                if (Predict(cpuUs, spiUs, i) <= limitUs)
+                    return i;
+            return Count - 1;
+        }
+
+        void ClockPolicy::Switch(uint8_t index)
+        {
+            // Carry the estimate over to the new clock, so the next decision doesn't wait for it to settle again.
+            CpuUs = (uint32_t)((uint64_t)CpuUs * Profiles[Current].Khz / Profiles[index].Khz);
+            SpiUs = (uint32_t)((uint64_t)SpiUs * SpiHz[Current] / SpiHz[index]);
+            Current = index;
+            UpFrames = 0;
+            DownFrames = 0;
+            Switches++;
+        }
+
+        uint8_t ClockPolicy::Update(uint32_t busyUs, uint32_t presentUs)
+        {
+            uint32_t spiUs = presentUs < busyUs ? presentUs : busyUs;
+            uint32_t cpuUs = busyUs - spiUs;
+            if (!HasSamples)
+            {
+                CpuUs = cpuUs;
+                SpiUs = spiUs;
+                HasSamples = true;
+            }
+            else
+            {
+                constexpr uint32_t Weight = (1u << CLOCK_GOVERNOR_SMOOTHING_SHIFT) - 1;
+                CpuUs = (uint32_t)(((uint64_t)CpuUs * Weight + cpuUs) >> CLOCK_GOVERNOR_SMOOTHING_SHIFT);
+                SpiUs = (uint32_t)(((uint64_t)SpiUs * Weight + spiUs) >> CLOCK_GOVERNOR_SMOOTHING_SHIFT);
+            }
+
+            // Stepping up also goes by this frame's own costs, so a load that jumps is followed within
+            // CLOCK_GOVERNOR_UP_FRAMES frames rather than once the average has caught up. A lone spike doesn't last
+            // that many frames.
+            uint8_t frameDesired = Fit(cpuUs, spiUs);
+            uint8_t averageDesired = Fit(CpuUs, SpiUs);
+            uint8_t desired = frameDesired > averageDesired ? frameDesired : averageDesired;
+
+            if (desired > Current)
+            {
+                // Frames are being missed (or about to be): go straight to the fastest profile all frames of the run agree on.
+                DownFrames = 0;
+                UpTarget = (UpFrames == 0 || desired < UpTarget) ? desired : UpTarget;
+                if (++UpFrames >= CLOCK_GOVERNOR_UP_FRAMES)
+                {
+                    // Start the average from the load that forced the change, so it doesn't talk the policy back down.
+                    CpuUs = cpuUs > CpuUs ? cpuUs : CpuUs;
+                    SpiUs = spiUs > SpiUs ? spiUs : SpiUs;
+                    Switch(UpTarget);
+                }
+            }
+            else if (Current > 0 && PredictUs(Current - 1) <= GetLimitUs(CpuUs, SpiUs, CLOCK_GOVERNOR_DOWN_MARGIN))
+            {
+                UpFrames = 0;
+                if (++DownFrames >= CLOCK_GOVERNOR_DOWN_FRAMES)
+                    Switch(Current - 1);
+            }
+            else
+            {
+                UpFrames = 0;
+                DownFrames = 0;
+            }
+            return Current;
+        }
+    }
+}
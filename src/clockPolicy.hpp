@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+
+// Load a profile's frame time may reach, as a percentage of the frame budget, before a faster profile is picked.
+#ifndef CLOCK_GOVERNOR_TARGET_LOAD
+    #define CLOCK_GOVERNOR_TARGET_LOAD 80
+#endif
+
+// How much longer than at the fastest profile a frame may take, in percent, when not even the fastest profile fits
+// the budget (e.g. frames bound by SPI). Keeps such games from being pinned at the top for almost nothing.
+#ifndef CLOCK_GOVERNOR_SLACK
+    #define CLOCK_GOVERNOR_SLACK 10
+#endif
+
+// Hysteresis: stepping down needs the slower profile to fit within this percentage of the load and slack that
+// stepping up allows, so a load sitting near a boundary doesn't flip between two profiles.
+#ifndef CLOCK_GOVERNOR_DOWN_MARGIN
+    #define CLOCK_GOVERNOR_DOWN_MARGIN 85
+#endif
+
+// Consecutive frames that must agree before stepping up (quickly, straight to the profile that fits) or down
+// (slowly, one profile at a time).
+#ifndef CLOCK_GOVERNOR_UP_FRAMES
+    #define CLOCK_GOVERNOR_UP_FRAMES 3
+#endif
+#ifndef CLOCK_GOVERNOR_DOWN_FRAMES
+    #define CLOCK_GOVERNOR_DOWN_FRAMES 120
+#endif
+
+// Frame costs are averaged over about 2^this frames.
+#ifndef CLOCK_GOVERNOR_SMOOTHING_SHIFT
+    #define CLOCK_GOVERNOR_SMOOTHING_SHIFT 3
+#endif
+
+namespace PicoPixel
+{
+    namespace ClockGovernor
+    {
+        struct ClockProfile
+        {
+            const char* Name;
+            uint32_t Khz;
+            bool Overvolt;      // Needs the core regulator raised (VREG_VOLTAGE_1_20) to be stable.
+        };
+
+        // The decision making, with no hardware access so it can be driven by a recorded or synthetic load trace
+        // (see RunClockBenchmarks() and tests/clockPolicyTests.cpp).
+        //
+        // Each frame's work is split into CPU time, which scales with clk_sys, and SPI time, which scales with the
+        // baud rate the display actually gets. clk_peri follows clk_sys, so that rate stays put wherever the divider
+        // can reach it and drops where it can't (below 2x the requested rate). From those the policy predicts the
+        // frame time at every profile and picks the slowest that fits the budget with CLOCK_GOVERNOR_TARGET_LOAD
+        // headroom. Profiles must be sorted from slowest to fastest.
+        class ClockPolicy
+        {
+        public:
+            ClockPolicy(const ClockProfile* profiles, uint8_t count, uint8_t initial, uint32_t frameBudgetUs);
+
+            // The display's requested baud rate. Until this is set, present time is taken not to change with clk_sys.
+            void SetSpiHz(uint32_t spiHz);
+
+            // Feed one frame: busyUs of work (everything but waiting for the next frame), of which presentUs went to
+            // the display. Returns the profile to run at from now on.
+            uint8_t Update(uint32_t busyUs, uint32_t presentUs);
+
+            // Switch without a frame's say-so (e.g. to the slowest while the menu idles). Keeps the load estimate.
+            void SetProfile(uint8_t index);
+            uint8_t GetProfile() const { return Current; }
+
+            // Forget the measured load, e.g. for a new game.
+            void ResetLoad();
+
+            // Frame time expected at a profile, from the smoothed costs measured at the current one.
+            uint32_t PredictUs(uint8_t index) const;
+
+            // Charge time to the current profile, for GetTimeUs().
+            void Account(uint32_t us) { TimeUs[Current] += us; }
+            uint64_t GetTimeUs(uint8_t index) const { return TimeUs[index]; }
+            uint32_t GetSwitchCount() const { return Switches; }
+
+            uint8_t GetCount() const { return Count; }
+            const ClockProfile& Get(uint8_t index) const { return Profiles[index]; }
+
+            // What spi_set_baudrate() will get out of a peripheral clock, with the SDK's divider search.
+            static uint32_t GetSpiBaudrate(uint32_t peripheralHz, uint32_t requestedHz);
+
+            static constexpr uint8_t MAX_PROFILES = 4;
+
+        private:
+            // Frame time expected at a profile for costs measured at the current one.
+            uint32_t Predict(uint32_t cpuUs, uint32_t spiUs, uint8_t index) const;
+            // Longest predicted frame a profile may take for these costs, with marginPercent of the target load and slack.
+            uint32_t GetLimitUs(uint32_t cpuUs, uint32_t spiUs, uint32_t marginPercent) const;
+            // Slowest profile that fits these costs, or the fastest.
+            uint8_t Fit(uint32_t cpuUs, uint32_t spiUs) const;
+            void Switch(uint8_t index);
+
+        private:
+            const ClockProfile* Profiles;
+            uint8_t Count;
+            uint8_t Current;
+            uint16_t UpFrames = 0;
+            uint8_t UpTarget = 0;           // Fastest profile every frame of the current up run wanted at least.
+            uint16_t DownFrames = 0;
+            uint32_t BudgetUs;
+            uint32_t SpiHz[MAX_PROFILES];   // Baud rate the display gets at each profile.
+            uint32_t CpuUs = 0;             // Smoothed costs at the current profile.
+            uint32_t SpiUs = 0;
+            bool HasSamples = false;
+            uint32_t Switches = 0;
+            uint64_t TimeUs[MAX_PROFILES] = {};
+        };
+    }
+}
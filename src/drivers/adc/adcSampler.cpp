@@ -0,0 +1,250 @@
+#include "adcSampler.hpp"
+#include "log.hpp"
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#endif
+
+static_assert((ADC_SAMPLER_AVERAGE & (ADC_SAMPLER_AVERAGE - 1)) == 0, "ADC_SAMPLER_AVERAGE must be a power of two");
+static_assert((ADC_SAMPLER_RING_SIZE & (ADC_SAMPLER_RING_SIZE - 1)) == 0, "ADC_SAMPLER_RING_SIZE must be a power of two");
+static_assert(ADC_SAMPLER_RING_SIZE >= 2 * ADC_SAMPLER_AVERAGE * PicoPixel::AdcSampler::INPUT_COUNT,
+    "ADC_SAMPLER_RING_SIZE is too small to average every input while the DMA keeps writing");
+
+namespace PicoPixel
+{
+    namespace AdcSampler
+    {
+        static bool Initialized = false;
+        static uint8_t References[INPUT_COUNT] = {};
+
+        // Hysteresis state: the last reading handed out per input.
+        static uint16_t Settled[INPUT_COUNT] = {};
+        static bool HasSettled[INPUT_COUNT] = {};
+
+        // Enabled inputs in the order the round robin converts them, lowest first.
+        static uint8_t Order[INPUT_COUNT] = {};
+        static uint8_t OrderCount = 0;
+
+#if PICO_ON_DEVICE
+        static constexpr uint32_t Log2(uint32_t value) { return value > 1 ? 1 + Log2(value / 2) : 0; }
+
+        // The DMA wraps its write address within the ring, which needs the ring aligned to its size.
+        alignas(ADC_SAMPLER_RING_SIZE * sizeof(uint16_t)) static uint16_t Ring[ADC_SAMPLER_RING_SIZE];
+        static int DmaChannel = -1;
+
+        // The transfer count is armed as high as it goes and counts down one per sample, which makes it the sample
+        // counter too. About five days at the full 10 kS/s; readings re-arm it long before it runs out.
+        static constexpr uint32_t ARMED_COUNT = 0xFFFFFFFFu;
+        static constexpr uint32_t REARM_AFTER = 0x80000000u;
+
+        static void Stop()
+        {
+            if (!OrderCount)
+                return;
+            adc_run(false);
+            dma_channel_abort(DmaChannel);
+            adc_fifo_drain();
+            OrderCount = 0;
+        }
+
+        static void Start()
+        {
+            uint32_t mask = 0;
+            for (uint8_t input = 0; input < INPUT_COUNT; input++)
+            {
+                if (References[input])
+                {
+                    Order[OrderCount++] = input;
+                    mask |= 1u << input;
+                }
+            }
+            if (!OrderCount)
+                return;
+
+            // Sample n is then always input Order[n % OrderCount], so a reading can find its own samples in the ring.
+            adc_select_input(Order[0]);
+            adc_set_round_robin(mask);
+            adc_set_clkdiv((float)clock_get_hz(clk_adc) / (ADC_SAMPLER_RATE_HZ * OrderCount) - 1.0f);
+            adc_fifo_setup(true, true, 1, false, false);
+            adc_fifo_drain();
+
+            dma_channel_config config = dma_channel_get_default_config(DmaChannel);
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+            channel_config_set_read_increment(&config, false);
+            channel_config_set_write_increment(&config, true);
+            channel_config_set_ring(&config, true, Log2(sizeof(Ring)));
+            channel_config_set_dreq(&config, DREQ_ADC);
+            dma_channel_configure(DmaChannel, &config, Ring, &adc_hw->fifo, ARMED_COUNT, true);
+            adc_run(true);
+        }
+
+        static void Restart()
+        {
+            Stop();
+            Start();
+        }
+
+        uint32_t GetSampleCount()
+        {
+            if (!OrderCount)
+                return 0;
+            return ARMED_COUNT - dma_channel_hw_addr(DmaChannel)->transfer_count;
+        }
+
+        // Position of an input in the round robin, or OrderCount if it isn't being sampled.
+        static uint8_t FindSlot(uint8_t input)
+        {
+            uint8_t slot = 0;
+            while (slot < OrderCount && Order[slot] != input)
+                slot++;
+            return slot;
+        }
+
+        // Newest sample number belonging to an input, if it has one yet.
+        static bool FindNewest(uint8_t input, uint32_t& sample)
+        {
+            uint8_t slot = FindSlot(input);
+            uint32_t count = GetSampleCount();
+            if (slot == OrderCount || count <= slot)
+                return false;
+            if (count > REARM_AFTER)
+            {
+                Restart();
+                return false;
+            }
+            sample = count - 1 - (count - 1 - slot) % OrderCount;
+            return true;
+        }
+
+        static bool Average(uint8_t input, uint16_t& value)
+        {
+            uint32_t sample;
+            if (!FindNewest(input, sample))
+                return false;
+            uint32_t sum = 0;
+            uint32_t taken = 0;
+            for (; taken < ADC_SAMPLER_AVERAGE; taken++, sample -= OrderCount)
+            {
+                sum += Ring[sample % ADC_SAMPLER_RING_SIZE];
+                if (sample < OrderCount)
+                {
+                    taken++;
+                    break;
+                }
+            }
+            value = (uint16_t)(sum / taken);
+            return true;
+        }
+
+        uint16_t ReadRaw(uint8_t input)
+        {
+            uint32_t sample;
+            return FindNewest(input, sample) ? Ring[sample % ADC_SAMPLER_RING_SIZE] : 0;
+        }
+#else
+        static void Restart()
+        {
+            OrderCount = 0;
+            for (uint8_t input = 0; input < INPUT_COUNT; input++)
+                if (References[input])
+                    Order[OrderCount++] = input;
+        }
+
+        uint32_t GetSampleCount()
+        {
+            return 0;
+        }
+
+        static bool Average(uint8_t input, uint16_t& value)
+        {
+            if (!References[input])
+                return false;
+            value = ReadRaw(input);
+            return true;
+        }
+
+        uint16_t ReadRaw(uint8_t input)
+        {
+            if (input >= INPUT_COUNT || !References[input])
+                return 0;
+            adc_select_input(input);
+            return adc_read();
+        }
+#endif
+
+        void Init()
+        {
+            if (Initialized)
+                return;
+            adc_init();
+#if PICO_ON_DEVICE
+            DmaChannel = dma_claim_unused_channel(true);
+#endif
+            Initialized = true;
+        }
+
+        bool Enable(uint8_t input)
+        {
+            if (input >= INPUT_COUNT)
+            {
+                LOG_ERROR("ADC: There is no input %u\n", input);
+                return false;
+            }
+            Init();
+            if (References[input]++)
+                return true;
+
+            if (input < 4)
+                adc_gpio_init(26 + input);
+#if PICO_ON_DEVICE
+            else
+                adc_set_temp_sensor_enabled(true);
+#endif
+            HasSettled[input] = false;
+            Restart();
+            return true;
+        }
+
+        void Disable(uint8_t input)
+        {
+            if (input >= INPUT_COUNT || !References[input] || --References[input])
+                return;
+#if PICO_ON_DEVICE
+            if (input == 4)
+                adc_set_temp_sensor_enabled(false);
+#endif
+            Restart();
+        }
+
+        bool IsEnabled(uint8_t input)
+        {
+            return input < INPUT_COUNT && References[input];
+        }
+
+        uint16_t Read(uint8_t input)
+        {
+            uint16_t value;
+            if (input >= INPUT_COUNT || !Average(input, value))
+                return 0;
+
+            // Snap to the ends, which hysteresis would otherwise keep a reading from ever reaching.
+            if (value <= ADC_SAMPLER_HYSTERESIS)
+                value = 0;
+            else if (value >= MAX_VALUE - ADC_SAMPLER_HYSTERESIS)
+                value = MAX_VALUE;
+
+            int delta = (int)value - (int)Settled[input];
+            if (!HasSettled[input] || delta > ADC_SAMPLER_HYSTERESIS || delta < -ADC_SAMPLER_HYSTERESIS
+                || value == 0 || value == MAX_VALUE)
+            {
+                Settled[input] = value;
+                HasSettled[input] = true;
+            }
+            return Settled[input];
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+// Samples per second taken from each enabled input. The ADC's round robin shares its 500 kS/s between them.
+#ifndef ADC_SAMPLER_RATE_HZ
+    #define ADC_SAMPLER_RATE_HZ 2000
+#endif
+
+// Newest samples averaged per reading (a power of two). 8 at 2 kHz smooths over 4 ms.
+#ifndef ADC_SAMPLER_AVERAGE
+    #define ADC_SAMPLER_AVERAGE 8
+#endif
+
+// How far (in 12-bit counts) the average has to move before a reading changes, so a resting knob reads steady.
+#ifndef ADC_SAMPLER_HYSTERESIS
+    #define ADC_SAMPLER_HYSTERESIS 6
+#endif
+
+// Samples in the DMA ring (a power of two). Needs at least ADC_SAMPLER_AVERAGE per enabled input, plus room for the
+// DMA to keep writing while a reading walks back through it.
+#ifndef ADC_SAMPLER_RING_SIZE
+    #define ADC_SAMPLER_RING_SIZE 128
+#endif
+
+namespace PicoPixel
+{
+    // Owns the ADC. Every enabled input is converted continuously in the ADC's round robin and DMA'd into a ring in
+    // RAM, with no CPU involvement, so a reading is a short average over the newest samples instead of a blocking
+    // conversion in the middle of a frame.
+    //
+    // Readings come straight out of the ring: nothing is locked and the DMA never waits, and a sample overwritten
+    // mid-reading is simply the newer one. Only the hysteresis state is per reader, so read from core0.
+    //
+    // The host simulator has no DMA; there a reading is one adc_read() of the simulated input, through the same
+    // hysteresis.
+    namespace AdcSampler
+    {
+        // Inputs 0-3 are GPIO 26-29, 4 is the temperature sensor.
+        static constexpr uint8_t INPUT_COUNT = 5;
+        static constexpr uint16_t MAX_VALUE = 4095;
+
+        // adc_init() and the pin set-up, once. Enable() does this itself; call it early to use the ADC directly
+        // (e.g. for entropy) before anything is enabled.
+        void Init();
+
+        // Start sampling an input (reference counted). Sampling restarts with the new set of inputs, so enable
+        // inputs when a game starts, not per frame. False for inputs that don't exist.
+        bool Enable(uint8_t input);
+        void Disable(uint8_t input);
+        bool IsEnabled(uint8_t input);
+
+        // Average of the newest ADC_SAMPLER_AVERAGE samples, with hysteresis. 0 for inputs that aren't enabled.
+        uint16_t Read(uint8_t input);
+
+        // The newest sample, unfiltered.
+        uint16_t ReadRaw(uint8_t input);
+
+        // Samples taken since sampling last (re)started, across all inputs.
+        uint32_t GetSampleCount();
+    }
+}
@@ -1,5 +1,6 @@
 #include "ili9341.hpp"
 #include "log.hpp"
+#include "memory/accounting.hpp"
 #include "hardware/pwm.h"
 #include <cstdlib>
 #include <array>
@@ -8,9 +9,30 @@ namespace PicoPixel
 {
     namespace Driver
     {
+        // What ContinueInitializeIli9341() does next. Each phase ends with a delay the controller needs before the next.
+        enum InitPhase : uint8_t
+        {
+            INIT_PHASE_RESET_LOW,       // After RESET has been high for 10 ms.
+            INIT_PHASE_RESET_HIGH,      // After holding RESET low for 10 ms.
+            INIT_PHASE_CONFIGURE,       // After the software reset.
+            INIT_PHASE_DISPLAY_ON,      // After sleep out.
+            INIT_PHASE_BACKLIGHT,       // After display on.
+            INIT_PHASE_DONE,
+        };
+
         void InitializeIli9341(Ili9341Data* display, spi_inst_t* spiPort, int spiClockFreqency, uint8_t gpioCS, uint8_t gpioRESET, uint8_t gpioDC, uint8_t gpioSDI_MOSI, uint8_t gpioSCK, uint8_t gpioLed, uint8_t gpioSDO_MISO, bool portrait)
         {
-            if (display->IsInitialized) return;
+            uint64_t readyAt = BeginInitializeIli9341(display, spiPort, spiClockFreqency, gpioCS, gpioRESET, gpioDC, gpioSDI_MOSI, gpioSCK, gpioLed, gpioSDO_MISO, portrait);
+            while (readyAt)
+            {
+                sleep_until(from_us_since_boot(readyAt));
+                readyAt = ContinueInitializeIli9341(display);
+            }
+        }
+
+        uint64_t BeginInitializeIli9341(Ili9341Data* display, spi_inst_t* spiPort, int spiClockFreqency, uint8_t gpioCS, uint8_t gpioRESET, uint8_t gpioDC, uint8_t gpioSDI_MOSI, uint8_t gpioSCK, uint8_t gpioLed, uint8_t gpioSDO_MISO, bool portrait)
+        {
+            if (display->IsInitialized) return 0;
 
             display->IsPortrait = portrait;
             display->SpiPort = spiPort;
@@ -22,7 +44,8 @@ namespace PicoPixel
             display->GpioSCK = gpioSCK;
             display->GpioLed = gpioLed;
             display->GpioSDO_MISO = gpioSDO_MISO;
-            // Width and Height are set later.
+            // Known now, so the framebuffer can be created while the display is still resetting.
+            SetDimensions(display, portrait);
 
             // Setup GPIO stuffs
             gpio_init(display->GpioLed);
@@ -54,38 +77,67 @@ namespace PicoPixel
             gpio_put(display->GpioDC, 0);
 
             // Hardware reset
-            sleep_ms(10);
-            gpio_put(display->GpioRESET, 0);
-            sleep_ms(10);
-            gpio_put(display->GpioRESET, 1);
-
-            // Software reset
-            SetCommand(display, ILI9341_SWRESET);
-            sleep_ms(100); // NOTE: Required to wait at least 5ms before sending new commands, but appears that we need more than 5ms.
-
-            // Gamma correction
-            SetCommand(display, ILI9341_GAMMASET);
-            CommandParameter(display, 0b00000100); // Gamma curve 4
-
-            // Orientation / ILI9341_MADCTL + Width/Height setting.
-            SetOrientation(display, portrait);
-
-            // TODO: Ability to customize pixel format.
-            SetCommand(display, ILI9341_PIXFMT);
-            CommandParameter(display, 0b01010101); // 16-bit pixel format.
-
-            // TODO: Ability to customize/set fps
-            SetCommand(display, ILI9341_FRMCTR1);
-            CommandParameter(display, 0b00000000); // Internal oscillator frequency division ratio (0)
-            //CommandParameter(display, 0b00011111); // 60 fps / 31 clocks per line
-            CommandParameter(display, 0b00011011); // 70 fps / 27 clocks per line (default)
-            //CommandParameter(display, 0b00010101); // 90 fps / 21 clocks per line
-            //CommandParameter(display, 0b00010000); // 119 fps / 16 clocks per line (broken)
-
-            Wake(display);
-            SetBrightnessPercent(display, 100.0f);
+            display->InitPhase = INIT_PHASE_RESET_LOW;
+            return time_us_64() + 10 * 1000;
+        }
 
-            display->IsInitialized = true;
+        uint64_t ContinueInitializeIli9341(Ili9341Data* display)
+        {
+            switch (display->InitPhase)
+            {
+            case INIT_PHASE_RESET_LOW:
+                gpio_put(display->GpioRESET, 0);
+                display->InitPhase = INIT_PHASE_RESET_HIGH;
+                return time_us_64() + 10 * 1000;
+
+            case INIT_PHASE_RESET_HIGH:
+                gpio_put(display->GpioRESET, 1);
+
+                // Software reset
+                SetCommand(display, ILI9341_SWRESET);
+                display->InitPhase = INIT_PHASE_CONFIGURE;
+                return time_us_64() + 100 * 1000; // NOTE: Required to wait at least 5ms before sending new commands, but appears that we need more than 5ms.
+
+            case INIT_PHASE_CONFIGURE:
+                // Gamma correction
+                SetCommand(display, ILI9341_GAMMASET);
+                CommandParameter(display, 0b00000100); // Gamma curve 4
+
+                // Orientation / ILI9341_MADCTL + Width/Height setting.
+                SetOrientation(display, display->IsPortrait);
+
+                // TODO: Ability to customize pixel format.
+                SetCommand(display, ILI9341_PIXFMT);
+                CommandParameter(display, 0b01010101); // 16-bit pixel format.
+
+                // TODO: Ability to customize/set fps
+                SetCommand(display, ILI9341_FRMCTR1);
+                CommandParameter(display, 0b00000000); // Internal oscillator frequency division ratio (0)
+                //CommandParameter(display, 0b00011111); // 60 fps / 31 clocks per line
+                CommandParameter(display, 0b00011011); // 70 fps / 27 clocks per line (default)
+                //CommandParameter(display, 0b00010101); // 90 fps / 21 clocks per line
+                //CommandParameter(display, 0b00010000); // 119 fps / 16 clocks per line (broken)
+
+                // Wake from sleep mode, as Wake() does but without blocking on its delays.
+                SetCommand(display, ILI9341_SLPOUT);
+                display->InitPhase = INIT_PHASE_DISPLAY_ON;
+                return time_us_64() + 120 * 1000; // NOTE: Datasheet requires 120ms minimum!
+
+            case INIT_PHASE_DISPLAY_ON:
+                SetCommand(display, ILI9341_DISPON);
+                display->InitPhase = INIT_PHASE_BACKLIGHT;
+                return time_us_64() + 10 * 1000; // Small delay for stability
+
+            case INIT_PHASE_BACKLIGHT:
+                display->IsAsleep = false;
+                SetBrightnessPercent(display, 100.0f);
+                display->IsInitialized = true;
+                display->InitPhase = INIT_PHASE_DONE;
+                return 0;
+
+            default:
+                return 0;
+            }
         }
 
         void DeinitializeIli9341(Ili9341Data* display)
@@ -96,13 +148,13 @@ namespace PicoPixel
         void CreateBuffer(Ili9341Data* display, Buffer* buffer)
         {
             if (buffer->IsInitialized)
-                free(buffer->Data);
+                Memory::Free(buffer->Data);
 
             size_t bufferSize = display->Width * display->Height * sizeof(uint16_t);
-            uint16_t* newBuffer = (uint16_t*)malloc(bufferSize);
+            uint16_t* newBuffer = (uint16_t*)Memory::Allocate(Memory::Tag::Framebuffer, bufferSize);
             if (!newBuffer)
             {
-                LOG("Failed to allocate framebuffer!\n");
+                LOG_ERROR("Failed to allocate framebuffer!\n");
             }
 
             buffer->Width = display->Width;
@@ -113,14 +165,14 @@ namespace PicoPixel
 
         void DestroyBuffer(Buffer *buffer)
         {
-            free(buffer->Data);
+            Memory::Free(buffer->Data);
             buffer->Width = 0;
             buffer->Height = 0;
             buffer->Data = nullptr;
             buffer->IsInitialized = false;
         }
 
-        void SetOrientation(Ili9341Data* display, bool portrait)
+        void SetDimensions(Ili9341Data* display, bool portrait)
         {
             display->IsPortrait = portrait;
             if (display->IsPortrait)
@@ -133,6 +185,11 @@ namespace PicoPixel
                 display->Width = 320;
                 display->Height = 240;
             }
+        }
+
+        void SetOrientation(Ili9341Data* display, bool portrait)
+        {
+            SetDimensions(display, portrait);
 
             EnsureSPI8Bit(display);
             SetCommand(display, ILI9341_MADCTL);
@@ -38,15 +38,24 @@ namespace PicoPixel
             uint16_t Width;             /** Current display width in pixels. */
             uint16_t Height;            /** Current display height in pixels. */
             bool IsAsleep = true;       /** True if the display is in sleep mode. */
+            uint8_t InitPhase = 0;      /** Next step of BeginInitializeIli9341()/ContinueInitializeIli9341(). */
         };
 
         void InitializeIli9341(Ili9341Data* display, spi_inst_t* spiPort, int spiClockFreqency, uint8_t gpioCS, uint8_t gpioRESET, uint8_t gpioDC, uint8_t gpioSDI_MOSI, uint8_t gpioSCK, uint8_t gpioLed, uint8_t gpioSDO_MISO, bool portrait);
         void DeinitializeIli9341(Ili9341Data* display);
 
+        // InitializeIli9341() in steps, for doing other start-up work during the reset and sleep-out delays (~250 ms).
+        // Both return when the next step is due (a time_us_64() timestamp): call ContinueInitializeIli9341() again at or
+        // after that time, until it returns 0 and the display is on. Width and Height are set by the Begin call.
+        uint64_t BeginInitializeIli9341(Ili9341Data* display, spi_inst_t* spiPort, int spiClockFreqency, uint8_t gpioCS, uint8_t gpioRESET, uint8_t gpioDC, uint8_t gpioSDI_MOSI, uint8_t gpioSCK, uint8_t gpioLed, uint8_t gpioSDO_MISO, bool portrait);
+        uint64_t ContinueInitializeIli9341(Ili9341Data* display);
+
         void CreateBuffer(Ili9341Data* display, Buffer* buffer);
         void DestroyBuffer(Buffer* buffer);
 
         void SetOrientation(Ili9341Data* display, bool portrait);
+        // Width and Height for an orientation, without telling the display.
+        void SetDimensions(Ili9341Data* display, bool portrait);
 
         void SetBrightness(Ili9341Data* display, uint16_t brightness);
         void SetBrightnessPercent(Ili9341Data* display, float percent);
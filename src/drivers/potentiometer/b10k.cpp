@@ -1,7 +1,8 @@
 #include "b10k.hpp"
-
-#include <hardware/gpio.h>
-#include <hardware/adc.h>
+#include "log.hpp"
+#include "replay.hpp"
+#include "drivers/adc/adcSampler.hpp"
+#include "input/input.hpp"
 
 namespace PicoPixel {
 	namespace B10kDriver {
@@ -9,19 +10,26 @@ namespace PicoPixel {
 			potentiometer->gpio	= gpio;
 			potentiometer->adc	= adc;
 
-			// TODO: Check if initializing ADC multiple times causes issues.
-			adc_init();
-			adc_gpio_init(potentiometer->gpio);
+			// The sampler sets up the ADC (once) and the pin, and keeps the input sampled from here on. Turning the knob
+			// also queues input events, so frames that show it are timed input to photon.
+			if (gpio != 26 + adc)
+				LOG_WARN("B10k: GPIO %u isn't ADC input %u's pin\n", gpio, adc);
+			Input::AddAnalog(potentiometer->adc);
 		}
 
 		void DeinitializeB10k(B10kData* potentiometer) {
-			// Not really necessary
-			adc_select_input(0);
+			Input::RemoveAnalog(potentiometer->adc);
 		}
 
 		int ReadB10k(B10kData* potentiometer) {
-			adc_select_input(potentiometer->adc);
-			return adc_read();
+			uint16_t value;
+			if (Replay::ReplayInput(potentiometer->adc, value))
+				return value;
+
+			// Filtered and already sampled, so this costs nothing and doesn't jitter with the frame rate.
+			value = AdcSampler::Read(potentiometer->adc);
+			Replay::RecordInput(potentiometer->adc, value);
+			return value;
 		}
 	}
 }
\ No newline at end of file
@@ -6,6 +6,8 @@ namespace PicoPixel
 {
     namespace B10kDriver
     {
+        static constexpr int B10K_MAX_VALUE = 4095;
+
         struct B10kData
         {
             // Hardware Configuration
@@ -16,6 +18,7 @@ namespace PicoPixel
         void InitializeB10k(B10kData* potentiometer, uint8_t gpio, uint8_t adc);
         void DeinitializeB10k(B10kData* potentiometer);
 
+		// Filtered position, 0 to B10K_MAX_VALUE.
 		int ReadB10k(B10kData* potentiometer);
     }
 }
@@ -2,18 +2,13 @@
 
 #include "games/game.hpp"
 #include "drivers/potentiometer/b10k.hpp"
-#include "utils/math.hpp"
+#include "assets/assetPack.hpp"
+#include "graphics/particles.hpp"
 
 namespace PicoPixel
 {
     namespace Games
     {
-        // Space dust particle
-        struct Particle
-        {
-            Utils::Vec3 Position;
-        };
-
         class PicoSpace : public Game
         {
         public:
@@ -25,32 +20,33 @@ namespace PicoPixel
             bool OnUpdate(float dt) override;
             void OnRender() override;
 
-            std::string GetName() override;
-            std::string GetDescription() override;
+            uint16_t GetSnapshotVersion() const override { return 1; }
+            void OnSaveSnapshot(Snapshot::Writer& writer) override;
+            bool OnLoadSnapshot(Snapshot::Reader& reader, uint16_t version) override;
+
+            static constexpr uint32_t CROSSHAIR_ASSET = Assets::AssetId("crosshair");
 
         private:
-            void InitializeParticles();
-            void DistributeParticle(Particle* particle);
             void UpdateParticles(float dt);
             void RenderParticles();
 
-            bool Project3DTo2D(const Utils::Vec3& point3D, uint16_t& x, uint16_t& y);
-
-            void PrintMemoryUsage();
-
         private:
-            const uint8_t CROSSHAIR_SIZE = 16;
+            const uint8_t CROSSHAIR_SIZE = 16;      // When drawn with lines, without the crosshair sprite.
+            Assets::SpriteView Crosshair;
 
             const float NEAR_PLANE = 0.1f;
             const float FAR_PLANE = 10000.0f; // Can optionally be 0.0f for no far plane limit.
 
-            // Space Dust
-            const uint8_t MAX_PARTICLES = 255;
+            // Space Dust. Stars that drift out of range die and the emitter tops the field back up.
+            const uint16_t MAX_PARTICLES = 2048;
             const uint8_t PARTICLE_BRIGHTNESS = 200;
-            Particle* Particles;
+            const float NEAREST_PARTICLE = 10.0f;
+            const float FARTHEST_PARTICLE = 1000.0f;
+            Graphics::ParticlePool Stars;
+            Graphics::ParticleEmitter StarEmitter;
 
             // Input
-            B10kDriver::B10kData* Potentiometer;
+            B10kDriver::B10kData* Potentiometer = nullptr;
         };
     }
 }
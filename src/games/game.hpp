@@ -2,8 +2,9 @@
 
 #include "drivers/display/ili9341.hpp"
 #include "graphics/graphics.hpp"
+#include "input/input.hpp"
+#include "snapshot.hpp"
 #include <cstdint>
-#include <string>
 
 namespace PicoPixel
 {
@@ -21,12 +22,44 @@ namespace PicoPixel
             virtual bool OnUpdate(float dt) = 0;
             virtual void OnRender() = 0;
 
-            // For menu
-            virtual std::string GetName() = 0;
-            virtual std::string GetDescription() = 0;
+            // Each queued input event, oldest first, before the frame's OnUpdate(). Replay records them, so a replayed
+            // session gets the same events on the same frames (only TimeUs differs).
+            virtual void OnInput(const Input::Event& event) { (void)event; }
+
+            // Simulation ticks per second. Games that return non-zero get OnUpdate() called with a fixed dt of
+            // 1 / tick rate (zero or more times per frame) and should render using GetRenderAlpha().
+            // The default 0 keeps one OnUpdate() per frame with the measured dt.
+            virtual uint16_t GetTickRate() { return 0; }
+
+            // Called once per frame between the last OnUpdate() and OnRender(), while nothing is rendering.
+            // Games that copy everything OnRender() reads into a Utils::DoubleBuffered here (and Swap() it) return true,
+            // which lets PIPELINED_RENDER builds render on core1 while core0 simulates the next frame.
+            virtual bool OnPublishState() { return false; }
+
+            // Instant resume (see Snapshot). Games that return a non-zero version are saved when the player leaves them
+            // and restored the next time they are launched. Bump the version when the saved layout changes; older
+            // snapshots are still handed to OnLoadSnapshot() with their version, newer ones are discarded.
+            virtual uint16_t GetSnapshotVersion() const { return 0; }
+
+            // Write everything needed to carry on from this exact moment. Called before OnShutdown(), twice (once to
+            // size the snapshot), so it must write the same bytes both times and not change any state.
+            virtual void OnSaveSnapshot(Snapshot::Writer& writer) { (void)writer; }
+
+            // Read back what OnSaveSnapshot() wrote. Called after OnInit(), so only state that changes during play
+            // needs saving. Returning false (or reading too much) makes the menu start the game over.
+            virtual bool OnLoadSnapshot(Snapshot::Reader& reader, uint16_t version) { (void)reader; (void)version; return false; }
+
+        protected:
+            // How far the current frame is between the previous tick and the latest one, in [0, 1).
+            // Interpolate drawn positions by this to hide the difference between tick rate and frame rate.
+            float GetRenderAlpha() const { return RenderAlpha; }
 
         protected:
             PicoPixel::Driver::Buffer* Buffer;
+
+        private:
+            friend class GameLoop;
+            float RenderAlpha = 0.0f;
         };
     }
 }
@@ -0,0 +1,88 @@
+#include "gameLoop.hpp"
+#include "pico/stdlib.h"
+
+namespace PicoPixel
+{
+    namespace Games
+    {
+        GameLoop::GameLoop(Game* game)
+         : CurrentGame(game),
+           TickUs(0),
+           AccumulatorUs(0),
+           DroppedTicks(0),
+           TicksLastFrame(0),
+           PublishesState(false),
+           NextFrameUs(time_us_64())
+        {
+            uint16_t tickRate = game->GetTickRate();
+            if (tickRate)
+                TickUs = 1000000u / tickRate;
+
+            // Publish the initial state, which also tells us whether the game supports pipelining.
+            Publish();
+        }
+
+        bool GameLoop::Update(float dt)
+        {
+            if (TickUs == 0)
+            {
+                TicksLastFrame = 1;
+                return CurrentGame->OnUpdate(dt);
+            }
+
+            // The accumulator is kept in whole microseconds so replays tick on exactly the same frames.
+            AccumulatorUs += dt > 0.0f ? (uint32_t)(dt * 1e6f + 0.5f) : 0;
+
+            const uint32_t maxBacklogUs = TickUs * GAME_LOOP_MAX_TICKS_PER_FRAME;
+            if (AccumulatorUs > maxBacklogUs)
+            {
+                DroppedTicks += (AccumulatorUs - maxBacklogUs) / TickUs;
+                AccumulatorUs = maxBacklogUs;
+            }
+
+            const float tickDt = TickUs / 1e6f;
+            TicksLastFrame = 0;
+            while (AccumulatorUs >= TickUs)
+            {
+                AccumulatorUs -= TickUs;
+                TicksLastFrame++;
+                if (CurrentGame->OnUpdate(tickDt))
+                    return true;
+            }
+            return false;
+        }
+
+        void GameLoop::Publish()
+        {
+            CurrentGame->RenderAlpha = TickUs ? (float)AccumulatorUs / (float)TickUs : 0.0f;
+            PublishesState = CurrentGame->OnPublishState();
+        }
+
+        void GameLoop::Render()
+        {
+            CurrentGame->OnRender();
+        }
+
+        void GameLoop::WaitForNextFrame()
+        {
+#if GAME_LOOP_FRAME_CAP_HZ > 0
+            constexpr uint32_t FrameUs = 1000000u / GAME_LOOP_FRAME_CAP_HZ;
+            uint64_t now = time_us_64();
+            NextFrameUs += FrameUs;
+
+            // Running late: re-anchor on now instead of rushing the next frames to catch up.
+            if ((int64_t)(NextFrameUs - now) <= 0)
+            {
+                NextFrameUs = now;
+                return;
+            }
+
+            // Sleeps in WFE; the SDK arms a timer alarm for the deadline so the core wakes up on time.
+            absolute_time_t deadline = from_us_since_boot(NextFrameUs);
+            while (!best_effort_wfe_or_timeout(deadline))
+            {
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "game.hpp"
+#include <cstdint>
+
+// Frames per second the loop paces itself to, sleeping until each deadline. 0 runs flat out.
+#ifndef GAME_LOOP_FRAME_CAP_HZ
+    #define GAME_LOOP_FRAME_CAP_HZ 60
+#endif
+
+// Most fixed ticks run for one frame. After a long stall the rest of the backlog is dropped instead of simulated,
+// so a slow frame can't cause an even slower one (the "spiral of death").
+#ifndef GAME_LOOP_MAX_TICKS_PER_FRAME
+    #define GAME_LOOP_MAX_TICKS_PER_FRAME 5
+#endif
+
+namespace PicoPixel
+{
+    namespace Games
+    {
+        // Drives a game's OnUpdate() either once per frame (variable step) or at its fixed tick rate using an accumulator,
+        // and paces frames with low-power waits instead of spinning.
+        class GameLoop
+        {
+        public:
+            GameLoop(Game* game);
+
+            // Advance the simulation by one frame's worth of time. Returns true when the game asked to quit.
+            bool Update(float dt);
+
+            // Sync point between simulation and rendering: fixes the render alpha and calls the game's OnPublishState().
+            void Publish();
+
+            // Calls OnRender(). Only reads what the last Publish() fixed, so it may run on the other core.
+            void Render();
+
+            // Sleep (WFE, woken by a timer alarm) until the next frame deadline. Returns immediately if it has passed.
+            void WaitForNextFrame();
+
+            uint8_t GetTicksLastFrame() const { return TicksLastFrame; }
+            uint32_t GetDroppedTicks() const { return DroppedTicks; }
+
+            // True if the game publishes double-buffered render state, so rendering can overlap the next update.
+            bool CanPipeline() const { return PublishesState; }
+
+        private:
+            Game* CurrentGame;
+            uint32_t TickUs;            // 0 for variable step.
+            uint32_t AccumulatorUs;
+            uint32_t DroppedTicks;
+            uint8_t TicksLastFrame;
+            bool PublishesState;
+            uint64_t NextFrameUs;
+        };
+    }
+}
@@ -1,19 +1,31 @@
 #include "gameRegistry.hpp"
+#include <cstring>
+
+// Bounds of the "picopixel_games" section. Defined by gameRegistry.ld on the device; GNU ld defines them automatically
+// for any section whose name is a valid C identifier, so they also exist without the script.
+extern "C" const PicoPixel::Games::GameDescriptor* const __start_picopixel_games[];
+extern "C" const PicoPixel::Games::GameDescriptor* const __stop_picopixel_games[];
 
 namespace PicoPixel
 {
     namespace Games
     {
-        std::vector<GameFactory> GameRegistry::Factories;
+        size_t GameRegistry::Count()
+        {
+            return (size_t)(__stop_picopixel_games - __start_picopixel_games);
+        }
 
-        std::vector<GameFactory>& GameRegistry::GetFactories()
+        const GameDescriptor& GameRegistry::Get(size_t index)
         {
-            return Factories;
+            return *__start_picopixel_games[index];
         }
 
-        void GameRegistry::Register(const GameFactory& factory)
+        const GameDescriptor* GameRegistry::Find(const char* name)
         {
-            Factories.push_back(factory);
+            for (const GameDescriptor* const* entry = __start_picopixel_games; entry != __stop_picopixel_games; entry++)
+                if (strcmp((*entry)->Name, name) == 0)
+                    return *entry;
+            return nullptr;
         }
     }
 }
@@ -2,51 +2,55 @@
 
 #include "drivers/display/ili9341.hpp"
 #include "game.hpp"
-#include <vector>
-#include <functional>
+#include "memory/arena.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Menu icons are square RGB565 images of this many pixels per side.
+#define GAME_ICON_SIZE 16
 
 namespace PicoPixel
 {
     namespace Games
     {
-        using GameFactory = std::function<Game*(PicoPixel::Driver::Buffer*)>;
+        // Creates the game in the game arena. Destroy it with ~Game() rather than delete, then reset the arena.
+        using GameFactory = Game* (*)(PicoPixel::Driver::Buffer* buffer);
+
+        // Everything the menu needs to know about a game, without creating one. Lives in flash.
+        struct GameDescriptor
+        {
+            const char* Name;
+            const char* Description;
+            const uint16_t* Icon;       // GAME_ICON_SIZE x GAME_ICON_SIZE RGB565 pixels, or nullptr.
+            uint32_t MemoryBudget;      // Game arena space the game expects to need while running, in bytes.
+            const uint32_t* Assets;     // Asset ids to prefetch while the menu is up, ending with 0, or nullptr.
+            GameFactory Create;
+        };
+
+        // Games register themselves with REGISTER_GAME, which places a pointer to their descriptor in the
+        // "picopixel_games" linker section. The registry is simply that section, so there is nothing to run at startup.
         class GameRegistry
         {
         public:
-            static std::vector<GameFactory>& GetFactories();
-            static void Register(const GameFactory& factory);
+            static size_t Count();
+            static const GameDescriptor& Get(size_t index);
 
-        private:
-            static std::vector<GameFactory> Factories;
+            // Returns nullptr if no game has that name.
+            static const GameDescriptor* Find(const char* name);
         };
     }
 }
 
-
-
-// NOTE: A static self-registration macro did not work. The compiler/linker must have optimized away the static variable, despite being marked as volatile.
-// All I know is that the lambda didn't get called, and so the game wasn't registered
-#if 0
-// TODO: Perhaps turn this into a struct and include game info (name, description) here?
-#define REGISTER_GAME(GameClass) \
-    static const bool Is##GameClass##Registered = \
-        []() \
-        { \
-            PicoPixel::Games::GameRegistry::Register( \
-                [](PicoPixel::Driver::Buffer* buffer) \
-                { \
-                    return new PicoPixel::Games::GameClass(buffer); \
-                } \
-            ); \
-            return true; \
-        };
-#endif
-
-// Instead, this macro will assist in creating the code to register a game. Be sure to call it during the initialization sequence of PicoPixel.
-#define REGISTER_GAME(GameClass) \
-    PicoPixel::Games::GameRegistry::Register( \
-        [](PicoPixel::Driver::Buffer* buffer) \
-        { \
-            return new PicoPixel::Games::GameClass(buffer); \
-        } \
-    );
+// Registers a game. Use it once, at namespace scope, in the game's .cpp file:
+//     REGISTER_GAME(PongGame, "Pong", "Classic Pong", nullptr, 2 * 1024, nullptr)
+// Registration order follows link order. The entry is marked used and the section is kept by the linker
+// (see gameRegistry.ld), which is what the old static-initializer registration lacked.
+#define REGISTER_GAME(GameClass, name, description, icon, memoryBudget, assets) \
+    static PicoPixel::Games::Game* Create##GameClass(PicoPixel::Driver::Buffer* buffer) \
+    { \
+        return PicoPixel::Memory::GetGameArena().New<GameClass>(buffer); \
+    } \
+    static constexpr PicoPixel::Games::GameDescriptor GameClass##Descriptor = \
+        { name, description, icon, memoryBudget, assets, &Create##GameClass }; \
+    __attribute__((used, section("picopixel_games"))) \
+    static const PicoPixel::Games::GameDescriptor* const GameClass##RegistryEntry = &GameClass##Descriptor;
@@ -1,9 +1,11 @@
 #include "pong.hpp"
 
+#include "games/gameRegistry.hpp"
 #include "graphics/graphics.hpp"
+#include "log.hpp"
+#include "memory/arena.hpp"
 #include "utils/random.hpp"
-#include <hardware/gpio.h>
-#include <hardware/adc.h>
+#include "utils/trig.hpp"
 #include <algorithm>
 #include <cmath>
 
@@ -27,6 +29,7 @@ namespace PicoPixel
             ballSize = 6;
             score1 = 0;
             score2 = 0;
+            rng = PicoPixel::Utils::MakeStream("Pong");
 
             centerLineDashSpacing = 8;
             centerLineDashWidth = 2;
@@ -37,14 +40,47 @@ namespace PicoPixel
             paddle2Y = fieldHeight / 2.0f - paddleHeight / 2.0f;
             ResetBall();
 
-            paddle1Potentiometer = new B10kDriver::B10kData();
+            paddle1Potentiometer = PicoPixel::Memory::GetGameArena().New<B10kDriver::B10kData>();
             // TODO: Remove magic numbers 28 & 2. Maybe. Doesn't really matter.
-            B10kDriver::InitializeB10k(paddle1Potentiometer, 28, 2);
+            if (paddle1Potentiometer)
+                B10kDriver::InitializeB10k(paddle1Potentiometer, 28, 2);
+            else
+                LOG_ERROR("Pong: Not enough memory for the potentiometer, the left paddle stays put\n");
         }
 
         void PongGame::OnShutdown()
         {
-            delete(paddle1Potentiometer);
+            // The potentiometer is freed with the rest of the game arena; only its input stops being sampled.
+            if (paddle1Potentiometer)
+                B10kDriver::DeinitializeB10k(paddle1Potentiometer);
+            paddle1Potentiometer = nullptr;
+        }
+
+        void PongGame::OnSaveSnapshot(Snapshot::Writer& writer)
+        {
+            // The field layout comes from OnInit(); only the rally, the score and the RNG are saved.
+            writer.Write(paddle1Y);
+            writer.Write(paddle2Y);
+            writer.Write(ballX);
+            writer.Write(ballY);
+            writer.Write(previousBallX);
+            writer.Write(previousBallY);
+            writer.Write(ballVelocityX);
+            writer.Write(ballVelocityY);
+            writer.Write(score1);
+            writer.Write(score2);
+            writer.Write(rng);
+        }
+
+        bool PongGame::OnLoadSnapshot(Snapshot::Reader& reader, uint16_t version)
+        {
+            (void)version;
+            return reader.Read(paddle1Y) && reader.Read(paddle2Y)
+                && reader.Read(ballX) && reader.Read(ballY)
+                && reader.Read(previousBallX) && reader.Read(previousBallY)
+                && reader.Read(ballVelocityX) && reader.Read(ballVelocityY)
+                && reader.Read(score1) && reader.Read(score2)
+                && reader.Read(rng);
         }
 
         void PongGame::ResetBall()
@@ -52,14 +88,21 @@ namespace PicoPixel
             // Reset ball to center with random angle and speed
             ballX = fieldWidth / 2.0f - ballSize / 2.0f;
             ballY = fieldHeight / 2.0f - ballSize / 2.0f;
-            float angle = (PicoPixel::Utils::RandRange(2) ? 1 : -1) * (3.14159f / 4.0f + (PicoPixel::Utils::Rand() % 100) / 400.0f);
-            float speed = 90.0f + (PicoPixel::Utils::Rand() % 40); // 90-130 px/sec
-            ballVelocityX = speed * std::cos(angle) * (PicoPixel::Utils::RandRange(2) ? 1 : -1);
-            ballVelocityY = speed * std::sin(angle);
+            previousBallX = ballX;
+            previousBallY = ballY;
+            float angle = (rng.Range(2) ? 1 : -1) * (3.14159f / 4.0f + rng.Range(100) / 400.0f);
+            float speed = 90.0f + rng.Range(40); // 90-130 px/sec
+            float sinAngle, cosAngle;
+            PicoPixel::Utils::FastSinCos(angle, sinAngle, cosAngle);
+            ballVelocityX = speed * cosAngle * (rng.Range(2) ? 1 : -1);
+            ballVelocityY = speed * sinAngle;
         }
 
         bool PongGame::OnUpdate(float dt)
         {
+            previousBallX = ballX;
+            previousBallY = ballY;
+
             // Calculate where paddles should move to intercept ball
             // TODO: Could make this smarter. Intercept where it *will* be.
             //float target1 = ballY + ballSize / 2.0f - paddleHeight / 2.0f;
@@ -74,8 +117,9 @@ namespace PicoPixel
             //         paddle1Y = std::max(paddle1Y - paddleSpeed * dt, target1);
             // }
 
-            // TODO: Remove magic number 15.
-            paddle1Y = B10kDriver::ReadB10k(paddle1Potentiometer) / 15;
+            // The knob's full turn spans the field.
+            if (paddle1Potentiometer)
+                paddle1Y = B10kDriver::ReadB10k(paddle1Potentiometer) * (fieldHeight - paddleHeight) / B10kDriver::B10K_MAX_VALUE;
 
             // Right paddle AI: only move if ball is on right region
             if (ballX + ballSize / 2.0f >= fieldWidth - (fieldWidth / paddleAISplitRatio))
@@ -112,11 +156,11 @@ namespace PicoPixel
                 ballX = paddleWidth;
                 ballVelocityX = -ballVelocityX;
                 // Randomize angle somewhat
-                ballVelocityY += (PicoPixel::Utils::Rand() % 40 - 20);
+                ballVelocityY += rng.Range(-20, 20);
                 // Random multiplier between 1.05 and 1.18 (biased to increase)
-                float speedMult = 1.05f + (PicoPixel::Utils::Rand() % 14) * 0.01f; // 1.05 to 1.18
-                if (PicoPixel::Utils::RandRange(5) == 0) // 1 in 5 chance to slow a bit
-                    speedMult = 0.95f + (PicoPixel::Utils::Rand() % 4) * 0.01f; // 0.95 to 1.00
+                float speedMult = 1.05f + rng.Range(14) * 0.01f; // 1.05 to 1.18
+                if (rng.Range(5) == 0) // 1 in 5 chance to slow a bit
+                    speedMult = 0.95f + rng.Range(4) * 0.01f; // 0.95 to 1.00
                 ballVelocityX *= speedMult;
                 ballVelocityY *= speedMult;
             }
@@ -126,11 +170,11 @@ namespace PicoPixel
                 ballX = fieldWidth - paddleWidth - ballSize;
                 ballVelocityX = -ballVelocityX;
                 // Randomize angle somewhat
-                ballVelocityY += (PicoPixel::Utils::Rand() % 40 - 20);
+                ballVelocityY += rng.Range(-20, 20);
                 // Speed up: random multiplier between 1.05 and 1.18 (biased to increase)
-                float speedMult = 1.05f + (PicoPixel::Utils::Rand() % 14) * 0.01f; // 1.05 to 1.18
-                if (PicoPixel::Utils::RandRange(5) == 0) // 1 in 5 chance to slow a bit
-                    speedMult = 0.95f + (PicoPixel::Utils::Rand() % 4) * 0.01f; // 0.95 to 1.00
+                float speedMult = 1.05f + rng.Range(14) * 0.01f; // 1.05 to 1.18
+                if (rng.Range(5) == 0) // 1 in 5 chance to slow a bit
+                    speedMult = 0.95f + rng.Range(4) * 0.01f; // 0.95 to 1.00
                 ballVelocityX *= speedMult;
                 ballVelocityY *= speedMult;
             }
@@ -153,17 +197,43 @@ namespace PicoPixel
             return false;
         }
 
+        bool PongGame::OnPublishState()
+        {
+            PongRenderState& state = renderState.Back();
+            state.paddle1Y = paddle1Y;
+            state.paddle2Y = paddle2Y;
+            state.ballX = ballX;
+            state.ballY = ballY;
+            state.previousBallX = previousBallX;
+            state.previousBallY = previousBallY;
+            state.score1 = score1;
+            state.score2 = score2;
+            renderState.Swap();
+            return true;
+        }
+
         void PongGame::OnRender()
         {
+            const PongRenderState& state = renderState.Front();
+
+            constexpr uint16_t Black = PicoPixel::Utils::RGBto16bit(0, 0, 0);
+            constexpr uint16_t White = PicoPixel::Utils::RGBto16bit(255, 255, 255);
+            constexpr uint16_t Grey = PicoPixel::Utils::RGBto16bit(128, 128, 128);
+            constexpr uint16_t Green = PicoPixel::Utils::RGBto16bit(0, 255, 0);
+            constexpr uint16_t Red = PicoPixel::Utils::RGBto16bit(255, 0, 0);
+
             // Clear screen
-            PicoPixel::Graphics::FillBuffer(Buffer, PicoPixel::Utils::RGBto16bit(0, 0, 0));
+            PicoPixel::Graphics::FillBuffer(Buffer, Black);
 
             // Draw left and right paddles
-            PicoPixel::Graphics::DrawRectangle(Buffer, 0, (uint16_t)paddle1Y, (uint16_t)paddleWidth, (uint16_t)paddleHeight, PicoPixel::Utils::RGBto16bit(255, 255, 255), true);
-            PicoPixel::Graphics::DrawRectangle(Buffer, (uint16_t)(fieldWidth - paddleWidth), (uint16_t)paddle2Y, (uint16_t)paddleWidth, (uint16_t)paddleHeight, PicoPixel::Utils::RGBto16bit(255, 255, 255), true);
+            PicoPixel::Graphics::DrawRectangle(Buffer, 0, (uint16_t)state.paddle1Y, (uint16_t)paddleWidth, (uint16_t)paddleHeight, White, true);
+            PicoPixel::Graphics::DrawRectangle(Buffer, (uint16_t)(fieldWidth - paddleWidth), (uint16_t)state.paddle2Y, (uint16_t)paddleWidth, (uint16_t)paddleHeight, White, true);
 
-            // Draw ball
-            PicoPixel::Graphics::DrawRectangle(Buffer, (uint16_t)ballX, (uint16_t)ballY, (uint16_t)ballSize, (uint16_t)ballSize, PicoPixel::Utils::RGBto16bit(255, 255, 255), true);
+            // Draw ball between the last two ticks (Pong runs at a fixed 120 Hz tick rate)
+            float alpha = GetRenderAlpha();
+            float drawX = state.previousBallX + (state.ballX - state.previousBallX) * alpha;
+            float drawY = state.previousBallY + (state.ballY - state.previousBallY) * alpha;
+            PicoPixel::Graphics::DrawRectangle(Buffer, (uint16_t)drawX, (uint16_t)drawY, (uint16_t)ballSize, (uint16_t)ballSize, White, true);
 
             // Draw center line
             for (uint16_t y = 0; y < fieldHeight; y += centerLineDashSpacing)
@@ -174,35 +244,27 @@ namespace PicoPixel
                     y,
                     centerLineDashWidth,
                     centerLineDashHeight,
-                    PicoPixel::Utils::RGBto16bit(128, 128, 128),
+                    Grey,
                     true);
             }
 
             // Draw scores as green (first 10) or red (overflow)
-            for (int i = 0; i < score1 && i <= 10; i++)
+            for (int i = 0; i < state.score1 && i <= 10; i++)
             {
                 if (i < 10)
-                    PicoPixel::Graphics::DrawRectangle(Buffer, 10 + i * 8, 10, 6, 6, PicoPixel::Utils::RGBto16bit(0, 255, 0), true);
+                    PicoPixel::Graphics::DrawRectangle(Buffer, 10 + i * 8, 10, 6, 6, Green, true);
                 else
-                    PicoPixel::Graphics::DrawRectangle(Buffer, 10 + i * 8, 10, 6, 6, PicoPixel::Utils::RGBto16bit(255, 0, 0), true);
+                    PicoPixel::Graphics::DrawRectangle(Buffer, 10 + i * 8, 10, 6, 6, Red, true);
             }
-            for (int i = 0; i < score2 && i <= 10; i++)
+            for (int i = 0; i < state.score2 && i <= 10; i++)
             {
                 if (i < 10)
-                    PicoPixel::Graphics::DrawRectangle(Buffer, fieldWidth - 10 - (i + 1) * 8, 10, 6, 6, PicoPixel::Utils::RGBto16bit(0, 255, 0), true);
+                    PicoPixel::Graphics::DrawRectangle(Buffer, fieldWidth - 10 - (i + 1) * 8, 10, 6, 6, Green, true);
                 else
-                    PicoPixel::Graphics::DrawRectangle(Buffer, fieldWidth - 10 - (i + 1) * 8, 10, 6, 6, PicoPixel::Utils::RGBto16bit(255, 0, 0), true);
+                    PicoPixel::Graphics::DrawRectangle(Buffer, fieldWidth - 10 - (i + 1) * 8, 10, 6, 6, Red, true);
             }
         }
 
-        std::string PongGame::GetName()
-        {
-            return "Pong";
-        }
-
-        std::string PongGame::GetDescription()
-        {
-            return "Classic Pong: Player vs AI";
-        }
+        REGISTER_GAME(PongGame, "Pong", "Classic Pong: Player vs AI", nullptr, 1024, nullptr)
     }
 }
@@ -2,12 +2,23 @@
 
 #include "drivers/potentiometer/b10k.hpp"
 #include "games/game.hpp"
+#include "utils/doubleBuffered.hpp"
+#include "utils/random.hpp"
 #include <string>
 
 namespace PicoPixel
 {
     namespace Games
     {
+        // Everything OnRender() reads that changes during play, published once per frame.
+        struct PongRenderState
+        {
+            float paddle1Y, paddle2Y;
+            float ballX, ballY;
+            float previousBallX, previousBallY;
+            int score1, score2;
+        };
+
         class PongGame : public Game
         {
         public:
@@ -19,8 +30,12 @@ namespace PicoPixel
             bool OnUpdate(float dt) override;
             void OnRender() override;
 
-            std::string GetName() override;
-            std::string GetDescription() override;
+            uint16_t GetTickRate() override { return 120; }
+            bool OnPublishState() override;
+
+            uint16_t GetSnapshotVersion() const override { return 1; }
+            void OnSaveSnapshot(Snapshot::Writer& writer) override;
+            bool OnLoadSnapshot(Snapshot::Reader& reader, uint16_t version) override;
 
         private:
             // Paddle and ball state
@@ -29,6 +44,7 @@ namespace PicoPixel
             float paddleWidth;
             float paddleSpeed;
             float ballX, ballY;
+            float previousBallX, previousBallY;   // Position at the previous tick, for render interpolation
             float ballVelocityX, ballVelocityY;
             float ballSize;
             int score1, score2;
@@ -39,8 +55,12 @@ namespace PicoPixel
             uint16_t centerLineDashSpacing;
             uint16_t centerLineDashWidth;
             uint16_t centerLineDashHeight;
+            // Serve and bounce randomness, seeded per session
+            PicoPixel::Utils::RandomStream rng;
+            // Render snapshot, so rendering can run on core1 while the next frame is simulated
+            PicoPixel::Utils::DoubleBuffered<PongRenderState> renderState;
             // Input
-            B10kDriver::B10kData* paddle1Potentiometer;
+            B10kDriver::B10kData* paddle1Potentiometer = nullptr;
         };
     }
 }
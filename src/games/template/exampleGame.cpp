@@ -15,6 +15,9 @@ namespace PicoPixel
         {
             // Initialization logic here
             LOG("OnInit()\n");
+            // A stream of its own, so the game draws the same rectangles for the same seed (and in a replay).
+            Rng = PicoPixel::Utils::MakeStream("Example Game");
+            PickRectangle();
         }
 
         void ExampleGame::OnShutdown()
@@ -26,45 +29,40 @@ namespace PicoPixel
         bool ExampleGame::OnUpdate(float dt)
         {
             // Game update logic here
-            LOG("OnUpdate(%f)\n", dt);
+            LOG_DEBUG("OnUpdate(%f)\n", dt);
 
-            sleep_ms(1000);
+            PickRectangle();
 
             return false; // We do not want to quit.
         }
 
-        void ExampleGame::OnRender()
+        void ExampleGame::OnInput(const Input::Event& event)
         {
-            // Rendering logic here
-            LOG("OnRender()\n");
-
-            PicoPixel::Graphics::FillBuffer(Buffer, PicoPixel::Utils::RGBto16bit(0, 0, 0));
+            // Input handling here. Events arrive before the frame's OnUpdate().
+            if (event.IsPressed(Input::Button::A))
+                PickRectangle();
+        }
 
+        void ExampleGame::PickRectangle()
+        {
             uint16_t maxWidth = Buffer->Width;
             uint16_t maxHeight = Buffer->Height;
-            uint16_t rectWidth = (rand() % (maxWidth / 2)) + 20;    // 20 to 1/2 of screen width
-            uint16_t rectHeight = (rand() % (maxHeight / 2)) + 20;  // 20 to 1/2 of screen height
-            uint16_t rectX = rand() % (maxWidth - rectWidth);       // Ensure rect fits horizontally
-            uint16_t rectY = rand() % (maxHeight - rectHeight);     // Ensure rect fits vertically
-
-            PicoPixel::Graphics::DrawRectangle(
-                Buffer,
-                rectX,
-                rectY,
-                rectWidth,
-                rectHeight,
-                PicoPixel::Utils::RGBto16bit(rand() % 256, rand() % 256, rand() % 256)
-            );
+            RectWidth = Rng.Range(maxWidth / 2) + 20;       // 20 to 1/2 of screen width
+            RectHeight = Rng.Range(maxHeight / 2) + 20;     // 20 to 1/2 of screen height
+            RectX = Rng.Range(maxWidth - RectWidth);        // Ensure rect fits horizontally
+            RectY = Rng.Range(maxHeight - RectHeight);      // Ensure rect fits vertically
+            RectColor = PicoPixel::Utils::RGBto16bit(Rng.Range(256), Rng.Range(256), Rng.Range(256));
         }
 
-        std::string ExampleGame::GetName()
+        void ExampleGame::OnRender()
         {
-            return "Example Game";
-        }
+            // Rendering logic here
+            LOG_DEBUG("OnRender()\n");
 
-        std::string ExampleGame::GetDescription()
-        {
-            return "An example game template.";
+            PicoPixel::Graphics::FillBuffer(Buffer, PicoPixel::Utils::RGBto16bit(0, 0, 0));
+            PicoPixel::Graphics::DrawRectangle(Buffer, RectX, RectY, RectWidth, RectHeight, RectColor);
         }
+
+        REGISTER_GAME(ExampleGame, "Example Game", "An example game template.", nullptr, 512, nullptr)
     }
 }
@@ -2,6 +2,7 @@
 
 #include "games/game.hpp"
 #include "games/gameRegistry.hpp"
+#include "utils/random.hpp"
 #include <string>
 
 namespace PicoPixel
@@ -18,9 +19,21 @@ namespace PicoPixel
             void OnShutdown() override;
             bool OnUpdate(float dt) override;
             void OnRender() override;
+            void OnInput(const Input::Event& event) override;
 
-            std::string GetName() override;
-            std::string GetDescription() override;
+            // One update a second. The loop waits in between, instead of the game blocking in OnUpdate().
+            uint16_t GetTickRate() override { return 1; }
+
+        private:
+            void PickRectangle();
+
+        private:
+            PicoPixel::Utils::RandomStream Rng;
+            uint16_t RectX = 0;
+            uint16_t RectY = 0;
+            uint16_t RectWidth = 0;
+            uint16_t RectHeight = 0;
+            uint16_t RectColor = 0;
         };
     }
 }
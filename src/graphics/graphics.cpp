@@ -12,12 +12,12 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (x >= buffer->Width || y >= buffer->Height)
             {
-                LOG("Out of bounds (%u,%u)", x, y);
+                LOG_DEFERRED(LOG_LEVEL_DEBUG, "Out of bounds (%u,%u)\n", x, y);
                 return;
             }
 
@@ -29,17 +29,17 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (x1 >= buffer->Width || y1 >= buffer->Height)
             {
-                LOG("Start out of bounds (%u,%u)", x1, y1);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Start out of bounds (%u,%u)\n", x1, y1);
                 return;
             }
             if (x2 >= buffer->Width || y2 >= buffer->Height)
             {
-                LOG("End out of bounds (%u,%u)", x2, y2);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "End out of bounds (%u,%u)\n", x2, y2);
                 return;
             }
 
@@ -66,22 +66,22 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (x1 >= buffer->Width || y1 >= buffer->Height)
             {
-                LOG("Vertex1 out of bounds (%u,%u)", x1, y1);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Vertex1 out of bounds (%u,%u)\n", x1, y1);
                 return;
             }
             if (x2 >= buffer->Width || y2 >= buffer->Height)
             {
-                LOG("Vertex2 out of bounds (%u,%u)", x2, y2);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Vertex2 out of bounds (%u,%u)\n", x2, y2);
                 return;
             }
             if (x3 >= buffer->Width || y3 >= buffer->Height)
             {
-                LOG("Vertex3 out of bounds (%u,%u)", x3, y3);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Vertex3 out of bounds (%u,%u)\n", x3, y3);
                 return;
             }
 
@@ -130,22 +130,22 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (x >= buffer->Width || y >= buffer->Height)
             {
-                LOG("Start out of bounds (%u,%u)", x, y);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Start out of bounds (%u,%u)\n", x, y);
                 return;
             }
             if (width == 0 || height == 0)
             {
-                LOG("Zero width or height");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Zero width or height\n");
                 return;
             }
             if (x + width > buffer->Width || y + height > buffer->Height)
             {
-                LOG("Rectangle out of bounds (%u,%u,%u,%u)", x, y, width, height);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Rectangle out of bounds (%u,%u,%u,%u)\n", x, y, width, height);
                 return;
             }
 
@@ -167,17 +167,17 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (centerX >= buffer->Width || centerY >= buffer->Height)
             {
-                LOG("Center out of bounds (%u,%u)", centerX, centerY);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Center out of bounds (%u,%u)\n", centerX, centerY);
                 return;
             }
             if (radius == 0)
             {
-                LOG("Zero radius");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Zero radius\n");
                 return;
             }
 
@@ -230,24 +230,24 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (!xPoints || !yPoints)
             {
-                LOG("Null points array");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Null points array\n");
                 return;
             }
             if (numPoints < 3)
             {
-                LOG("Not enough points (%u)", numPoints);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Not enough points (%u)\n", numPoints);
                 return;
             }
             for (uint16_t i = 0; i < numPoints; i++)
             {
                 if (xPoints[i] >= buffer->Width || yPoints[i] >= buffer->Height)
                 {
-                    LOG("Point %u out of bounds (%u,%u)", i, xPoints[i], yPoints[i]);
+                    LOG_DEFERRED(LOG_LEVEL_WARN, "Point %u out of bounds (%u,%u)\n", i, xPoints[i], yPoints[i]);
                     return;
                 }
             }
@@ -274,27 +274,27 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
             if (!bitmap)
             {
-                LOG("Bitmap is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Bitmap is null\n");
                 return;
             }
             if (x >= buffer->Width || y >= buffer->Height)
             {
-                LOG("Start out of bounds (%u,%u)", x, y);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Start out of bounds (%u,%u)\n", x, y);
                 return;
             }
             if (width == 0 || height == 0)
             {
-                LOG("Zero width or height");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Zero width or height\n");
                 return;
             }
             if (x + width > buffer->Width || y + height > buffer->Height)
             {
-                LOG("Bitmap out of bounds (%u,%u,%u,%u)", x, y, width, height);
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Bitmap out of bounds (%u,%u,%u,%u)\n", x, y, width, height);
                 return;
             }
 
@@ -314,7 +314,7 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
 
@@ -328,10 +328,10 @@ namespace PicoPixel
         {
             if (!buffer || !buffer->Data)
             {
-                LOG("Buffer is null");
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer is null\n");
                 return;
             }
-            LOG("DisplayTest started: buffer %p, size %ux%u", buffer, buffer->Width, buffer->Height);
+            LOG_DEBUG("DisplayTest started: buffer %p, size %ux%u\n", buffer, buffer->Width, buffer->Height);
 
             uint16_t width = buffer->Width;
             uint16_t height = buffer->Height;
@@ -346,39 +346,48 @@ namespace PicoPixel
             DrawRectangle(buffer, width - 50, height - 50, 50, 50, PicoPixel::Utils::RGBto16bit(150, 75, 0), true); // Brown
             DrawRectangle(buffer, width - 50, height - 50, 25, 25, PicoPixel::Utils::RGBto16bit(255, 0, 255), true); // Magenta
 
-            // Draw color bars
-            int bar = (width - 100) / 4;
-            for (int y = 0; y < height; y++)
-            {
-                float p = (float)y / (float)height;
-                uint8_t c = p * 255.0f;
-                // Red bar
-                DrawLine(buffer, 50, y, 50 + bar - 1, y, PicoPixel::Utils::RGBto16bit(c, 0, 0));
-                // Green bar
-                DrawLine(buffer, 50 + bar, y, 50 + 2 * bar - 1, y, PicoPixel::Utils::RGBto16bit(0, c, 0));
-                // Blue bar
-                DrawLine(buffer, 50 + 2 * bar, y, 50 + 3 * bar - 1, y, PicoPixel::Utils::RGBto16bit(0, 0, c));
-
-                // HSV rainbow bar
-                float hue = (1.0f - p) * 6.0f;
-                int sector = (int)hue;
-                float f = hue - sector;
-                sector = sector % 6;
-                uint8_t r, g, b;
-                switch(sector)
+            // Draw color bars. Each row's four colours are built as RGB888 and converted a batch of rows at a time.
+            constexpr int BarCount = 4;
+            constexpr int BatchRows = 16;
+            uint8_t rgb[BatchRows * BarCount * 3];
+            uint16_t colors[BatchRows * BarCount];
+            int bar = (width - 100) / BarCount;
+            for (int first = 0; first < height; first += BatchRows)
+            {
+                int rows = std::min(BatchRows, height - first);
+                for (int row = 0; row < rows; row++)
                 {
-                    case 0: r = 255; g = f * 255; b = 0; break;
-                    case 1: r = (1-f) * 255; g = 255; b = 0; break;
-                    case 2: r = 0; g = 255; b = f * 255; break;
-                    case 3: r = 0; g = (1-f) * 255; b = 255; break;
-                    case 4: r = f * 255; g = 0; b = 255; break;
-                    case 5: r = 255; g = 0; b = (1-f) * 255; break;
-                    default: r = 255; g = 0; b = 0; break;
+                    float p = (float)(first + row) / (float)height;
+                    uint8_t c = p * 255.0f;
+
+                    // HSV rainbow bar
+                    float hue = (1.0f - p) * 6.0f;
+                    int sector = (int)hue;
+                    float f = hue - sector;
+                    sector = sector % 6;
+                    uint8_t r, g, b;
+                    switch(sector)
+                    {
+                        case 0: r = 255; g = f * 255; b = 0; break;
+                        case 1: r = (1-f) * 255; g = 255; b = 0; break;
+                        case 2: r = 0; g = 255; b = f * 255; break;
+                        case 3: r = 0; g = (1-f) * 255; b = 255; break;
+                        case 4: r = f * 255; g = 0; b = 255; break;
+                        case 5: r = 255; g = 0; b = (1-f) * 255; break;
+                        default: r = 255; g = 0; b = 0; break;
+                    }
+
+                    // Red, green and blue ramps, then the rainbow.
+                    const uint8_t rowRgb[BarCount * 3] = { c, 0, 0,  0, c, 0,  0, 0, c,  r, g, b };
+                    std::copy(rowRgb, rowRgb + BarCount * 3, rgb + row * BarCount * 3);
                 }
-                uint16_t rgb565 = PicoPixel::Utils::RGBto16bit(r, g, b);
-                DrawLine(buffer, 50 + 3 * bar, y, 50 + 4 * bar - 1, y, rgb565);
+                PicoPixel::Utils::RGB888toRGB565(rgb, colors, rows * BarCount);
+
+                for (int row = 0; row < rows; row++)
+                    for (int i = 0; i < BarCount; i++)
+                        DrawLine(buffer, 50 + i * bar, first + row, 50 + (i + 1) * bar - 1, first + row, colors[row * BarCount + i]);
             }
-            LOG("DisplayTest finished");
+            LOG_DEBUG("DisplayTest finished\n");
         }
     }
 }
@@ -0,0 +1,619 @@
+#include "particles.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        // dt as 1/1024 s ticks, clamped to 1/16 s. The only float operation in a particle update.
+        static int32_t ToTicks(float dt)
+        {
+            int32_t ticks = (int32_t)(dt * 1024.0f + 0.5f);
+            return std::clamp(ticks, (int32_t)0, (int32_t)64);
+        }
+
+        // Q16.16 velocity times ticks, as a Q16.16 distance. Drops the velocity's lowest 4 bits so the product fits
+        // in 32 bits for speeds up to 8192 units per second.
+        static inline int32_t Advance(int32_t velocity, int32_t ticks)
+        {
+            return ((velocity >> 4) * ticks) >> 6;
+        }
+
+        bool ParticlePool::Init(Memory::Arena& arena, uint16_t capacity, uint8_t lanes)
+        {
+            Capacity = 0;
+            Count = 0;
+            Lanes = lanes;
+            BoundsValid = false;
+            X = arena.NewArray<int32_t>(capacity);
+            Y = arena.NewArray<int32_t>(capacity);
+            Z = (lanes & PARTICLE_DEPTH) ? arena.NewArray<int32_t>(capacity) : nullptr;
+            VX = (lanes & PARTICLE_VELOCITY) ? arena.NewArray<int32_t>(capacity) : nullptr;
+            VY = (lanes & PARTICLE_VELOCITY) ? arena.NewArray<int32_t>(capacity) : nullptr;
+            VZ = (lanes & PARTICLE_VELOCITY) && (lanes & PARTICLE_DEPTH) ? arena.NewArray<int32_t>(capacity) : nullptr;
+            Lifetime = (lanes & PARTICLE_LIFETIME) ? arena.NewArray<uint16_t>(capacity) : nullptr;
+            Colors = (lanes & PARTICLE_COLOR) ? arena.NewArray<uint16_t>(capacity) : nullptr;
+            if (!X || !Y || (Has(PARTICLE_DEPTH) && !Z) || (Has(PARTICLE_VELOCITY) && (!VX || !VY))
+                || (Has(PARTICLE_DEPTH | PARTICLE_VELOCITY) && !VZ) || (Has(PARTICLE_LIFETIME) && !Lifetime)
+                || (Has(PARTICLE_COLOR) && !Colors))
+                return false;
+
+            Capacity = capacity;
+            return true;
+        }
+
+        uint16_t ParticlePool::Spawn(Utils::Q16_16 x, Utils::Q16_16 y, Utils::Q16_16 z)
+        {
+            if (Count == Capacity)
+                return INVALID_PARTICLE;
+
+            uint16_t index = Count++;
+            X[index] = x.Raw;
+            Y[index] = y.Raw;
+            if (Z)
+                Z[index] = z.Raw;
+            if (VX)
+            {
+                VX[index] = 0;
+                VY[index] = 0;
+            }
+            if (VZ)
+                VZ[index] = 0;
+            if (Lifetime)
+                Lifetime[index] = 0xFFFF;
+            if (Colors)
+                Colors[index] = 0xFFFF;
+
+            // The caller may still set a velocity, so bounds are unknown until the next Update().
+            BoundsValid = false;
+            return index;
+        }
+
+        void ParticlePool::Kill(uint16_t index)
+        {
+            uint16_t last = --Count;
+            if (index == last)
+                return;
+
+            X[index] = X[last];
+            Y[index] = Y[last];
+            if (Z)
+                Z[index] = Z[last];
+            if (VX)
+            {
+                VX[index] = VX[last];
+                VY[index] = VY[last];
+            }
+            if (VZ)
+                VZ[index] = VZ[last];
+            if (Lifetime)
+                Lifetime[index] = Lifetime[last];
+            if (Colors)
+                Colors[index] = Colors[last];
+        }
+
+        void ParticlePool::Clear()
+        {
+            Count = 0;
+            BoundsValid = false;
+        }
+
+        void ParticlePool::Save(Snapshot::Writer& writer) const
+        {
+            writer.Write(Lanes);
+            writer.Write(Count);
+            writer.WriteArray(X, Count);
+            writer.WriteArray(Y, Count);
+            if (Z)
+                writer.WriteArray(Z, Count);
+            if (VX)
+            {
+                writer.WriteArray(VX, Count);
+                writer.WriteArray(VY, Count);
+            }
+            if (VZ)
+                writer.WriteArray(VZ, Count);
+            if (Lifetime)
+                writer.WriteArray(Lifetime, Count);
+            if (Colors)
+                writer.WriteArray(Colors, Count);
+        }
+
+        bool ParticlePool::Load(Snapshot::Reader& reader)
+        {
+            uint8_t lanes;
+            uint16_t count;
+            if (!reader.Read(lanes) || !reader.Read(count) || lanes != Lanes || count > Capacity)
+                return false;
+
+            Count = 0;
+            BoundsValid = false;
+            bool loaded = reader.ReadArray(X, count) && reader.ReadArray(Y, count)
+                && (!Z || reader.ReadArray(Z, count))
+                && (!VX || (reader.ReadArray(VX, count) && reader.ReadArray(VY, count)))
+                && (!VZ || reader.ReadArray(VZ, count))
+                && (!Lifetime || reader.ReadArray(Lifetime, count))
+                && (!Colors || reader.ReadArray(Colors, count));
+            if (loaded)
+                Count = count;
+            return loaded;
+        }
+
+        void ParticlePool::SetAcceleration(Utils::Q16_16 x, Utils::Q16_16 y, Utils::Q16_16 z)
+        {
+            AccelerationX = x.Raw;
+            AccelerationY = y.Raw;
+            AccelerationZ = z.Raw;
+        }
+
+        void ParticlePool::Update(float dt)
+        {
+            int32_t ticks = ToTicks(dt);
+
+            // One pass per lane, so each loop stays tight and branch free.
+            if (Lifetime)
+            {
+                for (uint16_t i = 0; i < Count;)
+                {
+                    if (Lifetime[i] <= ticks)
+                    {
+                        Kill(i);
+                        continue;
+                    }
+                    Lifetime[i] -= ticks;
+                    i++;
+                }
+            }
+
+            if (VZ)
+            {
+                int32_t accelerationZ = Advance(AccelerationZ, ticks);
+                for (uint16_t i = 0; i < Count; i++)
+                {
+                    VZ[i] += accelerationZ;
+                    Z[i] += Advance(VZ[i], ticks);
+                }
+            }
+
+            // Integrate X and Y and measure the bounds in the same pass.
+            int32_t minX = INT32_MAX, minY = INT32_MAX, maxX = INT32_MIN, maxY = INT32_MIN;
+            int32_t maxSpeedX = 0, maxSpeedY = 0;
+            if (VX)
+            {
+                int32_t accelerationX = Advance(AccelerationX, ticks);
+                int32_t accelerationY = Advance(AccelerationY, ticks);
+                for (uint16_t i = 0; i < Count; i++)
+                {
+                    int32_t vx = VX[i] + accelerationX;
+                    int32_t vy = VY[i] + accelerationY;
+                    int32_t x = X[i] + Advance(vx, ticks);
+                    int32_t y = Y[i] + Advance(vy, ticks);
+                    VX[i] = vx;
+                    VY[i] = vy;
+                    X[i] = x;
+                    Y[i] = y;
+                    minX = std::min(minX, x);
+                    maxX = std::max(maxX, x);
+                    minY = std::min(minY, y);
+                    maxY = std::max(maxY, y);
+                    maxSpeedX = std::max(maxSpeedX, std::abs(vx));
+                    maxSpeedY = std::max(maxSpeedY, std::abs(vy));
+                }
+            }
+            else
+            {
+                for (uint16_t i = 0; i < Count; i++)
+                {
+                    minX = std::min(minX, X[i]);
+                    maxX = std::max(maxX, X[i]);
+                    minY = std::min(minY, Y[i]);
+                    maxY = std::max(maxY, Y[i]);
+                }
+            }
+            MinX = minX >> 16;
+            MinY = minY >> 16;
+            MaxX = maxX >> 16;
+            MaxY = maxY >> 16;
+            MaxSpeedX = maxSpeedX;
+            MaxSpeedY = maxSpeedY;
+            BoundsValid = true;
+        }
+
+        void ParticlePool::Translate(Utils::Q16_16 x, Utils::Q16_16 y, Utils::Q16_16 z)
+        {
+            int32_t* lanes[3] = { X, Y, Z };
+            int32_t offsets[3] = { x.Raw, y.Raw, z.Raw };
+            for (int axis = 0; axis < 3; axis++)
+            {
+                int32_t* lane = lanes[axis];
+                int32_t offset = offsets[axis];
+                if (!lane || offset == 0)
+                    continue;
+                for (uint16_t i = 0; i < Count; i++)
+                    lane[i] += offset;
+            }
+
+            // floor(a + b) is floor(a) + floor(b) or one more, so widening the max edge by a pixel keeps the bounds
+            // conservative without another pass.
+            MinX += x.Raw >> 16;
+            MaxX += (x.Raw >> 16) + (x.Raw != 0);
+            MinY += y.Raw >> 16;
+            MaxY += (y.Raw >> 16) + (y.Raw != 0);
+        }
+
+        uint16_t ParticlePool::KillOutsideRange(Utils::Q16_16 range)
+        {
+            // Whole units are plenty for a range check. Anything past range on one axis is out without squaring,
+            // so the sum of squares stays under 3 * 32767^2 and fits in 32 bits.
+            int32_t limit = range.Raw >> 16;
+            uint32_t limitSquared = (uint32_t)(limit * limit);
+            uint16_t killed = 0;
+            for (uint16_t i = 0; i < Count;)
+            {
+                int32_t x = X[i] >> 16;
+                int32_t y = Y[i] >> 16;
+                int32_t z = Z ? Z[i] >> 16 : 0;
+                bool outside = std::abs(x) > limit || std::abs(y) > limit || std::abs(z) > limit
+                    || (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z) > limitSquared;
+                if (outside)
+                {
+                    Kill(i);
+                    killed++;
+                    continue;
+                }
+                i++;
+            }
+            return killed;
+        }
+
+        bool ParticlePool::GetBounds(int32_t& minX, int32_t& minY, int32_t& maxX, int32_t& maxY) const
+        {
+            if (!BoundsValid)
+                return false;
+            minX = MinX;
+            minY = MinY;
+            maxX = MaxX;
+            maxY = MaxY;
+            return true;
+        }
+
+        void ParticleEmitter::Init(const EmitterSettings& settings, const Utils::RandomStream& rng)
+        {
+            Settings = settings;
+            Rng = rng;
+            Accumulator = 0;
+        }
+
+        void ParticleEmitter::Save(Snapshot::Writer& writer) const
+        {
+            writer.Write(Rng);
+            writer.Write(Accumulator);
+        }
+
+        bool ParticleEmitter::Load(Snapshot::Reader& reader)
+        {
+            return reader.Read(Rng) && reader.Read(Accumulator);
+        }
+
+        uint16_t ParticleEmitter::Emit(ParticlePool& pool, float dt)
+        {
+            Accumulator += (uint32_t)Settings.Rate * ToTicks(dt);
+            uint32_t due = Accumulator >> 10;
+            Accumulator &= 1023;
+
+            uint16_t spawned = 0;
+            while (spawned < due && SpawnOne(pool))
+                spawned++;
+            return spawned;
+        }
+
+        uint16_t ParticleEmitter::Burst(ParticlePool& pool, uint16_t count)
+        {
+            uint16_t spawned = 0;
+            while (spawned < count && SpawnOne(pool))
+                spawned++;
+            return spawned;
+        }
+
+        uint16_t ParticleEmitter::Fill(ParticlePool& pool)
+        {
+            uint16_t spawned = 0;
+            while (SpawnOne(pool))
+                spawned++;
+            return spawned;
+        }
+
+        static Utils::Q16_16 Spread(Utils::RandomStream& rng, Utils::Q16_16 extent)
+        {
+            return extent.Raw > 0 ? rng.Fixed(-extent, extent) : Utils::Q16_16();
+        }
+
+        bool ParticleEmitter::SpawnOne(ParticlePool& pool)
+        {
+            if (pool.GetCount() == pool.GetCapacity())
+                return false;
+
+            Utils::Q16_16 x = Settings.X;
+            Utils::Q16_16 y = Settings.Y;
+            Utils::Q16_16 z = Settings.Z;
+            switch (Settings.SpawnShape)
+            {
+                case EmitterSettings::Shape::Point:
+                    break;
+
+                case EmitterSettings::Shape::Box:
+                    x += Spread(Rng, Settings.ExtentX);
+                    y += Spread(Rng, Settings.ExtentY);
+                    z += Spread(Rng, Settings.ExtentZ);
+                    break;
+
+                case EmitterSettings::Shape::Shell:
+                {
+                    // Uniform direction with no trig: pick points in a cube, 10 bits per axis from one draw, until one
+                    // lands inside the sphere (about half do), skipping the centre where the direction would be coarse.
+                    int32_t dx, dy, dz;
+                    uint32_t lengthSquared;
+                    do
+                    {
+                        uint32_t bits = Rng.Next();
+                        dx = (int32_t)(bits & 1023) - 512;
+                        dy = (int32_t)((bits >> 10) & 1023) - 512;
+                        dz = pool.Z ? (int32_t)((bits >> 20) & 1023) - 512 : 0;
+                        lengthSquared = (uint32_t)(dx * dx + dy * dy + dz * dz);
+                    } while (lengthSquared > 512 * 512 || lengthSquared < 128 * 128);
+
+                    Utils::Q16_16 distance = Settings.OuterRadius > Settings.InnerRadius
+                        ? Rng.Fixed(Settings.InnerRadius, Settings.OuterRadius) : Settings.InnerRadius;
+                    // |d| <= length on every axis, so d * (distance / length) can't exceed distance.
+                    int32_t scale = distance.Raw / (int32_t)Utils::ISqrt(lengthSquared);
+                    x += Utils::Q16_16::FromRaw(dx * scale);
+                    y += Utils::Q16_16::FromRaw(dy * scale);
+                    z += Utils::Q16_16::FromRaw(dz * scale);
+                    break;
+                }
+            }
+
+            uint16_t index = pool.Spawn(x, y, z);
+            if (pool.VX)
+            {
+                pool.VX[index] = (Settings.VelocityX + Spread(Rng, Settings.VelocitySpread)).Raw;
+                pool.VY[index] = (Settings.VelocityY + Spread(Rng, Settings.VelocitySpread)).Raw;
+            }
+            if (pool.VZ)
+                pool.VZ[index] = (Settings.VelocityZ + Spread(Rng, Settings.VelocitySpread)).Raw;
+            if (pool.Lifetime)
+            {
+                uint32_t milliseconds = Settings.MinLifetimeMs;
+                if (Settings.MaxLifetimeMs > Settings.MinLifetimeMs)
+                    milliseconds += Rng.Range((uint32_t)(Settings.MaxLifetimeMs - Settings.MinLifetimeMs + 1));
+                pool.Lifetime[index] = (uint16_t)std::min(milliseconds * 128 / 125, (uint32_t)0xFFFF);
+            }
+            if (pool.Colors)
+                pool.Colors[index] = Settings.Color;
+            return true;
+        }
+
+        // Per-channel saturating add of two RGB565 pixels. Spreading the channels apart leaves a spare bit above
+        // each one, so a single add does all three and the carries say which channels to clamp.
+        static inline uint16_t AddSaturate(uint16_t a, uint16_t b)
+        {
+            uint32_t spreadA = (a | ((uint32_t)a << 16)) & 0x07E0F81F;
+            uint32_t spreadB = (b | ((uint32_t)b << 16)) & 0x07E0F81F;
+            uint32_t sum = spreadA + spreadB;
+            uint32_t carries = sum & 0x08010020;
+            uint32_t saturated = (carries - (carries >> 5)) | (carries >> 6);
+            sum = (sum | saturated) & 0x07E0F81F;
+            return (uint16_t)(sum | (sum >> 16));
+        }
+
+        template<bool Additive>
+        static inline void Plot(uint16_t* pixel, uint16_t color)
+        {
+            *pixel = Additive ? AddSaturate(*pixel, color) : color;
+        }
+
+        // The single clip check per batch: are the pool's bounds, grown by margin, entirely on screen?
+        static bool IsOnScreen(const Driver::Buffer* buffer, const ParticlePool& pool, int32_t marginX, int32_t marginY)
+        {
+            int32_t minX, minY, maxX, maxY;
+            if (!pool.GetBounds(minX, minY, maxX, maxY))
+                return false;
+            return minX - marginX >= 0 && minY - marginY >= 0 && maxX + marginX < buffer->Width && maxY + marginY < buffer->Height;
+        }
+
+        // Colors are read as colors[i & colorMask], so a pool without a colour lane reads the batch colour every time
+        // with no branch in the loop.
+        static const uint16_t* ColorSource(const ParticlePool& pool, const uint16_t& color, uint32_t& colorMask)
+        {
+            colorMask = pool.Colors ? 0xFFFF : 0;
+            return pool.Colors ? pool.Colors : &color;
+        }
+
+        template<bool Additive, bool Clip>
+        static void DrawPoints(Driver::Buffer* buffer, const ParticlePool& pool, uint16_t color)
+        {
+            const uint32_t width = buffer->Width;
+            const uint32_t height = buffer->Height;
+            uint16_t* data = buffer->Data;
+            const int32_t* xs = pool.X;
+            const int32_t* ys = pool.Y;
+            uint32_t colorMask;
+            const uint16_t* colors = ColorSource(pool, color, colorMask);
+            for (uint16_t i = 0; i < pool.GetCount(); i++)
+            {
+                int32_t x = xs[i] >> 16;
+                int32_t y = ys[i] >> 16;
+                if (Clip && ((uint32_t)x >= width || (uint32_t)y >= height))
+                    continue;
+                Plot<Additive>(&data[y * width + x], colors[i & colorMask]);
+            }
+        }
+
+        void DrawParticlePoints(Driver::Buffer* buffer, const ParticlePool& pool, uint16_t color, ParticleBlend blend)
+        {
+            bool inside = IsOnScreen(buffer, pool, 0, 0);
+            if (blend == ParticleBlend::Additive)
+                inside ? DrawPoints<true, false>(buffer, pool, color) : DrawPoints<true, true>(buffer, pool, color);
+            else
+                inside ? DrawPoints<false, false>(buffer, pool, color) : DrawPoints<false, true>(buffer, pool, color);
+        }
+
+        // Streak tails use the same fixed-point step as integration, with seconds as 1/1024 s ticks (up to 1 s).
+        static inline int32_t Tail(int32_t velocity, int32_t ticks)
+        {
+            return (velocity >> 10) * ticks;
+        }
+
+        template<bool Additive, bool Clip>
+        static void DrawStreaks(Driver::Buffer* buffer, const ParticlePool& pool, uint16_t color, int32_t ticks)
+        {
+            const uint32_t width = buffer->Width;
+            const uint32_t height = buffer->Height;
+            uint16_t* data = buffer->Data;
+            uint32_t colorMask;
+            const uint16_t* colors = ColorSource(pool, color, colorMask);
+            for (uint16_t i = 0; i < pool.GetCount(); i++)
+            {
+                // Walk from the head back along the velocity, one pixel per step on the longer axis.
+                int32_t x = pool.X[i];
+                int32_t y = pool.Y[i];
+                int32_t tailX = -Tail(pool.VX[i], ticks);
+                int32_t tailY = -Tail(pool.VY[i], ticks);
+                int32_t steps = std::max(std::abs(tailX), std::abs(tailY)) >> 16;
+                int32_t stepX = steps ? tailX / steps : 0;
+                int32_t stepY = steps ? tailY / steps : 0;
+                uint16_t c = colors[i & colorMask];
+                for (int32_t step = 0; step <= steps; step++)
+                {
+                    int32_t px = x >> 16;
+                    int32_t py = y >> 16;
+                    if (!Clip || ((uint32_t)px < width && (uint32_t)py < height))
+                        Plot<Additive>(&data[py * width + px], c);
+                    x += stepX;
+                    y += stepY;
+                }
+            }
+        }
+
+        void DrawParticleStreaks(Driver::Buffer* buffer, const ParticlePool& pool, uint16_t color, ParticleBlend blend, Utils::Q16_16 seconds)
+        {
+            if (!pool.VX)
+            {
+                DrawParticlePoints(buffer, pool, color, blend);
+                return;
+            }
+
+            int32_t ticks = std::clamp((int32_t)(seconds.Raw >> 6), (int32_t)0, (int32_t)1024);
+            int32_t marginX = (Tail(pool.GetMaxSpeedX().Raw, ticks) >> 16) + 1;
+            int32_t marginY = (Tail(pool.GetMaxSpeedY().Raw, ticks) >> 16) + 1;
+            bool inside = IsOnScreen(buffer, pool, marginX, marginY);
+            if (blend == ParticleBlend::Additive)
+                inside ? DrawStreaks<true, false>(buffer, pool, color, ticks) : DrawStreaks<true, true>(buffer, pool, color, ticks);
+            else
+                inside ? DrawStreaks<false, false>(buffer, pool, color, ticks) : DrawStreaks<false, true>(buffer, pool, color, ticks);
+        }
+
+        template<bool Additive, bool Clip>
+        static void DrawSprites(Driver::Buffer* buffer, const ParticlePool& pool, const ParticleSprite& sprite)
+        {
+            const int32_t width = buffer->Width;
+            const int32_t height = buffer->Height;
+            uint16_t* data = buffer->Data;
+            for (uint16_t i = 0; i < pool.GetCount(); i++)
+            {
+                int32_t left = (pool.X[i] >> 16) - sprite.Width / 2;
+                int32_t top = (pool.Y[i] >> 16) - sprite.Height / 2;
+                const uint16_t* source = sprite.Pixels;
+                for (int32_t row = 0; row < sprite.Height; row++)
+                {
+                    int32_t y = top + row;
+                    if (Clip && (uint32_t)y >= (uint32_t)height)
+                    {
+                        source += sprite.Width;
+                        continue;
+                    }
+
+                    uint16_t* line = &data[y * width];
+                    for (int32_t x = left; x < left + sprite.Width; x++)
+                    {
+                        uint16_t pixel = *source++;
+                        if (Clip && (uint32_t)x >= (uint32_t)width)
+                            continue;
+                        if (!Additive && pixel == sprite.TransparentColor)
+                            continue;
+                        Plot<Additive>(&line[x], pixel);
+                    }
+                }
+            }
+        }
+
+        void DrawParticleSprites(Driver::Buffer* buffer, const ParticlePool& pool, const ParticleSprite& sprite, ParticleBlend blend)
+        {
+            bool inside = IsOnScreen(buffer, pool, sprite.Width / 2 + 1, sprite.Height / 2 + 1);
+            if (blend == ParticleBlend::Additive)
+                inside ? DrawSprites<true, false>(buffer, pool, sprite) : DrawSprites<true, true>(buffer, pool, sprite);
+            else
+                inside ? DrawSprites<false, false>(buffer, pool, sprite) : DrawSprites<false, true>(buffer, pool, sprite);
+        }
+
+        template<bool Additive>
+        static uint32_t DrawProjected(Driver::Buffer* buffer, const ParticlePool& pool, const ParticleProjection& projection, uint16_t color)
+        {
+            const uint32_t width = buffer->Width;
+            const uint32_t height = buffer->Height;
+            uint16_t* data = buffer->Data;
+            uint32_t colorMask;
+            const uint16_t* colors = ColorSource(pool, color, colorMask);
+
+            // Coordinates drop to 1/64 unit so x * focal fits in 32 bits for any Q16.16 x and focal lengths up to
+            // about 1000 px. Each visible particle then costs two integer divisions, which the RP2040 does in hardware.
+            const int32_t nearPlane = std::max(projection.Near.Raw >> 10, (int32_t)1);
+            const int32_t farPlane = projection.Far.Raw > 0 ? projection.Far.Raw >> 10 : INT32_MAX;
+            const int32_t focalX = projection.FocalX;
+            const int32_t focalY = projection.FocalY;
+            const int32_t centerX = projection.CenterX;
+            const int32_t centerY = projection.CenterY;
+            const int32_t rightX = (int32_t)width - centerX;
+            const int32_t bottomY = (int32_t)height - centerY;
+
+            uint32_t visible = 0;
+            for (uint16_t i = 0; i < pool.GetCount(); i++)
+            {
+                int32_t z = pool.Z[i] >> 10;
+                if (z < nearPlane || z > farPlane)
+                    continue;
+
+                // Projecting is also the clip. Points outside the view are rejected with multiplies before dividing,
+                // and only points that land on screen are written.
+                int32_t offsetX = (pool.X[i] >> 10) * focalX;
+                int32_t offsetY = (pool.Y[i] >> 10) * focalY;
+                if (offsetX < -z * centerX || offsetX >= z * rightX || offsetY < -z * centerY || offsetY >= z * bottomY)
+                    continue;
+                uint32_t x = (uint32_t)(centerX + offsetX / z);
+                uint32_t y = (uint32_t)(centerY + offsetY / z);
+                if (x >= width || y >= height)
+                    continue;
+
+                Plot<Additive>(&data[y * width + x], colors[i & colorMask]);
+                visible++;
+            }
+            return visible;
+        }
+
+        uint32_t DrawProjectedParticles(Driver::Buffer* buffer, const ParticlePool& pool, const ParticleProjection& projection,
+                                        uint16_t color, ParticleBlend blend)
+        {
+            if (!pool.Z)
+            {
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Particles: Projected draw of a pool without PARTICLE_DEPTH\n");
+                return 0;
+            }
+            if (blend == ParticleBlend::Additive)
+                return DrawProjected<true>(buffer, pool, projection, color);
+            return DrawProjected<false>(buffer, pool, projection, color);
+        }
+    }
+}
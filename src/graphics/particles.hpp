@@ -0,0 +1,192 @@
+#pragma once
+
+#include "drivers/display/ili9341.hpp"
+#include "memory/arena.hpp"
+#include "snapshot.hpp"
+#include "utils/fixed.hpp"
+#include "utils/random.hpp"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        // Optional per-particle data. X and Y are always there; everything else is only allocated when asked for.
+        enum ParticleLanes : uint8_t
+        {
+            PARTICLE_DEPTH = 1 << 0,        // Z, for pools drawn with DrawProjectedParticles().
+            PARTICLE_VELOCITY = 1 << 1,     // VX, VY (and VZ with PARTICLE_DEPTH), in units per second.
+            PARTICLE_LIFETIME = 1 << 2,     // Particles die when their lifetime runs out.
+            PARTICLE_COLOR = 1 << 3,        // Per-particle colour instead of one colour for the whole batch.
+        };
+
+        static constexpr uint16_t INVALID_PARTICLE = 0xFFFF;
+
+        // Fixed-capacity particle storage, one packed array per lane (struct of arrays) like Utils::EntityStorage.
+        // Live particles are always [0, GetCount()), so updates and draws are straight loops with no alive checks;
+        // Kill() moves the last particle into the hole.
+        //
+        // Positions and velocities are Q16.16 and integration is integer only: Update() turns dt into 1/1024 s ticks
+        // once, then each particle is a few shifts, adds and one 32-bit multiply per axis. Speeds up to 8192 units
+        // per second are exact at any frame rate; dt is clamped to 1/16 s so a hitch can't throw particles across
+        // the screen.
+        //
+        // Update() also measures the pool's screen bounds, which lets the draw functions clip the whole batch once
+        // and write straight into the buffer when it is all on screen.
+        class ParticlePool
+        {
+        public:
+            // Returns false if the arena couldn't hold capacity particles. Capacity must be below 0xFFFF.
+            bool Init(Memory::Arena& arena, uint16_t capacity, uint8_t lanes);
+
+            // New particle at a position, with zero velocity. Returns INVALID_PARTICLE when full.
+            uint16_t Spawn(Utils::Q16_16 x, Utils::Q16_16 y, Utils::Q16_16 z = Utils::Q16_16());
+
+            // Remove the particle at index. The last particle moves into index, so a loop should revisit it.
+            void Kill(uint16_t index);
+            void Clear();
+
+            // Applied to every velocity on each Update(), in units per second squared.
+            void SetAcceleration(Utils::Q16_16 x, Utils::Q16_16 y, Utils::Q16_16 z = Utils::Q16_16());
+
+            // Integrate velocities, age and kill expired particles, and refresh the bounds.
+            void Update(float dt);
+
+            // Move every particle by the same offset, e.g. camera motion. Zero components are skipped.
+            void Translate(Utils::Q16_16 x, Utils::Q16_16 y, Utils::Q16_16 z = Utils::Q16_16());
+
+            // Kill every particle further than range from the origin (all three axes with PARTICLE_DEPTH).
+            // Returns how many died.
+            uint16_t KillOutsideRange(Utils::Q16_16 range);
+
+            // The live particles, for game snapshots. Load() needs a pool initialised with the same lanes and at
+            // least as much capacity; acceleration is left to the game's OnInit().
+            void Save(Snapshot::Writer& writer) const;
+            bool Load(Snapshot::Reader& reader);
+
+            uint16_t GetCount() const { return Count; }
+            uint16_t GetCapacity() const { return Capacity; }
+            uint8_t GetLanes() const { return Lanes; }
+            bool Has(uint8_t lanes) const { return (Lanes & lanes) == lanes; }
+
+            // Whole-pixel bounds of every particle, and the largest |velocity| on each axis. Returns false when not
+            // known (something spawned since the last Update()), in which case draws clip per particle.
+            bool GetBounds(int32_t& minX, int32_t& minY, int32_t& maxX, int32_t& maxY) const;
+            Utils::Q16_16 GetMaxSpeedX() const { return Utils::Q16_16::FromRaw(MaxSpeedX); }
+            Utils::Q16_16 GetMaxSpeedY() const { return Utils::Q16_16::FromRaw(MaxSpeedY); }
+
+            // Lanes, as raw Q16.16, valid for [0, GetCount()). Null when the lane isn't in the pool.
+            int32_t* X = nullptr;
+            int32_t* Y = nullptr;
+            int32_t* Z = nullptr;
+            int32_t* VX = nullptr;
+            int32_t* VY = nullptr;
+            int32_t* VZ = nullptr;
+            uint16_t* Lifetime = nullptr;   // Remaining, in 1/1024 s ticks.
+            uint16_t* Colors = nullptr;
+
+        private:
+            uint16_t Count = 0;
+            uint16_t Capacity = 0;
+            uint8_t Lanes = 0;
+            bool BoundsValid = false;
+            int32_t MinX = 0, MinY = 0, MaxX = 0, MaxY = 0;
+            int32_t MaxSpeedX = 0, MaxSpeedY = 0;
+            int32_t AccelerationX = 0, AccelerationY = 0, AccelerationZ = 0;
+        };
+
+        // Spawns particles into a pool: continuously at a rate, in bursts, or topping the pool up to capacity.
+        struct EmitterSettings
+        {
+            enum class Shape : uint8_t
+            {
+                Point,      // At (X, Y, Z).
+                Box,        // Uniformly within +-Extent of (X, Y, Z).
+                Shell,      // Random direction from (X, Y, Z), at a distance uniform in [InnerRadius, OuterRadius).
+            };
+
+            Shape SpawnShape = Shape::Point;
+            Utils::Q16_16 X, Y, Z;
+            Utils::Q16_16 ExtentX, ExtentY, ExtentZ;
+            Utils::Q16_16 InnerRadius, OuterRadius;
+
+            // Base velocity plus a random +-VelocitySpread on each axis, in units per second.
+            Utils::Q16_16 VelocityX, VelocityY, VelocityZ;
+            Utils::Q16_16 VelocitySpread;
+
+            uint16_t Rate = 0;                  // Particles per second, for Emit().
+            uint16_t MinLifetimeMs = 1000;
+            uint16_t MaxLifetimeMs = 1000;
+            uint16_t Color = 0xFFFF;
+        };
+
+        class ParticleEmitter
+        {
+        public:
+            void Init(const EmitterSettings& settings, const Utils::RandomStream& rng);
+
+            // Spawn Rate particles per second, carrying the fraction over to the next call. Returns how many spawned.
+            uint16_t Emit(ParticlePool& pool, float dt);
+            uint16_t Burst(ParticlePool& pool, uint16_t count);
+            // Spawn until the pool is full, e.g. to keep a fixed-size field populated as particles die.
+            uint16_t Fill(ParticlePool& pool);
+
+            // The random stream and spawn credit, for game snapshots. Settings are left to the game's OnInit().
+            void Save(Snapshot::Writer& writer) const;
+            bool Load(Snapshot::Reader& reader);
+
+            // Free to change between calls, e.g. to move the emitter.
+            EmitterSettings Settings;
+
+        private:
+            bool SpawnOne(ParticlePool& pool);
+
+            Utils::RandomStream Rng;
+            uint32_t Accumulator = 0;           // Spawn credit in 1/1024 particles.
+        };
+
+        enum class ParticleBlend : uint8_t
+        {
+            Opaque,     // Overwrite the pixel.
+            Additive,   // Add per channel, saturating; overlapping particles glow.
+        };
+
+        struct ParticleSprite
+        {
+            const uint16_t* Pixels;
+            uint8_t Width;
+            uint8_t Height;
+            uint16_t TransparentColor;  // Skipped when drawing opaque. Black adds nothing, so it's free when additive.
+        };
+
+        // Integer perspective for pools with PARTICLE_DEPTH: screen = centre + focal * (x, y) / z.
+        struct ParticleProjection
+        {
+            int32_t FocalX;
+            int32_t FocalY;
+            int32_t CenterX;
+            int32_t CenterY;
+            Utils::Q16_16 Near;
+            Utils::Q16_16 Far;  // 0 for no far plane.
+
+            static ParticleProjection ForScreen(uint16_t width, uint16_t height, Utils::Q16_16 nearPlane, Utils::Q16_16 farPlane)
+            {
+                return { width / 2, height / 2, width / 2, height / 2, nearPlane, farPlane };
+            }
+        };
+
+        // Batch draws. Each checks the pool's bounds against the buffer once; when everything is on screen pixels
+        // are written with no per-particle checks. Colors come from the PARTICLE_COLOR lane when the pool has one.
+        void DrawParticlePoints(Driver::Buffer* buffer, const ParticlePool& pool, uint16_t color, ParticleBlend blend);
+
+        // A line from each particle back along its velocity, velocity * seconds long. Needs PARTICLE_VELOCITY.
+        void DrawParticleStreaks(Driver::Buffer* buffer, const ParticlePool& pool, uint16_t color, ParticleBlend blend, Utils::Q16_16 seconds);
+
+        // The sprite centred on each particle.
+        void DrawParticleSprites(Driver::Buffer* buffer, const ParticlePool& pool, const ParticleSprite& sprite, ParticleBlend blend);
+
+        // Project a PARTICLE_DEPTH pool and draw one pixel per visible particle. Returns how many were visible.
+        uint32_t DrawProjectedParticles(Driver::Buffer* buffer, const ParticlePool& pool, const ParticleProjection& projection,
+                                        uint16_t color, ParticleBlend blend);
+    }
+}
@@ -0,0 +1,198 @@
+#include "perfOverlay.hpp"
+
+#ifdef PERF_OVERLAY
+
+#include "utils/color.hpp"
+#include "memory/accounting.hpp"
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        namespace PerfOverlay
+        {
+            // Layout of the overlay region, in pixels.
+            static constexpr uint16_t PANEL_WIDTH = PERF_OVERLAY_HISTORY + 4;
+            static constexpr uint16_t PANEL_HEIGHT = 56;
+            static constexpr uint16_t GRAPH_HEIGHT = 33;    // 1 px per millisecond, up to 33 ms (30 fps).
+            static constexpr uint16_t TEXT_TOP = GRAPH_HEIGHT + 3;
+            static constexpr uint16_t TARGET_FRAME_MS = 16; // Reference line (60 fps).
+
+            // Heap is only re-measured occasionally since mallinfo() walks the free lists.
+            static constexpr uint8_t HEAP_SAMPLE_INTERVAL = 30;
+
+            static bool Enabled = true;
+            static uint16_t FrameMs10[PERF_OVERLAY_HISTORY]; // Frame times in 0.1 ms units.
+            static uint8_t HistoryHead = 0;
+            static uint32_t SmoothedFrameUs = 0;
+            static uint32_t SmoothedPresentUs = 0;
+            static uint32_t FreeHeapBytes = 0;
+            static uint8_t FramesUntilHeapSample = 0;
+
+            // 3x5 glyphs, one bit per pixel, rows top to bottom, 3 bits per row (MSB = left).
+            struct Glyph
+            {
+                char Character;
+                uint16_t Bits;
+            };
+
+            static constexpr Glyph Font[] =
+            {
+                { '0', 0b111101101101111 }, { '1', 0b010110010010111 }, { '2', 0b111001111100111 },
+                { '3', 0b111001111001111 }, { '4', 0b101101111001001 }, { '5', 0b111100111001111 },
+                { '6', 0b111100111101111 }, { '7', 0b111001001001001 }, { '8', 0b111101111101111 },
+                { '9', 0b111101111001111 }, { '.', 0b000000000000010 }, { 'F', 0b111100110100100 },
+                { 'P', 0b111101111100100 }, { 'S', 0b111100111001111 }, { 'I', 0b111010010010111 },
+                { 'H', 0b101101111101101 }, { 'K', 0b101101110101101 }, { 'M', 0b101111111101101 },
+                { 'B', 0b110101110101110 }, { 'E', 0b111100111100111 }, { 'A', 0b010101111101101 },
+                { ' ', 0b000000000000000 },
+            };
+
+            static uint16_t GlyphBits(char c)
+            {
+                for (const Glyph& glyph : Font)
+                    if (glyph.Character == c)
+                        return glyph.Bits;
+                return 0;
+            }
+
+            // Text is drawn unclipped, so callers keep it inside the panel.
+            static void DrawText(PicoPixel::Driver::Buffer* buffer, uint16_t x, uint16_t y, const char* text, uint16_t color)
+            {
+                for (; *text; text++, x += 4)
+                {
+                    uint16_t bits = GlyphBits(*text);
+                    for (uint8_t row = 0; row < 5; row++)
+                    {
+                        uint16_t* line = buffer->Data + (y + row) * buffer->Width + x;
+                        for (uint8_t col = 0; col < 3; col++)
+                            if (bits & (1u << (14 - row * 3 - col)))
+                                line[col] = color;
+                    }
+                }
+            }
+
+            // Writes value / 10 with one decimal, e.g. 167 -> "16.7". Returns the end of the written string.
+            static char* FormatTenths(char* out, uint32_t tenths)
+            {
+                char digits[10];
+                uint8_t count = 0;
+                uint32_t whole = tenths / 10;
+                do
+                {
+                    digits[count++] = '0' + whole % 10;
+                    whole /= 10;
+                } while (whole && count < sizeof(digits));
+                while (count)
+                    *out++ = digits[--count];
+                *out++ = '.';
+                *out++ = '0' + tenths % 10;
+                *out = '\0';
+                return out;
+            }
+
+            static char* Append(char* out, const char* text)
+            {
+                while (*text)
+                    *out++ = *text++;
+                *out = '\0';
+                return out;
+            }
+
+            void SetEnabled(bool enabled)
+            {
+                Enabled = enabled;
+            }
+
+            bool IsEnabled()
+            {
+                return Enabled;
+            }
+
+            void Toggle()
+            {
+                Enabled = !Enabled;
+            }
+
+            void RecordFrame(uint32_t frameUs, uint32_t presentUs)
+            {
+                uint32_t ms10 = frameUs / 100;
+                FrameMs10[HistoryHead] = ms10 > UINT16_MAX ? UINT16_MAX : (uint16_t)ms10;
+                HistoryHead = (HistoryHead + 1) % PERF_OVERLAY_HISTORY;
+
+                // Exponential moving averages (1/8 weight) keep the numbers readable.
+                SmoothedFrameUs = SmoothedFrameUs ? SmoothedFrameUs - SmoothedFrameUs / 8 + frameUs / 8 : frameUs;
+                SmoothedPresentUs = SmoothedPresentUs ? SmoothedPresentUs - SmoothedPresentUs / 8 + presentUs / 8 : presentUs;
+
+                if (FramesUntilHeapSample == 0)
+                {
+                    FreeHeapBytes = Memory::GetHeapFree();
+                    FramesUntilHeapSample = HEAP_SAMPLE_INTERVAL;
+                }
+                FramesUntilHeapSample--;
+            }
+
+            void Draw(PicoPixel::Driver::Buffer* buffer)
+            {
+                if (!Enabled || !buffer || !buffer->Data || buffer->Width < PANEL_WIDTH || buffer->Height < PANEL_HEIGHT)
+                    return;
+
+                constexpr uint16_t GraphColor = Utils::RGBto16bit(0, 255, 0);
+                constexpr uint16_t SlowColor = Utils::RGBto16bit(255, 0, 0);
+                constexpr uint16_t TargetColor = Utils::RGBto16bit(255, 255, 0);
+                constexpr uint16_t TextColor = Utils::RGBto16bit(255, 255, 255);
+
+                // Darken the panel to half brightness instead of clearing it, so the game stays visible underneath.
+                for (uint16_t y = 0; y < PANEL_HEIGHT; y++)
+                {
+                    uint16_t* line = buffer->Data + y * buffer->Width;
+                    for (uint16_t x = 0; x < PANEL_WIDTH; x++)
+                        line[x] = (line[x] >> 1) & 0b0111101111101111;
+                }
+
+                // Frame-time bars, oldest on the left. Bars over the 60 fps budget are drawn red.
+                uint16_t baseline = GRAPH_HEIGHT + 1;
+                for (uint16_t i = 0; i < PERF_OVERLAY_HISTORY; i++)
+                {
+                    uint16_t ms10 = FrameMs10[(HistoryHead + i) % PERF_OVERLAY_HISTORY];
+                    uint16_t height = ms10 / 10;
+                    if (height > GRAPH_HEIGHT)
+                        height = GRAPH_HEIGHT;
+                    uint16_t color = height > TARGET_FRAME_MS ? SlowColor : GraphColor;
+                    uint16_t* pixel = buffer->Data + baseline * buffer->Width + 2 + i;
+                    for (uint16_t h = 0; h < height; h++)
+                    {
+                        pixel -= buffer->Width;
+                        *pixel = color;
+                    }
+                }
+                uint16_t* target = buffer->Data + (baseline - TARGET_FRAME_MS) * buffer->Width + 2;
+                for (uint16_t x = 0; x < PERF_OVERLAY_HISTORY; x += 2)
+                    target[x] = TargetColor;
+
+                char text[24];
+                char* end;
+
+                // FPS from the smoothed frame time.
+                uint32_t fps10 = SmoothedFrameUs ? 10000000u / SmoothedFrameUs : 0;
+                end = Append(text, "FPS ");
+                FormatTenths(end, fps10);
+                DrawText(buffer, 2, TEXT_TOP, text, TextColor);
+
+                // DrawBuffer time, in milliseconds.
+                end = Append(text, "SPI ");
+                end = FormatTenths(end, SmoothedPresentUs / 100);
+                Append(end, "MS");
+                DrawText(buffer, 2, TEXT_TOP + 7, text, TextColor);
+
+                // Free heap, in kilobytes.
+                end = Append(text, "HEAP ");
+                end = FormatTenths(end, FreeHeapBytes * 10 / 1024);
+                Append(end, "KB");
+                DrawText(buffer, 2, TEXT_TOP + 14, text, TextColor);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "drivers/display/ili9341.hpp"
+#include <cstdint>
+
+// Number of frames shown in the frame-time graph (one pixel column each).
+#ifndef PERF_OVERLAY_HISTORY
+    #define PERF_OVERLAY_HISTORY 64
+#endif
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        // Small performance readout drawn into the top-left corner of the buffer:
+        // a rolling frame-time bar graph, FPS, time spent in DrawBuffer and free heap.
+        // Only built with the PERF_OVERLAY CMake option; LaunchMenu composites it after OnRender().
+        namespace PerfOverlay
+        {
+            void SetEnabled(bool enabled);
+            bool IsEnabled();
+            void Toggle();
+
+            // Feed one frame's timings. presentUs is the time spent in DrawBuffer for the previous frame.
+            void RecordFrame(uint32_t frameUs, uint32_t presentUs);
+
+            // Draw the overlay into the buffer. Does nothing when disabled.
+            void Draw(PicoPixel::Driver::Buffer* buffer);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include "sprites.hpp"
+#include "log.hpp"
+#include <cstring>
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        // One row of an RLE sprite, pixels [firstColumn, endColumn) of it written from out (which is firstColumn).
+        static void DrawRleRow(uint16_t* out, const uint16_t* packets, int32_t firstColumn, int32_t endColumn)
+        {
+            int32_t column = 0;
+            while (column < endColumn)
+            {
+                uint16_t packet = *packets++;
+                int32_t count = packet & Assets::RLE_COUNT_MASK;
+                uint16_t kind = packet & Assets::RLE_KIND_MASK;
+                int32_t start = column > firstColumn ? column : firstColumn;
+                int32_t end = column + count < endColumn ? column + count : endColumn;
+                if (kind == Assets::RLE_RUN)
+                {
+                    uint16_t color = *packets++;
+                    for (int32_t i = start; i < end; i++)
+                        out[i - firstColumn] = color;
+                }
+                else if (kind == Assets::RLE_LITERAL)
+                {
+                    for (int32_t i = start; i < end; i++)
+                        out[i - firstColumn] = packets[i - column];
+                    packets += count;
+                }
+                column += count;
+            }
+        }
+
+        void DrawSprite(Driver::Buffer* buffer, int32_t x, int32_t y, const Assets::SpriteView& sprite)
+        {
+            if (!buffer || !buffer->Data || !sprite.Data)
+            {
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer or sprite is null\n");
+                return;
+            }
+
+            // Clip once: [firstColumn, endColumn) x [firstRow, endRow) of the sprite is on screen.
+            int32_t firstColumn = x < 0 ? -x : 0;
+            int32_t firstRow = y < 0 ? -y : 0;
+            int32_t endColumn = x + sprite.Width > buffer->Width ? buffer->Width - x : sprite.Width;
+            int32_t endRow = y + sprite.Height > buffer->Height ? buffer->Height - y : sprite.Height;
+            if (firstColumn >= endColumn || firstRow >= endRow)
+                return;
+
+            int32_t width = endColumn - firstColumn;
+            bool transparent = sprite.IsTransparent();
+            for (int32_t row = firstRow; row < endRow; row++)
+            {
+                uint16_t* out = buffer->Data + (y + row) * buffer->Width + x + firstColumn;
+                switch (sprite.Format)
+                {
+                case Assets::PixelFormat::RGB565:
+                {
+                    const uint16_t* in = (const uint16_t*)sprite.Data + row * sprite.Width + firstColumn;
+                    if (!transparent)
+                    {
+                        memcpy(out, in, width * sizeof(uint16_t));
+                        break;
+                    }
+                    uint16_t key = sprite.TransparentColor;
+                    for (int32_t i = 0; i < width; i++)
+                    {
+                        if (in[i] != key)
+                            out[i] = in[i];
+                    }
+                    break;
+                }
+                case Assets::PixelFormat::Indexed8:
+                {
+                    const uint8_t* in = sprite.Data + row * sprite.Width + firstColumn;
+                    const uint16_t* palette = sprite.Palette;
+                    for (int32_t i = 0; i < width; i++)
+                    {
+                        uint8_t index = in[i];
+                        if (!transparent || index)
+                            out[i] = palette[index];
+                    }
+                    break;
+                }
+                case Assets::PixelFormat::Indexed4:
+                {
+                    const uint8_t* in = sprite.Data + row * ((sprite.Width + 1) / 2);
+                    const uint16_t* palette = sprite.Palette;
+                    for (int32_t i = 0; i < width; i++)
+                    {
+                        int32_t column = firstColumn + i;
+                        uint8_t index = (in[column >> 1] >> ((~column & 1) << 2)) & 0x0F;
+                        if (!transparent || index)
+                            out[i] = palette[index];
+                    }
+                    break;
+                }
+                case Assets::PixelFormat::Rle565:
+                {
+                    const uint32_t* rowOffsets = (const uint32_t*)sprite.Data;
+                    DrawRleRow(out, (const uint16_t*)(sprite.Data + rowOffsets[row]), firstColumn, endColumn);
+                    break;
+                }
+                default:
+                    return;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "assets/assetPack.hpp"
+#include "drivers/display/ili9341.hpp"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        // Blit a sprite straight from where it lives (XIP flash for the built-in asset pack), in any of the pack's
+        // pixel formats. The position may be partly or fully off screen; the sprite is clipped to the buffer once and
+        // the inner loops run without bounds checks. Transparent sprites skip their transparent pixels.
+        void DrawSprite(Driver::Buffer* buffer, int32_t x, int32_t y, const Assets::SpriteView& sprite);
+    }
+}
@@ -1 +1,70 @@
 #include "text.hpp"
+#include "log.hpp"
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        static void DrawGlyph(Driver::Buffer* buffer, int32_t x, int32_t y, const uint8_t* glyph, const Assets::FontView& font, uint16_t color)
+        {
+            bool inside = x >= 0 && y >= 0 && x + font.CellWidth <= buffer->Width && y + font.CellHeight <= buffer->Height;
+            for (uint8_t row = 0; row < font.CellHeight; row++, glyph += font.BytesPerRow)
+            {
+                int32_t screenY = y + row;
+                if (!inside && (screenY < 0 || screenY >= buffer->Height))
+                    continue;
+                uint16_t* out = buffer->Data + screenY * buffer->Width + x;
+                for (uint8_t column = 0; column < font.CellWidth; column++)
+                {
+                    if (!(glyph[column >> 3] & (0x80 >> (column & 7))))
+                        continue;
+                    if (inside || (x + column >= 0 && x + column < buffer->Width))
+                        out[column] = color;
+                }
+            }
+        }
+
+        int32_t DrawText(Driver::Buffer* buffer, int32_t x, int32_t y, const char* text, const Assets::FontView& font, uint16_t color)
+        {
+            if (!buffer || !buffer->Data || !text || !font.Glyphs)
+            {
+                LOG_DEFERRED(LOG_LEVEL_WARN, "Buffer, text or font is null\n");
+                return x;
+            }
+
+            int32_t lineX = x;
+            for (; *text; text++)
+            {
+                if (*text == '\n')
+                {
+                    x = lineX;
+                    y += font.CellHeight;
+                    continue;
+                }
+                const uint8_t* glyph = font.GetGlyph(*text);
+                if (glyph && x < buffer->Width && x + font.CellWidth > 0 && y < buffer->Height && y + font.CellHeight > 0)
+                    DrawGlyph(buffer, x, y, glyph, font, color);
+                x += font.GetAdvance(*text);
+            }
+            return x;
+        }
+
+        int32_t GetTextWidth(const char* text, const Assets::FontView& font)
+        {
+            int32_t width = 0;
+            int32_t lineWidth = 0;
+            for (; text && *text; text++)
+            {
+                if (*text == '\n')
+                {
+                    lineWidth = 0;
+                    continue;
+                }
+                lineWidth += font.GetAdvance(*text);
+                if (lineWidth > width)
+                    width = lineWidth;
+            }
+            return width;
+        }
+    }
+}
@@ -1,3 +1,19 @@
 #pragma once
 
-// TODO: Insert text rendering
+#include "assets/assetPack.hpp"
+#include "drivers/display/ili9341.hpp"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Graphics
+    {
+        // Draw text in a bitmap font from an asset pack, one colour, no background. Glyphs that are completely on
+        // screen are drawn without per-pixel checks; the rest are clipped. '\n' starts a new line at x. Characters
+        // the font lacks advance by half a cell. Returns the x after the last character.
+        int32_t DrawText(Driver::Buffer* buffer, int32_t x, int32_t y, const char* text, const Assets::FontView& font, uint16_t color);
+
+        // Width in pixels of the longest line.
+        int32_t GetTextWidth(const char* text, const Assets::FontView& font);
+    }
+}
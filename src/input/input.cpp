@@ -0,0 +1,218 @@
+#include "input.hpp"
+#include "log.hpp"
+#include "drivers/adc/adcSampler.hpp"
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+
+static_assert((INPUT_QUEUE_SIZE & (INPUT_QUEUE_SIZE - 1)) == 0, "INPUT_QUEUE_SIZE must be a power of two");
+
+namespace PicoPixel
+{
+    namespace Input
+    {
+        static constexpr uint8_t BUTTON_COUNT = (uint8_t)Button::Count;
+
+        static const int8_t Pins[BUTTON_COUNT] =
+        {
+            INPUT_PIN_UP, INPUT_PIN_DOWN, INPUT_PIN_LEFT, INPUT_PIN_RIGHT, INPUT_PIN_A, INPUT_PIN_B, INPUT_PIN_MENU,
+        };
+        static const char* const Names[BUTTON_COUNT] = { "Up", "Down", "Left", "Right", "A", "B", "Menu" };
+
+        // Head only moves in producers (the GPIO interrupt, or core0 with interrupts masked), Tail only in the consumer.
+        static Event Queue[INPUT_QUEUE_SIZE];
+        static volatile uint32_t Head = 0;
+        static volatile uint32_t Tail = 0;
+        static volatile uint32_t Dropped = 0;
+
+        static volatile bool Down[BUTTON_COUNT] = {};
+        static volatile uint64_t LastEdgeUs[BUTTON_COUNT] = {};
+
+        static uint8_t AnalogReferences[AdcSampler::INPUT_COUNT] = {};
+        static uint16_t AnalogValues[AdcSampler::INPUT_COUNT] = {};
+
+        // A reading is an average over the sampler's window, so on average it shows a movement half a window late.
+        static constexpr uint32_t ANALOG_DELAY_US = ADC_SAMPLER_AVERAGE * 1000000u / ADC_SAMPLER_RATE_HZ / 2;
+
+        static uint32_t LatencyFrames = 0;
+        static uint64_t LatencyTotalUs = 0;
+        static uint32_t LatencyMinUs = UINT32_MAX;
+        static uint32_t LatencyMaxUs = 0;
+
+        static void Push(const Event& event)
+        {
+            uint32_t head = Head;
+            if (head - Tail == INPUT_QUEUE_SIZE)
+            {
+                Dropped = Dropped + 1;
+                return;
+            }
+            Queue[head % INPUT_QUEUE_SIZE] = event;
+            __dmb(); // The event must be complete before the consumer can see it.
+            Head = head + 1;
+        }
+
+        // Push from core0's normal context, which the GPIO interrupt could otherwise preempt mid-push.
+        static void PushMasked(const Event& event)
+        {
+            uint32_t status = save_and_disable_interrupts();
+            Push(event);
+            restore_interrupts(status);
+        }
+
+        static void SetButton(uint8_t button, bool down, uint64_t now)
+        {
+            Down[button] = down;
+            LastEdgeUs[button] = now;
+            Push({ now, down ? EventType::ButtonDown : EventType::ButtonUp, button, 0 });
+        }
+
+        static void OnEdge(uint gpio, uint32_t events)
+        {
+            (void)events;
+            uint64_t now = time_us_64();
+            for (uint8_t button = 0; button < BUTTON_COUNT; button++)
+            {
+                if (Pins[button] != (int)gpio)
+                    continue;
+                bool down = !gpio_get(gpio);
+                if (down != Down[button] && now - LastEdgeUs[button] >= INPUT_DEBOUNCE_US)
+                    SetButton(button, down, now);
+                return;
+            }
+        }
+
+        void Init()
+        {
+            bool haveCallback = false;
+            for (uint8_t button = 0; button < BUTTON_COUNT; button++)
+            {
+                if (Pins[button] < 0)
+                    continue;
+                gpio_init(Pins[button]);
+                gpio_set_dir(Pins[button], GPIO_IN);
+                gpio_pull_up(Pins[button]);
+            }
+            // Let the pull-ups charge the lines before taking the starting levels.
+            sleep_us(10);
+            for (uint8_t button = 0; button < BUTTON_COUNT; button++)
+            {
+                if (Pins[button] < 0)
+                    continue;
+                Down[button] = !gpio_get(Pins[button]);
+                // There is one GPIO callback per core; every button shares it.
+                if (!haveCallback)
+                    gpio_set_irq_enabled_with_callback(Pins[button], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &OnEdge);
+                else
+                    gpio_set_irq_enabled(Pins[button], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+                haveCallback = true;
+            }
+        }
+
+        void AddAnalog(uint8_t adcInput)
+        {
+            if (adcInput >= AdcSampler::INPUT_COUNT || !AdcSampler::Enable(adcInput))
+                return;
+            if (!AnalogReferences[adcInput]++)
+                AnalogValues[adcInput] = 0xFFFF;    // Not a reading, so the first Poll() reports where it starts.
+        }
+
+        void RemoveAnalog(uint8_t adcInput)
+        {
+            if (adcInput >= AdcSampler::INPUT_COUNT || !AnalogReferences[adcInput])
+                return;
+            AnalogReferences[adcInput]--;
+            AdcSampler::Disable(adcInput);
+        }
+
+        void Poll()
+        {
+            uint64_t now = time_us_64();
+
+            // Buttons whose last edge was bounce and that settled the other way.
+            uint32_t status = save_and_disable_interrupts();
+            for (uint8_t button = 0; button < BUTTON_COUNT; button++)
+            {
+                if (Pins[button] < 0)
+                    continue;
+                bool down = !gpio_get(Pins[button]);
+                if (down != Down[button] && now - LastEdgeUs[button] >= INPUT_DEBOUNCE_US)
+                    SetButton(button, down, now);
+            }
+            restore_interrupts(status);
+
+            for (uint8_t input = 0; input < AdcSampler::INPUT_COUNT; input++)
+            {
+                if (!AnalogReferences[input])
+                    continue;
+                uint16_t value = AdcSampler::Read(input);
+                if (value == AnalogValues[input])
+                    continue;
+                AnalogValues[input] = value;
+                PushMasked({ now - ANALOG_DELAY_US, EventType::Analog, input, value });
+            }
+
+            // TEMP: Serial keys, until every board has buttons.
+            for (int key = getchar_timeout_us(0); key >= 0; key = getchar_timeout_us(0))
+                PushMasked({ now, EventType::Key, (uint8_t)key, 0 });
+        }
+
+        bool Pop(Event& event)
+        {
+            uint32_t tail = Tail;
+            if (tail == Head)
+                return false;
+            __dmb(); // Don't read the event before seeing Head move past it.
+            event = Queue[tail % INPUT_QUEUE_SIZE];
+            __dmb(); // Nor hand its slot back before it has been copied out.
+            Tail = tail + 1;
+            return true;
+        }
+
+        void Clear()
+        {
+            Tail = Head;
+        }
+
+        bool IsDown(Button button)
+        {
+            return button < Button::Count && Down[(uint8_t)button];
+        }
+
+        const char* GetButtonName(Button button)
+        {
+            return button < Button::Count ? Names[(uint8_t)button] : "?";
+        }
+
+        void RecordLatency(uint64_t inputUs, uint64_t presentedUs)
+        {
+            if (!inputUs || presentedUs < inputUs)
+                return;
+            uint32_t latencyUs = (uint32_t)(presentedUs - inputUs);
+            LatencyFrames++;
+            LatencyTotalUs += latencyUs;
+            LatencyMinUs = latencyUs < LatencyMinUs ? latencyUs : LatencyMinUs;
+            LatencyMaxUs = latencyUs > LatencyMaxUs ? latencyUs : LatencyMaxUs;
+            LOG_DEFERRED(LOG_LEVEL_DEBUG, "Input: %lu us input to photon\n", (unsigned long)latencyUs);
+        }
+
+        void Report()
+        {
+            if (LatencyFrames)
+                LOG("Input: %lu frames showed new input, input to photon avg %lu us, min %lu us, max %lu us\n",
+                    (unsigned long)LatencyFrames, (unsigned long)(LatencyTotalUs / LatencyFrames),
+                    (unsigned long)LatencyMinUs, (unsigned long)LatencyMaxUs);
+            else
+                LOG("Input: No frames showed new input\n");
+            if (Dropped)
+                LOG_WARN("Input: %lu events dropped on a full queue (INPUT_QUEUE_SIZE)\n", (unsigned long)Dropped);
+
+            LatencyFrames = 0;
+            LatencyTotalUs = 0;
+            LatencyMinUs = UINT32_MAX;
+            LatencyMaxUs = 0;
+            Dropped = 0;
+        }
+    }
+}
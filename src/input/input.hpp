@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+// GPIO each button is wired to (a push button to ground; the internal pull-up is used), or -1 if it isn't fitted.
+#ifndef INPUT_PIN_UP
+    #define INPUT_PIN_UP 2
+#endif
+#ifndef INPUT_PIN_DOWN
+    #define INPUT_PIN_DOWN 3
+#endif
+#ifndef INPUT_PIN_LEFT
+    #define INPUT_PIN_LEFT 4
+#endif
+#ifndef INPUT_PIN_RIGHT
+    #define INPUT_PIN_RIGHT 13
+#endif
+#ifndef INPUT_PIN_A
+    #define INPUT_PIN_A 14
+#endif
+#ifndef INPUT_PIN_B
+    #define INPUT_PIN_B 15
+#endif
+#ifndef INPUT_PIN_MENU
+    #define INPUT_PIN_MENU 22
+#endif
+
+// Events that can wait to be consumed (a power of two). Later ones are dropped and counted.
+#ifndef INPUT_QUEUE_SIZE
+    #define INPUT_QUEUE_SIZE 32
+#endif
+
+// Further edges on a button within this long of the last one are contact bounce, in microseconds.
+#ifndef INPUT_DEBOUNCE_US
+    #define INPUT_DEBOUNCE_US 5000
+#endif
+
+namespace PicoPixel
+{
+    // Timestamped input events, from GPIO buttons (edge interrupts), analog inputs (AdcSampler) and serial keys, in one
+    // queue that the menu drains once per frame and hands on to the running game.
+    //
+    // Button events are queued from the GPIO interrupt with the time of the edge, so a press is stamped when it
+    // happens rather than when a frame gets round to it. The first edge is taken straight away and the bounce after
+    // it ignored; Poll() catches up with the pin if it settled the other way. Everything else is queued by Poll()
+    // with interrupts briefly masked, which keeps the queue single-producer as far as the consumer can tell: nothing
+    // is locked and nothing waits on the reading side.
+    //
+    // The menu tags each frame with the newest event it consumed, and the present path turns that into
+    // input-to-photon latency (RecordLatency(), Report()).
+    namespace Input
+    {
+        enum class Button : uint8_t
+        {
+            Up,
+            Down,
+            Left,
+            Right,
+            A,
+            B,
+            Menu,
+            Count,
+        };
+
+        enum class EventType : uint8_t
+        {
+            ButtonDown,     // Code is the Button.
+            ButtonUp,
+            Analog,         // Code is the ADC input, Value its filtered reading (0-4095).
+            Key,            // Code is the character received over serial.
+        };
+
+        struct Event
+        {
+            uint64_t TimeUs;
+            EventType Type;
+            uint8_t Code;
+            uint16_t Value;
+
+            bool IsPressed(Button button) const { return Type == EventType::ButtonDown && Code == (uint8_t)button; }
+        };
+
+        // Set up the button pins and their interrupt. Call once on core0, whose interrupts then carry the buttons.
+        void Init();
+
+        // Queue an event when an analog input moves (reference counted, like AdcSampler::Enable(), which this
+        // does too).
+        void AddAnalog(uint8_t adcInput);
+        void RemoveAnalog(uint8_t adcInput);
+
+        // Check analog inputs, serial and settled buttons. Call once per frame before draining the queue.
+        void Poll();
+
+        // The oldest queued event. False when there are none.
+        bool Pop(Event& event);
+
+        // Drop everything queued, e.g. presses meant for a game that has just ended.
+        void Clear();
+
+        bool IsDown(Button button);
+        const char* GetButtonName(Button button);
+
+        // A frame whose newest input was stamped inputUs finished going out to the display at presentedUs. Called by
+        // the core that presents.
+        void RecordLatency(uint64_t inputUs, uint64_t presentedUs);
+
+        // Input-to-photon latency since the last report, and events dropped on a full queue.
+        void Report();
+    }
+}
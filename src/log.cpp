@@ -0,0 +1,179 @@
+#include "log.hpp"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <cstdio>
+
+namespace PicoPixel
+{
+    namespace Log
+    {
+        // Single ring shared by both cores. A striped spin lock is plenty since the critical section is a struct copy.
+        static LogRecord Records[LOG_DEFERRED_CAPACITY];
+        static uint32_t Head = 0;   // Next slot to write.
+        static uint32_t Tail = 0;   // Next slot to read.
+        static uint32_t Dropped = 0;
+
+        static spin_lock_t* GetLock()
+        {
+            return spin_lock_instance(PICO_SPINLOCK_ID_STRIPED_FIRST);
+        }
+
+        void PushRecord(const LogRecord& record)
+        {
+            uint32_t timestamp = time_us_32();
+
+            spin_lock_t* lock = GetLock();
+            uint32_t irq = spin_lock_blocking(lock);
+            if (Head - Tail >= LOG_DEFERRED_CAPACITY)
+            {
+                Dropped++;
+            }
+            else
+            {
+                LogRecord& slot = Records[Head % LOG_DEFERRED_CAPACITY];
+                slot = record;
+                slot.Timestamp = timestamp;
+                Head++;
+            }
+            spin_unlock(lock, irq);
+        }
+
+        static bool PopRecord(LogRecord* record)
+        {
+            spin_lock_t* lock = GetLock();
+            uint32_t irq = spin_lock_blocking(lock);
+            bool available = Head != Tail;
+            if (available)
+            {
+                *record = Records[Tail % LOG_DEFERRED_CAPACITY];
+                Tail++;
+            }
+            spin_unlock(lock, irq);
+            return available;
+        }
+
+        static float ArgAsFloat(uintptr_t arg)
+        {
+            uint32_t bits = (uint32_t)arg;
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+
+        // Format a record the same way printf would. We can't rebuild a va_list, so each conversion is printed on its own.
+        static void PrintRecord(const LogRecord& record)
+        {
+            static const char* const Tags[] = { "[---]", "[ERR]", "[WRN]", "[LOG]", "[DBG]", "[TRC]" };
+            const LogSite* site = record.Site;
+            printf("%s %s:%d %s() +%luus: ", Tags[site->Level <= LOG_LEVEL_TRACE ? site->Level : 0], site->File, site->Line, site->Function, (unsigned long)record.Timestamp);
+
+            const char* fmt = site->Format;
+            uint8_t argIndex = 0;
+            while (*fmt)
+            {
+                if (*fmt != '%')
+                {
+                    putchar(*fmt++);
+                    continue;
+                }
+                if (fmt[1] == '%')
+                {
+                    putchar('%');
+                    fmt += 2;
+                    continue;
+                }
+
+                // Copy the conversion spec (flags, width, precision, length, conversion) into its own string.
+                char spec[16];
+                uint8_t length = 0;
+                spec[length++] = *fmt++;
+                while (*fmt && length < sizeof(spec) - 2 && !strchr("diouxXeEfFgGaAcspn", *fmt))
+                    spec[length++] = *fmt++;
+                char conversion = *fmt;
+                if (*fmt)
+                    spec[length++] = *fmt++;
+                spec[length] = '\0';
+
+                if (argIndex >= record.ArgCount)
+                {
+                    fputs(spec, stdout);
+                    continue;
+                }
+
+                uintptr_t arg = record.Args[argIndex];
+                ArgType type = (ArgType)((record.ArgTypes >> (argIndex * 2)) & 0x3);
+                argIndex++;
+
+                // Arguments were captured as 32-bit values, so length modifiers are dropped and the bare conversion is printed.
+                char bare[16];
+                uint8_t bareLength = 0;
+                for (uint8_t i = 0; i < length - 1; i++)
+                    if (!strchr("hlLqjzt", spec[i]))
+                        bare[bareLength++] = spec[i];
+                bare[bareLength++] = conversion;
+                bare[bareLength] = '\0';
+
+                if (conversion == 's')
+                    printf(bare, arg ? (const char*)(uintptr_t)arg : "(null)");
+                else if (conversion == 'p')
+                    printf(bare, (void*)(uintptr_t)arg);
+                else if (strchr("eEfFgGaA", conversion))
+                    printf(bare, type == ArgType::Float ? (double)ArgAsFloat(arg) : (double)(int32_t)arg);
+                else if (type == ArgType::Float)
+                    printf(bare, (int)ArgAsFloat(arg));
+                else if (type == ArgType::Signed)
+                    printf(bare, (int)(int32_t)arg);
+                else
+                    printf(bare, (unsigned int)arg);
+            }
+        }
+
+        uint32_t Drain(uint32_t maxRecords)
+        {
+            static uint32_t reportedDropped = 0;
+
+            uint32_t printed = 0;
+            LogRecord record;
+            while (printed < maxRecords && PopRecord(&record))
+            {
+                PrintRecord(record);
+                printed++;
+            }
+
+            uint32_t dropped = Dropped;
+            if (dropped != reportedDropped)
+            {
+                printf("[WRN] log.cpp: %lu deferred log records dropped (ring full)\n", (unsigned long)(dropped - reportedDropped));
+                reportedDropped = dropped;
+            }
+            return printed;
+        }
+
+        void DumpBinary()
+        {
+            // Header: record size, pending count and dropped count so the decoder can sanity check the stream.
+            spin_lock_t* lock = GetLock();
+            uint32_t irq = spin_lock_blocking(lock);
+            uint32_t pending = Head - Tail;
+            uint32_t dropped = Dropped;
+            spin_unlock(lock, irq);
+
+            printf("#PPLG-BEGIN %u %lu %lu\n", (unsigned)sizeof(LogRecord), (unsigned long)pending, (unsigned long)dropped);
+            LogRecord record;
+            while (PopRecord(&record))
+            {
+                const uint8_t* bytes = (const uint8_t*)&record;
+                printf("#PPLG ");
+                for (size_t i = 0; i < sizeof(LogRecord); i++)
+                    printf("%02x", bytes[i]);
+                putchar('\n');
+            }
+            printf("#PPLG-END\n");
+        }
+
+        uint32_t GetDroppedCount()
+        {
+            return Dropped;
+        }
+    }
+}
@@ -1,11 +1,195 @@
 #pragma once
 
-// TODO: Add to CMake.
-#ifndef STRIP_LOGGING
-    #include <cstdio>
-    #include <cstring>
-    #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
-    #define LOG(fmt, ...) printf("[LOG] %s:%d %s(): " fmt, __FILENAME__, __LINE__, __func__, ##__VA_ARGS__)
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// Log levels. A log statement is only compiled in if its level is at or below the module's level.
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+// Global level, set by CMake (LOG_LEVEL). STRIP_LOGGING removes everything.
+#ifdef STRIP_LOGGING
+    #undef LOG_LEVEL
+    #define LOG_LEVEL LOG_LEVEL_NONE
+#elif !defined(LOG_LEVEL)
+    #define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Per-module level. Define LOG_MODULE_LEVEL before including this header to override it for one file, e.g.
+//     #define LOG_MODULE_LEVEL LOG_LEVEL_WARN
+//     #include "log.hpp"
+// Modules may be more or less verbose than the global level, but STRIP_LOGGING always wins.
+#ifndef LOG_MODULE_LEVEL
+    #define LOG_MODULE_LEVEL LOG_LEVEL
+#endif
+
+// Number of records the deferred ring can hold before new records are dropped.
+#ifndef LOG_DEFERRED_CAPACITY
+    #define LOG_DEFERRED_CAPACITY 64
+#endif
+
+// Maximum number of arguments a deferred record stores. Extra arguments are a compile error.
+#define LOG_DEFERRED_MAX_ARGS 4
+
+namespace PicoPixel
+{
+    namespace Log
+    {
+        // Offset of the file name within a path, so __FILE__ can be trimmed at compile time.
+        constexpr size_t BasenameOffset(const char* path, size_t index = 0, size_t last = 0)
+        {
+            return path[index] == '\0' ? last
+                : BasenameOffset(path, index + 1, (path[index] == '/' || path[index] == '\\') ? index + 1 : last);
+        }
+
+        // Everything about a deferred log statement that is known at compile time.
+        // One of these lives in flash per call site; records only store a pointer to it.
+        struct LogSite
+        {
+            const char* Format;
+            const char* File;
+            const char* Function;
+            uint16_t Line;
+            uint8_t Level;
+        };
+
+        // How a deferred argument was captured. Packed two bits per argument into LogRecord::ArgTypes.
+        enum class ArgType : uint8_t
+        {
+            Signed = 0,
+            Unsigned = 1,
+            Float = 2,
+            Pointer = 3,
+        };
+
+        // A deferred log record. Fixed size so the ring is a flat array.
+        struct LogRecord
+        {
+            const LogSite* Site;
+            uint32_t Timestamp;         /** time_us_32() when the record was pushed. */
+            uint8_t ArgCount;
+            uint8_t ArgTypes;
+            uint16_t Reserved;
+            uintptr_t Args[LOG_DEFERRED_MAX_ARGS]; /** Pointer sized so %s survives on 64-bit host builds. */
+        };
+
+        template<typename T>
+        constexpr ArgType GetArgType()
+        {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_floating_point_v<U>)
+                return ArgType::Float;
+            else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>)
+                return ArgType::Pointer;
+            else if constexpr (std::is_signed_v<U>)
+                return ArgType::Signed;
+            else
+                return ArgType::Unsigned;
+        }
+
+        template<typename T>
+        inline uintptr_t PackArg(T value)
+        {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_floating_point_v<U>)
+            {
+                float f = (float)value;
+                uint32_t bits;
+                std::memcpy(&bits, &f, sizeof(bits));
+                return bits;
+            }
+            else if constexpr (std::is_pointer_v<U>)
+                return (uintptr_t)value;
+            else if constexpr (std::is_null_pointer_v<U>)
+                return 0;
+            else
+                return (uintptr_t)(uint32_t)value;
+        }
+
+        // Copy a record into the ring. Safe to call from either core and from interrupts.
+        void PushRecord(const LogRecord& record);
+
+        template<typename... Args>
+        inline void Push(const LogSite* site, Args... args)
+        {
+            static_assert(sizeof...(Args) <= LOG_DEFERRED_MAX_ARGS, "Too many arguments for a deferred log record");
+
+            LogRecord record;
+            record.Site = site;
+            record.ArgCount = sizeof...(Args);
+            record.ArgTypes = 0;
+            record.Reserved = 0;
+            uint8_t index = 0;
+            ((record.ArgTypes |= (uint8_t)GetArgType<Args>() << (index * 2), record.Args[index++] = PackArg(args)), ...);
+            (void)index;
+            PushRecord(record);
+        }
+
+        // Print up to maxRecords deferred records as text. Call this off the hot path (e.g. after presenting a frame).
+        // Returns the number of records printed.
+        uint32_t Drain(uint32_t maxRecords);
+
+        // Dump all pending records as "#PPLG" hex lines for tools/log_decode.py, which resolves them against the ELF.
+        // Much cheaper than Drain() since nothing is formatted on the device.
+        void DumpBinary();
+
+        // Records dropped since boot because the ring was full.
+        uint32_t GetDroppedCount();
+    }
+}
+
+// File name only, resolved at compile time.
+#define __FILENAME__ (__FILE__ + std::integral_constant<size_t, PicoPixel::Log::BasenameOffset(__FILE__)>::value)
+
+// True if a statement of this level is compiled into the current module.
+#ifdef STRIP_LOGGING
+    #define LOG_ENABLED(level) false
 #else
-    #define LOG(fmt, ...)
+    #define LOG_ENABLED(level) ((level) <= LOG_MODULE_LEVEL)
 #endif
+
+#define LOG_TAG_1 "[ERR]"
+#define LOG_TAG_2 "[WRN]"
+#define LOG_TAG_3 "[LOG]"
+#define LOG_TAG_4 "[DBG]"
+#define LOG_TAG_5 "[TRC]"
+#define LOG_TAG(level) LOG_TAG_##level
+
+// Deferred: stores a LogSite pointer plus raw arguments in the ring, costing a few hundred cycles instead of a printf.
+// %s arguments must point to memory that outlives the record (string literals, static buffers).
+#define LOG_DEFERRED(level, fmt, ...) \
+    do \
+    { \
+        if constexpr (LOG_ENABLED(level)) \
+        { \
+            static const PicoPixel::Log::LogSite LogSite_ = { fmt, __FILENAME__, __func__, __LINE__, level }; \
+            PicoPixel::Log::Push(&LogSite_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#ifdef LOG_MODE_DEFERRED
+    #define LOG_AT(level, fmt, ...) LOG_DEFERRED(level, fmt, ##__VA_ARGS__)
+#else
+    #include <cstdio>
+    #define LOG_AT(level, fmt, ...) \
+        do \
+        { \
+            if constexpr (LOG_ENABLED(level)) \
+                printf(LOG_TAG(level) " %s:%d %s(): " fmt, __FILENAME__, __LINE__, __func__, ##__VA_ARGS__); \
+        } while (0)
+#endif
+
+#define LOG_ERROR(fmt, ...) LOG_AT(1, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(2, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(3, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG_AT(4, fmt, ##__VA_ARGS__)
+#define LOG_TRACE(fmt, ...) LOG_AT(5, fmt, ##__VA_ARGS__)
+
+// Plain LOG is info level.
+#define LOG(fmt, ...) LOG_INFO(fmt, ##__VA_ARGS__)
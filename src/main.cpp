@@ -5,19 +5,25 @@
 #include <hardware/gpio.h>
 // #include <hardware/watchdog.h>
 #include <hardware/clocks.h>
+#include "boot.hpp"
+#include "clockGovernor.hpp"
 #include "drivers/display/ili9341.hpp"
+#include "assets/assetCache.hpp"
 #include "graphics/graphics.hpp"
-#include "games/gameRegistry.hpp"
+#include "graphics/sprites.hpp"
+#include "graphics/text.hpp"
+#include "input/input.hpp"
 #include "menu.hpp"
 #include "utils/color.hpp"
 #include "utils/random.hpp"
+#include "utils/trig.hpp"
+#include "benchmarks/benchmark.hpp"
+#include "replay.hpp"
+#include "snapshot.hpp"
+#include "memory/accounting.hpp"
 #include <cmath>
 #include <log.hpp>
 
-#include "games/PicoSpace/PicoSpace.hpp"
-#include "games/template/exampleGame.hpp"
-#include "games/pong/pong.hpp"
-
 void FlashGPIOLEDPin(bool longFlash)
 {
     cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
@@ -95,18 +101,18 @@ bool RunDiagnostics(PicoPixel::Driver::Ili9341Data* ili9341Data, PicoPixel::Driv
     uint16_t hexX[6], hexY[6];
     for (int i = 0; i < 6; i++)
     {
-        float angle = 2.0f * 3.1415926f * i / 6.0f;
-        hexX[i] = (uint16_t)(buffer->Width / 2.0f + (buffer->Height / 3.0f) * cosf(angle));
-        hexY[i] = (uint16_t)(buffer->Height / 2.0f + (buffer->Height / 3.0f)* sinf(angle));
+        PicoPixel::Utils::BinaryAngle angle = PicoPixel::Utils::BinaryAngle::FromTurns(i, 6);
+        hexX[i] = (uint16_t)(buffer->Width / 2 + (PicoPixel::Utils::Cos(angle) * (buffer->Height / 3)).ToInt());
+        hexY[i] = (uint16_t)(buffer->Height / 2 + (PicoPixel::Utils::Sin(angle) * (buffer->Height / 3)).ToInt());
     }
     PicoPixel::Graphics::DrawPolygon(buffer, hexX, hexY, 6, PicoPixel::Utils::RGBto16bit(255, 128, 0), false);
     // Pentagon filled
     uint16_t pentX[5], pentY[5];
     for (int i = 0; i < 5; i++)
     {
-        float angle = 2.0f * 3.1415926f * i / 5.0f - 3.1415926f/2.0f;
-        pentX[i] = (uint16_t)(buffer->Width / 2.0f + (buffer->Height / 4.0f) * cosf(angle));
-        pentY[i] = (uint16_t)(buffer->Height / 2.0f + (buffer->Height / 4.0f) * sinf(angle));
+        PicoPixel::Utils::BinaryAngle angle = PicoPixel::Utils::BinaryAngle::FromTurns(i, 5) - PicoPixel::Utils::BinaryAngle::FromTurns(1, 4);
+        pentX[i] = (uint16_t)(buffer->Width / 2 + (PicoPixel::Utils::Cos(angle) * (buffer->Height / 4)).ToInt());
+        pentY[i] = (uint16_t)(buffer->Height / 2 + (PicoPixel::Utils::Sin(angle) * (buffer->Height / 4)).ToInt());
     }
     PicoPixel::Graphics::DrawPolygon(buffer, pentX, pentY, 5, PicoPixel::Utils::RGBto16bit(0, 255, 128), true);
     PicoPixel::Driver::DrawBuffer(ili9341Data, 0, 0, buffer);
@@ -125,13 +131,21 @@ bool RunDiagnostics(PicoPixel::Driver::Ili9341Data* ili9341Data, PicoPixel::Driv
 
 int main()
 {
+    // Before anything deep runs (and before core1 starts), so the stack high-water marks cover the whole run.
+    PicoPixel::Memory::PaintStacks();
+
     stdio_init_all();
     LOG("Hello, World!");
 
-    PicoPixel::Driver::Ili9341Data* ili9341Data = new PicoPixel::Driver::Ili9341Data();
-    PicoPixel::Driver::InitializeIli9341(ili9341Data,
+    // ------- Begin initialization -------
+
+    // The display spends most of its ~250 ms start-up waiting out reset and sleep-out delays, so everything that
+    // doesn't need it runs in those gaps (see Boot::InitScheduler). The timeline is printed before the menu starts.
+    const int displaySpiHz = static_cast<int>(62.5 * MHz);
+    PicoPixel::Driver::Ili9341Data* ili9341Data = PicoPixel::Memory::New<PicoPixel::Driver::Ili9341Data>(PicoPixel::Memory::Tag::Driver);
+    uint64_t displayReadyAt = PicoPixel::Driver::BeginInitializeIli9341(ili9341Data,
         spi1,
-        static_cast<int>(62.5 * MHz),
+        displaySpiHz,
         18, // CS
         17, // RESET
         16, // DC
@@ -151,57 +165,101 @@ int main()
         int T_IRQ = 5;
     } touchGpio;
 
+    // The size is known as soon as initialization starts, so the splash is ready the moment the display is.
     PicoPixel::Driver::Buffer buffer;
     PicoPixel::Driver::CreateBuffer(ili9341Data, &buffer);
 
-    // TODO: Proper splashscreen/logo
-    // display->Clear(display->RGBto16bit(0, 0, 0));
-    // const char* text = "PicoPixel";
-    // uint16_t textWidth = display->GetTextWidth(text);
-    // uint16_t centerX = (display->GetWidth() - textWidth) / 2;
-    // display->DrawText(text, centerX, display->GetHeight() / 2, display->RGBto16bit(255, 0, 0));
+    struct Splash
+    {
+        PicoPixel::Driver::Ili9341Data* Display;
+        PicoPixel::Driver::Buffer* Buffer;
+    } splash = { ili9341Data, &buffer };
 
-    // const char* text2 = "Loading...";
-    // textWidth = display->GetTextWidth(text2);
-    // centerX = (display->GetWidth() - textWidth) / 2;
-    // display->DrawText(text2, centerX, display->GetHeight() / 2 + display->GetFontHeight() + 4, display->RGBto16bit(255, 255, 255));
+    PicoPixel::Boot::InitScheduler boot;
+    boot.Add("Splash", [](void* context)
+    {
+        // Boot logo, blitted straight out of the asset pack in flash.
+        PicoPixel::Driver::Buffer* buffer = ((Splash*)context)->Buffer;
+        PicoPixel::Graphics::FillBuffer(buffer, PicoPixel::Utils::RGBto16bit(0, 0, 0));
+        PicoPixel::Assets::SpriteView logo;
+        if (PicoPixel::Assets::GetSprite(PicoPixel::Assets::AssetId("logo"), logo))
+            PicoPixel::Graphics::DrawSprite(buffer, (buffer->Width - logo.Width) / 2, (buffer->Height - logo.Height) / 2, logo);
+        PicoPixel::Assets::FontView font;
+        if (PicoPixel::Assets::GetFont(PicoPixel::Assets::AssetId("font"), font))
+        {
+            const char* text = "Loading...";
+            PicoPixel::Graphics::DrawText(buffer, (buffer->Width - PicoPixel::Graphics::GetTextWidth(text, font)) / 2,
+                (buffer->Height + logo.Height) / 2 + font.CellHeight, text, font, PicoPixel::Utils::RGBto16bit(255, 255, 255));
+        }
+        return true;
+    }, &splash);
+    boot.Add("Radio", [](void*)
+    {
+        // Required to access the onboard LED.
+        return cyw43_arch_init() == 0;
+    }, nullptr, true);
+    boot.Add("Entropy", [](void*)
+    {
+        PicoPixel::Utils::InitRand();
+        return true;
+    });
+    boot.Add("Input", [](void*)
+    {
+        PicoPixel::Input::Init();
+        return true;
+    });
+    boot.Add("Filesystem", [](void*)
+    {
+        return fs_init();
+    });
+    boot.Add("Asset cache", [](void*)
+    {
+        // Art that doesn't fit in flash streams from the filesystem; without a pack there, everything comes from flash.
+        PicoPixel::Assets::GetAssetCache().Open(ASSET_STREAM_PATH);
+        return true;
+    });
+    // Games register themselves at link time (REGISTER_GAME in each game's .cpp), so there is nothing to run for them.
 
-    for (int i = 0; i < buffer.Width * buffer.Height; i++)
-        buffer.Data[i] = PicoPixel::Utils::RGBto16bit(255, 0, 140);
-    PicoPixel::Driver::DrawBuffer(ili9341Data, 0, 0, &buffer);
+    bool booted = boot.Run("Display", displayReadyAt, [](void* context)
+    {
+        Splash* splash = (Splash*)context;
+        uint64_t readyAt = PicoPixel::Driver::ContinueInitializeIli9341(splash->Display);
+        if (!readyAt)
+        {
+            // Up as soon as the display is, even if other steps are still to come.
+            PicoPixel::Driver::DrawBuffer(splash->Display, 0, 0, splash->Buffer);
+            PicoPixel::Boot::Mark("First frame");
+        }
+        return readyAt;
+    }, &splash);
+    if (!booted)
+        return false;
 
 #ifdef STARTUP_DELAY_MS
     sleep_ms(STARTUP_DELAY_MS);
 #endif
 
-    // ------- Begin initialization -------
-
     LOG("System Clock Frequency is %d Hz\n", clock_get_hz(clk_sys));
     LOG("USB Clock Frequency is %d Hz\n", clock_get_hz(clk_usb));
+#ifdef CLOCK_GOVERNOR
+    // From here on clk_sys follows the load: lowest in the menu, raised as far as a game needs.
+    PicoPixel::ClockGovernor::Init(ili9341Data->SpiPort, displaySpiHz);
+#endif
 
     // TODO: Watchdog recovery stuff here
     // TODO: Silly progress bar or idle animation for loading
 
-    if (cyw43_arch_init())
-    {
-        LOG("cyw43_arch_init failed! (Required to access the onboard LED)\n");
-        return false;
-    }
-
-    PicoPixel::Utils::InitRand();
-
-    // ------- Begin Game Registration -------
-
-    REGISTER_GAME(ExampleGame);
-    REGISTER_GAME(PongGame);
-    REGISTER_GAME(PicoSpace);
-
-    // ------- End Game Registration -------
-
     //sleep_ms(1000);
 
     // ------- End of initialization -------
 
+    PicoPixel::Memory::Report();
+
+#ifdef RUN_BENCHMARKS
+    PicoPixel::Benchmarks::RunAll();
+    PicoPixel::Benchmarks::RunReplay(REPLAY_PATH, &buffer);
+#endif
+
     // TODO: Add a variable for this.
     if (false)
     {
@@ -213,11 +271,17 @@ int main()
         RunDiagnostics(ili9341Data, &buffer);
     }
 
+    PicoPixel::Boot::Mark("Menu");
+    PicoPixel::Boot::Report();
     PicoPixel::Menu::LaunchMenu(ili9341Data, &buffer);
 
+    // The last game's snapshot may still be on its way to flash.
+    PicoPixel::Snapshot::Flush();
+    PicoPixel::Assets::GetAssetCache().Close();
+
     PicoPixel::Driver::DestroyBuffer(&buffer);
     PicoPixel::Driver::DeinitializeIli9341(ili9341Data);
-    delete(ili9341Data);
+    PicoPixel::Memory::Delete(ili9341Data);
 
 
 
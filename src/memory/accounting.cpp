@@ -0,0 +1,224 @@
+#include "accounting.hpp"
+#include "arena.hpp"
+#include "log.hpp"
+
+#include "pico/stdlib.h"
+#include <cstdlib>
+#include <malloc.h>
+
+#if PICO_ON_DEVICE
+// Provided by the Pico SDK linker script. Static data ends at __bss_end__, the heap runs from there up to
+// __StackLimit, and each core's stack sits in its own 4 KB scratch bank (core0 in Y, core1 in X).
+extern "C" char __data_start__;
+extern "C" char __bss_end__;
+extern "C" char __StackLimit;
+extern "C" uint32_t __StackBottom;
+extern "C" uint32_t __StackTop;
+extern "C" uint32_t __StackOneBottom;
+extern "C" uint32_t __StackOneTop;
+
+// 256 KB of striped main RAM plus the two 4 KB scratch banks.
+#define MEMORY_TOTAL_RAM (264 * 1024)
+#endif
+
+namespace PicoPixel
+{
+    namespace Memory
+    {
+        static constexpr uint32_t STACK_PAINT = 0x5AC4CA7Eu;
+
+        static TagStats Tags[(size_t)Tag::Count] = {};
+
+        static const char* const TagNames[(size_t)Tag::Count] =
+        {
+            "Framebuffer",
+            "Driver",
+            "Game",
+            "Registry",
+            "Filesystem",
+            "Assets",
+            "Other",
+        };
+
+        // Keeps the payload 8-byte aligned, like malloc().
+        struct alignas(8) AllocationHeader
+        {
+            uint32_t Size;
+            Tag Owner;
+        };
+
+        const char* GetTagName(Tag tag)
+        {
+            return TagNames[(size_t)tag];
+        }
+
+        const TagStats& GetTagStats(Tag tag)
+        {
+            return Tags[(size_t)tag];
+        }
+
+        void TrackAllocation(Tag tag, size_t size)
+        {
+            TagStats& stats = Tags[(size_t)tag];
+            stats.CurrentBytes += size;
+            stats.Allocations++;
+            if (stats.CurrentBytes > stats.PeakBytes)
+                stats.PeakBytes = stats.CurrentBytes;
+        }
+
+        void TrackFree(Tag tag, size_t size, uint32_t allocations)
+        {
+            TagStats& stats = Tags[(size_t)tag];
+            stats.CurrentBytes -= size;
+            stats.Allocations -= allocations;
+        }
+
+        void* Allocate(Tag tag, size_t size)
+        {
+            AllocationHeader* header = (AllocationHeader*)malloc(sizeof(AllocationHeader) + size);
+            if (!header)
+            {
+                LOG_ERROR("Out of memory allocating %zu bytes for %s (%lu bytes of heap left)\n",
+                    size, GetTagName(tag), (unsigned long)GetHeapFree());
+                return nullptr;
+            }
+
+            header->Size = (uint32_t)size;
+            header->Owner = tag;
+            TrackAllocation(tag, size);
+            return header + 1;
+        }
+
+        void Free(void* memory)
+        {
+            if (!memory)
+                return;
+
+            AllocationHeader* header = (AllocationHeader*)memory - 1;
+            TrackFree(header->Owner, header->Size);
+            free(header);
+        }
+
+        // glibc deprecated mallinfo() in favour of mallinfo2(), which newlib doesn't have.
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        static struct mallinfo2 HeapInfo() { return mallinfo2(); }
+#else
+        static struct mallinfo HeapInfo() { return mallinfo(); }
+#endif
+
+        uint32_t GetHeapUsed()
+        {
+            return (uint32_t)HeapInfo().uordblks;
+        }
+
+        uint32_t GetHeapFree()
+        {
+            auto info = HeapInfo();
+#if PICO_ON_DEVICE
+            // newlib only knows about what it has already taken with sbrk(), so measure against the whole region.
+            uint32_t heapSize = (uint32_t)(&__StackLimit - &__bss_end__);
+            return heapSize > (uint32_t)info.uordblks ? heapSize - info.uordblks : 0;
+#else
+            return info.fordblks;
+#endif
+        }
+
+        // Painted bounds of each core's stack. The top is where the stack starts (it grows down).
+        static uint32_t* StackBottom[2] = {};
+        static uint32_t* StackTop[2] = {};
+
+        // Paint [bottom, end), top down so a host stack grows into it a page at a time. Volatile so the stores aren't
+        // treated as dead.
+        static void Paint(uint32_t* bottom, uint32_t* end)
+        {
+            for (volatile uint32_t* word = end; word > bottom; )
+                *--word = STACK_PAINT;
+        }
+
+        __attribute__((noinline)) void PaintStacks()
+        {
+            // Leave some room below this frame for Paint() itself.
+            uint32_t* frame = (uint32_t*)__builtin_frame_address(0) - 64;
+
+#if PICO_ON_DEVICE
+            StackBottom[0] = &__StackBottom;
+            StackTop[0] = &__StackTop;
+            StackBottom[1] = &__StackOneBottom;
+            StackTop[1] = &__StackOneTop;
+            Paint(StackBottom[0], frame);
+            Paint(StackBottom[1], StackTop[1]);
+#else
+            // Only the main thread's stack; the host has no second core to measure.
+            StackTop[0] = (uint32_t*)__builtin_frame_address(0);
+            StackBottom[0] = frame - MEMORY_HOST_STACK_PAINT_BYTES / sizeof(uint32_t);
+            Paint(StackBottom[0], frame);
+#endif
+        }
+
+        uint32_t GetStackHighWater(uint8_t core)
+        {
+            if (core > 1 || !StackBottom[core])
+                return 0;
+
+            const volatile uint32_t* word = StackBottom[core];
+            while (word < StackTop[core] && *word == STACK_PAINT)
+                word++;
+            return (uint32_t)((const uint8_t*)StackTop[core] - (const uint8_t*)word);
+        }
+
+        uint32_t GetStackSize(uint8_t core)
+        {
+            if (core > 1 || !StackBottom[core])
+                return 0;
+            return (uint32_t)((const uint8_t*)StackTop[core] - (const uint8_t*)StackBottom[core]);
+        }
+
+        void Report()
+        {
+            uint32_t heapUsed = GetHeapUsed();
+            uint32_t heapFree = GetHeapFree();
+
+            LOG("Memory: %-11s %8s %8s %6s\n", "Tag", "Current", "Peak", "Count");
+            for (size_t i = 0; i < (size_t)Tag::Count; i++)
+            {
+                const TagStats& stats = Tags[i];
+                LOG("Memory: %-11s %8lu %8lu %6lu\n", TagNames[i],
+                    (unsigned long)stats.CurrentBytes, (unsigned long)stats.PeakBytes, (unsigned long)stats.Allocations);
+            }
+
+            const Arena& gameArena = GetGameArena();
+            LOG("Memory: game arena %zu / %zu bytes, high water %zu\n",
+                gameArena.GetUsed(), gameArena.GetCapacity(), gameArena.GetHighWater());
+            LOG("Memory: heap %lu used, %lu free\n", (unsigned long)heapUsed, (unsigned long)heapFree);
+            for (uint8_t core = 0; core < 2; core++)
+            {
+                if (GetStackSize(core))
+                    LOG("Memory: core%d stack high water %lu / %lu bytes\n", core,
+                        (unsigned long)GetStackHighWater(core), (unsigned long)GetStackSize(core));
+            }
+
+#if PICO_ON_DEVICE
+            // Everything except free heap and untouched stack is spoken for.
+            uint32_t staticBytes = (uint32_t)(&__bss_end__ - &__data_start__);
+            uint32_t unusedStack = (GetStackSize(0) - GetStackHighWater(0)) + (GetStackSize(1) - GetStackHighWater(1));
+            uint32_t used = MEMORY_TOTAL_RAM - heapFree - unusedStack;
+            LOG("Memory: static %lu bytes, %lu / %lu bytes of RAM used (%lu%%), %lu bytes headroom\n",
+                (unsigned long)staticBytes, (unsigned long)used, (unsigned long)MEMORY_TOTAL_RAM,
+                (unsigned long)(used * 100 / MEMORY_TOTAL_RAM), (unsigned long)(MEMORY_TOTAL_RAM - used));
+#endif
+        }
+
+        void Update()
+        {
+#if MEMORY_REPORT_INTERVAL_MS > 0
+            static uint32_t lastReportUs = 0;
+            uint32_t now = time_us_32();
+            if (now - lastReportUs >= MEMORY_REPORT_INTERVAL_MS * 1000u)
+            {
+                lastReportUs = now;
+                Report();
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// How often Update() prints Report() over serial, in milliseconds. 0 reports only on demand.
+#ifndef MEMORY_REPORT_INTERVAL_MS
+    #define MEMORY_REPORT_INTERVAL_MS 0
+#endif
+
+// Host builds have no linker-defined stacks, so this much of the main thread's stack below PaintStacks() is painted.
+#ifndef MEMORY_HOST_STACK_PAINT_BYTES
+    #define MEMORY_HOST_STACK_PAINT_BYTES (64 * 1024)
+#endif
+
+namespace PicoPixel
+{
+    // Who owns what. Allocations made through here are counted against a tag; memory owned elsewhere (static regions,
+    // arenas, library heap use) is reported with TrackAllocation()/TrackFree(). Report() puts the tags next to static
+    // RAM, the heap and both stacks so we can see how close we are to the RP2040's 264 KB.
+    // Only core0 allocates, so the counters are not locked.
+    namespace Memory
+    {
+        enum class Tag : uint8_t
+        {
+            Framebuffer,
+            Driver,
+            Game,
+            Registry,
+            Filesystem,
+            Assets,
+            Other,
+            Count,
+        };
+
+        struct TagStats
+        {
+            uint32_t CurrentBytes;
+            uint32_t PeakBytes;
+            uint32_t Allocations;   // Live allocations.
+        };
+
+        const char* GetTagName(Tag tag);
+        const TagStats& GetTagStats(Tag tag);
+
+        // malloc()/free() with the size and tag kept in a small header. Allocate() logs and returns nullptr on failure.
+        void* Allocate(Tag tag, size_t size);
+        void Free(void* memory);
+
+        template<typename T, typename... Args>
+        T* New(Tag tag, Args&&... args)
+        {
+            void* memory = Allocate(tag, sizeof(T));
+            return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+        }
+
+        template<typename T>
+        void Delete(T* object)
+        {
+            if (!object)
+                return;
+            object->~T();
+            Free(object);
+        }
+
+        // Count memory that wasn't allocated through Allocate() against a tag. TrackFree() can release several
+        // allocations at once, e.g. when an arena is reset.
+        void TrackAllocation(Tag tag, size_t size);
+        void TrackFree(Tag tag, size_t size, uint32_t allocations = 1);
+
+        // Heap bytes in use and left, according to newlib (glibc on the host). mallinfo() walks the free lists,
+        // so don't call these every frame.
+        uint32_t GetHeapUsed();
+        uint32_t GetHeapFree();
+
+        // Fill the unused part of both stacks with a pattern so GetStackHighWater() can find the deepest use.
+        // Call first thing in main(), before core1 is launched.
+        void PaintStacks();
+
+        // Most stack the core has used since PaintStacks(), and its size, in bytes.
+        uint32_t GetStackHighWater(uint8_t core);
+        uint32_t GetStackSize(uint8_t core);
+
+        // Print tags, static RAM, heap and stack usage over serial.
+        void Report();
+
+        // Call once per frame; prints Report() every MEMORY_REPORT_INTERVAL_MS.
+        void Update();
+    }
+}
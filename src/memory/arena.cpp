@@ -0,0 +1,69 @@
+#include "arena.hpp"
+#include "log.hpp"
+
+#include <cstdlib>
+
+namespace PicoPixel
+{
+    namespace Memory
+    {
+        Arena::Arena(const char* name, Tag owner, void* base, size_t capacity)
+         : Name(name), Owner(owner), Base(static_cast<uint8_t*>(base)), Capacity(capacity)
+        {
+        }
+
+        void* Arena::Allocate(size_t size, size_t alignment)
+        {
+            // Align the address rather than the offset, so the base itself doesn't need to be maximally aligned.
+            uintptr_t address = (uintptr_t)(Base + Used);
+            size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+            if (size > Capacity - Used || padding > Capacity - Used - size)
+            {
+                LOG_ERROR("Arena %s: out of memory allocating %zu bytes (%zu of %zu used)\n", Name, size, Used, Capacity);
+                return nullptr;
+            }
+
+            void* memory = Base + Used + padding;
+            Used += padding + size;
+            Allocations++;
+            TrackAllocation(Owner, padding + size);
+            if (Used > SessionPeak)
+                SessionPeak = Used;
+            if (Used > HighWater)
+                HighWater = Used;
+            return memory;
+        }
+
+        void Arena::Reset()
+        {
+            TrackFree(Owner, Used, Allocations);
+            Used = 0;
+            Allocations = 0;
+            SessionPeak = 0;
+        }
+
+        void Arena::Report() const
+        {
+            LOG("Arena %s: %zu / %zu bytes used, peak %zu this session\n", Name, Used, Capacity, SessionPeak);
+            LOG("Arena %s: High water %zu bytes (%zu%%)\n", Name, HighWater, HighWater * 100 / Capacity);
+        }
+
+        void* Arena::do_allocate(size_t bytes, size_t alignment)
+        {
+            // Builds have no exceptions to throw std::bad_alloc with, and pmr containers can't handle nullptr.
+            void* memory = Allocate(bytes, alignment);
+            if (!memory)
+                abort();
+            return memory;
+        }
+
+        // Statically allocated, so it is carved out of RAM before main() and never competes with the heap.
+        alignas(8) static uint8_t GameArenaStorage[GAME_ARENA_SIZE];
+
+        Arena& GetGameArena()
+        {
+            static Arena gameArena("Game", Tag::Game, GameArenaStorage, sizeof(GameArenaStorage));
+            return gameArena;
+        }
+    }
+}
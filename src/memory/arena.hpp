@@ -0,0 +1,140 @@
+#pragma once
+
+#include "accounting.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+// Size of the game arena. Everything a game allocates while it runs (the game object included) must fit in here.
+#ifndef GAME_ARENA_SIZE
+    #define GAME_ARENA_SIZE (40 * 1024)
+#endif
+
+namespace PicoPixel
+{
+    namespace Memory
+    {
+        // Bump allocator over a fixed region. Allocation is a pointer bump and memory is only given back all at once
+        // with Reset(), so it can't fragment. Destructors are never run by the arena: objects that need one must be
+        // destroyed by hand before Reset(). Not thread safe; only allocate from core0.
+        //
+        // Also a std::pmr::memory_resource, so pmr containers can use it directly:
+        //     std::pmr::vector<Enemy> enemies(&Memory::GetGameArena());
+        // Deallocating through the resource is a no-op. Allocations are counted against the arena's accounting tag.
+        class Arena : public std::pmr::memory_resource
+        {
+        public:
+            Arena(const char* name, Tag owner, void* base, size_t capacity);
+
+            // Returns nullptr (and logs) when the arena is full.
+            void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+            template<typename T, typename... Args>
+            T* New(Args&&... args)
+            {
+                void* memory = Allocate(sizeof(T), alignof(T));
+                return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+            }
+
+            // Value-initialized, so arrays of numbers start out zeroed.
+            template<typename T>
+            T* NewArray(size_t count)
+            {
+                void* memory = Allocate(sizeof(T) * count, alignof(T));
+                return memory ? new (memory) T[count]() : nullptr;
+            }
+
+            // Frees everything at once.
+            void Reset();
+
+            size_t GetUsed() const { return Used; }
+            size_t GetCapacity() const { return Capacity; }
+
+            // Most ever used since boot, and since the last Reset().
+            size_t GetHighWater() const { return HighWater; }
+            size_t GetSessionPeak() const { return SessionPeak; }
+
+            // Log usage and high-water marks.
+            void Report() const;
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void*, size_t, size_t) override {}
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        private:
+            const char* Name;
+            Tag Owner;
+            uint8_t* Base;
+            size_t Capacity;
+            size_t Used = 0;
+            uint32_t Allocations = 0;
+            size_t SessionPeak = 0;
+            size_t HighWater = 0;
+        };
+
+        // Fixed-size blocks of T carved out of an arena, with O(1) New()/Delete() through an intrusive free list.
+        // For objects that come and go during a session (particles, projectiles) without bumping the arena each time.
+        // The blocks belong to the arena, so a pool must not be used after its arena is Reset().
+        template<typename T>
+        class Pool
+        {
+        public:
+            // Returns false if the arena couldn't hold count blocks.
+            bool Init(Arena& arena, size_t count)
+            {
+                Slot* slots = static_cast<Slot*>(arena.Allocate(sizeof(Slot) * count, alignof(Slot)));
+                FreeList = nullptr;
+                FreeCount = 0;
+                Count = slots ? count : 0;
+                for (size_t i = Count; i > 0; i--)
+                {
+                    slots[i - 1].Next = FreeList;
+                    FreeList = &slots[i - 1];
+                }
+                FreeCount = Count;
+                return slots != nullptr;
+            }
+
+            // Returns nullptr when every block is in use.
+            template<typename... Args>
+            T* New(Args&&... args)
+            {
+                Slot* slot = FreeList;
+                if (!slot)
+                    return nullptr;
+                FreeList = slot->Next;
+                FreeCount--;
+                return new (slot->Storage) T(std::forward<Args>(args)...);
+            }
+
+            void Delete(T* object)
+            {
+                object->~T();
+                Slot* slot = reinterpret_cast<Slot*>(object);
+                slot->Next = FreeList;
+                FreeList = slot;
+                FreeCount++;
+            }
+
+            size_t GetCount() const { return Count; }
+            size_t GetFreeCount() const { return FreeCount; }
+
+        private:
+            union Slot
+            {
+                Slot* Next;
+                alignas(T) unsigned char Storage[sizeof(T)];
+            };
+
+            Slot* FreeList = nullptr;
+            size_t FreeCount = 0;
+            size_t Count = 0;
+        };
+
+        // The arena games allocate from. Reset by the menu when a game exits, after the game object is destroyed.
+        Arena& GetGameArena();
+    }
+}
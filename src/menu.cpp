@@ -1,7 +1,26 @@
 #include "menu.hpp"
+#include "clockGovernor.hpp"
 #include "log.hpp"
+#include "profiler.hpp"
+#include "replay.hpp"
+#include "renderPipeline.hpp"
+#include "snapshot.hpp"
+#include "input/input.hpp"
+#include "assets/assetCache.hpp"
+#include "memory/accounting.hpp"
+#include "memory/arena.hpp"
+#include "graphics/perfOverlay.hpp"
 #include "games/gameRegistry.hpp"
 #include "games/game.hpp"
+#include "games/gameLoop.hpp"
+
+// Deferred log records printed after each game frame.
+#define LOG_DRAIN_PER_FRAME 8
+
+// How long the game list stays up before the auto-selected game starts, unless it has a snapshot to resume.
+#ifndef MENU_AUTO_SELECT_DELAY_MS
+    #define MENU_AUTO_SELECT_DELAY_MS 3000
+#endif
 
 namespace PicoPixel
 {
@@ -11,58 +30,244 @@ namespace PicoPixel
         TODO:
           - Clean this code file up
           - Visible menu with navigate-able list of games
-          - Input for menu (either temp input over serial connection messages, or physical GPIO keys)
-          - Either a dedicated button for menu to stop game, or dedicated quit button for game to implement a close dialogue..?
           - Power on/off menu button that would turn off the display and wait to wake up
         */
 
+        // Start streaming a game's assets in, so it doesn't stall on them when it starts.
+        static void PrefetchAssets(const PicoPixel::Games::GameDescriptor* game)
+        {
+            PicoPixel::Assets::AssetCache& assetCache = PicoPixel::Assets::GetAssetCache();
+            for (const uint32_t* asset = game->Assets; asset && *asset; asset++)
+                assetCache.Prefetch(*asset);
+        }
+
         void LaunchMenu(PicoPixel::Driver::Ili9341Data* ili9341Data, PicoPixel::Driver::Buffer* buffer)
         {
-            auto& factories = PicoPixel::Games::GameRegistry::GetFactories();
-            LOG("Registered games: %zu\n", factories.size());
-            int selected = 0;
+            using PicoPixel::Games::GameRegistry;
+            LOG("Registered games: %zu\n", GameRegistry::Count());
+            const PicoPixel::Games::GameDescriptor* selectedGame = nullptr;
             bool exitMenu = false;
             bool exitGame = false;
             enum class MenuState { Menu, Game };
             MenuState state = MenuState::Menu;
             PicoPixel::Games::Game* currentGame = nullptr;
+            // The last game that didn't fit in the game arena. Once one hasn't, the menu stops starting games by itself,
+            // or it would retry the same one forever without input.
+            const PicoPixel::Games::GameDescriptor* failedGame = nullptr;
 
             while (!exitMenu)
             {
                 switch (state)
                 {
                 case MenuState::Menu:
-                    for (size_t i = 0; i < factories.size(); i++)
+                    // Straight from the descriptors in flash: no games are created and nothing is allocated.
+                    for (size_t i = 0; i < GameRegistry::Count(); i++)
                     {
-                        PicoPixel::Games::Game* temp = factories[i](buffer);
-                        LOG("%s - %s\n", temp->GetName().c_str(), temp->GetDescription().c_str());
-                        delete temp;
+                        const PicoPixel::Games::GameDescriptor& game = GameRegistry::Get(i);
+                        LOG("%s - %s (%lu KB)\n", game.Name, game.Description, (unsigned long)(game.MemoryBudget / 1024));
                     }
-                    // FIXME: TEMP! Need to be able to select options.
+                    PicoPixel::Log::Drain(LOG_DEFERRED_CAPACITY);
+                    // FIXME: TEMP! Nothing is drawn yet: Up/Down (or w/s over serial) step through the list above, A (or
+                    // Enter) starts the selection, and it starts by itself after MENU_AUTO_SELECT_DELAY_MS without input
+                    // (until a game has failed to start).
                     {
-                        sleep_ms(3000);
-                        LOG("Auto-selecting option 3\n");
-                        currentGame = factories[2](buffer);
+                        if (GameRegistry::Count() == 0)
+                            break;
+                        size_t selected = 0;
+                        const PicoPixel::Games::GameDescriptor* preferred = GameRegistry::Find("PicoSpace");
+                        while (preferred && &GameRegistry::Get(selected) != preferred)
+                            selected++;
+                        if (&GameRegistry::Get(selected) == failedGame)
+                            selected = (selected + 1) % GameRegistry::Count();
+                        selectedGame = &GameRegistry::Get(selected);
+                        PrefetchAssets(selectedGame);
+
+                        // A game with a snapshot goes straight back in. Either way, keep writing the last session's
+                        // snapshot out and the assets in while waiting.
+#ifdef CLOCK_GOVERNOR
+                        // Nothing to draw while waiting, so idle at the lowest clock.
+                        PicoPixel::ClockGovernor::SetIdle();
+#endif
+                        uint64_t deadline = failedGame ? UINT64_MAX
+                            : time_us_64() + (PicoPixel::Snapshot::Exists(selectedGame->Name) ? 0 : MENU_AUTO_SELECT_DELAY_MS * 1000ull);
+                        bool start = false;
+                        while (!start && time_us_64() < deadline)
+                        {
+                            PicoPixel::Snapshot::Service();
+                            PicoPixel::Assets::GetAssetCache().Service();
+
+                            PicoPixel::Input::Poll();
+                            PicoPixel::Input::Event event;
+                            while (PicoPixel::Input::Pop(event))
+                            {
+                                bool isKey = event.Type == PicoPixel::Input::EventType::Key;
+                                int step = 0;
+                                if (event.IsPressed(PicoPixel::Input::Button::Up) || (isKey && event.Code == 'w'))
+                                    step = -1;
+                                else if (event.IsPressed(PicoPixel::Input::Button::Down) || (isKey && event.Code == 's'))
+                                    step = 1;
+                                else if (event.IsPressed(PicoPixel::Input::Button::A) || (isKey && (event.Code == '\r' || event.Code == '\n')))
+                                    start = true;
+                                if (step)
+                                {
+                                    selected = (selected + GameRegistry::Count() + step) % GameRegistry::Count();
+                                    selectedGame = &GameRegistry::Get(selected);
+                                    PrefetchAssets(selectedGame);
+                                    LOG("> %s\n", selectedGame->Name);
+                                    if (!failedGame)
+                                        deadline = time_us_64() + MENU_AUTO_SELECT_DELAY_MS * 1000ull;
+                                }
+                            }
+                            sleep_ms(10);
+                        }
+
+                        LOG("%s %s\n", start ? "Starting" : "Auto-selecting", selectedGame->Name);
+                        if (selectedGame->MemoryBudget > PicoPixel::Memory::GetGameArena().GetCapacity())
+                            LOG_WARN("%s needs %lu bytes but the game arena only has %zu\n", selectedGame->Name,
+                                (unsigned long)selectedGame->MemoryBudget, PicoPixel::Memory::GetGameArena().GetCapacity());
+                        currentGame = selectedGame->Create(buffer);
+                        if (!currentGame)
+                        {
+                            // Back to the list: another game may well fit.
+                            LOG_ERROR("%s doesn't fit in the game arena, pick another\n", selectedGame->Name);
+                            PicoPixel::Memory::GetGameArena().Reset();
+                            failedGame = selectedGame;
+                            break;
+                        }
                         state = MenuState::Game;
                     }
                     break;
 
                 case MenuState::Game:
                     exitGame = false;
+#ifdef REPLAY_RECORD
+                    PicoPixel::Replay::StartRecording(REPLAY_PATH, selectedGame->Name);
+#endif
                     currentGame->OnInit();
+                    // Recordings start from the recorded seed, so they never resume.
+                    if (PicoPixel::Replay::GetMode() == PicoPixel::Replay::Mode::Off
+                        && PicoPixel::Snapshot::Restore(currentGame, selectedGame->Name) == PicoPixel::Snapshot::RestoreResult::Failed)
+                    {
+                        // Half-loaded: throw the game away and start it over. It is shut down like any other, so
+                        // whatever OnInit() took hold of is given back.
+                        currentGame->OnShutdown();
+                        currentGame->~Game();
+                        PicoPixel::Memory::GetGameArena().Reset();
+                        currentGame = selectedGame->Create(buffer);
+                        if (!currentGame)
+                        {
+                            LOG_ERROR("%s doesn't fit in the game arena, pick another\n", selectedGame->Name);
+                            PicoPixel::Replay::Stop();
+                            PicoPixel::Memory::GetGameArena().Reset();
+                            failedGame = selectedGame;
+                            state = MenuState::Menu;
+                            break;
+                        }
+                        currentGame->OnInit();
+                    }
+#ifdef CLOCK_GOVERNOR
+                    PicoPixel::ClockGovernor::StartGame();
+#endif
+                    PicoPixel::Games::GameLoop loop(currentGame);
+                    PicoPixel::RenderPipeline::Start(&loop, ili9341Data, buffer);
+                    // Presses that were meant for the menu.
+                    PicoPixel::Input::Clear();
                     uint64_t lastTime = time_us_64();
                     while (!exitGame)
                     {
+                        PROFILE_BEGIN_FRAME();
                         uint64_t now = time_us_64();
-                        float dt = (now - lastTime) / 1e6f;
+                        float dt = PicoPixel::Replay::FrameDelta((now - lastTime) / 1e6f);
+#ifdef PERF_OVERLAY
+                        PicoPixel::Graphics::PerfOverlay::RecordFrame((uint32_t)(now - lastTime), PicoPixel::RenderPipeline::GetLastPresentUs());
+#endif
+
+                        // Input, oldest first. The menu takes what it needs and the game sees everything. Serial keys:
+                        // 'p' toggles the overlay, 'm' prints a memory report, 'f' dumps the profiler, 'q' (or Menu)
+                        // leaves the game, saving it for next time. The frame is tagged with the newest input it consumed.
+                        PicoPixel::Input::Poll();
+                        PicoPixel::Input::Event event;
+                        uint64_t inputUs = 0;
+                        bool quit = false;
+#ifdef PROFILING
+                        bool dumpProfile = false;
+#endif
+                        while (PicoPixel::Input::Pop(event))
+                        {
+                            inputUs = event.TimeUs > inputUs ? event.TimeUs : inputUs;
+                            if (event.Type == PicoPixel::Input::EventType::Key)
+                            {
+#ifdef PERF_OVERLAY
+                                if (event.Code == 'p')
+                                    PicoPixel::Graphics::PerfOverlay::Toggle();
+#endif
+                                if (event.Code == 'm')
+                                    PicoPixel::Memory::Report();
+#ifdef PROFILING
+                                dumpProfile |= event.Code == 'f';
+#endif
+                                quit |= event.Code == 'q';
+                            }
+                            quit |= event.IsPressed(PicoPixel::Input::Button::Menu);
+                            PicoPixel::Replay::RecordEvent(event);
+                            currentGame->OnInput(event);
+                        }
+                        PicoPixel::Memory::Update();
+                        PicoPixel::Snapshot::Service();
+                        PicoPixel::Assets::GetAssetCache().Service();
                         lastTime = now;
-                        exitGame = currentGame->OnUpdate(dt);
-                        currentGame->OnRender();
-                        PicoPixel::Driver::DrawBuffer(ili9341Data, 0, 0, buffer);
+                        {
+                            PROFILE_ZONE("Update");
+                            exitGame = loop.Update(dt) || quit;
+                        }
+                        // Render and present, inline or on core1 (PIPELINED_RENDER) while the next frame is simulated.
+                        PicoPixel::RenderPipeline::Submit(inputUs);
+
+                        // Deferred logs are printed here, after the frame is out, and only a few per frame.
+                        PicoPixel::Log::Drain(LOG_DRAIN_PER_FRAME);
+                        PROFILE_END_FRAME();
+
+#ifdef CLOCK_GOVERNOR
+                        // Everything up to here is the frame's work; the rest is headroom. Clocks only change with the
+                        // display idle, since SPI is re-divided for the new clk_peri.
+                        if (PicoPixel::ClockGovernor::Update((uint32_t)(time_us_64() - now), PicoPixel::RenderPipeline::GetLastPresentUs()))
+                        {
+                            PicoPixel::RenderPipeline::Flush();
+                            PicoPixel::ClockGovernor::Apply();
+                        }
+#endif
+
+#ifdef PROFILING
+                        // After the frame has been timed, and kept out of the next frame's dt.
+                        if (dumpProfile)
+                        {
+                            uint64_t dumpStartUs = time_us_64();
+                            PicoPixel::Profiler::Dump();
+                            lastTime += time_us_64() - dumpStartUs;
+                        }
+#endif
+
+                        // Idle in low power until the next frame is due instead of spinning.
+                        loop.WaitForNextFrame();
                     }
+                    PicoPixel::RenderPipeline::Stop();
+                    PicoPixel::Snapshot::Save(currentGame, selectedGame->Name);
                     currentGame->OnShutdown();
-                    delete currentGame;
+                    PicoPixel::Replay::Stop();
+                    // The game and everything it allocated live in the game arena, so one reset frees the whole session.
+                    currentGame->~Game();
                     currentGame = nullptr;
+                    PicoPixel::Memory::GetGameArena().Report();
+                    PicoPixel::Memory::GetGameArena().Reset();
+                    PicoPixel::Memory::Report();
+                    PicoPixel::Assets::GetAssetCache().Report();
+                    PicoPixel::Input::Report();
+#ifdef CLOCK_GOVERNOR
+                    PicoPixel::ClockGovernor::Report();
+#endif
+#ifdef PROFILING
+                    PicoPixel::Profiler::Dump();
+#endif
                     state = MenuState::Menu;
                     break;
                 }
@@ -0,0 +1,305 @@
+#include "collisionGrid.hpp"
+#include "log.hpp"
+
+#include <cmath>
+
+namespace PicoPixel
+{
+    namespace Physics
+    {
+        bool CollisionGrid::Init(Memory::Arena& arena, uint16_t maxBodies, float width, float height, float cellSize, uint32_t entryCapacity)
+        {
+            if (entryCapacity == 0)
+                entryCapacity = maxBodies * 4u;
+            if (entryCapacity >= END)
+                entryCapacity = END - 1;
+
+            CellSize = cellSize;
+            InverseCellSize = 1.0f / cellSize;
+            Columns = (uint16_t)std::max(1.0f, ceilf(width * InverseCellSize));
+            Rows = (uint16_t)std::max(1.0f, ceilf(height * InverseCellSize));
+            CellCount = (uint32_t)Columns * Rows;
+
+            Bounds = arena.NewArray<Aabb>(maxBodies);
+            Radii = arena.NewArray<float>(maxBodies);
+            UserData = arena.NewArray<uint32_t>(maxBodies);
+            Categories = arena.NewArray<uint16_t>(maxBodies);
+            Masks = arena.NewArray<uint16_t>(maxBodies);
+            Types = arena.NewArray<ShapeType>(maxBodies);
+            CellRanges = arena.NewArray<uint16_t>(maxBodies * 4u);
+            Stamps = arena.NewArray<uint16_t>(maxBodies);
+            FreeBodies = arena.NewArray<uint16_t>(maxBodies);
+            Active = arena.NewArray<bool>(maxBodies);
+            CellHeads = arena.NewArray<uint16_t>(CellCount);
+            Entries = arena.NewArray<Entry>(entryCapacity);
+            MaxBodies = 0;
+            if (!Bounds || !Radii || !UserData || !Categories || !Masks || !Types || !CellRanges || !Stamps || !FreeBodies
+                || !Active || !CellHeads || !Entries)
+                return false;
+
+            for (uint32_t cell = 0; cell < CellCount; cell++)
+                CellHeads[cell] = END;
+            for (uint32_t i = 0; i < entryCapacity; i++)
+                Entries[i].Next = i + 1 < entryCapacity ? (uint16_t)(i + 1) : END;
+            FreeEntry = 0;
+
+            // Hand out low ids first.
+            for (uint16_t i = 0; i < maxBodies; i++)
+                FreeBodies[i] = maxBodies - 1 - i;
+            FreeBodyCount = maxBodies;
+            BodyCount = 0;
+            MaxBodies = maxBodies;
+            return true;
+        }
+
+        BodyId CollisionGrid::AddBox(const Aabb& box, uint32_t userData, uint16_t category, uint16_t mask)
+        {
+            return Add(ShapeType::Box, box, 0.0f, userData, category, mask);
+        }
+
+        BodyId CollisionGrid::AddCircle(const Circle& circle, uint32_t userData, uint16_t category, uint16_t mask)
+        {
+            return Add(ShapeType::Circle, circle.GetBounds(), circle.Radius, userData, category, mask);
+        }
+
+        BodyId CollisionGrid::Add(ShapeType type, const Aabb& bounds, float radius, uint32_t userData, uint16_t category, uint16_t mask)
+        {
+            if (FreeBodyCount == 0)
+                return INVALID_BODY;
+
+            BodyId body = FreeBodies[--FreeBodyCount];
+            Types[body] = type;
+            Bounds[body] = bounds;
+            Radii[body] = radius;
+            UserData[body] = userData;
+            Categories[body] = category;
+            Masks[body] = mask;
+            Stamps[body] = Stamp;
+            Active[body] = true;
+            CellRange(bounds, CellRanges[body * 4 + 0], CellRanges[body * 4 + 1], CellRanges[body * 4 + 2], CellRanges[body * 4 + 3]);
+            Link(body);
+            BodyCount++;
+            return body;
+        }
+
+        void CollisionGrid::Remove(BodyId body)
+        {
+            if (body >= MaxBodies || !Active[body])
+                return;
+
+            Unlink(body);
+            Active[body] = false;
+            FreeBodies[FreeBodyCount++] = body;
+            BodyCount--;
+        }
+
+        void CollisionGrid::MoveBox(BodyId body, const Aabb& box)
+        {
+            Move(body, box, 0.0f);
+        }
+
+        void CollisionGrid::MoveCircle(BodyId body, const Circle& circle)
+        {
+            Move(body, circle.GetBounds(), circle.Radius);
+        }
+
+        void CollisionGrid::Move(BodyId body, const Aabb& bounds, float radius)
+        {
+            Bounds[body] = bounds;
+            Radii[body] = radius;
+
+            // Only relink when the body crosses into a different set of cells.
+            uint16_t x0, y0, x1, y1;
+            CellRange(bounds, x0, y0, x1, y1);
+            uint16_t* range = &CellRanges[body * 4];
+            if (range[0] == x0 && range[1] == y0 && range[2] == x1 && range[3] == y1)
+                return;
+
+            Unlink(body);
+            range[0] = x0;
+            range[1] = y0;
+            range[2] = x1;
+            range[3] = y1;
+            Link(body);
+        }
+
+        void CollisionGrid::Link(BodyId body)
+        {
+            const uint16_t* range = &CellRanges[body * 4];
+            for (uint16_t y = range[1]; y <= range[3]; y++)
+            {
+                for (uint16_t x = range[0]; x <= range[2]; x++)
+                {
+                    if (FreeEntry == END)
+                    {
+                        LOG_WARN("CollisionGrid: Out of cell entries, body %u is missing from cell %u,%u\n", body, x, y);
+                        continue;
+                    }
+
+                    uint16_t entry = FreeEntry;
+                    FreeEntry = Entries[entry].Next;
+                    uint16_t& head = CellHeads[y * Columns + x];
+                    Entries[entry] = { body, head };
+                    head = entry;
+                }
+            }
+        }
+
+        void CollisionGrid::Unlink(BodyId body)
+        {
+            const uint16_t* range = &CellRanges[body * 4];
+            for (uint16_t y = range[1]; y <= range[3]; y++)
+            {
+                for (uint16_t x = range[0]; x <= range[2]; x++)
+                {
+                    // Cells hold a handful of bodies, so a linear walk is cheaper than keeping back links.
+                    for (uint16_t* link = &CellHeads[y * Columns + x]; *link != END; link = &Entries[*link].Next)
+                    {
+                        if (Entries[*link].Body != body)
+                            continue;
+
+                        uint16_t entry = *link;
+                        *link = Entries[entry].Next;
+                        Entries[entry].Next = FreeEntry;
+                        FreeEntry = entry;
+                        break;
+                    }
+                }
+            }
+        }
+
+        static uint16_t ToCell(float coordinate, float inverseCellSize, uint16_t count)
+        {
+            float cell = floorf(coordinate * inverseCellSize);
+            if (cell < 0.0f)
+                return 0;
+            if (cell >= count)
+                return count - 1;
+            return (uint16_t)cell;
+        }
+
+        void CollisionGrid::CellRange(const Aabb& bounds, uint16_t& x0, uint16_t& y0, uint16_t& x1, uint16_t& y1) const
+        {
+            x0 = ToCell(bounds.MinX, InverseCellSize, Columns);
+            y0 = ToCell(bounds.MinY, InverseCellSize, Rows);
+            x1 = ToCell(bounds.MaxX, InverseCellSize, Columns);
+            y1 = ToCell(bounds.MaxY, InverseCellSize, Rows);
+        }
+
+        uint32_t CollisionGrid::OwnerCell(BodyId a, BodyId b) const
+        {
+            // The overlap's top-left corner lies inside both bounds, so both bodies are linked into its cell.
+            uint16_t x = ToCell(std::max(Bounds[a].MinX, Bounds[b].MinX), InverseCellSize, Columns);
+            uint16_t y = ToCell(std::max(Bounds[a].MinY, Bounds[b].MinY), InverseCellSize, Rows);
+            return (uint32_t)y * Columns + x;
+        }
+
+        bool CollisionGrid::TestPair(BodyId a, BodyId b) const
+        {
+            bool circleA = Types[a] == ShapeType::Circle;
+            bool circleB = Types[b] == ShapeType::Circle;
+            if (circleA && circleB)
+                return Overlaps(GetCircle(a), GetCircle(b));
+            if (circleA)
+                return Overlaps(Bounds[b], GetCircle(a));
+            if (circleB)
+                return Overlaps(Bounds[a], GetCircle(b));
+            return Overlaps(Bounds[a], Bounds[b]);
+        }
+
+        bool CollisionGrid::OverlapsShape(BodyId body, const Aabb& box) const
+        {
+            if (Types[body] == ShapeType::Circle)
+                return Overlaps(box, GetCircle(body));
+            return Overlaps(box, Bounds[body]);
+        }
+
+        bool CollisionGrid::IntersectBody(BodyId body, float x0, float y0, float dx, float dy, float& fraction) const
+        {
+            if (Types[body] == ShapeType::Circle)
+                return IntersectSegment(GetCircle(body), x0, y0, dx, dy, fraction);
+            return IntersectSegment(Bounds[body], x0, y0, dx, dy, fraction);
+        }
+
+        uint16_t CollisionGrid::NextStamp()
+        {
+            // On wrap-around, clear every stamp so an old one can't match the new query by accident.
+            if (++Stamp == 0)
+            {
+                for (uint16_t i = 0; i < MaxBodies; i++)
+                    Stamps[i] = 0;
+                Stamp = 1;
+            }
+            return Stamp;
+        }
+
+        bool CollisionGrid::Raycast(float x0, float y0, float x1, float y1, RayHit& hit, uint16_t mask)
+        {
+            float dx = x1 - x0;
+            float dy = y1 - y0;
+            uint16_t stamp = NextStamp();
+
+            // Walk the cells along the segment (Amanatides & Woo). Bodies outside the area are linked into the edge
+            // cells, so those cells reach out to infinity and the walk never leaves the grid.
+            int32_t cellX = ToCell(x0, InverseCellSize, Columns);
+            int32_t cellY = ToCell(y0, InverseCellSize, Rows);
+            int32_t stepX = dx > 0.0f ? 1 : -1;
+            int32_t stepY = dy > 0.0f ? 1 : -1;
+            float deltaX = dx != 0.0f ? CellSize / fabsf(dx) : INFINITY;
+            float deltaY = dy != 0.0f ? CellSize / fabsf(dy) : INFINITY;
+
+            // Segment fraction at which the walk crosses into the next column/row, or infinity past the edge cell.
+            auto crossing = [this](int32_t cell, int32_t step, int32_t count, float origin, float direction)
+            {
+                int32_t boundary = cell + (step > 0 ? 1 : 0);
+                if (direction == 0.0f || boundary <= 0 || boundary >= count)
+                    return INFINITY;
+                return (boundary * CellSize - origin) / direction;
+            };
+            float crossX = crossing(cellX, stepX, Columns, x0, dx);
+            float crossY = crossing(cellY, stepY, Rows, y0, dy);
+
+            hit.Body = INVALID_BODY;
+            hit.Fraction = 2.0f;
+            while (true)
+            {
+                for (uint16_t i = CellHeads[cellY * Columns + cellX]; i != END; i = Entries[i].Next)
+                {
+                    BodyId body = Entries[i].Body;
+                    if (Stamps[body] == stamp)
+                        continue;
+                    Stamps[body] = stamp;
+
+                    float fraction;
+                    if ((Categories[body] & mask) && IntersectBody(body, x0, y0, dx, dy, fraction) && fraction < hit.Fraction)
+                    {
+                        hit.Body = body;
+                        hit.Fraction = fraction;
+                    }
+                }
+
+                // Stop when the segment ends in this cell, or the nearest hit so far comes before anything in later cells.
+                float cellExit = std::min(crossX, crossY);
+                if (cellExit > 1.0f || hit.Fraction <= cellExit)
+                    break;
+
+                if (crossX < crossY)
+                {
+                    cellX += stepX;
+                    crossX = cellX + stepX < 0 || cellX + stepX >= Columns ? INFINITY : crossX + deltaX;
+                }
+                else
+                {
+                    cellY += stepY;
+                    crossY = cellY + stepY < 0 || cellY + stepY >= Rows ? INFINITY : crossY + deltaY;
+                }
+            }
+
+            if (hit.Body == INVALID_BODY)
+                return false;
+            hit.X = x0 + dx * hit.Fraction;
+            hit.Y = y0 + dy * hit.Fraction;
+            return true;
+        }
+    }
+}
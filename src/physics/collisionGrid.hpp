@@ -0,0 +1,164 @@
+#pragma once
+
+#include "shapes.hpp"
+#include "memory/arena.hpp"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Physics
+    {
+        using BodyId = uint16_t;
+        static constexpr BodyId INVALID_BODY = 0xFFFF;
+
+        enum class ShapeType : uint8_t
+        {
+            Box,
+            Circle,
+        };
+
+        struct RayHit
+        {
+            BodyId Body;
+            float Fraction;     // Along the segment, in [0, 1].
+            float X, Y;         // Where the segment first touches the body.
+        };
+
+        // Uniform-grid broadphase over a fixed area. Each body is linked into every cell its bounds cover; moving a body
+        // only relinks it when that cell range changes, which for small, slow bodies is rarely. Pairs are reported once,
+        // from the cell holding the top-left corner of the two bounds' overlap, so no pair set is needed.
+        //
+        // Bodies carry a category and a mask: two bodies are only tested if each one's category is in the other's mask,
+        // so e.g. bullets can skip each other entirely.
+        //
+        // All storage comes from an arena in Init(). Size cells around the typical body so most cover 1-4 cells;
+        // entryCapacity is the total number of body-in-cell links and defaults to four per body. Bodies outside the
+        // area are clamped into the edge cells, so they still collide, just less efficiently.
+        class CollisionGrid
+        {
+        public:
+            bool Init(Memory::Arena& arena, uint16_t maxBodies, float width, float height, float cellSize, uint32_t entryCapacity = 0);
+
+            // Returns INVALID_BODY when the grid is full.
+            BodyId AddBox(const Aabb& box, uint32_t userData, uint16_t category = 1, uint16_t mask = 0xFFFF);
+            BodyId AddCircle(const Circle& circle, uint32_t userData, uint16_t category = 1, uint16_t mask = 0xFFFF);
+            void Remove(BodyId body);
+
+            // Move a body, keeping its shape type.
+            void MoveBox(BodyId body, const Aabb& box);
+            void MoveCircle(BodyId body, const Circle& circle);
+
+            const Aabb& GetBounds(BodyId body) const { return Bounds[body]; }
+            uint32_t GetUserData(BodyId body) const { return UserData[body]; }
+            uint16_t GetBodyCount() const { return BodyCount; }
+
+            // True if the two bodies' actual shapes overlap.
+            bool TestPair(BodyId a, BodyId b) const;
+
+            // Call fn(BodyId a, BodyId b) once for every overlapping pair that passes the category/mask filter.
+            template<typename Fn>
+            void ForEachPair(Fn&& fn)
+            {
+                for (uint32_t cell = 0; cell < CellCount; cell++)
+                {
+                    for (uint16_t i = CellHeads[cell]; i != END; i = Entries[i].Next)
+                    {
+                        BodyId a = Entries[i].Body;
+                        for (uint16_t j = Entries[i].Next; j != END; j = Entries[j].Next)
+                        {
+                            BodyId b = Entries[j].Body;
+                            if (!Accepts(a, b) || !Overlaps(Bounds[a], Bounds[b]) || OwnerCell(a, b) != cell)
+                                continue;
+                            if (TestPair(a, b))
+                                fn(a, b);
+                        }
+                    }
+                }
+            }
+
+            // Call fn(BodyId) for every body whose shape overlaps the box and whose category is in mask.
+            template<typename Fn>
+            void Query(const Aabb& box, Fn&& fn, uint16_t mask = 0xFFFF)
+            {
+                uint16_t stamp = NextStamp();
+                uint16_t x0, y0, x1, y1;
+                CellRange(box, x0, y0, x1, y1);
+                for (uint16_t y = y0; y <= y1; y++)
+                {
+                    for (uint16_t x = x0; x <= x1; x++)
+                    {
+                        for (uint16_t i = CellHeads[y * Columns + x]; i != END; i = Entries[i].Next)
+                        {
+                            BodyId body = Entries[i].Body;
+                            if (Stamps[body] == stamp)
+                                continue;
+                            Stamps[body] = stamp;
+                            if ((Categories[body] & mask) && OverlapsShape(body, box))
+                                fn(body);
+                        }
+                    }
+                }
+            }
+
+            // Nearest body (whose category is in mask) touched by the segment from (x0, y0) to (x1, y1).
+            // Walks only the cells the segment passes through, in order, and stops once no later cell can be nearer.
+            bool Raycast(float x0, float y0, float x1, float y1, RayHit& hit, uint16_t mask = 0xFFFF);
+
+        private:
+            static constexpr uint16_t END = 0xFFFF;
+
+            struct Entry
+            {
+                BodyId Body;
+                uint16_t Next;
+            };
+
+            BodyId Add(ShapeType type, const Aabb& bounds, float radius, uint32_t userData, uint16_t category, uint16_t mask);
+            void Move(BodyId body, const Aabb& bounds, float radius);
+            void Link(BodyId body);
+            void Unlink(BodyId body);
+            void CellRange(const Aabb& bounds, uint16_t& x0, uint16_t& y0, uint16_t& x1, uint16_t& y1) const;
+            uint32_t OwnerCell(BodyId a, BodyId b) const;
+            bool OverlapsShape(BodyId body, const Aabb& box) const;
+            bool IntersectBody(BodyId body, float x0, float y0, float dx, float dy, float& fraction) const;
+            uint16_t NextStamp();
+
+            bool Accepts(BodyId a, BodyId b) const
+            {
+                return (Categories[a] & Masks[b]) && (Categories[b] & Masks[a]);
+            }
+
+            Circle GetCircle(BodyId body) const
+            {
+                const Aabb& bounds = Bounds[body];
+                return { (bounds.MinX + bounds.MaxX) * 0.5f, (bounds.MinY + bounds.MaxY) * 0.5f, Radii[body] };
+            }
+
+            // Per body.
+            Aabb* Bounds = nullptr;
+            float* Radii = nullptr;             // Circles only; the centre is the middle of Bounds.
+            uint32_t* UserData = nullptr;
+            uint16_t* Categories = nullptr;
+            uint16_t* Masks = nullptr;
+            ShapeType* Types = nullptr;
+            uint16_t* CellRanges = nullptr;     // x0, y0, x1, y1 per body: the cells it is currently linked into.
+            uint16_t* Stamps = nullptr;         // Last query that visited the body, to skip duplicates across cells.
+            uint16_t* FreeBodies = nullptr;
+            bool* Active = nullptr;
+            uint16_t MaxBodies = 0;
+            uint16_t FreeBodyCount = 0;
+            uint16_t BodyCount = 0;
+            uint16_t Stamp = 0;
+
+            // Grid.
+            uint16_t* CellHeads = nullptr;
+            Entry* Entries = nullptr;
+            uint16_t FreeEntry = END;           // Free entries are chained through Next.
+            uint16_t Columns = 0;
+            uint16_t Rows = 0;
+            uint32_t CellCount = 0;
+            float CellSize = 1.0f;
+            float InverseCellSize = 1.0f;
+        };
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace PicoPixel
+{
+    namespace Physics
+    {
+        // Axis-aligned box in screen space (y grows down), inclusive of its min edge and exclusive of its max edge.
+        struct Aabb
+        {
+            float MinX, MinY;
+            float MaxX, MaxY;
+
+            static Aabb FromRect(float x, float y, float width, float height)
+            {
+                return { x, y, x + width, y + height };
+            }
+
+            float GetWidth() const { return MaxX - MinX; }
+            float GetHeight() const { return MaxY - MinY; }
+        };
+
+        struct Circle
+        {
+            float X, Y;
+            float Radius;
+
+            Aabb GetBounds() const
+            {
+                return { X - Radius, Y - Radius, X + Radius, Y + Radius };
+            }
+        };
+
+        inline bool Overlaps(const Aabb& a, const Aabb& b)
+        {
+            return a.MinX < b.MaxX && b.MinX < a.MaxX && a.MinY < b.MaxY && b.MinY < a.MaxY;
+        }
+
+        inline bool Overlaps(const Circle& a, const Circle& b)
+        {
+            float dx = a.X - b.X;
+            float dy = a.Y - b.Y;
+            float radii = a.Radius + b.Radius;
+            return dx * dx + dy * dy < radii * radii;
+        }
+
+        inline bool Overlaps(const Aabb& box, const Circle& circle)
+        {
+            // Distance from the centre to the closest point of the box.
+            float dx = circle.X - std::clamp(circle.X, box.MinX, box.MaxX);
+            float dy = circle.Y - std::clamp(circle.Y, box.MinY, box.MaxY);
+            return dx * dx + dy * dy < circle.Radius * circle.Radius;
+        }
+
+        inline bool Overlaps(const Circle& circle, const Aabb& box)
+        {
+            return Overlaps(box, circle);
+        }
+
+        // Segment tests. The segment runs from (x0, y0) to (x0 + dx, y0 + dy); on a hit, fraction is how far along it
+        // (in [0, 1]) the shape is first touched. A segment that starts inside the shape hits at 0.
+        inline bool IntersectSegment(const Aabb& box, float x0, float y0, float dx, float dy, float& fraction)
+        {
+            // Slab test: clip [0, 1] against the x and y slabs in turn.
+            float enter = 0.0f;
+            float exit = 1.0f;
+            const float origin[2] = { x0, y0 };
+            const float direction[2] = { dx, dy };
+            const float minimum[2] = { box.MinX, box.MinY };
+            const float maximum[2] = { box.MaxX, box.MaxY };
+            for (int axis = 0; axis < 2; axis++)
+            {
+                if (direction[axis] == 0.0f)
+                {
+                    if (origin[axis] < minimum[axis] || origin[axis] >= maximum[axis])
+                        return false;
+                    continue;
+                }
+
+                float inverse = 1.0f / direction[axis];
+                float near = (minimum[axis] - origin[axis]) * inverse;
+                float far = (maximum[axis] - origin[axis]) * inverse;
+                if (near > far)
+                    std::swap(near, far);
+                enter = std::max(enter, near);
+                exit = std::min(exit, far);
+                if (enter > exit)
+                    return false;
+            }
+            fraction = enter;
+            return true;
+        }
+
+        inline bool IntersectSegment(const Circle& circle, float x0, float y0, float dx, float dy, float& fraction)
+        {
+            // Solve |origin + t * direction - centre|^2 = r^2 for the smaller t.
+            float ox = x0 - circle.X;
+            float oy = y0 - circle.Y;
+            float c = ox * ox + oy * oy - circle.Radius * circle.Radius;
+            if (c <= 0.0f)
+            {
+                fraction = 0.0f;
+                return true;
+            }
+
+            float a = dx * dx + dy * dy;
+            float b = ox * dx + oy * dy;
+            float discriminant = b * b - a * c;
+            if (a == 0.0f || b >= 0.0f || discriminant < 0.0f)
+                return false;
+
+            float t = (-b - sqrtf(discriminant)) / a;
+            if (t > 1.0f)
+                return false;
+            fraction = t;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,278 @@
+#include "hostPlatform.hpp"
+#include "log.hpp"
+
+#include "hardware/spi.h"
+#include "hardware/clocks.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Enough panel memory for either orientation.
+#define HOST_PANEL_SIZE 320
+
+namespace PicoPixel
+{
+    namespace HostPlatform
+    {
+        // ILI9341 commands the decoder understands. Everything else is accepted and ignored.
+        static constexpr uint8_t COMMAND_CASET = 0x2A;
+        static constexpr uint8_t COMMAND_PASET = 0x2B;
+        static constexpr uint8_t COMMAND_RAMWR = 0x2C;
+        static constexpr uint8_t COMMAND_MADCTL = 0x36;
+        static constexpr uint8_t MADCTL_MV = 0x20;
+
+        struct SpiPort
+        {
+            uint32_t Baudrate;
+            uint8_t DataBits;
+        };
+
+        // Just enough of the ILI9341 to turn CASET/PASET/RAMWR traffic into frames.
+        struct Panel
+        {
+            uint16_t Pixels[HOST_PANEL_SIZE * HOST_PANEL_SIZE];
+            uint8_t Command;
+            uint8_t Parameters[4];
+            uint8_t ParameterCount;
+            uint16_t ColumnStart, ColumnEnd;
+            uint16_t PageStart, PageEnd;
+            uint16_t Column, Page;
+            bool HaveHighByte;      // 8-bit RAMWR data arrives a byte at a time.
+            uint8_t HighByte;
+            uint32_t PixelsWritten;
+            bool Landscape;
+        };
+
+        static Panel Display = {};
+        static uint32_t FramesPresented = 0;
+        static std::chrono::steady_clock::time_point FirstFrameTime;
+
+        static uint16_t PanelWidth()
+        {
+            return Display.Landscape ? 320 : 240;
+        }
+
+        static uint16_t PanelHeight()
+        {
+            return Display.Landscape ? 240 : 320;
+        }
+
+        static void DumpFrame()
+        {
+            const Config& config = GetConfig();
+            if (!config.DumpDirectory || FramesPresented % config.DumpEvery != 0)
+                return;
+
+            char path[512];
+            snprintf(path, sizeof(path), "%s/frame_%05lu.%s", config.DumpDirectory, (unsigned long)FramesPresented, config.DumpRaw ? "raw" : "ppm");
+            FILE* file = fopen(path, "wb");
+            if (!file)
+            {
+                LOG_ERROR("Host: Could not write %s\n", path);
+                return;
+            }
+
+            uint16_t width = PanelWidth();
+            uint16_t height = PanelHeight();
+            if (config.DumpRaw)
+            {
+                for (uint16_t y = 0; y < height; y++)
+                    fwrite(&Display.Pixels[y * HOST_PANEL_SIZE], sizeof(uint16_t), width, file);
+            }
+            else
+            {
+                fprintf(file, "P6\n%u %u\n255\n", width, height);
+                uint8_t row[HOST_PANEL_SIZE * 3];
+                for (uint16_t y = 0; y < height; y++)
+                {
+                    for (uint16_t x = 0; x < width; x++)
+                    {
+                        // Expand RGB565 to 8 bits per channel, replicating the high bits into the low ones.
+                        uint16_t pixel = Display.Pixels[y * HOST_PANEL_SIZE + x];
+                        uint8_t r = (pixel >> 11) & 0x1F;
+                        uint8_t g = (pixel >> 5) & 0x3F;
+                        uint8_t b = pixel & 0x1F;
+                        row[x * 3 + 0] = (uint8_t)((r << 3) | (r >> 2));
+                        row[x * 3 + 1] = (uint8_t)((g << 2) | (g >> 4));
+                        row[x * 3 + 2] = (uint8_t)((b << 3) | (b >> 2));
+                    }
+                    fwrite(row, 3, width, file);
+                }
+            }
+            fclose(file);
+        }
+
+        // A RAMWR that covers the whole panel is a presented frame.
+        static void FinishFrame()
+        {
+            if (FramesPresented == 0)
+                FirstFrameTime = std::chrono::steady_clock::now();
+            FramesPresented++;
+            DumpFrame();
+
+            uint32_t limit = GetConfig().FrameLimit;
+            if (limit && FramesPresented >= limit)
+            {
+                double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - FirstFrameTime).count();
+                LOG("Host: %lu frames, %.3f s of %s time\n", (unsigned long)FramesPresented, time_us_64() / 1e6,
+                    GetConfig().RealTime ? "real" : "virtual");
+                LOG("Host: %.3f s wall clock (%.0f fps)\n", wallSeconds, wallSeconds > 0.0 ? (FramesPresented - 1) / wallSeconds : 0.0);
+                // With LOG_MODE_DEFERRED the summary (and whatever the frame queued) is still in the ring.
+                PicoPixel::Log::Drain(LOG_DEFERRED_CAPACITY);
+                Exit(0);
+            }
+        }
+
+        static void WritePixel(uint16_t pixel)
+        {
+            if (Display.Column < HOST_PANEL_SIZE && Display.Page < HOST_PANEL_SIZE)
+                Display.Pixels[Display.Page * HOST_PANEL_SIZE + Display.Column] = pixel;
+
+            // Fill the window left to right, top to bottom, wrapping back to the start like the controller does.
+            if (++Display.Column > Display.ColumnEnd)
+            {
+                Display.Column = Display.ColumnStart;
+                if (++Display.Page > Display.PageEnd)
+                    Display.Page = Display.PageStart;
+            }
+
+            uint32_t windowSize = (uint32_t)(Display.ColumnEnd - Display.ColumnStart + 1) * (Display.PageEnd - Display.PageStart + 1);
+            if (++Display.PixelsWritten == windowSize && windowSize == (uint32_t)PanelWidth() * PanelHeight())
+                FinishFrame();
+        }
+
+        static void BeginCommand(uint8_t command)
+        {
+            Display.Command = command;
+            Display.ParameterCount = 0;
+            Display.HaveHighByte = false;
+            if (command == COMMAND_RAMWR)
+            {
+                Display.Column = Display.ColumnStart;
+                Display.Page = Display.PageStart;
+                Display.PixelsWritten = 0;
+            }
+        }
+
+        static void WriteData(uint8_t data)
+        {
+            if (Display.Command == COMMAND_RAMWR)
+            {
+                if (!Display.HaveHighByte)
+                {
+                    Display.HighByte = data;
+                    Display.HaveHighByte = true;
+                    return;
+                }
+                Display.HaveHighByte = false;
+                WritePixel((uint16_t)(Display.HighByte << 8 | data));
+                return;
+            }
+
+            if (Display.ParameterCount < sizeof(Display.Parameters))
+                Display.Parameters[Display.ParameterCount++] = data;
+
+            if (Display.Command == COMMAND_MADCTL && Display.ParameterCount == 1)
+                Display.Landscape = (data & MADCTL_MV) != 0;
+            else if (Display.Command == COMMAND_CASET && Display.ParameterCount == 4)
+            {
+                Display.ColumnStart = (uint16_t)(Display.Parameters[0] << 8 | Display.Parameters[1]);
+                Display.ColumnEnd = (uint16_t)(Display.Parameters[2] << 8 | Display.Parameters[3]);
+            }
+            else if (Display.Command == COMMAND_PASET && Display.ParameterCount == 4)
+            {
+                Display.PageStart = (uint16_t)(Display.Parameters[0] << 8 | Display.Parameters[1]);
+                Display.PageEnd = (uint16_t)(Display.Parameters[2] << 8 | Display.Parameters[3]);
+            }
+        }
+
+        // Time the bits would take on the wire.
+        static void ChargeTransfer(const SpiPort* port, size_t bits)
+        {
+            if (port->Baudrate)
+                AdvanceTime(bits * 1000000ull / port->Baudrate);
+        }
+    }
+}
+
+using namespace PicoPixel::HostPlatform;
+
+// The SDK's spi0/spi1 are pointers to hardware registers; here they're just distinct handles.
+struct spi_inst
+{
+    SpiPort Port;
+};
+
+static spi_inst Instances[2] = {};
+spi_inst_t* const spi0 = &Instances[0];
+spi_inst_t* const spi1 = &Instances[1];
+
+extern "C"
+{
+    uint spi_init(spi_inst_t* spi, uint baudrate)
+    {
+        spi->Port.DataBits = 8;
+        return spi_set_baudrate(spi, baudrate);
+    }
+
+    void spi_deinit(spi_inst_t* spi)
+    {
+        spi->Port.Baudrate = 0;
+    }
+
+    uint spi_set_baudrate(spi_inst_t* spi, uint baudrate)
+    {
+        // The SDK's divider search: the smallest even prescale that leaves the post-divider in range, then the largest
+        // post-divider that doesn't go over the request. Never more than half of clk_peri.
+        uint32_t peripheralHz = clock_get_hz(clk_peri);
+        uint32_t prescale = 2;
+        for (; prescale <= 254; prescale += 2)
+            if (peripheralHz < (prescale + 2) * 256ull * baudrate)
+                break;
+        uint32_t postdiv = 256;
+        for (; postdiv > 1; postdiv--)
+            if (peripheralHz / (prescale * (postdiv - 1)) > baudrate)
+                break;
+        spi->Port.Baudrate = peripheralHz / (prescale * postdiv);
+        return spi->Port.Baudrate;
+    }
+
+    uint spi_get_baudrate(const spi_inst_t* spi)
+    {
+        return spi->Port.Baudrate;
+    }
+
+    void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order)
+    {
+        (void)cpol;
+        (void)cpha;
+        (void)order;
+        spi->Port.DataBits = (uint8_t)data_bits;
+    }
+
+    int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len)
+    {
+        ChargeTransfer(&spi->Port, len * 8);
+        bool command = !PicoPixel::HostPlatform::GetPinLevel(HOST_DISPLAY_DC_PIN);
+        for (size_t i = 0; i < len; i++)
+        {
+            if (command)
+                BeginCommand(src[i]);
+            else
+                WriteData(src[i]);
+        }
+        return (int)len;
+    }
+
+    int spi_write16_blocking(spi_inst_t* spi, const uint16_t* src, size_t len)
+    {
+        ChargeTransfer(&spi->Port, len * 16);
+        if (Display.Command == COMMAND_RAMWR)
+        {
+            for (size_t i = 0; i < len; i++)
+                WritePixel(src[i]);
+        }
+        return (int)len;
+    }
+}
@@ -0,0 +1,389 @@
+#include "hostPlatform.hpp"
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace PicoPixel
+{
+    namespace HostPlatform
+    {
+        static uint32_t ReadEnv(const char* name, uint32_t fallback)
+        {
+            const char* value = getenv(name);
+            return value && *value ? (uint32_t)strtoul(value, nullptr, 10) : fallback;
+        }
+
+        const Config& GetConfig()
+        {
+            static const Config config =
+            {
+                ReadEnv("PICOPIXEL_FRAMES", 600),
+                getenv("PICOPIXEL_DUMP_DIR"),
+                std::max(ReadEnv("PICOPIXEL_DUMP_EVERY", 1), 1u),
+                ReadEnv("PICOPIXEL_DUMP_RAW", 0) != 0,
+                ReadEnv("PICOPIXEL_REALTIME", 0) != 0,
+                getenv("PICOPIXEL_KEYS"),
+            };
+            return config;
+        }
+
+        static std::atomic<uint64_t> VirtualTimeUs{0};
+        static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+        void AdvanceTime(uint64_t us)
+        {
+            if (!GetConfig().RealTime)
+                VirtualTimeUs += us;
+        }
+
+        static uint64_t NowUs()
+        {
+            if (!GetConfig().RealTime)
+                return VirtualTimeUs;
+            return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count();
+        }
+
+        static void WaitUntil(uint64_t targetUs)
+        {
+            if (!GetConfig().RealTime)
+            {
+                // Never move time backwards if the other core already went past the target.
+                uint64_t now = VirtualTimeUs;
+                while (now < targetUs && !VirtualTimeUs.compare_exchange_weak(now, targetUs))
+                {
+                }
+                return;
+            }
+            uint64_t now = NowUs();
+            if (targetUs > now)
+                std::this_thread::sleep_for(std::chrono::microseconds(targetUs - now));
+        }
+
+        // Next unread "ms:c" entry of PICOPIXEL_KEYS.
+        static const char* NextKey = nullptr;
+
+        static int ReadScriptedKey()
+        {
+            if (!NextKey)
+                NextKey = GetConfig().Keys ? GetConfig().Keys : "";
+            char* end;
+            unsigned long atMs = strtoul(NextKey, &end, 10);
+            if (end == NextKey || *end != ':' || !end[1] || NowUs() < atMs * 1000ull)
+                return PICO_ERROR_TIMEOUT;
+            int key = (unsigned char)end[1];
+            NextKey = end + 2;
+            if (*NextKey == ',')
+                NextKey++;
+            return key;
+        }
+
+        static bool PinLevels[32] = {};
+
+        bool GetPinLevel(uint32_t gpio)
+        {
+            return gpio < 32 && PinLevels[gpio];
+        }
+
+        static bool Core1Launched = false;
+
+        void Exit(int status)
+        {
+            fflush(stdout);
+            // A core1 thread blocked on the FIFO can't be joined, so skip static destructors when one exists.
+            if (Core1Launched)
+                _Exit(status);
+            exit(status);
+        }
+
+        // Inter-core FIFOs: index 0 carries core0 -> core1, index 1 carries core1 -> core0.
+        static constexpr size_t FIFO_DEPTH = 8;
+        static std::mutex FifoMutex;
+        static std::condition_variable FifoChanged;
+        static std::deque<uint32_t> Fifos[2];
+        static std::thread Core1;
+        static thread_local uint CoreNum = 0;
+
+        static spin_lock_t SpinLocks[NUM_SPIN_LOCKS];
+    }
+}
+
+using namespace PicoPixel::HostPlatform;
+
+extern "C"
+{
+    // ------- pico/stdlib -------
+
+    bool stdio_init_all(void)
+    {
+        // Unbuffered, so output interleaves sensibly with a crash or an Exit() from core1.
+        setvbuf(stdout, nullptr, _IONBF, 0);
+        return true;
+    }
+
+    int getchar_timeout_us(uint32_t timeout_us)
+    {
+        // Headless: the only serial input is what PICOPIXEL_KEYS scripts.
+        (void)timeout_us;
+        return ReadScriptedKey();
+    }
+
+    uint64_t time_us_64(void)
+    {
+        return NowUs();
+    }
+
+    uint32_t time_us_32(void)
+    {
+        return (uint32_t)NowUs();
+    }
+
+    void sleep_us(uint64_t us)
+    {
+        WaitUntil(NowUs() + us);
+    }
+
+    void sleep_ms(uint32_t ms)
+    {
+        sleep_us(ms * 1000ull);
+    }
+
+    bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+    {
+        WaitUntil(timeout_timestamp);
+        return true;
+    }
+
+    // ------- hardware/gpio -------
+
+    void gpio_init(uint gpio)
+    {
+        if (gpio < 32)
+            PinLevels[gpio] = false;
+    }
+
+    void gpio_set_function(uint gpio, enum gpio_function fn)
+    {
+        (void)gpio;
+        (void)fn;
+    }
+
+    void gpio_set_dir(uint gpio, bool out)
+    {
+        (void)gpio;
+        (void)out;
+    }
+
+    void gpio_put(uint gpio, bool value)
+    {
+        if (gpio < 32)
+            PinLevels[gpio] = value;
+    }
+
+    bool gpio_get(uint gpio)
+    {
+        return GetPinLevel(gpio);
+    }
+
+    void gpio_pull_up(uint gpio)
+    {
+        if (gpio < 32)
+            PinLevels[gpio] = true;
+    }
+
+    void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+    {
+        (void)gpio;
+        (void)event_mask;
+        (void)enabled;
+    }
+
+    void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+    {
+        (void)callback;
+        gpio_set_irq_enabled(gpio, event_mask, enabled);
+    }
+
+    // ------- hardware/adc -------
+
+    static uint SelectedInput = 0;
+
+    void adc_init(void)
+    {
+    }
+
+    void adc_gpio_init(uint gpio)
+    {
+        (void)gpio;
+    }
+
+    void adc_select_input(uint input)
+    {
+        SelectedInput = input;
+    }
+
+    uint adc_get_selected_input(void)
+    {
+        return SelectedInput;
+    }
+
+    uint16_t adc_read(void)
+    {
+        // About 0.706 V, the sensor's reading at 27 degrees.
+        if (SelectedInput == 4)
+            return 876;
+
+        // A 4 second triangle over the full 12-bit range, offset per input so channels differ.
+        uint32_t phase = (uint32_t)((NowUs() / 1000 + SelectedInput * 1000) % 4000);
+        uint32_t level = phase < 2000 ? phase : 4000 - phase;
+        return (uint16_t)(level * 4095 / 2000);
+    }
+
+    // ------- hardware/clocks -------
+
+    static uint32_t SysHz = 125 * MHZ;
+
+    bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+    {
+        (void)required;
+        // Only what the PLL can make from the 12 MHz crystal is accepted on the device. Close enough for the profiles.
+        if (freq_khz < 12000 || freq_khz > 300000)
+            return false;
+        SysHz = freq_khz * KHZ;
+        return true;
+    }
+
+    uint32_t clock_get_hz(enum clock_index clk_index)
+    {
+        switch (clk_index)
+        {
+        case clk_usb:
+        case clk_adc:
+            return 48 * MHZ;
+        case clk_ref:
+            return 12 * MHZ;
+        case clk_rtc:
+            return 46875;
+        case clk_sys:
+        case clk_peri:
+            return SysHz;
+        default:
+            return 125 * MHZ;
+        }
+    }
+
+    // ------- hardware/sync -------
+
+    spin_lock_t* spin_lock_instance(uint lock_num)
+    {
+        return &SpinLocks[lock_num % NUM_SPIN_LOCKS];
+    }
+
+    uint32_t spin_lock_blocking(spin_lock_t* lock)
+    {
+        while (__atomic_exchange_n((uint32_t*)lock, 1u, __ATOMIC_ACQUIRE))
+            std::this_thread::yield();
+        return 0;
+    }
+
+    void spin_unlock(spin_lock_t* lock, uint32_t saved_irq)
+    {
+        (void)saved_irq;
+        __atomic_store_n((uint32_t*)lock, 0u, __ATOMIC_RELEASE);
+    }
+
+    uint32_t save_and_disable_interrupts(void)
+    {
+        return 0;
+    }
+
+    void restore_interrupts(uint32_t status)
+    {
+        (void)status;
+    }
+
+    void __wfe(void)
+    {
+        std::this_thread::yield();
+    }
+
+    void __sev(void)
+    {
+    }
+
+    void __dmb(void)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    uint get_core_num(void)
+    {
+        return CoreNum;
+    }
+
+    // ------- pico/multicore -------
+
+    void multicore_launch_core1(void (*entry)(void))
+    {
+        multicore_reset_core1();
+        Core1Launched = true;
+        Core1 = std::thread([entry]()
+        {
+            CoreNum = 1;
+            entry();
+        });
+    }
+
+    void multicore_reset_core1(void)
+    {
+        if (Core1.joinable())
+            Core1.join();
+        std::lock_guard<std::mutex> lock(FifoMutex);
+        Fifos[0].clear();
+        Fifos[1].clear();
+    }
+
+    void multicore_fifo_push_blocking(uint32_t data)
+    {
+        std::deque<uint32_t>& fifo = Fifos[CoreNum];
+        std::unique_lock<std::mutex> lock(FifoMutex);
+        FifoChanged.wait(lock, [&fifo]() { return fifo.size() < FIFO_DEPTH; });
+        fifo.push_back(data);
+        FifoChanged.notify_all();
+    }
+
+    uint32_t multicore_fifo_pop_blocking(void)
+    {
+        std::deque<uint32_t>& fifo = Fifos[CoreNum ^ 1];
+        std::unique_lock<std::mutex> lock(FifoMutex);
+        FifoChanged.wait(lock, [&fifo]() { return !fifo.empty(); });
+        uint32_t data = fifo.front();
+        fifo.pop_front();
+        FifoChanged.notify_all();
+        return data;
+    }
+
+    bool multicore_fifo_rvalid(void)
+    {
+        std::lock_guard<std::mutex> lock(FifoMutex);
+        return !Fifos[CoreNum ^ 1].empty();
+    }
+
+    void multicore_fifo_drain(void)
+    {
+        std::lock_guard<std::mutex> lock(FifoMutex);
+        Fifos[CoreNum ^ 1].clear();
+    }
+}
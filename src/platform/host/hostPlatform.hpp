@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Pin the ILI9341's DC line is wired to (see main.cpp). The display shim reads it to tell commands from data.
+#ifndef HOST_DISPLAY_DC_PIN
+    #define HOST_DISPLAY_DC_PIN 16
+#endif
+
+namespace PicoPixel
+{
+    // Headless host build (HOST_SIMULATOR). Stands in for the Pico SDK so the menu and games run on Linux, as fast as
+    // the host allows, under perf/valgrind. Configured from the environment:
+    //   PICOPIXEL_FRAMES=n        Exit after n presented frames (default 600, 0 runs forever).
+    //   PICOPIXEL_DUMP_DIR=path   Write presented frames there as frame_NNNNN.ppm.
+    //   PICOPIXEL_DUMP_EVERY=n    Only dump every nth frame (default 1).
+    //   PICOPIXEL_DUMP_RAW=1      Dump raw little-endian RGB565 (.raw) instead of PPM.
+    //   PICOPIXEL_REALTIME=1      Use the wall clock instead of virtual time.
+    //   PICOPIXEL_KEYS=ms:c,...   Serial input: getchar_timeout_us() returns key c once ms milliseconds have passed.
+    //
+    // Virtual time only moves when the firmware waits: sleeps, frame pacing, and SPI transfers (bytes on the wire at
+    // the configured baud rate). Game code itself takes no time, so runs are deterministic and frame pacing is exact.
+    // Profile CPU time with perf, or set PICOPIXEL_REALTIME for the built-in profiler and benchmarks.
+    namespace HostPlatform
+    {
+        struct Config
+        {
+            uint32_t FrameLimit;
+            const char* DumpDirectory;
+            uint32_t DumpEvery;
+            bool DumpRaw;
+            bool RealTime;
+            const char* Keys;
+        };
+
+        const Config& GetConfig();
+
+        // Move virtual time forward. Does nothing in real-time mode.
+        void AdvanceTime(uint64_t us);
+
+        bool GetPinLevel(uint32_t gpio);
+
+        // Flush output and leave the process, even if a core1 thread is still blocked.
+        [[noreturn]] void Exit(int status);
+    }
+}
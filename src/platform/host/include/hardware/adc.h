@@ -0,0 +1,20 @@
+#pragma once
+
+// Host simulator shim for hardware/adc.h. Inputs read a slow deterministic sweep driven by (virtual) time;
+// input 4 reads a steady room-temperature value like the RP2040's sensor.
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+uint16_t adc_read(void);
+
+#ifdef __cplusplus
+}
+#endif
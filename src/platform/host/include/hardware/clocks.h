@@ -0,0 +1,41 @@
+#pragma once
+
+// Host simulator shim for hardware/clocks.h. Reports the RP2040's default clocks, with clk_sys (and clk_peri, which
+// follows it) changeable through set_sys_clock_khz().
+
+#include "pico/stdlib.h"
+
+#define KHZ 1000
+#define MHZ 1000000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum clock_index
+{
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+};
+
+enum
+{
+    KHz = 1000,
+    MHz = 1000000,
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host simulator shim for hardware/pwm.h. The backlight has nothing to drive, so these do nothing.
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1u) & 7u; }
+static inline void pwm_set_enabled(uint slice_num, bool enabled) { (void)slice_num; (void)enabled; }
+static inline void pwm_set_gpio_level(uint gpio, uint16_t level) { (void)gpio; (void)level; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+// Host simulator shim for hardware/sync.h. Spin locks are real atomics, since the multicore shim runs core1
+// on its own thread; "interrupts" don't exist on the host.
+
+#include "pico/stdlib.h"
+
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16
+#define PICO_SPINLOCK_ID_STRIPED_LAST 23
+#define NUM_SPIN_LOCKS 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef volatile uint32_t spin_lock_t;
+
+spin_lock_t* spin_lock_instance(uint lock_num);
+uint32_t spin_lock_blocking(spin_lock_t* lock);
+void spin_unlock(spin_lock_t* lock, uint32_t saved_irq);
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+void __wfe(void);
+void __sev(void);
+void __dmb(void);
+
+uint get_core_num(void);
+
+#ifdef __cplusplus
+}
+#endif
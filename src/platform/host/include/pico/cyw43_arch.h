@@ -0,0 +1,19 @@
+#pragma once
+
+// Host simulator shim for pico/cyw43_arch.h. There is no wireless chip, so the onboard LED is a no-op.
+
+#include "pico/stdlib.h"
+
+#define CYW43_WL_GPIO_LED_PIN 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline int cyw43_arch_init(void) { return 0; }
+static inline void cyw43_arch_deinit(void) {}
+static inline void cyw43_arch_gpio_put(uint wl_gpio, bool value) { (void)wl_gpio; (void)value; }
+
+#ifdef __cplusplus
+}
+#endif
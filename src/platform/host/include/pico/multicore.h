@@ -0,0 +1,22 @@
+#pragma once
+
+// Host simulator shim for pico/multicore.h. Core1 is a thread and the inter-core FIFOs are 8-deep queues, like the
+// hardware. multicore_reset_core1() can't stop a running thread, so it waits for core1's entry function to return.
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+bool multicore_fifo_rvalid(void);
+void multicore_fifo_drain(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+// Host simulator shim for the parts of the Pico SDK's pico/stdlib.h that PicoPixel uses.
+// Time is virtual unless PICOPIXEL_REALTIME is set; see platform/host/hostPlatform.hpp.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "hardware/gpio.h"
+
+#ifndef PICO_ON_DEVICE
+    #define PICO_ON_DEVICE 0
+#endif
+
+#define PICO_ERROR_TIMEOUT -1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+
+static inline void tight_loop_contents(void) {}
+
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return time_us_64() + ms * 1000ull; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+static inline void sleep_until(absolute_time_t t) { uint64_t now = time_us_64(); if (t > now) sleep_us(t - now); }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,245 @@
+#include "profiler.hpp"
+#include "log.hpp"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <cstdio>
+#include <cstring>
+
+namespace PicoPixel
+{
+    namespace Profiler
+    {
+        // time_us_32() is used throughout. The M0+ has no DWT cycle counter, and a 32-bit microsecond
+        // timestamp is a single register read that wraps every ~71 minutes, which is fine for durations.
+
+        static ZoneStats Zones[PROFILER_MAX_ZONES];
+        static uint8_t ZoneCount = 0;
+
+        static ZoneEvent Events[PROFILER_EVENT_CAPACITY];
+        static uint32_t EventHead = 0;  // Total events ever written; the ring holds the last PROFILER_EVENT_CAPACITY.
+
+        static uint16_t Frame = 0;
+        static uint32_t FrameStartUs = 0;
+        static uint32_t LastFrameUs = 0;
+#if PROFILER_DUMP_INTERVAL_MS > 0
+        static uint32_t LastDumpUs = 0;
+#endif
+        static ZoneId FrameZone = 0xFF;
+
+        // Nesting depth per core so both cores can be profiled at once.
+        static uint8_t Depth[2] = { 0, 0 };
+
+        static spin_lock_t* GetLock()
+        {
+            return spin_lock_instance(PICO_SPINLOCK_ID_STRIPED_FIRST + 1);
+        }
+
+        static void ResetStats(ZoneStats* stats)
+        {
+            stats->Count = 0;
+            stats->MinUs = UINT32_MAX;
+            stats->MaxUs = 0;
+            stats->TotalUs = 0;
+            memset(stats->Histogram, 0, sizeof(stats->Histogram));
+        }
+
+        // Log-linear buckets: exact below 8us, then four buckets per power of two (~25% resolution).
+        static uint8_t BucketFor(uint32_t us)
+        {
+            if (us < 8)
+                return (uint8_t)us;
+            uint32_t msb = 31 - __builtin_clz(us);
+            uint32_t sub = (us >> (msb - 2)) & 0x3;
+            uint32_t bucket = 8 + (msb - 3) * 4 + sub;
+            return bucket < PROFILER_HISTOGRAM_BUCKETS ? (uint8_t)bucket : PROFILER_HISTOGRAM_BUCKETS - 1;
+        }
+
+        static uint32_t BucketUpperBound(uint8_t bucket)
+        {
+            if (bucket < 8)
+                return bucket;
+            uint32_t msb = 3 + (bucket - 8) / 4;
+            uint32_t sub = (bucket - 8) % 4;
+            return ((4 + sub + 1) << (msb - 2)) - 1;
+        }
+
+        ZoneId RegisterZone(const char* name)
+        {
+            spin_lock_t* lock = GetLock();
+            uint32_t irq = spin_lock_blocking(lock);
+
+            ZoneId id = 0xFF;
+            for (uint8_t i = 0; i < ZoneCount; i++)
+            {
+                if (Zones[i].Name == name || strcmp(Zones[i].Name, name) == 0)
+                {
+                    id = i;
+                    break;
+                }
+            }
+            if (id == 0xFF && ZoneCount < PROFILER_MAX_ZONES)
+            {
+                id = ZoneCount++;
+                Zones[id].Name = name;
+                ResetStats(&Zones[id]);
+            }
+
+            spin_unlock(lock, irq);
+
+            if (id == 0xFF)
+                LOG_WARN("Out of profiler zones (PROFILER_MAX_ZONES = %d), ignoring \"%s\"\n", PROFILER_MAX_ZONES, name);
+            return id;
+        }
+
+        void BeginFrame()
+        {
+            if (FrameZone == 0xFF)
+                FrameZone = RegisterZone("Frame");
+
+            FrameStartUs = time_us_32();
+            Depth[get_core_num()] = 1;
+        }
+
+        void EndFrame()
+        {
+            uint32_t now = time_us_32();
+            LastFrameUs = now - FrameStartUs;
+            Depth[get_core_num()] = 0;
+            RecordZone(FrameZone, FrameStartUs, LastFrameUs, 0);
+            Frame++;
+
+#if PROFILER_DUMP_INTERVAL_MS > 0
+            if (now - LastDumpUs >= PROFILER_DUMP_INTERVAL_MS * 1000u)
+            {
+                LastDumpUs = now;
+                Dump();
+            }
+#endif
+        }
+
+        void RecordZone(ZoneId zone, uint32_t startUs, uint32_t durationUs, uint8_t depth)
+        {
+            if (zone >= ZoneCount)
+                return;
+
+            spin_lock_t* lock = GetLock();
+            uint32_t irq = spin_lock_blocking(lock);
+
+            ZoneStats& stats = Zones[zone];
+            stats.Count++;
+            stats.TotalUs += durationUs;
+            if (durationUs < stats.MinUs) stats.MinUs = durationUs;
+            if (durationUs > stats.MaxUs) stats.MaxUs = durationUs;
+            uint16_t& bucket = stats.Histogram[BucketFor(durationUs)];
+            if (bucket != UINT16_MAX)
+                bucket++;
+
+            ZoneEvent& event = Events[EventHead % PROFILER_EVENT_CAPACITY];
+            event.StartUs = startUs;
+            event.DurationUs = durationUs;
+            event.Frame = Frame;
+            event.Zone = zone;
+            event.Depth = depth;
+            EventHead++;
+
+            spin_unlock(lock, irq);
+        }
+
+        const ZoneStats* GetZoneStats(ZoneId zone)
+        {
+            return zone < ZoneCount ? &Zones[zone] : nullptr;
+        }
+
+        uint8_t GetZoneCount()
+        {
+            return ZoneCount;
+        }
+
+        uint32_t GetPercentile(ZoneId zone, float fraction)
+        {
+            if (zone >= ZoneCount || Zones[zone].Count == 0)
+                return 0;
+
+            const ZoneStats& stats = Zones[zone];
+            uint32_t target = (uint32_t)(stats.Count * fraction);
+            if (target == 0)
+                target = 1;
+            uint32_t seen = 0;
+            for (uint8_t i = 0; i < PROFILER_HISTOGRAM_BUCKETS; i++)
+            {
+                seen += stats.Histogram[i];
+                if (seen >= target)
+                {
+                    uint32_t bound = BucketUpperBound(i);
+                    return bound < stats.MaxUs ? bound : stats.MaxUs;
+                }
+            }
+            return stats.MaxUs;
+        }
+
+        uint32_t GetLastFrameUs()
+        {
+            return LastFrameUs;
+        }
+
+        void Dump(bool includeEvents)
+        {
+            // Format (one record per line, so it survives being interleaved with other serial output):
+            //   #PPPF-BEGIN <nowUs> <frame> <zoneCount>
+            //   #PPPF-ZONE <id> <name> <count> <minUs> <avgUs> <maxUs> <p99Us>
+            //   #PPPF-EVENTS <count>
+            //   #PPPF-EV <event>... (up to 8 per line, each is hex startUs:8 durationUs:8 frame:4 zone:2 depth:2)
+            //   #PPPF-END
+            printf("#PPPF-BEGIN %lu %u %u\n", (unsigned long)time_us_32(), (unsigned)Frame, (unsigned)ZoneCount);
+            for (uint8_t i = 0; i < ZoneCount; i++)
+            {
+                const ZoneStats& stats = Zones[i];
+                uint32_t avg = stats.Count ? (uint32_t)(stats.TotalUs / stats.Count) : 0;
+                printf("#PPPF-ZONE %u %s %lu %lu %lu %lu %lu\n", (unsigned)i, stats.Name, (unsigned long)stats.Count,
+                    (unsigned long)(stats.Count ? stats.MinUs : 0), (unsigned long)avg, (unsigned long)stats.MaxUs, (unsigned long)GetPercentile(i, 0.99f));
+            }
+
+            if (includeEvents)
+            {
+                // Snapshot the ring under the lock one event at a time; events keep flowing while we print.
+                uint32_t head = EventHead;
+                uint32_t count = head < PROFILER_EVENT_CAPACITY ? head : PROFILER_EVENT_CAPACITY;
+                printf("#PPPF-EVENTS %lu\n", (unsigned long)count);
+                spin_lock_t* lock = GetLock();
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    uint32_t irq = spin_lock_blocking(lock);
+                    ZoneEvent event = Events[(head - count + i) % PROFILER_EVENT_CAPACITY];
+                    spin_unlock(lock, irq);
+
+                    if (i % 8 == 0)
+                        printf("#PPPF-EV ");
+                    printf("%08lx%08lx%04x%02x%02x", (unsigned long)event.StartUs, (unsigned long)event.DurationUs, (unsigned)event.Frame, (unsigned)event.Zone, (unsigned)event.Depth);
+                    if (i % 8 == 7 || i == count - 1)
+                        putchar('\n');
+                    else
+                        putchar(' ');
+                }
+            }
+            printf("#PPPF-END\n");
+
+            spin_lock_t* lock = GetLock();
+            uint32_t irq = spin_lock_blocking(lock);
+            for (uint8_t i = 0; i < ZoneCount; i++)
+                ResetStats(&Zones[i]);
+            spin_unlock(lock, irq);
+        }
+
+        ScopedZone::ScopedZone(ZoneId zone)
+         : StartUs(time_us_32()), Zone(zone), Depth(Profiler::Depth[get_core_num()]++)
+        {
+        }
+
+        ScopedZone::~ScopedZone()
+        {
+            uint32_t duration = time_us_32() - StartUs;
+            Profiler::Depth[get_core_num()]--;
+            RecordZone(Zone, StartUs, duration, Depth);
+        }
+    }
+}
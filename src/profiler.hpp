@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+
+// Maximum number of distinct named zones (frame phases included).
+#ifndef PROFILER_MAX_ZONES
+    #define PROFILER_MAX_ZONES 16
+#endif
+
+// Number of zone events kept for timeline export. Older events are overwritten.
+#ifndef PROFILER_EVENT_CAPACITY
+    #define PROFILER_EVENT_CAPACITY 256
+#endif
+
+// How often EndFrame() dumps stats over serial, in milliseconds. 0 (the default) disables periodic dumps: a dump is
+// ~20 KB of printf and hitches the frame it lands in, so the menu dumps on demand ('f') and after each game instead.
+#ifndef PROFILER_DUMP_INTERVAL_MS
+    #define PROFILER_DUMP_INTERVAL_MS 0
+#endif
+
+// Histogram buckets per zone, used for the p99. Values past the last bucket (~260 ms) are clamped into it.
+#define PROFILER_HISTOGRAM_BUCKETS 68
+
+namespace PicoPixel
+{
+    namespace Profiler
+    {
+        using ZoneId = uint8_t;
+
+        // Stats for one zone over the current dump window. Reset by Dump().
+        struct ZoneStats
+        {
+            const char* Name;
+            uint32_t Count;
+            uint32_t MinUs;
+            uint32_t MaxUs;
+            uint64_t TotalUs;
+            uint16_t Histogram[PROFILER_HISTOGRAM_BUCKETS];
+        };
+
+        // A single timed zone in the ring. Depth is the nesting level, used to rebuild call stacks on the host.
+        struct ZoneEvent
+        {
+            uint32_t StartUs;
+            uint32_t DurationUs;
+            uint16_t Frame;
+            ZoneId Zone;
+            uint8_t Depth;
+        };
+
+        // Returns the id for a zone name, registering it if needed. Names must be string literals (the pointer is kept).
+        ZoneId RegisterZone(const char* name);
+
+        void BeginFrame();
+        void EndFrame();
+
+        void RecordZone(ZoneId zone, uint32_t startUs, uint32_t durationUs, uint8_t depth);
+
+        const ZoneStats* GetZoneStats(ZoneId zone);
+        uint8_t GetZoneCount();
+
+        // Duration (in microseconds) below which the given fraction of samples fall, e.g. 0.99f for the p99.
+        uint32_t GetPercentile(ZoneId zone, float fraction);
+
+        // Duration of the last completed frame, in microseconds.
+        uint32_t GetLastFrameUs();
+
+        // Write zone stats (and optionally the event ring) as "#PPPF" lines for tools/profile_decode.py, then reset the stats.
+        void Dump(bool includeEvents = true);
+
+        // Times the enclosing scope and records it against a zone.
+        class ScopedZone
+        {
+        public:
+            ScopedZone(ZoneId zone);
+            ~ScopedZone();
+
+        private:
+            uint32_t StartUs;
+            ZoneId Zone;
+            uint8_t Depth;
+        };
+    }
+}
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+#ifdef PROFILING
+    // Time the rest of the enclosing scope under the given name.
+    #define PROFILE_ZONE(name) \
+        static const PicoPixel::Profiler::ZoneId PROFILER_CONCAT(ProfileZoneId_, __LINE__) = PicoPixel::Profiler::RegisterZone(name); \
+        PicoPixel::Profiler::ScopedZone PROFILER_CONCAT(ProfileZone_, __LINE__)(PROFILER_CONCAT(ProfileZoneId_, __LINE__))
+    #define PROFILE_BEGIN_FRAME() PicoPixel::Profiler::BeginFrame()
+    #define PROFILE_END_FRAME() PicoPixel::Profiler::EndFrame()
+#else
+    #define PROFILE_ZONE(name)
+    #define PROFILE_BEGIN_FRAME()
+    #define PROFILE_END_FRAME()
+#endif
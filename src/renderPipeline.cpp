@@ -0,0 +1,137 @@
+#include "renderPipeline.hpp"
+#include "profiler.hpp"
+#include "graphics/perfOverlay.hpp"
+#include "input/input.hpp"
+
+#ifdef PIPELINED_RENDER
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#endif
+
+namespace PicoPixel
+{
+    namespace RenderPipeline
+    {
+        // Written by whichever core presents, read by core0 for the overlay. A torn read can't happen on a 32-bit value.
+        static volatile uint32_t LastPresentUs = 0;
+
+        // Newest input the frame being rendered consumed. Set before the frame is handed to core1, which only reads it
+        // after the hand-off.
+        static uint64_t FrameInputUs = 0;
+
+        void RenderAndPresent(Games::GameLoop* loop, Driver::Ili9341Data* display, Driver::Buffer* buffer)
+        {
+            {
+                PROFILE_ZONE("Render");
+                loop->Render();
+#ifdef PERF_OVERLAY
+                Graphics::PerfOverlay::Draw(buffer);
+#endif
+            }
+            {
+                PROFILE_ZONE("Present");
+                uint64_t presentStart = time_us_64();
+                Driver::DrawBuffer(display, 0, 0, buffer);
+                uint64_t presentEnd = time_us_64();
+                LastPresentUs = (uint32_t)(presentEnd - presentStart);
+                Input::RecordLatency(FrameInputUs, presentEnd);
+            }
+        }
+
+        uint32_t GetLastPresentUs()
+        {
+            return LastPresentUs;
+        }
+
+        static Games::GameLoop* Loop = nullptr;
+        static Driver::Ili9341Data* Display = nullptr;
+        static Driver::Buffer* Target = nullptr;
+
+#ifdef PIPELINED_RENDER
+        enum Message : uint32_t
+        {
+            MESSAGE_STOP = 0,
+            MESSAGE_RENDER = 1,
+            MESSAGE_DONE = 2,
+        };
+
+        static bool UseCore1 = false;
+        static bool FramePending = false;
+
+        static void Core1Main()
+        {
+            while (multicore_fifo_pop_blocking() == MESSAGE_RENDER)
+            {
+                RenderAndPresent(Loop, Display, Target);
+                multicore_fifo_push_blocking(MESSAGE_DONE);
+            }
+        }
+
+        static void WaitForFrame()
+        {
+            if (FramePending)
+                multicore_fifo_pop_blocking();
+            FramePending = false;
+        }
+#endif
+
+        void Start(Games::GameLoop* loop, Driver::Ili9341Data* display, Driver::Buffer* buffer)
+        {
+            Loop = loop;
+            Display = display;
+            Target = buffer;
+
+#ifdef PIPELINED_RENDER
+            UseCore1 = loop->CanPipeline();
+            FramePending = false;
+            if (UseCore1)
+            {
+                multicore_reset_core1();
+                multicore_fifo_drain();
+                multicore_launch_core1(Core1Main);
+            }
+#endif
+        }
+
+        void Submit(uint64_t inputUs)
+        {
+#ifdef PIPELINED_RENDER
+            if (UseCore1)
+            {
+                WaitForFrame();
+                FrameInputUs = inputUs;
+                Loop->Publish();
+                __dmb(); // Published state must be visible before core1 starts reading it.
+                multicore_fifo_push_blocking(MESSAGE_RENDER);
+                FramePending = true;
+                return;
+            }
+#endif
+            FrameInputUs = inputUs;
+            Loop->Publish();
+            RenderAndPresent(Loop, Display, Target);
+        }
+
+        void Flush()
+        {
+#ifdef PIPELINED_RENDER
+            if (UseCore1)
+                WaitForFrame();
+#endif
+        }
+
+        void Stop()
+        {
+#ifdef PIPELINED_RENDER
+            if (UseCore1)
+            {
+                WaitForFrame();
+                multicore_fifo_push_blocking(MESSAGE_STOP);
+                multicore_reset_core1();
+                UseCore1 = false;
+            }
+#endif
+            Loop = nullptr;
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "drivers/display/ili9341.hpp"
+#include "games/gameLoop.hpp"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    // Renders and presents frames, either inline on core0 or, with PIPELINED_RENDER, on core1 while core0 simulates
+    // the next frame. The game only ever renders state published at the sync point, so both paths draw identical frames.
+    namespace RenderPipeline
+    {
+        // Render the last published state (plus the perf overlay) and send it to the display.
+        void RenderAndPresent(Games::GameLoop* loop, Driver::Ili9341Data* display, Driver::Buffer* buffer);
+
+        // Set up for a game session. Launches core1 as the render core when built with PIPELINED_RENDER
+        // and the game supports it (GameLoop::CanPipeline()).
+        void Start(Games::GameLoop* loop, Driver::Ili9341Data* display, Driver::Buffer* buffer);
+
+        // Sync point after each frame's update. Pipelined: wait for core1 to finish the previous frame, publish the
+        // current state and hand it over. Otherwise: publish, render and present inline.
+        // inputUs is the timestamp of the newest input event the frame consumed (0 for none); once the frame is out,
+        // the time since then is recorded as input-to-photon latency (Input::RecordLatency()).
+        void Submit(uint64_t inputUs = 0);
+
+        // Wait for a frame still being rendered or presented on core1 (if any), e.g. before touching the clocks.
+        void Flush();
+
+        // Wait for the last frame to finish and stop core1.
+        void Stop();
+
+        // Time spent in DrawBuffer for the last presented frame, in microseconds.
+        uint32_t GetLastPresentUs();
+    }
+}
@@ -0,0 +1,388 @@
+#include "replay.hpp"
+#include "log.hpp"
+#include "memory/accounting.hpp"
+#include "pico/stdlib.h"
+#include "utils/random.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace PicoPixel
+{
+    namespace Replay
+    {
+        static constexpr char MAGIC[4] = { 'P', 'P', 'R', 'P' };
+        static constexpr uint8_t VERSION = 2;     // 2: input events.
+        static constexpr uint8_t MAX_CHANNELS = 8;
+        static constexpr size_t NAME_SIZE = 24;
+
+        enum Tag : uint8_t
+        {
+            TAG_END = 0x00,
+            TAG_FRAME = 0x01,
+            TAG_INPUT = 0x02,
+            TAG_EVENT = 0x03,
+        };
+
+        struct Header
+        {
+            char Magic[4];
+            uint8_t Version;
+            uint8_t Reserved[3];
+            uint64_t Seed;
+            char GameName[NAME_SIZE];
+        };
+
+        static Mode CurrentMode = Mode::Off;
+        static FILE* File = nullptr;
+        static uint8_t Buffer[REPLAY_BUFFER_SIZE];
+        static size_t BufferUsed = 0;   // Recording: bytes waiting to be written. Replaying: bytes in Buffer.
+        static size_t BufferRead = 0;   // Replaying: next byte to consume.
+        static bool Finished = false;
+        static bool Diverged = false;
+        static uint16_t LastValue[MAX_CHANNELS];
+        static uint32_t FileHeapBytes = 0;  // Heap newlib and littlefs hold for the open file, counted as Filesystem.
+
+        // Count whatever the heap grew by since heapBefore against the open file. Measured after the first read or
+        // write, since stdio only allocates the file's buffer then.
+        static void TrackFileHeap(uint32_t heapBefore)
+        {
+            uint32_t heapAfter = Memory::GetHeapUsed();
+            FileHeapBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+            Memory::TrackAllocation(Memory::Tag::Filesystem, FileHeapBytes);
+        }
+
+        static void CloseFile()
+        {
+            fclose(File);
+            File = nullptr;
+            Memory::TrackFree(Memory::Tag::Filesystem, FileHeapBytes);
+            FileHeapBytes = 0;
+        }
+
+        // --- Writing ---
+
+        static void Flush()
+        {
+            if (BufferUsed && File)
+                fwrite(Buffer, 1, BufferUsed, File);
+            BufferUsed = 0;
+        }
+
+        static void WriteByte(uint8_t byte)
+        {
+            if (BufferUsed == sizeof(Buffer))
+                Flush();
+            Buffer[BufferUsed++] = byte;
+        }
+
+        static void WriteVarint(uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                WriteByte((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            WriteByte((uint8_t)value);
+        }
+
+        // --- Reading ---
+
+        static bool ReadByte(uint8_t& byte)
+        {
+            if (BufferRead == BufferUsed)
+            {
+                BufferUsed = File ? fread(Buffer, 1, sizeof(Buffer), File) : 0;
+                BufferRead = 0;
+                if (BufferUsed == 0)
+                    return false;
+            }
+            byte = Buffer[BufferRead++];
+            return true;
+        }
+
+        static bool ReadVarint(uint32_t& value)
+        {
+            value = 0;
+            for (uint8_t shift = 0; shift < 35; shift += 7)
+            {
+                uint8_t byte;
+                if (!ReadByte(byte))
+                    return false;
+                value |= (uint32_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        static uint32_t ZigZag(int32_t value)
+        {
+            return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+        }
+
+        static int32_t UnZigZag(uint32_t value)
+        {
+            return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+        }
+
+        // The record's tag has been read. False if the file ends inside it.
+        static bool ReadEvent(Input::Event& event)
+        {
+            uint8_t type;
+            uint32_t value;
+            if (!ReadByte(type) || !ReadByte(event.Code) || !ReadVarint(value))
+                return false;
+            event.Type = (Input::EventType)type;
+            event.Value = (uint16_t)value;
+            return true;
+        }
+
+        // The next unread byte, without consuming it. False at the end of the file.
+        static bool PeekByte(uint8_t& byte)
+        {
+            if (BufferRead == BufferUsed)
+            {
+                if (!ReadByte(byte))
+                    return false;
+                BufferRead--;
+            }
+            byte = Buffer[BufferRead];
+            return true;
+        }
+
+        static void Reset()
+        {
+            BufferUsed = 0;
+            BufferRead = 0;
+            Finished = false;
+            Diverged = false;
+            memset(LastValue, 0, sizeof(LastValue));
+        }
+
+        bool StartRecording(const char* path, const char* gameName)
+        {
+            Stop();
+
+            uint32_t heapBefore = Memory::GetHeapUsed();
+            File = fopen(path, "wb");
+            if (!File)
+            {
+                LOG_ERROR("Replay: Could not open %s for recording\n", path);
+                return false;
+            }
+
+            // A fresh seed per session, taken from the running generator so consecutive sessions differ.
+            uint64_t seed = ((uint64_t)Utils::DefaultStream().Next() << 32) | Utils::DefaultStream().Next();
+            Utils::SeedRand(seed);
+
+            Header header = {};
+            memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+            header.Version = VERSION;
+            header.Seed = seed;
+            strncpy(header.GameName, gameName, NAME_SIZE - 1);
+            fwrite(&header, sizeof(header), 1, File);
+            TrackFileHeap(heapBefore);
+
+            Reset();
+            CurrentMode = Mode::Recording;
+            LOG("Replay: Recording %s to %s\n", gameName, path);
+            return true;
+        }
+
+        bool StartReplay(const char* path, char* gameName, size_t gameNameSize)
+        {
+            Stop();
+
+            uint32_t heapBefore = Memory::GetHeapUsed();
+            File = fopen(path, "rb");
+            if (!File)
+                return false;
+
+            Header header;
+            bool valid = fread(&header, sizeof(header), 1, File) == 1;
+            TrackFileHeap(heapBefore);
+            if (!valid || memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0 || header.Version != VERSION)
+            {
+                LOG_ERROR("Replay: %s is not a version %d recording\n", path, VERSION);
+                CloseFile();
+                return false;
+            }
+
+            header.GameName[NAME_SIZE - 1] = '\0';
+            if (gameName && gameNameSize)
+            {
+                strncpy(gameName, header.GameName, gameNameSize - 1);
+                gameName[gameNameSize - 1] = '\0';
+            }
+
+            Utils::SeedRand(header.Seed);
+
+            Reset();
+            CurrentMode = Mode::Replaying;
+            LOG("Replay: Playing back %s from %s\n", header.GameName, path);
+            return true;
+        }
+
+        void Stop()
+        {
+            if (CurrentMode == Mode::Recording)
+            {
+                WriteByte(TAG_END);
+                Flush();
+            }
+            if (File)
+                CloseFile();
+            CurrentMode = Mode::Off;
+        }
+
+        Mode GetMode()
+        {
+            return CurrentMode;
+        }
+
+        bool IsFinished()
+        {
+            return CurrentMode == Mode::Replaying && Finished;
+        }
+
+        float FrameDelta(float liveDt)
+        {
+            if (CurrentMode == Mode::Recording)
+            {
+                uint32_t dtUs = liveDt > 0.0f ? (uint32_t)(liveDt * 1e6f + 0.5f) : 0;
+                WriteByte(TAG_FRAME);
+                WriteVarint(dtUs);
+                return dtUs / 1e6f;
+            }
+
+            if (CurrentMode == Mode::Replaying)
+            {
+                // Skip any input the game didn't consume last frame so frames stay aligned.
+                uint8_t tag;
+                while (!Finished && ReadByte(tag))
+                {
+                    if (tag == TAG_FRAME)
+                    {
+                        uint32_t dtUs;
+                        if (!ReadVarint(dtUs))
+                            break;
+                        return dtUs / 1e6f;
+                    }
+                    if (tag == TAG_EVENT)
+                    {
+                        Input::Event event;
+                        if (!ReadEvent(event))
+                            break;
+                        if (!Diverged)
+                        {
+                            Diverged = true;
+                            LOG_WARN("Replay: Game was handed fewer input events than were recorded, playback may diverge\n");
+                        }
+                        continue;
+                    }
+                    if (tag != TAG_INPUT)
+                        break;
+
+                    uint8_t channel;
+                    uint32_t delta;
+                    if (!ReadByte(channel) || !ReadVarint(delta))
+                        break;
+                    if (channel < MAX_CHANNELS)
+                        LastValue[channel] = (uint16_t)(LastValue[channel] + UnZigZag(delta));
+                    if (!Diverged)
+                    {
+                        Diverged = true;
+                        LOG_WARN("Replay: Game read fewer inputs than were recorded, playback may diverge\n");
+                    }
+                }
+                Finished = true;
+                return 0.0f;
+            }
+
+            return liveDt;
+        }
+
+        bool ReplayInput(uint8_t channel, uint16_t& value)
+        {
+            if (CurrentMode != Mode::Replaying)
+                return false;
+
+            channel = channel < MAX_CHANNELS ? channel : MAX_CHANNELS - 1;
+            value = LastValue[channel];
+            if (Finished)
+                return true;
+
+            // Peek: input records for this frame come before the next frame record.
+            uint8_t tag;
+            if (!PeekByte(tag))
+            {
+                Finished = true;
+                return true;
+            }
+            if (tag != TAG_INPUT)
+            {
+                if (!Diverged)
+                {
+                    Diverged = true;
+                    LOG_WARN("Replay: Game read more inputs than were recorded, playback may diverge\n");
+                }
+                return true;
+            }
+            BufferRead++;
+
+            uint8_t recordedChannel;
+            uint32_t delta;
+            if (!ReadByte(recordedChannel) || !ReadVarint(delta))
+            {
+                Finished = true;
+                return true;
+            }
+            if (recordedChannel < MAX_CHANNELS)
+                LastValue[recordedChannel] = (uint16_t)(LastValue[recordedChannel] + UnZigZag(delta));
+            value = LastValue[recordedChannel < MAX_CHANNELS ? recordedChannel : channel];
+            return true;
+        }
+
+        void RecordEvent(const Input::Event& event)
+        {
+            if (CurrentMode != Mode::Recording)
+                return;
+
+            WriteByte(TAG_EVENT);
+            WriteByte((uint8_t)event.Type);
+            WriteByte(event.Code);
+            WriteVarint(event.Value);
+        }
+
+        bool ReplayEvent(Input::Event& event)
+        {
+            if (CurrentMode != Mode::Replaying || Finished)
+                return false;
+
+            // A frame's events come straight after its dt.
+            uint8_t tag;
+            if (!PeekByte(tag) || tag != TAG_EVENT)
+                return false;
+            BufferRead++;
+            if (!ReadEvent(event))
+            {
+                Finished = true;
+                return false;
+            }
+            event.TimeUs = time_us_64();
+            return true;
+        }
+
+        void RecordInput(uint8_t channel, uint16_t value)
+        {
+            if (CurrentMode != Mode::Recording)
+                return;
+
+            channel = channel < MAX_CHANNELS ? channel : MAX_CHANNELS - 1;
+            WriteByte(TAG_INPUT);
+            WriteByte(channel);
+            WriteVarint(ZigZag((int32_t)value - (int32_t)LastValue[channel]));
+            LastValue[channel] = value;
+        }
+    }
+}
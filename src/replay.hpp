@@ -0,0 +1,67 @@
+#pragma once
+
+#include "input/input.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Where the menu records sessions (REPLAY_RECORD) and where the boot benchmarks look for one to play back.
+#ifndef REPLAY_PATH
+    #define REPLAY_PATH "/replay.ppr"
+#endif
+
+// Bytes buffered in RAM before each write to the file.
+#ifndef REPLAY_BUFFER_SIZE
+    #define REPLAY_BUFFER_SIZE 256
+#endif
+
+namespace PicoPixel
+{
+    // Record/replay of everything that makes a game session non-deterministic: the RNG seed, every frame's dt, every
+    // input event the game was handed and every input sample. A replayed session runs the exact same simulation, so
+    // timings can be compared across builds.
+    //
+    // File layout (little endian): "PPRP", version, 3 reserved bytes, 64-bit seed, 24-byte game name, then records:
+    //   0x01 varint dtUs                         one per frame
+    //   0x03 type code varint value              one per input event passed to Game::OnInput(), after its frame's dt
+    //   0x02 channel zigzag-varint delta         one per input sample, delta against the channel's previous sample
+    //   0x00                                     end of recording
+    // Files are opened with stdio, so this is littlefs on the device (pico-vfs) and a plain file on the host.
+    namespace Replay
+    {
+        enum class Mode : uint8_t
+        {
+            Off,
+            Recording,
+            Replaying,
+        };
+
+        // Re-seeds the RNG with a fresh seed and records it. Call before the game's OnInit().
+        bool StartRecording(const char* path, const char* gameName);
+
+        // Re-seeds the RNG from the file and copies the recorded game name. Call before the game's OnInit().
+        bool StartReplay(const char* path, char* gameName, size_t gameNameSize);
+
+        // Flushes and closes the file.
+        void Stop();
+
+        Mode GetMode();
+
+        // True once a replay has consumed every recorded frame.
+        bool IsFinished();
+
+        // Call once per frame with the measured dt. Returns the dt the game should use: the recorded one when replaying,
+        // or the live one rounded to the microsecond it was stored as when recording.
+        float FrameDelta(float liveDt);
+
+        // Input events for Game::OnInput(). Pass each event to RecordEvent() as the game gets it. While replaying,
+        // ReplayEvent() hands out the current frame's recorded events instead (stamped with the time they are replayed
+        // at), returning false after the last one; call it after FrameDelta() until it does.
+        void RecordEvent(const Input::Event& event);
+        bool ReplayEvent(Input::Event& event);
+
+        // Input hooks for drivers. ReplayInput() returns true and the recorded value while replaying;
+        // otherwise the driver reads the hardware and passes the sample to RecordInput().
+        bool ReplayInput(uint8_t channel, uint16_t& value);
+        void RecordInput(uint8_t channel, uint16_t value);
+    }
+}
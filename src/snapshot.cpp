@@ -0,0 +1,286 @@
+#include "snapshot.hpp"
+#include "log.hpp"
+#include "games/game.hpp"
+#include "memory/accounting.hpp"
+#include "utils/crc.hpp"
+#include "pico/stdlib.h"
+#include <cstdio>
+
+namespace PicoPixel
+{
+    namespace Snapshot
+    {
+        static constexpr char MAGIC[4] = { 'P', 'P', 'S', 'N' };
+        static constexpr uint8_t FORMAT_VERSION = 1;
+        static constexpr size_t NAME_SIZE = 24;
+        static constexpr size_t PATH_SIZE = 48;
+
+        struct Header
+        {
+            char Magic[4];
+            uint8_t FormatVersion;
+            uint8_t Reserved;
+            uint16_t GameVersion;
+            char GameName[NAME_SIZE];
+            uint32_t PayloadSize;
+            uint32_t Crc;
+        };
+
+        // The snapshot waiting to be written: header and payload in one heap block.
+        static uint8_t* Blob = nullptr;
+        static size_t BlobSize = 0;
+        static size_t BlobWritten = 0;
+        static char BlobName[NAME_SIZE];
+        static FILE* File = nullptr;
+        static uint32_t FileHeapBytes = 0;  // Heap littlefs holds for the open file, counted as Filesystem.
+
+        static void GetPath(char* path, const char* name, bool temporary)
+        {
+            int length = snprintf(path, PATH_SIZE, SNAPSHOT_PATH_FORMAT, name);
+            if (temporary && length > 0 && length + 4 < (int)PATH_SIZE)
+                strcpy(path + length, ".tmp");
+        }
+
+        static void CloseFile()
+        {
+            fclose(File);
+            File = nullptr;
+            Memory::TrackFree(Memory::Tag::Filesystem, FileHeapBytes);
+            FileHeapBytes = 0;
+        }
+
+        static void DropBlob()
+        {
+            Memory::Free(Blob);
+            Blob = nullptr;
+            BlobSize = 0;
+            BlobWritten = 0;
+        }
+
+        // Delete a game's snapshot, including one still waiting to be written.
+        static void Discard(const char* name)
+        {
+            char path[PATH_SIZE];
+            if (Blob && strncmp(BlobName, name, NAME_SIZE) == 0)
+            {
+                if (File)
+                {
+                    CloseFile();
+                    GetPath(path, name, true);
+                    remove(path);
+                }
+                DropBlob();
+            }
+            GetPath(path, name, false);
+            remove(path);
+        }
+
+        // Checks everything in a snapshot except the payload, which isn't loaded yet when reading from a file.
+        static bool IsCompatible(const Header& header, const Games::Game* game, const char* name)
+        {
+            uint16_t version = game->GetSnapshotVersion();
+            return memcmp(header.Magic, MAGIC, sizeof(MAGIC)) == 0
+                && header.FormatVersion == FORMAT_VERSION
+                && header.GameVersion != 0 && header.GameVersion <= version
+                && strncmp(header.GameName, name, NAME_SIZE) == 0;
+        }
+
+        bool Save(Games::Game* game, const char* name)
+        {
+            uint16_t version = game->GetSnapshotVersion();
+            if (version == 0)
+                return false;
+
+            // One snapshot in flight at a time.
+            Flush();
+
+            uint64_t start = time_us_64();
+            Writer sizing;
+            game->OnSaveSnapshot(sizing);
+            size_t payloadSize = sizing.GetSize();
+            uint8_t* blob = (uint8_t*)Memory::Allocate(Memory::Tag::Filesystem, sizeof(Header) + payloadSize);
+            if (!blob)
+            {
+                LOG_ERROR("Snapshot: Not enough memory to save %s (%zu bytes)\n", name, payloadSize);
+                return false;
+            }
+
+            Writer writer(blob + sizeof(Header), payloadSize);
+            game->OnSaveSnapshot(writer);
+            if (writer.HasFailed() || writer.GetSize() != payloadSize)
+            {
+                LOG_ERROR("Snapshot: %s wrote a different amount of state the second time\n", name);
+                Memory::Free(blob);
+                return false;
+            }
+
+            Header header = {};
+            memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+            header.FormatVersion = FORMAT_VERSION;
+            header.GameVersion = version;
+            strncpy(header.GameName, name, NAME_SIZE - 1);
+            header.PayloadSize = (uint32_t)payloadSize;
+            header.Crc = Utils::Crc32(blob + sizeof(Header), payloadSize);
+            memcpy(blob, &header, sizeof(header));
+
+            Blob = blob;
+            BlobSize = sizeof(Header) + payloadSize;
+            BlobWritten = 0;
+            memcpy(BlobName, header.GameName, NAME_SIZE);
+            LOG("Snapshot: Saved %s (%zu bytes) in %lu us, writing in the background\n", name, BlobSize,
+                (unsigned long)(time_us_64() - start));
+            return true;
+        }
+
+        RestoreResult Restore(Games::Game* game, const char* name)
+        {
+            if (game->GetSnapshotVersion() == 0)
+                return RestoreResult::None;
+
+            uint64_t start = time_us_64();
+            const uint8_t* blob = nullptr;
+            uint8_t* loaded = nullptr;
+            char path[PATH_SIZE];
+            GetPath(path, name, false);
+
+            if (Blob && strncmp(BlobName, name, NAME_SIZE) == 0)
+            {
+                // Still on its way to flash, and the RAM copy is the newest anyway.
+                blob = Blob;
+            }
+            else
+            {
+                FILE* file = fopen(path, "rb");
+                if (!file)
+                    return RestoreResult::None;
+
+                Header header;
+                bool valid = fread(&header, sizeof(header), 1, file) == 1 && IsCompatible(header, game, name);
+                if (valid)
+                {
+                    loaded = (uint8_t*)Memory::Allocate(Memory::Tag::Filesystem, sizeof(Header) + header.PayloadSize);
+                    valid = loaded && fread(loaded + sizeof(Header), 1, header.PayloadSize, file) == header.PayloadSize;
+                    if (loaded)
+                        memcpy(loaded, &header, sizeof(header));
+                }
+                fclose(file);
+                blob = loaded;
+                if (!valid)
+                {
+                    LOG_WARN("Snapshot: %s is unreadable or from an incompatible version, discarding it\n", path);
+                    Memory::Free(loaded);
+                    Discard(name);
+                    return RestoreResult::None;
+                }
+            }
+
+            Header header;
+            memcpy(&header, blob, sizeof(header));
+            const uint8_t* payload = blob + sizeof(Header);
+            if (!IsCompatible(header, game, name) || Utils::Crc32(payload, header.PayloadSize) != header.Crc)
+            {
+                LOG_WARN("Snapshot: %s failed its checksum, discarding it\n", path);
+                Memory::Free(loaded);
+                Discard(name);
+                return RestoreResult::None;
+            }
+
+            Reader reader(payload, header.PayloadSize);
+            bool restored = game->OnLoadSnapshot(reader, header.GameVersion) && !reader.HasFailed();
+            Memory::Free(loaded);
+            if (!restored)
+            {
+                LOG_WARN("Snapshot: %s rejected its snapshot, discarding it\n", name);
+                Discard(name);
+                return RestoreResult::Failed;
+            }
+
+            LOG("Snapshot: Restored %s (%lu bytes, version %u) in %lu us\n", name, (unsigned long)header.PayloadSize,
+                header.GameVersion, (unsigned long)(time_us_64() - start));
+            return RestoreResult::Restored;
+        }
+
+        void Service(uint32_t budgetUs)
+        {
+            if (!Blob)
+                return;
+
+            uint64_t start = time_us_64();
+            char path[PATH_SIZE];
+            GetPath(path, BlobName, true);
+            if (!File)
+            {
+                uint32_t heapBefore = Memory::GetHeapUsed();
+                File = fopen(path, "wb");
+                if (!File)
+                {
+                    LOG_ERROR("Snapshot: Could not open %s for writing\n", path);
+                    DropBlob();
+                    return;
+                }
+                // The blob already is the buffer; stdio would only copy it again.
+                setvbuf(File, nullptr, _IONBF, 0);
+                uint32_t heapAfter = Memory::GetHeapUsed();
+                FileHeapBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+                Memory::TrackAllocation(Memory::Tag::Filesystem, FileHeapBytes);
+            }
+
+            // Most chunks only fill littlefs's cache and cost microseconds. The one that crosses into a new block
+            // pays for a flash erase, which can't be split, so a frame can still go over by one erase.
+            do
+            {
+                size_t chunk = BlobSize - BlobWritten < SNAPSHOT_CHUNK_SIZE ? BlobSize - BlobWritten : SNAPSHOT_CHUNK_SIZE;
+                if (fwrite(Blob + BlobWritten, 1, chunk, File) != chunk)
+                {
+                    LOG_ERROR("Snapshot: Writing %s failed, keeping the previous snapshot\n", path);
+                    CloseFile();
+                    remove(path);
+                    DropBlob();
+                    return;
+                }
+                BlobWritten += chunk;
+            } while (BlobWritten < BlobSize && time_us_64() - start < budgetUs);
+
+            if (BlobWritten < BlobSize)
+                return;
+
+            CloseFile();
+            char finalPath[PATH_SIZE];
+            GetPath(finalPath, BlobName, false);
+            if (rename(path, finalPath) != 0)
+            {
+                LOG_ERROR("Snapshot: Could not move %s into place\n", path);
+                remove(path);
+            }
+            else
+            {
+                LOG("Snapshot: Wrote %s (%zu bytes)\n", finalPath, BlobSize);
+            }
+            DropBlob();
+        }
+
+        void Flush()
+        {
+            while (Blob)
+                Service(UINT32_MAX);
+        }
+
+        bool IsWriting()
+        {
+            return Blob != nullptr;
+        }
+
+        bool Exists(const char* name)
+        {
+            if (Blob && strncmp(BlobName, name, NAME_SIZE) == 0)
+                return true;
+
+            char path[PATH_SIZE];
+            GetPath(path, name, false);
+            FILE* file = fopen(path, "rb");
+            if (file)
+                fclose(file);
+            return file != nullptr;
+        }
+    }
+}
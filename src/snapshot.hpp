@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Where a game's snapshot is kept; %s is the game's registered name.
+#ifndef SNAPSHOT_PATH_FORMAT
+    #define SNAPSHOT_PATH_FORMAT "/%s.pps"
+#endif
+
+// Bytes handed to the filesystem per write while a snapshot is being saved.
+#ifndef SNAPSHOT_CHUNK_SIZE
+    #define SNAPSHOT_CHUNK_SIZE 512
+#endif
+
+// How long Service() may spend writing per call, in microseconds.
+#ifndef SNAPSHOT_SERVICE_BUDGET_US
+    #define SNAPSHOT_SERVICE_BUDGET_US 2000
+#endif
+
+namespace PicoPixel
+{
+    namespace Games
+    {
+        class Game;
+    }
+
+    // Instant resume: the menu saves the running game into a snapshot when leaving it and restores it the next time
+    // the game is launched, instead of starting over.
+    //
+    // Games opt in with Game::GetSnapshotVersion() and write/read their own state with a Writer/Reader. The blob is
+    // built in RAM in one go (the game arena is reset right after) and then written out a chunk at a time by
+    // Service(), which the menu calls once per frame, so saving never stalls a frame for the length of the write.
+    // The file is written under a temporary name and renamed into place, so a power cut mid-write leaves the
+    // previous snapshot intact.
+    //
+    // File layout (little endian): "PPSN", format version, reserved byte, 16-bit game version, 24-byte game name,
+    // 32-bit payload size, CRC-32 of the payload, then the payload. Files are opened with stdio, like Replay.
+    namespace Snapshot
+    {
+        // Appends a game's state to a snapshot. Constructed without storage it only counts bytes, which is how Save()
+        // sizes the blob before allocating it.
+        class Writer
+        {
+        public:
+            Writer() = default;
+            Writer(uint8_t* data, size_t capacity)
+             : Data(data), Capacity(capacity)
+            {
+            }
+
+            template<typename T>
+            void Write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Snapshots store raw bytes");
+                WriteBytes(&value, sizeof(T));
+            }
+
+            template<typename T>
+            void WriteArray(const T* values, size_t count)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Snapshots store raw bytes");
+                WriteBytes(values, count * sizeof(T));
+            }
+
+            void WriteBytes(const void* data, size_t size)
+            {
+                if (Data)
+                {
+                    if (Failed || size > Capacity - Size)
+                    {
+                        Failed = true;
+                        return;
+                    }
+                    memcpy(Data + Size, data, size);
+                }
+                Size += size;
+            }
+
+            size_t GetSize() const { return Size; }
+            bool HasFailed() const { return Failed; }
+
+        private:
+            uint8_t* Data = nullptr;
+            size_t Capacity = 0;
+            size_t Size = 0;
+            bool Failed = false;
+        };
+
+        // Reads a game's state back, in the order it was written. Reading past the end fails the whole restore.
+        class Reader
+        {
+        public:
+            Reader(const uint8_t* data, size_t size)
+             : Data(data), Size(size)
+            {
+            }
+
+            template<typename T>
+            bool Read(T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Snapshots store raw bytes");
+                return ReadBytes(&value, sizeof(T));
+            }
+
+            template<typename T>
+            bool ReadArray(T* values, size_t count)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Snapshots store raw bytes");
+                return ReadBytes(values, count * sizeof(T));
+            }
+
+            bool ReadBytes(void* data, size_t size)
+            {
+                if (Failed || size > Size - Position)
+                {
+                    Failed = true;
+                    return false;
+                }
+                memcpy(data, Data + Position, size);
+                Position += size;
+                return true;
+            }
+
+            size_t GetRemaining() const { return Size - Position; }
+            bool HasFailed() const { return Failed; }
+
+        private:
+            const uint8_t* Data;
+            size_t Size;
+            size_t Position = 0;
+            bool Failed = false;
+        };
+
+        enum class RestoreResult : uint8_t
+        {
+            None,       // No usable snapshot (or the game doesn't take them); the game is as OnInit() left it.
+            Restored,
+            Failed,     // The game rejected the snapshot part way through. Its state is undefined, start it over.
+        };
+
+        // Serialize the game and queue the blob for writing. Call while the game is still running, before
+        // OnShutdown(). Any snapshot still being written is finished first. Returns false if nothing was queued.
+        bool Save(Games::Game* game, const char* name);
+
+        // Load the game's snapshot, if there is one. Call after OnInit(). A snapshot that is still queued for writing
+        // is restored straight from RAM. Corrupt or incompatible snapshots are deleted.
+        RestoreResult Restore(Games::Game* game, const char* name);
+
+        // Write the queued snapshot for up to budgetUs. Call once per frame.
+        void Service(uint32_t budgetUs = SNAPSHOT_SERVICE_BUDGET_US);
+
+        // Finish writing the queued snapshot, blocking. Call before the flash or the display is powered down.
+        void Flush();
+
+        bool IsWriting();
+        bool Exists(const char* name);
+    }
+}
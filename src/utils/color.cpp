@@ -1,92 +1,113 @@
 #include "color.hpp"
-#include <array>
+#include <cstring>
 
 namespace PicoPixel
 {
     namespace Utils
     {
-// TODO: Move to CMake file as an option.
-#define SPEED_OPTIMIZATION
-#ifdef SPEED_OPTIMIZATION // (Uses more memory)
-
-        // Each lookup table: 256 entries × 2 bytes = 512 bytes
-        // Total: 3 tables × 512 bytes = 1,536 bytes (1.5 KB)?
-
-        // Generate lookup tables at compile time using constexpr functions
-        constexpr std::array<uint16_t, 256> make_r5_lookup()
+        // Word loads/stores through memcpy so unaligned buffers are safe. GCC turns these into single
+        // ldr/str instructions when the pointer is known to be aligned, and byte accesses otherwise.
+        static inline uint32_t LoadWord(const void* p)
         {
-            std::array<uint16_t, 256> arr{};
-            for (int i = 0; i < 256; i++)
-            {
-                arr[i] = ((i >> 3) << 11);
-            }
-            return arr;
+            uint32_t word;
+            memcpy(&word, p, sizeof(word));
+            return word;
         }
 
-        constexpr std::array<uint16_t, 256> make_g6_lookup()
+        static inline void StoreWord(void* p, uint32_t word)
         {
-            std::array<uint16_t, 256> arr{};
-            for (int i = 0; i < 256; i++)
-            {
-                arr[i] = ((i >> 2) << 5);
-            }
-            return arr;
+            memcpy(p, &word, sizeof(word));
         }
 
-        constexpr std::array<uint16_t, 256> make_b5_lookup()
+        // Little-endian packing: byte 0 of the word is the first channel.
+        static inline uint32_t Pack565(uint32_t r, uint32_t g, uint32_t b)
         {
-            std::array<uint16_t, 256> arr{};
-            for (int i = 0; i < 256; i++)
-            {
-                arr[i] = (i >> 3);
-            }
-            return arr;
+            return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
         }
 
-        static const auto r5_lookup = make_r5_lookup();
-        static const auto g6_lookup = make_g6_lookup();
-        static const auto b5_lookup = make_b5_lookup();
-
-        uint16_t RGBto16bit(uint8_t r, uint8_t g, uint8_t b)
-        {
-            // Ultra-fast lookup table conversion! Woo!
-            return r5_lookup[r] | g6_lookup[g] | b5_lookup[b];
-        }
-#else
-        uint16_t RGBto16bit(uint8_t r, uint8_t g, uint8_t b)
+        void RGB888toRGB565(const uint8_t* rgb, uint16_t* out, uint32_t count)
         {
-            // Fast bit manipulation
-            uint16_t r5 = r >> 3;   // 8-bit to 5-bit
-            uint16_t g6 = g >> 2;   // 8-bit to 6-bit
-            uint16_t b5 = b >> 3;   // 8-bit to 5-bit
+            // 4 pixels = 12 input bytes = 3 words in, 2 words out.
+            while (count >= 4)
+            {
+                uint32_t w0 = LoadWord(rgb);        // r0 g0 b0 r1
+                uint32_t w1 = LoadWord(rgb + 4);    // g1 b1 r2 g2
+                uint32_t w2 = LoadWord(rgb + 8);    // b2 r3 g3 b3
+
+                uint32_t p0 = Pack565(w0 & 0xFF, (w0 >> 8) & 0xFF, (w0 >> 16) & 0xFF);
+                uint32_t p1 = Pack565(w0 >> 24, w1 & 0xFF, (w1 >> 8) & 0xFF);
+                uint32_t p2 = Pack565((w1 >> 16) & 0xFF, w1 >> 24, w2 & 0xFF);
+                uint32_t p3 = Pack565((w2 >> 8) & 0xFF, (w2 >> 16) & 0xFF, w2 >> 24);
 
-            uint16_t res = (r5 << 11) | (g6 << 5) | b5;
+                StoreWord(out, p0 | (p1 << 16));
+                StoreWord(out + 2, p2 | (p3 << 16));
 
-            return res;
+                rgb += 12;
+                out += 4;
+                count -= 4;
+            }
+            while (count--)
+            {
+                *out++ = RGBto16bit(rgb[0], rgb[1], rgb[2]);
+                rgb += 3;
+            }
         }
-#endif
 
-        uint16_t RGBAto16bit(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+        static inline uint32_t RGBAWordTo565(uint32_t w)
         {
+            uint32_t a = w >> 24;
             if (a == 0xFF)
+                return Pack565(w & 0xFF, (w >> 8) & 0xFF, (w >> 16) & 0xFF);
+            if (a == 0)
+                return 0;
+            return Pack565(((w & 0xFF) * a) >> 8, (((w >> 8) & 0xFF) * a) >> 8, (((w >> 16) & 0xFF) * a) >> 8);
+        }
+
+        void RGBA8888toRGB565(const uint8_t* rgba, uint16_t* out, uint32_t count)
+        {
+            // 4 pixels = 4 words in, 2 words out.
+            while (count >= 4)
             {
-                // Fully opaque - use fast path
-                return RGBto16bit(r, g, b);
+                uint32_t p0 = RGBAWordTo565(LoadWord(rgba));
+                uint32_t p1 = RGBAWordTo565(LoadWord(rgba + 4));
+                uint32_t p2 = RGBAWordTo565(LoadWord(rgba + 8));
+                uint32_t p3 = RGBAWordTo565(LoadWord(rgba + 12));
+
+                StoreWord(out, p0 | (p1 << 16));
+                StoreWord(out + 2, p2 | (p3 << 16));
+
+                rgba += 16;
+                out += 4;
+                count -= 4;
             }
-            else if (a == 0x00)
+            while (count--)
             {
-                // Fully transparent - return black
-                return 0x0000;
+                *out++ = RGBAto16bit(rgba[0], rgba[1], rgba[2], rgba[3]);
+                rgba += 4;
             }
-            else
+        }
+
+        void RGB565toWireOrder(const uint16_t* in, uint16_t* out, uint32_t count)
+        {
+            // Two pixels per word; the mask-and-shift pattern compiles to a single rev16.
+            while (count >= 8)
             {
-                // Alpha blend using fast integer math (avoid float operations)
-                uint16_t invAlpha = 255 - a;
-                r = (r * a) >> 8;  // Fast division by 256 (close to 255)
-                g = (g * a) >> 8;
-                b = (b * a) >> 8;
-                return RGBto16bit(r, g, b);
+                uint32_t w0 = LoadWord(in);
+                uint32_t w1 = LoadWord(in + 2);
+                uint32_t w2 = LoadWord(in + 4);
+                uint32_t w3 = LoadWord(in + 6);
+
+                StoreWord(out, ((w0 & 0x00FF00FF) << 8) | ((w0 >> 8) & 0x00FF00FF));
+                StoreWord(out + 2, ((w1 & 0x00FF00FF) << 8) | ((w1 >> 8) & 0x00FF00FF));
+                StoreWord(out + 4, ((w2 & 0x00FF00FF) << 8) | ((w2 >> 8) & 0x00FF00FF));
+                StoreWord(out + 6, ((w3 & 0x00FF00FF) << 8) | ((w3 >> 8) & 0x00FF00FF));
+
+                in += 8;
+                out += 8;
+                count -= 8;
             }
+            while (count--)
+                *out++ = RGB565toWireOrder(*in++);
         }
     }
 }
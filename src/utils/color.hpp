@@ -6,7 +6,42 @@ namespace PicoPixel
 {
     namespace Utils
     {
-        uint16_t RGBto16bit(uint8_t r, uint8_t g, uint8_t b);
-        uint16_t RGBAto16bit(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+        // Header-inline and constexpr so constant colours fold to a literal at compile time.
+        // (The old lookup tables cost three loads per call; three shifts are cheaper on the M0+.)
+        constexpr uint16_t RGBto16bit(uint8_t r, uint8_t g, uint8_t b)
+        {
+            return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+        }
+
+        // Alpha is applied against black (the colour is scaled by a / 256), not blended with the destination.
+        constexpr uint16_t RGBAto16bit(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+        {
+            if (a == 0xFF)
+                return RGBto16bit(r, g, b);     // Fully opaque - use fast path
+            if (a == 0x00)
+                return 0x0000;                  // Fully transparent - return black
+
+            // Fast integer math: >> 8 is close enough to / 255.
+            return RGBto16bit((uint8_t)((r * a) >> 8), (uint8_t)((g * a) >> 8), (uint8_t)((b * a) >> 8));
+        }
+
+        // Swap the two bytes of an RGB565 pixel. The ILI9341 expects big-endian pixels on the wire.
+        constexpr uint16_t RGB565toWireOrder(uint16_t color)
+        {
+            return (uint16_t)((color << 8) | (color >> 8));
+        }
+
+        // Bulk conversions for asset decoding and procedural fills. These work on whole 32-bit words
+        // (two output pixels at a time) and are unrolled, so they are several times faster than
+        // calling RGBto16bit() per pixel. Input and output may have any alignment.
+
+        // Packed 24-bit RGB (3 bytes per pixel) to RGB565.
+        void RGB888toRGB565(const uint8_t* rgb, uint16_t* out, uint32_t count);
+
+        // Packed 32-bit RGBA (4 bytes per pixel, R first) to RGB565, scaling by alpha like RGBAto16bit().
+        void RGBA8888toRGB565(const uint8_t* rgba, uint16_t* out, uint32_t count);
+
+        // RGB565 to byte-swapped wire order. in and out may be the same buffer.
+        void RGB565toWireOrder(const uint16_t* in, uint16_t* out, uint32_t count);
     }
 }
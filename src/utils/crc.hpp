@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        // CRC-32 (IEEE 802.3, the zlib/PNG one). Table-driven a nibble at a time: the 64-byte table stays in RAM next
+        // to the code instead of a 1 KB byte table, at two lookups per byte. Pass the previous result as crc to
+        // continue a running checksum over several buffers.
+        uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        // Two copies of a state struct: the simulation fills Back() and the renderer reads Front().
+        // Swap() must only be called at a sync point where nothing is reading Front(), e.g. from Game::OnPublishState().
+        template<typename T>
+        class DoubleBuffered
+        {
+        public:
+            T& Back() { return States[BackIndex]; }
+            const T& Front() const { return States[BackIndex ^ 1]; }
+
+            void Swap() { BackIndex ^= 1; }
+
+        private:
+            T States[2] = {};
+            uint8_t BackIndex = 0;
+        };
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "memory/arena.hpp"
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        // Handle to an entity in an EntityStorage. Stays valid until the entity is destroyed; after that the slot's
+        // generation moves on, so a stale handle is detected instead of silently aliasing whatever reuses the slot.
+        struct Entity
+        {
+            uint16_t Index;
+            uint16_t Generation;
+
+            bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+            bool operator!=(const Entity& other) const { return !(*this == other); }
+        };
+
+        static constexpr Entity NULL_ENTITY = { 0xFFFF, 0 };
+
+        // Fixed-capacity entity storage with one densely packed array per component type (struct of arrays).
+        // Live entities always occupy dense indices [0, Count()), so systems walk each component array front to back
+        // with no holes and no alive checks. Destroy() keeps it packed by moving the last entity into the hole, which
+        // means dense order is not stable; hold Entity handles, not dense indices, across frames.
+        //
+        // Every array comes out of an arena in Init(), usually the game arena from OnInit(), so memory is fixed up front
+        // and nothing is allocated per entity. Components must be trivially copyable, as they're moved with plain
+        // assignment and never destructed. Keep components small and split hot from cold data, e.g.
+        //     struct Position { float X, Y; };
+        //     struct Velocity { float X, Y; };
+        //     Utils::EntityStorage<Position, Velocity, Sprite> bullets;
+        //     bullets.Init(Memory::GetGameArena(), 256);
+        //     bullets.Each<Position, Velocity>([dt](Position& p, const Velocity& v) { p.X += v.X * dt; p.Y += v.Y * dt; });
+        template<typename... Components>
+        class EntityStorage
+        {
+            static_assert(sizeof...(Components) > 0, "EntityStorage needs at least one component");
+            static_assert((std::is_trivially_copyable_v<Components> && ...), "Components must be trivially copyable");
+
+        public:
+            // Returns false if the arena couldn't hold capacity entities. Capacity must be below 0xFFFF.
+            bool Init(Memory::Arena& arena, uint16_t capacity)
+            {
+                Capacity = 0;
+                Alive = 0;
+                DenseToSlot = arena.NewArray<uint16_t>(capacity);
+                SlotToDense = arena.NewArray<uint16_t>(capacity);
+                Generations = arena.NewArray<uint16_t>(capacity);
+                FreeSlots = arena.NewArray<uint16_t>(capacity);
+                Arrays = std::tuple<Components*...>(arena.NewArray<Components>(capacity)...);
+                if (!DenseToSlot || !SlotToDense || !Generations || !FreeSlots || !AllArraysAllocated())
+                    return false;
+
+                // Hand out low slots first.
+                for (uint16_t i = 0; i < capacity; i++)
+                    FreeSlots[i] = capacity - 1 - i;
+                FreeCount = capacity;
+                Capacity = capacity;
+                return true;
+            }
+
+            // New entity with value-initialized components. Returns NULL_ENTITY when full.
+            Entity Create()
+            {
+                if (FreeCount == 0)
+                    return NULL_ENTITY;
+
+                uint16_t slot = FreeSlots[--FreeCount];
+                uint16_t dense = Alive++;
+                DenseToSlot[dense] = slot;
+                SlotToDense[slot] = dense;
+                ((std::get<Components*>(Arrays)[dense] = Components{}), ...);
+                return { slot, Generations[slot] };
+            }
+
+            // Returns false if the handle was already stale.
+            bool Destroy(Entity entity)
+            {
+                if (!IsAlive(entity))
+                    return false;
+
+                uint16_t dense = SlotToDense[entity.Index];
+                uint16_t last = --Alive;
+                if (dense != last)
+                {
+                    ((std::get<Components*>(Arrays)[dense] = std::get<Components*>(Arrays)[last]), ...);
+                    uint16_t movedSlot = DenseToSlot[last];
+                    DenseToSlot[dense] = movedSlot;
+                    SlotToDense[movedSlot] = dense;
+                }
+
+                Generations[entity.Index]++;
+                FreeSlots[FreeCount++] = entity.Index;
+                return true;
+            }
+
+            // Destroy the entity at a dense index, e.g. from inside a loop over Data(). The last entity moves into
+            // that index, so a loop should revisit it rather than advance.
+            void DestroyAt(uint16_t dense)
+            {
+                Destroy(GetEntity(dense));
+            }
+
+            bool IsAlive(Entity entity) const
+            {
+                return entity.Index < Capacity && Generations[entity.Index] == entity.Generation
+                    && SlotToDense[entity.Index] < Alive && DenseToSlot[SlotToDense[entity.Index]] == entity.Index;
+            }
+
+            void Clear()
+            {
+                while (Alive)
+                    DestroyAt(Alive - 1);
+            }
+
+            uint16_t Count() const { return Alive; }
+            uint16_t GetCapacity() const { return Capacity; }
+
+            // The dense array of one component, valid for indices [0, Count()).
+            template<typename Component>
+            Component* Data() { return std::get<Component*>(Arrays); }
+
+            template<typename Component>
+            const Component* Data() const { return std::get<Component*>(Arrays); }
+
+            // Component of a live entity. The handle must be alive.
+            template<typename Component>
+            Component& Get(Entity entity) { return std::get<Component*>(Arrays)[SlotToDense[entity.Index]]; }
+
+            Entity GetEntity(uint16_t dense) const
+            {
+                uint16_t slot = DenseToSlot[dense];
+                return { slot, Generations[slot] };
+            }
+
+            // Run fn(Selected&...) for every entity, walking the selected component arrays in lockstep.
+            template<typename... Selected, typename Fn>
+            void Each(Fn&& fn)
+            {
+                std::tuple<Selected*...> arrays(std::get<Selected*>(Arrays)...);
+                for (uint16_t i = 0; i < Alive; i++)
+                    fn(std::get<Selected*>(arrays)[i]...);
+            }
+
+        private:
+            bool AllArraysAllocated() const
+            {
+                return ((std::get<Components*>(Arrays) != nullptr) && ...);
+            }
+
+            std::tuple<Components*...> Arrays;
+            uint16_t* DenseToSlot = nullptr;    // Dense index -> slot, for Destroy() and GetEntity().
+            uint16_t* SlotToDense = nullptr;    // Slot (Entity::Index) -> dense index.
+            uint16_t* Generations = nullptr;    // Bumped on every destroy.
+            uint16_t* FreeSlots = nullptr;      // Stack of unused slots.
+            uint16_t FreeCount = 0;
+            uint16_t Alive = 0;
+            uint16_t Capacity = 0;
+        };
+    }
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        // Signed fixed-point number with FracBits fractional bits, stored in Storage and widened to Wide for
+        // multiplication and division. The RP2040's M0+ cores have no FPU, so this is the type to use in hot loops.
+        //
+        // Plain operators wrap on overflow like the underlying integers do (and are the fastest).
+        // Saturating*() clamp to Max()/Min(), and Checked*() report overflow instead of producing a result.
+        template<int FracBits, typename Storage, typename Wide>
+        struct FixedPoint
+        {
+            static_assert(std::is_signed_v<Storage> && std::is_signed_v<Wide>, "FixedPoint storage must be signed");
+            static_assert(sizeof(Wide) >= 2 * sizeof(Storage), "Wide must hold the product of two Storage values");
+            static_assert(FracBits > 0 && FracBits < (int)sizeof(Storage) * 8 - 1, "Invalid number of fractional bits");
+
+            static constexpr int FRACTIONAL_BITS = FracBits;
+            static constexpr Storage ONE_RAW = (Storage)((Storage)1 << FracBits);
+
+            Storage Raw;
+
+            constexpr FixedPoint()
+             : Raw(0)
+            {
+            }
+            constexpr FixedPoint(int value)
+             : Raw((Storage)((Wide)value * ONE_RAW))
+            {
+            }
+
+            static constexpr FixedPoint FromRaw(Storage raw)
+            {
+                FixedPoint result;
+                result.Raw = raw;
+                return result;
+            }
+            static constexpr FixedPoint FromFloat(float value)
+            {
+                // Round to nearest rather than truncate, so FromFloat(ToFloat(x)) == x.
+                return FromRaw((Storage)(value * ONE_RAW + (value >= 0.0f ? 0.5f : -0.5f)));
+            }
+            static constexpr FixedPoint FromRatio(int numerator, int denominator)
+            {
+                return FromRaw((Storage)(((Wide)numerator * ONE_RAW) / denominator));
+            }
+            static constexpr FixedPoint Max() { return FromRaw(std::numeric_limits<Storage>::max()); }
+            static constexpr FixedPoint Min() { return FromRaw(std::numeric_limits<Storage>::min()); }
+            static constexpr FixedPoint Epsilon() { return FromRaw(1); }
+            static constexpr FixedPoint One() { return FromRaw(ONE_RAW); }
+
+            constexpr float ToFloat() const { return (float)Raw / (float)ONE_RAW; }
+            constexpr int ToInt() const { return (int)(Raw >> FracBits); }             // Rounds towards negative infinity.
+            constexpr int RoundToInt() const { return (int)((Raw + (ONE_RAW >> 1)) >> FracBits); }
+            constexpr FixedPoint Fraction() const { return FromRaw((Storage)(Raw & (ONE_RAW - 1))); }
+
+            constexpr FixedPoint operator-() const { return FromRaw((Storage)-Raw); }
+            constexpr FixedPoint operator+(FixedPoint other) const { return FromRaw((Storage)(Raw + other.Raw)); }
+            constexpr FixedPoint operator-(FixedPoint other) const { return FromRaw((Storage)(Raw - other.Raw)); }
+            constexpr FixedPoint operator*(FixedPoint other) const { return FromRaw((Storage)(((Wide)Raw * other.Raw) >> FracBits)); }
+            constexpr FixedPoint operator/(FixedPoint other) const { return FromRaw((Storage)(((Wide)Raw * ONE_RAW) / other.Raw)); }
+
+            // Scaling by an integer needs no widening.
+            constexpr FixedPoint operator*(int scalar) const { return FromRaw((Storage)(Raw * scalar)); }
+            constexpr FixedPoint operator/(int scalar) const { return FromRaw((Storage)(Raw / scalar)); }
+            constexpr FixedPoint operator<<(int shift) const { return FromRaw((Storage)(Raw << shift)); }
+            constexpr FixedPoint operator>>(int shift) const { return FromRaw((Storage)(Raw >> shift)); }
+
+            constexpr FixedPoint& operator+=(FixedPoint other) { Raw = (Storage)(Raw + other.Raw); return *this; }
+            constexpr FixedPoint& operator-=(FixedPoint other) { Raw = (Storage)(Raw - other.Raw); return *this; }
+            constexpr FixedPoint& operator*=(FixedPoint other) { *this = *this * other; return *this; }
+            constexpr FixedPoint& operator/=(FixedPoint other) { *this = *this / other; return *this; }
+            constexpr FixedPoint& operator*=(int scalar) { Raw = (Storage)(Raw * scalar); return *this; }
+            constexpr FixedPoint& operator/=(int scalar) { Raw = (Storage)(Raw / scalar); return *this; }
+
+            constexpr bool operator==(FixedPoint other) const { return Raw == other.Raw; }
+            constexpr bool operator!=(FixedPoint other) const { return Raw != other.Raw; }
+            constexpr bool operator<(FixedPoint other) const { return Raw < other.Raw; }
+            constexpr bool operator<=(FixedPoint other) const { return Raw <= other.Raw; }
+            constexpr bool operator>(FixedPoint other) const { return Raw > other.Raw; }
+            constexpr bool operator>=(FixedPoint other) const { return Raw >= other.Raw; }
+        };
+
+        // 16.16: range +-32768 with 1/65536 resolution. The default for positions and physics.
+        using Q16_16 = FixedPoint<16, int32_t, int64_t>;
+        // 8.8: range +-128 with 1/256 resolution. Half the memory, for large arrays of small values.
+        using Q8_8 = FixedPoint<8, int16_t, int32_t>;
+
+        namespace Detail
+        {
+            template<typename Wide, typename Storage>
+            constexpr Storage Saturate(Wide value)
+            {
+                if (value > (Wide)std::numeric_limits<Storage>::max()) return std::numeric_limits<Storage>::max();
+                if (value < (Wide)std::numeric_limits<Storage>::min()) return std::numeric_limits<Storage>::min();
+                return (Storage)value;
+            }
+
+            template<typename Wide, typename Storage>
+            constexpr bool Fits(Wide value)
+            {
+                return value <= (Wide)std::numeric_limits<Storage>::max() && value >= (Wide)std::numeric_limits<Storage>::min();
+            }
+        }
+
+        // Saturating arithmetic: results are clamped to [Min(), Max()] instead of wrapping.
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> SaturatingAdd(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b)
+        {
+            return FixedPoint<F, S, W>::FromRaw(Detail::Saturate<W, S>((W)a.Raw + b.Raw));
+        }
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> SaturatingSub(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b)
+        {
+            return FixedPoint<F, S, W>::FromRaw(Detail::Saturate<W, S>((W)a.Raw - b.Raw));
+        }
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> SaturatingMul(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b)
+        {
+            return FixedPoint<F, S, W>::FromRaw(Detail::Saturate<W, S>(((W)a.Raw * b.Raw) >> F));
+        }
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> SaturatingDiv(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b)
+        {
+            if (b.Raw == 0)
+                return a.Raw >= 0 ? FixedPoint<F, S, W>::Max() : FixedPoint<F, S, W>::Min();
+            return FixedPoint<F, S, W>::FromRaw(Detail::Saturate<W, S>(((W)a.Raw * FixedPoint<F, S, W>::ONE_RAW) / b.Raw));
+        }
+
+        // Checked arithmetic: returns false (and leaves result untouched) on overflow or division by zero.
+        template<int F, typename S, typename W>
+        constexpr bool CheckedAdd(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b, FixedPoint<F, S, W>& result)
+        {
+            W value = (W)a.Raw + b.Raw;
+            if (!Detail::Fits<W, S>(value)) return false;
+            result = FixedPoint<F, S, W>::FromRaw((S)value);
+            return true;
+        }
+        template<int F, typename S, typename W>
+        constexpr bool CheckedSub(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b, FixedPoint<F, S, W>& result)
+        {
+            W value = (W)a.Raw - b.Raw;
+            if (!Detail::Fits<W, S>(value)) return false;
+            result = FixedPoint<F, S, W>::FromRaw((S)value);
+            return true;
+        }
+        template<int F, typename S, typename W>
+        constexpr bool CheckedMul(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b, FixedPoint<F, S, W>& result)
+        {
+            W value = ((W)a.Raw * b.Raw) >> F;
+            if (!Detail::Fits<W, S>(value)) return false;
+            result = FixedPoint<F, S, W>::FromRaw((S)value);
+            return true;
+        }
+        template<int F, typename S, typename W>
+        constexpr bool CheckedDiv(FixedPoint<F, S, W> a, FixedPoint<F, S, W> b, FixedPoint<F, S, W>& result)
+        {
+            if (b.Raw == 0) return false;
+            W value = ((W)a.Raw * FixedPoint<F, S, W>::ONE_RAW) / b.Raw;
+            if (!Detail::Fits<W, S>(value)) return false;
+            result = FixedPoint<F, S, W>::FromRaw((S)value);
+            return true;
+        }
+
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> Abs(FixedPoint<F, S, W> value)
+        {
+            return value.Raw < 0 ? -value : value;
+        }
+
+        // Fast reciprocal, saturating for |x| <= Epsilon(). For Q16.16 this is a single 32-bit unsigned division
+        // (one hardware divider operation on the RP2040) instead of a 64-bit one, and is at most 1 LSB low.
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> Reciprocal(FixedPoint<F, S, W> value)
+        {
+            using T = FixedPoint<F, S, W>;
+            bool negative = value.Raw < 0;
+            // Negated unsigned, so Min() (whose magnitude no signed Storage can hold) is defined too.
+            uint32_t magnitude = negative ? 0u - (uint32_t)value.Raw : (uint32_t)value.Raw;
+            if (magnitude <= 1)
+                return negative ? T::Min() : T::Max();
+
+            W raw;
+            if constexpr (2 * F == 32)
+                raw = (W)(0xFFFFFFFFu / magnitude);     // 2^32 / x, less one LSB at worst.
+            else if constexpr (2 * F < 32)
+                raw = (W)((1u << (2 * F)) / magnitude);
+            else
+                raw = ((W)1 << (2 * F)) / magnitude;
+
+            S result = Detail::Saturate<W, S>(raw);
+            return T::FromRaw(negative ? (S)-result : result);
+        }
+
+        // Integer square root: floor(sqrt(value)), bit by bit with no multiplies.
+        constexpr uint32_t ISqrt(uint32_t value)
+        {
+            uint32_t result = 0;
+            uint32_t bit = 1u << 30;
+            while (bit > value)
+                bit >>= 2;
+            while (bit != 0)
+            {
+                if (value >= result + bit)
+                {
+                    value -= result + bit;
+                    result = (result >> 1) + bit;
+                }
+                else
+                {
+                    result >>= 1;
+                }
+                bit >>= 2;
+            }
+            return result;
+        }
+
+        // Square root of a fixed-point value. Negative inputs return zero.
+        template<int F, typename S, typename W>
+        constexpr FixedPoint<F, S, W> Sqrt(FixedPoint<F, S, W> value)
+        {
+            if (value.Raw <= 0)
+                return FixedPoint<F, S, W>();
+
+            // sqrt(raw / 2^F) * 2^F == sqrt(raw << F). When raw << F doesn't fit in 32 bits, shift by as much as
+            // fits (an even amount) and scale the root back up, which keeps at least 16 significant bits while
+            // staying in 32-bit arithmetic.
+            uint32_t raw = (uint32_t)value.Raw;
+            int shift = F & ~1;
+            while (shift > 0 && (raw >> (32 - shift)) != 0)
+                shift -= 2;
+            uint32_t root = ISqrt(raw << shift);
+            int remaining = F - shift;
+            if (remaining & 1)
+                return FixedPoint<F, S, W>::FromRaw((S)((uint64_t)root * 92682u >> 16 << (remaining >> 1))); // * sqrt(2)
+            return FixedPoint<F, S, W>::FromRaw((S)(root << (remaining >> 1)));
+        }
+
+        namespace Fixed
+        {
+            template<typename T = Q16_16>
+            struct Vec2
+            {
+                T x, y;
+
+                constexpr Vec2() : x(), y() {}
+                constexpr Vec2(T x, T y) : x(x), y(y) {}
+
+                constexpr Vec2 operator+(const Vec2& other) const { return Vec2(x + other.x, y + other.y); }
+                constexpr Vec2 operator-(const Vec2& other) const { return Vec2(x - other.x, y - other.y); }
+                constexpr Vec2 operator*(T scalar) const { return Vec2(x * scalar, y * scalar); }
+                constexpr Vec2& operator+=(const Vec2& other) { x += other.x; y += other.y; return *this; }
+                constexpr Vec2& operator-=(const Vec2& other) { x -= other.x; y -= other.y; return *this; }
+
+                constexpr T Dot(const Vec2& other) const { return x * other.x + y * other.y; }
+                // Squared length avoids the square root; use it for range checks.
+                constexpr T LengthSquared() const { return Dot(*this); }
+                constexpr T Length() const { return Sqrt(LengthSquared()); }
+            };
+
+            template<typename T = Q16_16>
+            struct Vec3
+            {
+                T x, y, z;
+
+                constexpr Vec3() : x(), y(), z() {}
+                constexpr Vec3(T x, T y, T z) : x(x), y(y), z(z) {}
+
+                constexpr Vec3 operator+(const Vec3& other) const { return Vec3(x + other.x, y + other.y, z + other.z); }
+                constexpr Vec3 operator-(const Vec3& other) const { return Vec3(x - other.x, y - other.y, z - other.z); }
+                constexpr Vec3 operator*(T scalar) const { return Vec3(x * scalar, y * scalar, z * scalar); }
+                constexpr Vec3& operator+=(const Vec3& other) { x += other.x; y += other.y; z += other.z; return *this; }
+                constexpr Vec3& operator-=(const Vec3& other) { x -= other.x; y -= other.y; z -= other.z; return *this; }
+
+                constexpr T Dot(const Vec3& other) const { return x * other.x + y * other.y + z * other.z; }
+                constexpr Vec3 Cross(const Vec3& other) const
+                {
+                    return Vec3(y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x);
+                }
+                constexpr T LengthSquared() const { return Dot(*this); }
+                constexpr T Length() const { return Sqrt(LengthSquared()); }
+            };
+
+            template<typename T = Q16_16>
+            struct Mat3
+            {
+                T m[3][3];
+
+                constexpr Mat3() : m() { Identity(); }
+
+                constexpr void Identity()
+                {
+                    for (int i = 0; i < 3; i++)
+                        for (int j = 0; j < 3; j++)
+                            m[i][j] = (i == j) ? T(1) : T();
+                }
+
+                constexpr Vec3<T> Transform(const Vec3<T>& v) const
+                {
+                    return Vec3<T>(
+                        m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                        m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                        m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z
+                    );
+                }
+
+                constexpr Mat3 operator*(const Mat3& other) const
+                {
+                    Mat3 result;
+                    for (int i = 0; i < 3; i++)
+                        for (int j = 0; j < 3; j++)
+                            result.m[i][j] = m[i][0] * other.m[0][j] + m[i][1] * other.m[1][j] + m[i][2] * other.m[2][j];
+                    return result;
+                }
+            };
+
+            template<typename T = Q16_16>
+            struct Mat4
+            {
+                T m[4][4];
+
+                constexpr Mat4() : m() { Identity(); }
+
+                constexpr void Identity()
+                {
+                    for (int i = 0; i < 4; i++)
+                        for (int j = 0; j < 4; j++)
+                            m[i][j] = (i == j) ? T(1) : T();
+                }
+
+                constexpr void Translate(const Vec3<T>& offset)
+                {
+                    m[0][3] += offset.x;
+                    m[1][3] += offset.y;
+                    m[2][3] += offset.z;
+                }
+
+                // Transform a point (w = 1), ignoring the projective row.
+                constexpr Vec3<T> TransformPoint(const Vec3<T>& v) const
+                {
+                    return Vec3<T>(
+                        m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+                        m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3],
+                        m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3]
+                    );
+                }
+
+                constexpr Mat4 operator*(const Mat4& other) const
+                {
+                    Mat4 result;
+                    for (int i = 0; i < 4; i++)
+                        for (int j = 0; j < 4; j++)
+                            result.m[i][j] = m[i][0] * other.m[0][j] + m[i][1] * other.m[1][j] + m[i][2] * other.m[2][j] + m[i][3] * other.m[3][j];
+                    return result;
+                }
+            };
+        }
+    }
+}
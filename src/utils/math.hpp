@@ -1,5 +1,6 @@
 #pragma once
 
+#include "trig.hpp"
 #include <cmath>
 
 namespace PicoPixel
@@ -89,8 +90,8 @@ namespace PicoPixel
 
             void RotateX(float angle)
             {
-                float cos_a = cosf(angle);
-                float sin_a = sinf(angle);
+                float cos_a, sin_a;
+                FastSinCos(angle, sin_a, cos_a);
                 Identity();
                 m[1][1] = cos_a;  m[1][2] = -sin_a;
                 m[2][1] = sin_a;  m[2][2] = cos_a;
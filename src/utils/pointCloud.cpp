@@ -0,0 +1,107 @@
+#include "pointCloud.hpp"
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        namespace PointCloud
+        {
+            static void Offset(float* __restrict values, uint32_t count, float offset)
+            {
+                if (offset == 0.0f)
+                    return;
+                for (uint32_t i = 0; i < count; i++)
+                    values[i] += offset;
+            }
+
+            void Translate(float* __restrict x, float* __restrict y, float* __restrict z, uint32_t count, const Vec3& offset)
+            {
+                Offset(x, count, offset.x);
+                Offset(y, count, offset.y);
+                Offset(z, count, offset.z);
+            }
+
+            void Rotate(float* __restrict x, float* __restrict y, float* __restrict z, uint32_t count, const Mat3& matrix)
+            {
+                // Hoist the matrix into locals so the compiler doesn't reload it after every store.
+                const float m00 = matrix.m[0][0], m01 = matrix.m[0][1], m02 = matrix.m[0][2];
+                const float m10 = matrix.m[1][0], m11 = matrix.m[1][1], m12 = matrix.m[1][2];
+                const float m20 = matrix.m[2][0], m21 = matrix.m[2][1], m22 = matrix.m[2][2];
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    float px = x[i];
+                    float py = y[i];
+                    float pz = z[i];
+                    x[i] = m00 * px + m01 * py + m02 * pz;
+                    y[i] = m10 * px + m11 * py + m12 * pz;
+                    z[i] = m20 * px + m21 * py + m22 * pz;
+                }
+            }
+
+            uint32_t CullOutsideRange(const float* __restrict x, const float* __restrict y, const float* __restrict z, uint32_t count, float rangeSquared,
+                                      uint32_t* __restrict outsideMask)
+            {
+                uint32_t outside = 0;
+                for (uint32_t word = 0; word < MaskWords(count); word++)
+                {
+                    uint32_t base = word * 32;
+                    uint32_t end = base + 32 < count ? base + 32 : count;
+                    uint32_t bits = 0;
+                    for (uint32_t i = base; i < end; i++)
+                    {
+                        if (x[i] * x[i] + y[i] * y[i] + z[i] * z[i] > rangeSquared)
+                        {
+                            bits |= 1u << (i - base);
+                            outside++;
+                        }
+                    }
+                    outsideMask[word] = bits;
+                }
+                return outside;
+            }
+
+            uint32_t Project(const float* __restrict x, const float* __restrict y, const float* __restrict z, uint32_t count, const Projection& projection,
+                             uint16_t* __restrict screenX, uint16_t* __restrict screenY, uint32_t* __restrict visibleMask)
+            {
+                const float nearPlane = projection.Near;
+                const float farPlane = projection.Far != 0.0f ? projection.Far : 3.4e38f;
+                const float focalX = projection.FocalX;
+                const float focalY = projection.FocalY;
+                const float centerX = projection.CenterX;
+                const float centerY = projection.CenterY;
+                const float width = projection.Width;
+                const float height = projection.Height;
+
+                uint32_t visible = 0;
+                for (uint32_t word = 0; word < MaskWords(count); word++)
+                {
+                    uint32_t base = word * 32;
+                    uint32_t end = base + 32 < count ? base + 32 : count;
+                    uint32_t bits = 0;
+                    for (uint32_t i = base; i < end; i++)
+                    {
+                        float pz = z[i];
+                        if (pz < nearPlane || pz > farPlane)
+                            continue;
+
+                        // One reciprocal per point instead of two divisions.
+                        float inverseZ = 1.0f / pz;
+                        float sx = x[i] * inverseZ * focalX + centerX;
+                        float sy = y[i] * inverseZ * focalY + centerY;
+
+                        // Compare as floats so points far off screen can't overflow the integer conversion.
+                        if (sx < 0.0f || sx >= width || sy < 0.0f || sy >= height)
+                            continue;
+
+                        screenX[i] = (uint16_t)sx;
+                        screenY[i] = (uint16_t)sy;
+                        bits |= 1u << (i - base);
+                        visible++;
+                    }
+                    visibleMask[word] = bits;
+                }
+                return visible;
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "math.hpp"
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        // Batch kernels over structure-of-arrays point data (separate x[], y[], z[] arrays).
+        // Each kernel is one tight loop over plain floats, so there are no Vec3 temporaries or per-point calls,
+        // and work that only touches one axis only touches that axis' array.
+        //
+        // Nothing runs these at runtime any more: PicoSpace's starfield moved to Graphics::ParticlePool. They are kept
+        // as the float baseline that RunPointCloudBenchmarks() and RunParticleBenchmarks() measure against; use
+        // ParticlePool in games.
+        namespace PointCloud
+        {
+            // Per-point flags are packed one bit per point, 32 points per word (bit i % 32 of word i / 32).
+            constexpr uint32_t MaskWords(uint32_t count) { return (count + 31) / 32; }
+            constexpr bool TestMask(const uint32_t* mask, uint32_t index) { return (mask[index >> 5] >> (index & 31)) & 1; }
+
+            // Perspective parameters, computed once per frame instead of once per point.
+            struct Projection
+            {
+                float FocalX;   // Pixels per unit of x / z. Height / 2 * aspect, which is simply Width / 2.
+                float FocalY;
+                float CenterX;
+                float CenterY;
+                float Near;
+                float Far;      // 0 for no far plane.
+                uint16_t Width;
+                uint16_t Height;
+
+                static Projection ForScreen(uint16_t width, uint16_t height, float nearPlane, float farPlane)
+                {
+                    Projection projection;
+                    projection.FocalX = width / 2.0f;
+                    projection.FocalY = height / 2.0f;
+                    projection.CenterX = width / 2.0f;
+                    projection.CenterY = height / 2.0f;
+                    projection.Near = nearPlane;
+                    projection.Far = farPlane;
+                    projection.Width = width;
+                    projection.Height = height;
+                    return projection;
+                }
+            };
+
+            // p += offset. Zero components are skipped entirely.
+            void Translate(float* x, float* y, float* z, uint32_t count, const Vec3& offset);
+
+            // p = matrix * p.
+            void Rotate(float* x, float* y, float* z, uint32_t count, const Mat3& matrix);
+
+            // Sets the mask bit of every point with x^2 + y^2 + z^2 > rangeSquared. Returns how many were set.
+            uint32_t CullOutsideRange(const float* x, const float* y, const float* z, uint32_t count, float rangeSquared, uint32_t* outsideMask);
+
+            // Projects every point to screen coordinates. Points behind the near plane, past the far plane or off screen
+            // get a clear mask bit and unspecified coordinates. Returns the number of visible points.
+            uint32_t Project(const float* x, const float* y, const float* z, uint32_t count, const Projection& projection,
+                             uint16_t* screenX, uint16_t* screenY, uint32_t* visibleMask);
+        }
+    }
+}
@@ -1,19 +1,20 @@
 #include "random.hpp"
-#include <cstdlib>
 #include "log.hpp"
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
 #include "hardware/clocks.h"
+#include "drivers/adc/adcSampler.hpp"
 
 namespace PicoPixel
 {
     namespace Utils
     {
 
-        // Helper to gather entropy from ADC noise
+        // Helper to gather entropy from ADC noise. Runs at boot, before the sampler is running, so it can convert
+        // directly.
         static uint16_t GetADCEntropy()
         {
-            adc_init();
+            AdcSampler::Init();
             adc_select_input(0); // Use ADC0 (GPIO26)
             sleep_us(10); // Give it a moment to sit
             uint16_t noise = 0;
@@ -25,17 +26,62 @@ namespace PicoPixel
             return noise;
         }
 
+        static uint64_t GlobalSeed = 0;
+        static RandomStream Default;
+
+        static uint64_t SplitMix64(uint64_t& state)
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        void RandomStream::Seed(uint64_t seed)
+        {
+            uint64_t mix = seed;
+            uint64_t a = SplitMix64(mix);
+            uint64_t b = SplitMix64(mix);
+            State[0] = (uint32_t)a;
+            State[1] = (uint32_t)(a >> 32);
+            State[2] = (uint32_t)b;
+            State[3] = (uint32_t)(b >> 32);
+        }
+
+        void RandomStream::Fill(uint32_t* out, uint32_t count)
+        {
+            uint32_t s0 = State[0], s1 = State[1], s2 = State[2], s3 = State[3];
+            for (uint32_t i = 0; i < count; i++)
+            {
+                out[i] = Rotl(s0 + s3, 7) + s0;
+                const uint32_t t = s1 << 9;
+                s2 ^= s0;
+                s3 ^= s1;
+                s1 ^= s2;
+                s0 ^= s3;
+                s2 ^= t;
+                s3 = Rotl(s3, 11);
+            }
+            State[0] = s0; State[1] = s1; State[2] = s2; State[3] = s3;
+        }
+
+        void RandomStream::FillRange(uint16_t* out, uint32_t count, uint16_t bound)
+        {
+            for (uint32_t i = 0; i < count; i++)
+                out[i] = (uint16_t)Range(bound);
+        }
+
         void InitRand()
         {
             // Use microsecond timer
-            uint32_t seed = time_us_64();
+            uint64_t seed = time_us_64();
 
             // Use ADC noise
-            seed ^= GetADCEntropy();
+            seed ^= (uint64_t)GetADCEntropy() << 32;
 
             // Use core temperature sensor
             adc_select_input(4); // 4 = internal temperature sensor
-            seed ^= adc_read();
+            seed ^= (uint64_t)adc_read() << 48;
 
             // Use address of a stack variable
             int dummy;
@@ -44,24 +90,43 @@ namespace PicoPixel
             // Use the system clock
             seed ^= (uint32_t)clock_get_hz(clk_sys);
 
-            srand(seed);
-            LOG("Seed: %u\n", seed);
-            LOG("First 10 random numbers: ");
-            for (int i = 0; i < 10; i++)
-            {
-                printf("%u ", (unsigned)rand());
-            }
-            printf("\n");
+            SeedRand(seed);
+            LOG("Seed: %08lx%08lx\n", (unsigned long)(seed >> 32), (unsigned long)(uint32_t)seed);
+        }
+
+        void SeedRand(uint64_t seed)
+        {
+            GlobalSeed = seed;
+            Default.Seed(seed);
+        }
+
+        uint64_t GetRandSeed()
+        {
+            return GlobalSeed;
+        }
+
+        RandomStream MakeStream(const char* name)
+        {
+            // FNV-1a of the name, mixed into the global seed.
+            uint64_t hash = 0xCBF29CE484222325ull;
+            for (; *name; name++)
+                hash = (hash ^ (uint8_t)*name) * 0x100000001B3ull;
+            return RandomStream(GlobalSeed ^ hash);
+        }
+
+        RandomStream& DefaultStream()
+        {
+            return Default;
         }
 
         uint16_t Rand()
         {
-            return (uint16_t)rand();
+            return (uint16_t)(Default.Next() >> 16);
         }
 
         uint16_t RandRange(uint16_t max)
         {
-            return (max == 0) ? 0 : (Rand() % max);
+            return (uint16_t)Default.Range(max);
         }
 
     }
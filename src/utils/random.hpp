@@ -1,18 +1,146 @@
 #pragma once
 
+#include "fixed.hpp"
 #include <cstdint>
+#include <cstring>
 
 namespace PicoPixel
 {
     namespace Utils
     {
-        // Initialize the random number generator
+        // xoshiro128++: 16 bytes of state, a handful of adds/xors/rotates per 32-bit output, no locks.
+        // Each subsystem should own its own stream (see MakeStream) so one game's draws never shift another's sequence.
+        class RandomStream
+        {
+        public:
+            RandomStream()
+            {
+                Seed(0);
+            }
+            explicit RandomStream(uint64_t seed)
+            {
+                Seed(seed);
+            }
+
+            // Expand a 64-bit seed into the full state with splitmix64, which never produces the all-zero state.
+            void Seed(uint64_t seed);
+
+            uint32_t Next()
+            {
+                const uint32_t result = Rotl(State[0] + State[3], 7) + State[0];
+                const uint32_t t = State[1] << 9;
+                State[2] ^= State[0];
+                State[3] ^= State[1];
+                State[1] ^= State[2];
+                State[0] ^= State[3];
+                State[2] ^= t;
+                State[3] = Rotl(State[3], 11);
+                return result;
+            }
+
+            // Unbiased value in [0, bound) using Lemire's multiply-and-reject, so there's normally no division at all.
+            // Bounds up to 65536 only need a 32-bit multiply, which the M0+ does in a single cycle.
+            uint32_t Range(uint32_t bound)
+            {
+                if (bound <= 0x10000)
+                {
+                    if (bound == 0)
+                        return 0;
+                    uint32_t product = (Next() >> 16) * bound;
+                    if ((product & 0xFFFF) < bound)
+                    {
+                        uint32_t threshold = (0x10000 - bound) % bound;
+                        while ((product & 0xFFFF) < threshold)
+                            product = (Next() >> 16) * bound;
+                    }
+                    return product >> 16;
+                }
+
+                uint64_t product = (uint64_t)Next() * bound;
+                if ((uint32_t)product < bound)
+                {
+                    uint32_t threshold = (0u - bound) % bound;
+                    while ((uint32_t)product < threshold)
+                        product = (uint64_t)Next() * bound;
+                }
+                return (uint32_t)(product >> 32);
+            }
+
+            // Unbiased value in [min, max).
+            int32_t Range(int32_t min, int32_t max)
+            {
+                return max > min ? min + (int32_t)Range((uint32_t)(max - min)) : min;
+            }
+
+            // True with probability numerator / denominator.
+            bool Chance(uint32_t numerator, uint32_t denominator)
+            {
+                return Range(denominator) < numerator;
+            }
+
+            // Uniform float in [0, 1). Builds a float in [1, 2) from 23 random mantissa bits and subtracts one,
+            // which avoids a (soft-float) integer conversion.
+            float Float01()
+            {
+                uint32_t bits = 0x3F800000u | (Next() >> 9);
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value - 1.0f;
+            }
+
+            // Uniform float in [min, max).
+            float Float(float min, float max)
+            {
+                return min + Float01() * (max - min);
+            }
+
+            // Uniform Q16.16 in [0, 1).
+            Q16_16 Fixed01()
+            {
+                return Q16_16::FromRaw((int32_t)(Next() >> 16));
+            }
+
+            // Uniform Q16.16 in [min, max).
+            Q16_16 Fixed(Q16_16 min, Q16_16 max)
+            {
+                return Q16_16::FromRaw(min.Raw + (int32_t)Range((uint32_t)(max.Raw - min.Raw)));
+            }
+
+            // Bulk fill. Keeps the state in registers for the whole loop.
+            void Fill(uint32_t* out, uint32_t count);
+
+            // Bulk fill with unbiased values in [0, bound).
+            void FillRange(uint16_t* out, uint32_t count, uint16_t bound);
+
+        private:
+            static uint32_t Rotl(uint32_t value, int shift)
+            {
+                return (value << shift) | (value >> (32 - shift));
+            }
+
+            uint32_t State[4];
+        };
+
+        // Initialize the random number generator from hardware entropy (timer, ADC noise, temperature sensor...).
         void InitRand();
 
+        // Re-seed everything deterministically instead, e.g. to replay a recorded session.
+        void SeedRand(uint64_t seed);
+
+        // The seed picked by InitRand() or given to SeedRand().
+        uint64_t GetRandSeed();
+
+        // An independent stream derived from the global seed and a name, e.g. MakeStream("Pong").
+        // The same seed and name always give the same sequence.
+        RandomStream MakeStream(const char* name);
+
+        // Shared stream used by Rand() and RandRange().
+        RandomStream& DefaultStream();
+
         // Get a random 16-bit value
         uint16_t Rand();
 
-        // Get a random value in [0, max)
+        // Get an unbiased random value in [0, max)
         uint16_t RandRange(uint16_t max);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "fixed.hpp"
+#include <array>
+#include <cstdint>
+
+namespace PicoPixel
+{
+    namespace Utils
+    {
+        // Table-driven trigonometry. newlib's sinf/cosf/atan2f are long soft-float routines on the M0+; these are a
+        // couple of table reads, one multiply and some shifts.
+        //
+        // Error bounds (measured over every BinaryAngle against double-precision results):
+        //   Sin/Cos (Q16.16)        |error| < 1 LSB (1.3e-5)
+        //   FastSin/FastCos (float) |error| < 5e-6, plus up to 4.8e-5 rad from rounding the argument to a BinaryAngle
+        //   Atan2                   |error| < 1 BinaryAngle unit (6.3e-5 rad measured, 0.004 degrees)
+
+        // Angle where 65536 is a full turn. Wraps naturally, so no range reduction is ever needed.
+        struct BinaryAngle
+        {
+            uint16_t Raw;
+
+            static constexpr uint32_t FULL_TURN = 65536;
+
+            constexpr BinaryAngle()
+             : Raw(0)
+            {
+            }
+            constexpr explicit BinaryAngle(uint16_t raw)
+             : Raw(raw)
+            {
+            }
+
+            static constexpr BinaryAngle FromRadians(float radians)
+            {
+                // 65536 / (2 * pi). Going through int32 keeps negative angles wrapping correctly.
+                return BinaryAngle((uint16_t)RoundToInt(radians * 10430.378f));
+            }
+            static constexpr BinaryAngle FromDegrees(float degrees)
+            {
+                return BinaryAngle((uint16_t)RoundToInt(degrees * 182.04444f));
+            }
+            // Fraction of a full turn, e.g. FromTurns(1, 6) for 60 degrees.
+            static constexpr BinaryAngle FromTurns(uint32_t numerator, uint32_t denominator)
+            {
+                return BinaryAngle((uint16_t)((uint64_t)numerator * FULL_TURN / denominator));
+            }
+
+            constexpr float ToRadians() const { return Raw * 9.5873799e-5f; }  // 2 * pi / 65536
+            constexpr float ToDegrees() const { return Raw * 0.0054931641f; }  // 360 / 65536
+
+            constexpr BinaryAngle operator+(BinaryAngle other) const { return BinaryAngle((uint16_t)(Raw + other.Raw)); }
+            constexpr BinaryAngle operator-(BinaryAngle other) const { return BinaryAngle((uint16_t)(Raw - other.Raw)); }
+            constexpr BinaryAngle operator-() const { return BinaryAngle((uint16_t)-Raw); }
+            constexpr BinaryAngle& operator+=(BinaryAngle other) { Raw = (uint16_t)(Raw + other.Raw); return *this; }
+            constexpr BinaryAngle& operator-=(BinaryAngle other) { Raw = (uint16_t)(Raw - other.Raw); return *this; }
+            constexpr bool operator==(BinaryAngle other) const { return Raw == other.Raw; }
+            constexpr bool operator!=(BinaryAngle other) const { return Raw != other.Raw; }
+
+        private:
+            static constexpr int32_t RoundToInt(float value)
+            {
+                return (int32_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+            }
+        };
+
+        namespace Detail
+        {
+            constexpr double PI = 3.14159265358979323846;
+
+            // Taylor series, only used at compile time to build the tables. Accurate to ~1e-16 on [0, pi/2].
+            constexpr double ConstexprSin(double x)
+            {
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 12; n++)
+                {
+                    term *= -x * x / ((2 * n) * (2 * n + 1));
+                    sum += term;
+                }
+                return sum;
+            }
+
+            // atan(x) for x in [0, 1], via atan(x) = 2 * atan(x / (1 + sqrt(1 + x^2))) to speed up the series.
+            constexpr double ConstexprSqrt(double x)
+            {
+                double guess = x > 1.0 ? x : 1.0;
+                for (int i = 0; i < 40; i++)
+                    guess = 0.5 * (guess + x / guess);
+                return guess;
+            }
+
+            constexpr double ConstexprAtan(double x)
+            {
+                double reduced = x / (1.0 + ConstexprSqrt(1.0 + x * x));
+                double term = reduced;
+                double sum = reduced;
+                for (int n = 1; n < 40; n++)
+                {
+                    term *= -reduced * reduced;
+                    sum += term / (2 * n + 1);
+                }
+                return 2.0 * sum;
+            }
+
+            // Quarter sine wave in Q1.30, 256 segments plus a guard entry for interpolation.
+            constexpr int SINE_TABLE_BITS = 8;
+            constexpr std::array<int32_t, (1 << SINE_TABLE_BITS) + 1> MakeSineTable()
+            {
+                std::array<int32_t, (1 << SINE_TABLE_BITS) + 1> table{};
+                for (int i = 0; i <= (1 << SINE_TABLE_BITS); i++)
+                    table[i] = (int32_t)(ConstexprSin(PI / 2.0 * i / (1 << SINE_TABLE_BITS)) * (1 << 30) + 0.5);
+                return table;
+            }
+
+            // atan(t) for t in [0, 1] in BinaryAngle units (0 .. 8192), scaled by 2^8 for interpolation precision.
+            constexpr int ATAN_TABLE_BITS = 8;
+            constexpr std::array<uint32_t, (1 << ATAN_TABLE_BITS) + 1> MakeAtanTable()
+            {
+                std::array<uint32_t, (1 << ATAN_TABLE_BITS) + 1> table{};
+                for (int i = 0; i <= (1 << ATAN_TABLE_BITS); i++)
+                    table[i] = (uint32_t)(ConstexprAtan((double)i / (1 << ATAN_TABLE_BITS)) * (65536.0 / (2.0 * PI)) * 256.0 + 0.5);
+                return table;
+            }
+
+            inline constexpr auto SineTable = MakeSineTable();
+            inline constexpr auto AtanTable = MakeAtanTable();
+
+            // Sine in Q1.30 for any angle.
+            constexpr int32_t SinQ30(uint16_t angle)
+            {
+                // Top two bits pick the quadrant, the next 8 the table segment, the low 6 the interpolation weight.
+                uint32_t quadrant = angle >> 14;
+                uint32_t offset = angle & 0x3FFF;
+                if (quadrant & 1)
+                    offset = 0x4000 - offset;   // Mirror in quadrants 1 and 3 (0x4000 lands on the guard entry).
+
+                uint32_t index = offset >> 6;
+                int32_t weight = (int32_t)(offset & 0x3F);
+                int32_t a = SineTable[index];
+                int32_t b = index < (1u << SINE_TABLE_BITS) ? SineTable[index + 1] : a;
+                int32_t value = a + (int32_t)(((int64_t)(b - a) * weight) >> 6);
+                return (quadrant & 2) ? -value : value;
+            }
+        }
+
+        constexpr Q16_16 Sin(BinaryAngle angle)
+        {
+            return Q16_16::FromRaw((Detail::SinQ30(angle.Raw) + (1 << 13)) >> 14);
+        }
+
+        constexpr Q16_16 Cos(BinaryAngle angle)
+        {
+            return Sin(BinaryAngle((uint16_t)(angle.Raw + 0x4000)));
+        }
+
+        constexpr void SinCos(BinaryAngle angle, Q16_16& sin, Q16_16& cos)
+        {
+            sin = Sin(angle);
+            cos = Cos(angle);
+        }
+
+        // Angle of the vector (x, y), like atan2(y, x). Any consistent units work, e.g. Q16.16 raw values or pixels.
+        constexpr BinaryAngle Atan2(int32_t y, int32_t x)
+        {
+            if (x == 0 && y == 0)
+                return BinaryAngle();
+
+            uint32_t ax = x < 0 ? (uint32_t)-(int64_t)x : (uint32_t)x;
+            uint32_t ay = y < 0 ? (uint32_t)-(int64_t)y : (uint32_t)y;
+
+            // Reduce to the first octant: t = min / max in [0, 1] as a 16-bit fraction.
+            bool swapped = ay > ax;
+            uint32_t high = swapped ? ay : ax;
+            uint32_t low = swapped ? ax : ay;
+            uint32_t t = (uint32_t)(((uint64_t)low << 16) / high);
+
+            uint32_t index = t >> (16 - Detail::ATAN_TABLE_BITS);
+            uint32_t weight = t & ((1u << (16 - Detail::ATAN_TABLE_BITS)) - 1);
+            uint32_t a = Detail::AtanTable[index];
+            uint32_t b = index < (1u << Detail::ATAN_TABLE_BITS) ? Detail::AtanTable[index + 1] : a;
+            uint32_t angle = (a + (((b - a) * weight) >> (16 - Detail::ATAN_TABLE_BITS)) + 128) >> 8;
+
+            // Undo the octant reduction.
+            if (swapped) angle = 0x4000 - angle;
+            if (x < 0) angle = 0x8000 - angle;
+            if (y < 0) angle = 0x10000 - angle;
+            return BinaryAngle((uint16_t)angle);
+        }
+
+        constexpr BinaryAngle Atan2(Q16_16 y, Q16_16 x)
+        {
+            return Atan2(y.Raw, x.Raw);
+        }
+
+        // Float front-ends. The argument is quantised to a BinaryAngle, so these are for games, not science.
+        constexpr float FastSin(float radians)
+        {
+            return Detail::SinQ30(BinaryAngle::FromRadians(radians).Raw) * (1.0f / (1 << 30));
+        }
+
+        constexpr float FastCos(float radians)
+        {
+            return Detail::SinQ30((uint16_t)(BinaryAngle::FromRadians(radians).Raw + 0x4000)) * (1.0f / (1 << 30));
+        }
+
+        constexpr void FastSinCos(float radians, float& sin, float& cos)
+        {
+            uint16_t angle = BinaryAngle::FromRadians(radians).Raw;
+            sin = Detail::SinQ30(angle) * (1.0f / (1 << 30));
+            cos = Detail::SinQ30((uint16_t)(angle + 0x4000)) * (1.0f / (1 << 30));
+        }
+
+        // Returns radians in [0, 2 * pi), unlike atan2f's (-pi, pi].
+        inline float FastAtan2(float y, float x)
+        {
+            // Scale into integers while keeping the ratio; 2^20 keeps plenty of precision for |values| up to ~2000.
+            float largest = (x < 0 ? -x : x) > (y < 0 ? -y : y) ? (x < 0 ? -x : x) : (y < 0 ? -y : y);
+            if (largest == 0.0f)
+                return 0.0f;
+            float scale = 1048576.0f / largest;
+            return Atan2((int32_t)(y * scale), (int32_t)(x * scale)).ToRadians();
+        }
+    }
+}
@@ -0,0 +1,185 @@
+#include "test.hpp"
+#include "clockPolicy.hpp"
+
+#include <cstdint>
+
+// Replays a synthetic load trace through the clock governor's policy, like RunClockBenchmarks() but with the
+// outcomes checked: where each kind of load settles, how quickly it gets there, what that costs in missed frames
+// against staying at 125 MHz, and that it doesn't flip between profiles.
+
+using namespace PicoPixel;
+using ClockGovernor::ClockPolicy;
+using ClockGovernor::ClockProfile;
+
+static constexpr uint32_t SpiHz = 62500000;
+static constexpr uint32_t BudgetUs = 1000000u / 60;
+static constexpr uint32_t FullFrame = 320 * 240 * 2;
+static constexpr uint8_t Eco = 0;
+static constexpr uint8_t Normal = 1;
+
+static const ClockProfile Profiles[] =
+{
+    { "Eco", 62500, false },
+    { "Normal", 125000, false },
+    { "Turbo", 250000, true },
+};
+
+// One stretch of a synthetic game: CPU work (as it takes at 125 MHz) and bytes sent to the display per frame.
+struct LoadPhase
+{
+    const char* Name;
+    uint32_t CpuUsAt125;    // 0 for "spiky": a heavy frame every half second on an otherwise light load.
+    uint32_t SpiBytes;
+    uint32_t Frames;
+};
+
+static const LoadPhase Trace[] =
+{
+    { "Light", 1500, FullFrame / 8, 600 },
+    { "CPU bound", 10000, FullFrame / 4, 600 },
+    { "SPI bound", 2000, FullFrame, 600 },
+    { "Spiky", 0, FullFrame / 4, 600 },
+    { "Light", 1500, FullFrame / 8, 600 },
+};
+static constexpr uint32_t PhaseCount = sizeof(Trace) / sizeof(Trace[0]);
+
+struct PhaseResult
+{
+    uint8_t FinalProfile;
+    uint32_t SettledFrame;      // Frames into the phase of its last switch (0 if none).
+    uint32_t FirstAboveNormal;  // Frames into the phase until the profile was at least Normal, or Frames.
+    uint32_t Switches;
+    uint32_t Missed;
+    uint32_t FixedMissed;       // Missed at a fixed 125 MHz.
+};
+
+static uint32_t FrameCpuUs(const LoadPhase& phase, uint32_t frame)
+{
+    return phase.CpuUsAt125 ? phase.CpuUsAt125 : (frame % 30 == 0 ? 20000 : 1000);
+}
+
+static void Replay(uint8_t profileCount, PhaseResult* results)
+{
+    ClockPolicy policy(Profiles, profileCount, Normal, BudgetUs);
+    policy.SetSpiHz(SpiHz);
+    uint32_t fixedSpiHz = ClockPolicy::GetSpiBaudrate(125000000, SpiHz);
+
+    for (uint32_t p = 0; p < PhaseCount; p++)
+    {
+        const LoadPhase& phase = Trace[p];
+        PhaseResult& result = results[p];
+        result = {};
+        result.FirstAboveNormal = phase.Frames;
+        uint32_t switches = policy.GetSwitchCount();
+        uint8_t lastProfile = policy.GetProfile();
+
+        for (uint32_t frame = 0; frame < phase.Frames; frame++)
+        {
+            if (policy.GetProfile() >= Normal && result.FirstAboveNormal == phase.Frames)
+                result.FirstAboveNormal = frame;
+
+            const ClockProfile& profile = Profiles[policy.GetProfile()];
+            uint32_t cpuUsAt125 = FrameCpuUs(phase, frame);
+            uint32_t spiHz = ClockPolicy::GetSpiBaudrate(profile.Khz * 1000, SpiHz);
+            uint32_t cpuUs = (uint32_t)((uint64_t)cpuUsAt125 * 125000 / profile.Khz);
+            uint32_t spiUs = (uint32_t)((uint64_t)phase.SpiBytes * 8 * 1000000 / spiHz);
+            result.Missed += cpuUs + spiUs > BudgetUs;
+            result.FixedMissed += cpuUsAt125 + (uint32_t)((uint64_t)phase.SpiBytes * 8 * 1000000 / fixedSpiHz) > BudgetUs;
+
+            if (policy.Update(cpuUs + spiUs, spiUs) != lastProfile)
+            {
+                lastProfile = policy.GetProfile();
+                result.SettledFrame = frame + 1;
+            }
+        }
+        result.FinalProfile = policy.GetProfile();
+        result.Switches = policy.GetSwitchCount() - switches;
+    }
+}
+
+static void CheckTrace(uint8_t profileCount)
+{
+    const uint8_t fastest = profileCount - 1;
+    PhaseResult results[PhaseCount];
+    Replay(profileCount, results);
+
+    for (uint32_t p = 0; p < PhaseCount; p++)
+    {
+        const PhaseResult& result = results[p];
+        printf("%u profiles: %-10s -> %-7s after %3lu frames, %lu switches, missed %3lu (%3lu at 125 MHz)\n",
+            profileCount, Trace[p].Name, Profiles[result.FinalProfile].Name, (unsigned long)result.SettledFrame,
+            (unsigned long)result.Switches, (unsigned long)result.Missed, (unsigned long)result.FixedMissed);
+
+        // A slower clock may only cost frames while the policy reacts to a jump in load.
+        CHECK(result.Missed <= result.FixedMissed + CLOCK_GOVERNOR_UP_FRAMES, "%u profiles, %s: missed %lu frames, %lu at 125 MHz",
+            profileCount, Trace[p].Name, (unsigned long)result.Missed, (unsigned long)result.FixedMissed);
+        // At most one step each way per phase: no flipping between neighbours.
+        CHECK(result.Switches <= 2, "%u profiles, %s: %lu switches", profileCount, Trace[p].Name, (unsigned long)result.Switches);
+    }
+
+    // Light loads settle at Eco once CLOCK_GOVERNOR_DOWN_FRAMES agree, and no later than twice that.
+    const uint32_t lightPhases[] = { 0, PhaseCount - 1 };
+    for (uint32_t p : lightPhases)
+    {
+        CHECK(results[p].FinalProfile == Eco, "%u profiles, %s phase %lu: ended at %s", profileCount, Trace[p].Name,
+            (unsigned long)p, Profiles[results[p].FinalProfile].Name);
+        CHECK(results[p].SettledFrame <= 2 * CLOCK_GOVERNOR_DOWN_FRAMES, "%u profiles, %s phase %lu: settled after %lu frames",
+            profileCount, Trace[p].Name, (unsigned long)p, (unsigned long)results[p].SettledFrame);
+    }
+
+    // CPU bound from Eco: at least Normal within CLOCK_GOVERNOR_UP_FRAMES, and straight to the fastest profile
+    // when Normal doesn't leave CLOCK_GOVERNOR_TARGET_LOAD headroom.
+    const PhaseResult& cpu = results[1];
+    CHECK(cpu.FirstAboveNormal <= CLOCK_GOVERNOR_UP_FRAMES, "%u profiles: CPU bound reached Normal after %lu frames",
+        profileCount, (unsigned long)cpu.FirstAboveNormal);
+    CHECK(cpu.FinalProfile == fastest, "%u profiles: CPU bound ended at %s", profileCount, Profiles[cpu.FinalProfile].Name);
+    CHECK(cpu.Switches == 1, "%u profiles: CPU bound took %lu switches", profileCount, (unsigned long)cpu.Switches);
+
+    // SPI bound: Turbo can't speed up the display, so it isn't worth overclocking for.
+    CHECK(results[2].FinalProfile == Normal, "%u profiles: SPI bound ended at %s", profileCount,
+        Profiles[results[2].FinalProfile].Name);
+
+    uint32_t switches = 0;
+    for (const PhaseResult& result : results)
+        switches += result.Switches;
+    CHECK(switches <= 2 * PhaseCount, "%u profiles: %lu switches over the trace", profileCount, (unsigned long)switches);
+}
+
+// Lone heavy frames shouldn't move the clock up. (The first frame seeds the average, so the spikes come later.)
+static void CheckSpikes()
+{
+    ClockPolicy policy(Profiles, 3, Normal, BudgetUs);
+    policy.SetSpiHz(SpiHz);
+    for (uint32_t frame = 0; frame < 600; frame++)
+    {
+        uint32_t busyUs = frame % 60 == 59 ? 30000 : 3000;
+        policy.Update(busyUs, 1000);
+        CHECK(policy.GetProfile() < 2, "went to Turbo on frame %lu", (unsigned long)frame);
+    }
+}
+
+// Switching to a profile and back rescales the load estimate, rather than drifting or resetting it.
+static void CheckRescaling()
+{
+    ClockPolicy policy(Profiles, 3, Normal, BudgetUs);
+    policy.SetSpiHz(SpiHz);
+    for (uint32_t frame = 0; frame < 64; frame++)
+        policy.Update(8000, 3000);
+    uint32_t atNormal = policy.PredictUs(Normal);
+    policy.SetProfile(Eco);
+    CHECK(policy.PredictUs(Normal) + 2 >= atNormal && policy.PredictUs(Normal) <= atNormal + 2,
+        "predicted %lu us at Normal from Eco, %lu us before", (unsigned long)policy.PredictUs(Normal), (unsigned long)atNormal);
+    CHECK(policy.PredictUs(Eco) > atNormal, "Eco predicted faster than Normal");
+    policy.SetProfile(Normal);
+    CHECK(policy.PredictUs(Normal) + 4 >= atNormal && policy.PredictUs(Normal) <= atNormal + 4,
+        "predicted %lu us at Normal after a round trip, %lu us before", (unsigned long)policy.PredictUs(Normal), (unsigned long)atNormal);
+}
+
+int main()
+{
+    CheckTrace(2);
+    CheckTrace(3);
+    CheckSpikes();
+    CheckRescaling();
+    return Tests::Finish("clockPolicyTests");
+}
@@ -0,0 +1,152 @@
+#include "test.hpp"
+#include "utils/fixed.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+// Precision of the fixed-point operations against exact (long double) results, in LSBs of the raw value. Q8.8 is
+// checked exhaustively where that is cheap, Q16.16 on random operands plus the edges.
+
+using namespace PicoPixel;
+using Utils::Q16_16;
+using Utils::Q8_8;
+
+static uint32_t State = 0x2545F491;
+
+// xorshift32: reproducible operands without pulling in the firmware's RNG.
+static uint32_t NextRandom()
+{
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+    return State;
+}
+
+// Uniform in [-limit, limit].
+static int32_t RandomRaw(int32_t limit)
+{
+    return (int32_t)(NextRandom() % (2u * (uint32_t)limit + 1)) - limit;
+}
+
+template<typename T>
+static long double ToExact(T value)
+{
+    return std::ldexp((long double)value.Raw, -T::FRACTIONAL_BITS);
+}
+
+// Raw units the exact value is ahead of the result (positive when the result is low).
+template<typename T>
+static long double ErrorLsb(T result, long double exact)
+{
+    return std::ldexp(exact, T::FRACTIONAL_BITS) - (long double)result.Raw;
+}
+
+// Products are truncated towards negative infinity (an arithmetic shift), so they are at most 1 LSB low.
+template<typename T>
+static void CheckMul(T a, T b)
+{
+    long double error = ErrorLsb(a * b, ToExact(a) * ToExact(b));
+    CHECK(error >= 0.0L && error < 1.0L, "raw %ld * %ld is %Lf LSB out", (long)a.Raw, (long)b.Raw, error);
+}
+
+// Quotients are truncated towards zero: less than 1 LSB out, never away from zero.
+template<typename T>
+static void CheckDiv(T a, T b)
+{
+    long double exact = ToExact(a) / ToExact(b);
+    long double error = ErrorLsb(a / b, exact);
+    CHECK(std::fabs(error) < 1.0L && (exact >= 0.0L ? error >= 0.0L : error <= 0.0L), "raw %ld / %ld is %Lf LSB out",
+        (long)a.Raw, (long)b.Raw, error);
+}
+
+// Within 1 LSB of the truncated exact reciprocal (and never above it), or saturated where that doesn't fit.
+template<typename T>
+static void CheckReciprocal(T value)
+{
+    T result = Utils::Reciprocal(value);
+    if (value.Raw == 0 || value.Raw == 1 || value.Raw == -1)
+    {
+        CHECK(result == (value.Raw < 0 ? T::Min() : T::Max()), "1 / raw %ld is raw %ld, not saturated",
+            (long)value.Raw, (long)result.Raw);
+        return;
+    }
+    long double exact = 1.0L / ToExact(value);
+    long double limit = std::ldexp((long double)T::Max().Raw, -T::FRACTIONAL_BITS);
+    if (std::fabs(exact) > limit)
+    {
+        CHECK(result == (value.Raw < 0 ? -T::Max() : T::Max()), "1 / raw %ld is raw %ld, not saturated",
+            (long)value.Raw, (long)result.Raw);
+        return;
+    }
+    long double error = std::fabs(std::ldexp(std::fabs(exact), T::FRACTIONAL_BITS)) - std::fabs((long double)result.Raw);
+    CHECK(error >= 0.0L && error < 2.0L, "1 / raw %ld is %Lf LSB low", (long)value.Raw, error);
+}
+
+// Never above the exact root, and low by less than 1 LSB plus 2^-15 of the root (at least 16 significant bits).
+template<typename T>
+static void CheckSqrt(T value)
+{
+    T result = Utils::Sqrt(value);
+    if (value.Raw <= 0)
+    {
+        CHECK(result.Raw == 0, "sqrt(raw %ld) is raw %ld, not 0", (long)value.Raw, (long)result.Raw);
+        return;
+    }
+    long double exact = std::sqrt(ToExact(value));
+    long double error = ErrorLsb(result, exact);
+    long double bound = 1.0L + std::ldexp(exact, T::FRACTIONAL_BITS - 15);
+    CHECK(error >= 0.0L && error < bound, "sqrt(raw %ld) is %Lf LSB low (bound %Lf)", (long)value.Raw, error, bound);
+}
+
+static void TestQ8_8()
+{
+    for (int32_t raw = INT16_MIN; raw <= INT16_MAX; raw++)
+    {
+        CheckReciprocal(Q8_8::FromRaw((int16_t)raw));
+        CheckSqrt(Q8_8::FromRaw((int16_t)raw));
+    }
+
+    // Products of up to +-11.3 and quotients whose result fits.
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        Q8_8 a = Q8_8::FromRaw((int16_t)RandomRaw(2896));
+        Q8_8 b = Q8_8::FromRaw((int16_t)RandomRaw(2896));
+        CheckMul(a, b);
+        if (std::abs(b.Raw) > std::abs(a.Raw) / 128)
+            CheckDiv(a, b);
+    }
+}
+
+static void TestQ16_16()
+{
+    const int32_t edges[] = { INT32_MIN, INT32_MIN + 1, -65537, -65536, -2, -1, 0, 1, 2, 3, 65535, 65536, 65537, INT32_MAX };
+    for (int32_t raw : edges)
+    {
+        CheckReciprocal(Q16_16::FromRaw(raw));
+        CheckSqrt(Q16_16::FromRaw(raw));
+    }
+
+    for (uint32_t i = 0; i < 200000; i++)
+    {
+        // Products of up to +-181 (whose result fits), quotients whose result fits.
+        Q16_16 a = Q16_16::FromRaw(RandomRaw(181 << 16));
+        Q16_16 b = Q16_16::FromRaw(RandomRaw(181 << 16));
+        CheckMul(a, b);
+        if (std::abs(b.Raw) > std::abs(a.Raw) / 32768)
+            CheckDiv(a, b);
+
+        Q16_16 any = Q16_16::FromRaw((int32_t)NextRandom());
+        CheckReciprocal(any);
+        CheckSqrt(any);
+        // Small magnitudes too, where the reciprocal saturates and the root keeps the fewest bits.
+        CheckReciprocal(Q16_16::FromRaw(RandomRaw(1 << 12)));
+        CheckSqrt(Q16_16::FromRaw(RandomRaw(1 << 12)));
+    }
+}
+
+int main()
+{
+    TestQ8_8();
+    TestQ16_16();
+    return Tests::Finish("fixedTests");
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal harness for the host tests (registered with CTest by the HOST_SIMULATOR build). CHECK() reports a failed
+// condition with printf-style context and carries on, so one run shows every failure; main() returns
+// Tests::Finish().
+namespace PicoPixel
+{
+    namespace Tests
+    {
+        inline int Checks = 0;
+        inline int Failures = 0;
+
+        inline int Finish(const char* name)
+        {
+            if (Failures)
+                printf("%s: %d of %d checks failed\n", name, Failures, Checks);
+            else
+                printf("%s: all %d checks passed\n", name, Checks);
+            return Failures ? 1 : 0;
+        }
+    }
+}
+
+#define CHECK(condition, ...) \
+    do \
+    { \
+        PicoPixel::Tests::Checks++; \
+        if (!(condition)) \
+        { \
+            PicoPixel::Tests::Failures++; \
+            printf("%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #condition); \
+            printf(__VA_ARGS__); \
+            putchar('\n'); \
+        } \
+    } while (0)
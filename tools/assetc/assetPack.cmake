@@ -0,0 +1,58 @@
+set(PICOPIXEL_ASSETC_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# picopixel_add_asset_pack(<target> <manifest>)
+#
+# Builds the assetc host tool, compiles the manifest's images into assets.ppak in the build tree whenever the manifest
+# or any image changes, and links the pack into <target> as read-only data (src/assets/assetPackData.S).
+function(picopixel_add_asset_pack TARGET MANIFEST)
+    set(ASSETC_SOURCE_DIR ${PICOPIXEL_ASSETC_DIR})
+    set(PACK_DIR ${CMAKE_CURRENT_BINARY_DIR}/assets)
+    set(PACK ${PACK_DIR}/assets.ppak)
+
+    if(CMAKE_CROSSCOMPILING)
+        # The firmware's toolchain can't build a tool for the host, so build assetc as its own project (like the
+        # SDK's pioasm).
+        include(ExternalProject)
+        ExternalProject_Add(assetcBuild
+            PREFIX assetc
+            SOURCE_DIR ${ASSETC_SOURCE_DIR}
+            BINARY_DIR ${CMAKE_CURRENT_BINARY_DIR}/assetc
+            CMAKE_ARGS "-DCMAKE_MAKE_PROGRAM:FILEPATH=${CMAKE_MAKE_PROGRAM}"
+            BUILD_ALWAYS 1
+            INSTALL_COMMAND ""
+        )
+        set(ASSETC ${CMAKE_CURRENT_BINARY_DIR}/assetc/assetc)
+        set(ASSETC_DEPENDS assetcBuild)
+    else()
+        add_subdirectory(${ASSETC_SOURCE_DIR} ${CMAKE_CURRENT_BINARY_DIR}/assetc)
+        set(ASSETC $<TARGET_FILE:assetc>)
+        set(ASSETC_DEPENDS assetc)
+    endif()
+
+    # Every image the manifest names (the third column), so editing one rebuilds the pack.
+    get_filename_component(MANIFEST_DIR ${MANIFEST} DIRECTORY)
+    set(SOURCES ${MANIFEST})
+    file(STRINGS ${MANIFEST} LINES)
+    foreach(LINE IN LISTS LINES)
+        string(REGEX REPLACE "#.*" "" LINE "${LINE}")
+        if(LINE MATCHES "^[ \t]*[^ \t]+[ \t]+[^ \t]+[ \t]+([^ \t]+)")
+            list(APPEND SOURCES ${MANIFEST_DIR}/${CMAKE_MATCH_1})
+        endif()
+    endforeach()
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${MANIFEST})
+
+    file(MAKE_DIRECTORY ${PACK_DIR})
+    add_custom_command(
+        OUTPUT ${PACK}
+        COMMAND ${ASSETC} ${MANIFEST} ${PACK}
+        DEPENDS ${ASSETC_DEPENDS} ${SOURCES}
+        COMMENT "Compiling asset pack from ${MANIFEST}"
+        VERBATIM
+    )
+
+    get_filename_component(PACK_SOURCE ${PICOPIXEL_ASSETC_DIR}/../../src/assets/assetPackData.S ABSOLUTE)
+    target_sources(${TARGET} PRIVATE ${PACK_SOURCE})
+    set_source_files_properties(${PACK_SOURCE} PROPERTIES OBJECT_DEPENDS ${PACK})
+    # For the .incbin.
+    target_include_directories(${TARGET} PRIVATE ${PACK_DIR})
+endfunction()
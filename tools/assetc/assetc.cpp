@@ -0,0 +1,518 @@
+// assetc: compiles the images listed in an asset manifest into one asset pack (see src/assets/assetFormat.hpp).
+//
+// Usage: assetc <manifest> <output pack>
+//
+// Manifest lines are "name type source [option=value ...]"; '#' starts a comment and sources are relative to the
+// manifest. Types and their options:
+//   sprite   format=auto|rgb565|indexed|rle (default auto: whichever is smallest)
+//            key=RRGGBB   treat this colour as transparent (for BMPs, which have no alpha)
+//   font     cell=WxH     glyph cell size; glyphs are laid out left to right, top to bottom (required)
+//            first=N      character code of the first cell (default 32)
+//            count=N      number of glyphs (default: every cell)
+//            mono=1       advance every glyph by the cell width instead of its own width
+//   raw      the source file's bytes, unchanged
+// Sources are PNG or BMP. Pixels with alpha below 128 are transparent.
+
+#include "image.hpp"
+#include "assets/assetFormat.hpp"
+#include "utils/crc.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace PicoPixel
+{
+    namespace AssetCompiler
+    {
+        struct CompiledAsset
+        {
+            std::string Name;
+            Assets::AssetEntry Entry = {};
+            std::vector<uint8_t> Data;
+        };
+
+        static uint16_t ToRgb565(const uint8_t* rgba)
+        {
+            return (uint16_t)(((rgba[0] & 0xF8) << 8) | ((rgba[1] & 0xFC) << 3) | (rgba[2] >> 3));
+        }
+
+        static void Append16(std::vector<uint8_t>& out, uint16_t value)
+        {
+            out.push_back((uint8_t)value);
+            out.push_back((uint8_t)(value >> 8));
+        }
+
+        static void Append32(std::vector<uint8_t>& out, uint32_t value)
+        {
+            Append16(out, (uint16_t)value);
+            Append16(out, (uint16_t)(value >> 16));
+        }
+
+        static void Pad(std::vector<uint8_t>& out)
+        {
+            out.resize(Assets::AlignAsset((uint32_t)out.size()), 0);
+        }
+
+        // The image as RGB565 plus a transparency mask.
+        struct Pixels565
+        {
+            std::vector<uint16_t> Colors;
+            std::vector<bool> Transparent;
+            bool AnyTransparent = false;
+        };
+
+        static Pixels565 Convert(const Image& image, int32_t keyColor)
+        {
+            Pixels565 pixels;
+            size_t count = (size_t)image.Width * image.Height;
+            pixels.Colors.resize(count);
+            pixels.Transparent.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint8_t* rgba = &image.Pixels[i * 4];
+                uint32_t rgb = ((uint32_t)rgba[0] << 16) | (rgba[1] << 8) | rgba[2];
+                bool transparent = rgba[3] < 128 || (keyColor >= 0 && rgb == (uint32_t)keyColor);
+                pixels.Colors[i] = transparent ? 0 : ToRgb565(rgba);
+                pixels.Transparent[i] = transparent;
+                pixels.AnyTransparent |= transparent;
+            }
+            return pixels;
+        }
+
+        static std::vector<uint8_t> EncodeRgb565(const Pixels565& pixels, uint16_t transparentColor)
+        {
+            std::vector<uint8_t> out;
+            for (size_t i = 0; i < pixels.Colors.size(); i++)
+                Append16(out, pixels.Transparent[i] ? transparentColor : pixels.Colors[i]);
+            return out;
+        }
+
+        // Empty when the image has too many colours.
+        static std::vector<uint8_t> EncodeIndexed(const Pixels565& pixels, uint32_t width, uint32_t height, Assets::PixelFormat& format, uint16_t& paletteSize)
+        {
+            // Index 0 is reserved for transparency when there is any.
+            std::vector<uint16_t> palette;
+            if (pixels.AnyTransparent)
+                palette.push_back(0);
+            std::map<uint16_t, uint8_t> lookup;
+            std::vector<uint8_t> indices(pixels.Colors.size());
+            for (size_t i = 0; i < pixels.Colors.size(); i++)
+            {
+                if (pixels.Transparent[i])
+                    continue;
+                auto found = lookup.find(pixels.Colors[i]);
+                if (found == lookup.end())
+                {
+                    if (palette.size() == 256)
+                        return {};
+                    found = lookup.emplace(pixels.Colors[i], (uint8_t)palette.size()).first;
+                    palette.push_back(pixels.Colors[i]);
+                }
+                indices[i] = found->second;
+            }
+
+            std::vector<uint8_t> out;
+            for (uint16_t color : palette)
+                Append16(out, color);
+            Pad(out);
+            paletteSize = (uint16_t)palette.size();
+            if (palette.size() <= 16)
+            {
+                format = Assets::PixelFormat::Indexed4;
+                for (uint32_t y = 0; y < height; y++)
+                {
+                    for (uint32_t x = 0; x < width; x += 2)
+                    {
+                        uint8_t high = indices[y * width + x];
+                        uint8_t low = x + 1 < width ? indices[y * width + x + 1] : 0;
+                        out.push_back((uint8_t)((high << 4) | low));
+                    }
+                }
+            }
+            else
+            {
+                format = Assets::PixelFormat::Indexed8;
+                out.insert(out.end(), indices.begin(), indices.end());
+            }
+            return out;
+        }
+
+        static std::vector<uint8_t> EncodeRle(const Pixels565& pixels, uint32_t width, uint32_t height)
+        {
+            std::vector<uint8_t> rows;
+            std::vector<uint32_t> rowOffsets;
+            uint32_t tableSize = height * 4;
+            for (uint32_t y = 0; y < height; y++)
+            {
+                rowOffsets.push_back(tableSize + (uint32_t)rows.size());
+                const uint16_t* colors = &pixels.Colors[(size_t)y * width];
+                auto transparent = [&](uint32_t x) { return (bool)pixels.Transparent[(size_t)y * width + x]; };
+
+                uint32_t x = 0;
+                while (x < width)
+                {
+                    uint32_t run = 1;
+                    if (transparent(x))
+                    {
+                        while (x + run < width && transparent(x + run) && run < Assets::RLE_COUNT_MASK)
+                            run++;
+                        Append16(rows, (uint16_t)(Assets::RLE_SKIP | run));
+                        x += run;
+                        continue;
+                    }
+                    while (x + run < width && !transparent(x + run) && colors[x + run] == colors[x] && run < Assets::RLE_COUNT_MASK)
+                        run++;
+                    if (run >= 3)
+                    {
+                        Append16(rows, (uint16_t)(Assets::RLE_RUN | run));
+                        Append16(rows, colors[x]);
+                        x += run;
+                        continue;
+                    }
+
+                    // Literal until the next transparent pixel or a run worth encoding.
+                    uint32_t literal = 0;
+                    while (x + literal < width && !transparent(x + literal) && literal < Assets::RLE_COUNT_MASK)
+                    {
+                        uint32_t ahead = x + literal;
+                        if (ahead + 2 < width && !transparent(ahead + 1) && !transparent(ahead + 2)
+                            && colors[ahead] == colors[ahead + 1] && colors[ahead] == colors[ahead + 2])
+                            break;
+                        literal++;
+                    }
+                    if (literal == 0)
+                        literal = 1;
+                    Append16(rows, (uint16_t)(Assets::RLE_LITERAL | literal));
+                    for (uint32_t i = 0; i < literal; i++)
+                        Append16(rows, colors[x + i]);
+                    x += literal;
+                }
+            }
+
+            std::vector<uint8_t> out;
+            for (uint32_t offset : rowOffsets)
+                Append32(out, offset);
+            out.insert(out.end(), rows.begin(), rows.end());
+            return out;
+        }
+
+        // A colour no opaque pixel uses, to stand in for transparent pixels in RGB565 sprites. Magenta if possible.
+        static uint16_t PickTransparentColor(const Pixels565& pixels)
+        {
+            std::set<uint16_t> used;
+            for (size_t i = 0; i < pixels.Colors.size(); i++)
+            {
+                if (!pixels.Transparent[i])
+                    used.insert(pixels.Colors[i]);
+            }
+            uint16_t color = 0xF81F;
+            while (used.count(color))
+                color++;
+            return color;
+        }
+
+        static bool CompileSprite(const Image& image, const std::map<std::string, std::string>& options, CompiledAsset& asset, std::string& error)
+        {
+            int32_t keyColor = -1;
+            auto key = options.find("key");
+            if (key != options.end())
+                keyColor = (int32_t)strtoul(key->second.c_str(), nullptr, 16);
+            std::string format = options.count("format") ? options.at("format") : "auto";
+
+            Pixels565 pixels = Convert(image, keyColor);
+            Assets::AssetEntry& entry = asset.Entry;
+            entry.Type = Assets::AssetType::Sprite;
+            entry.Width = (uint16_t)image.Width;
+            entry.Height = (uint16_t)image.Height;
+            entry.Flags = pixels.AnyTransparent ? Assets::ASSET_TRANSPARENT : 0;
+            entry.TransparentColor = PickTransparentColor(pixels);
+
+            std::vector<uint8_t> rgb565 = EncodeRgb565(pixels, entry.TransparentColor);
+            Assets::PixelFormat indexedFormat = Assets::PixelFormat::None;
+            uint16_t paletteSize = 0;
+            std::vector<uint8_t> indexed = EncodeIndexed(pixels, image.Width, image.Height, indexedFormat, paletteSize);
+            std::vector<uint8_t> rle = EncodeRle(pixels, image.Width, image.Height);
+
+            if (format == "auto")
+            {
+                format = "rgb565";
+                size_t best = rgb565.size();
+                if (!indexed.empty() && indexed.size() < best)
+                {
+                    format = "indexed";
+                    best = indexed.size();
+                }
+                if (rle.size() < best)
+                    format = "rle";
+            }
+
+            if (format == "rgb565")
+            {
+                entry.Format = Assets::PixelFormat::RGB565;
+                asset.Data = rgb565;
+            }
+            else if (format == "indexed")
+            {
+                if (indexed.empty())
+                {
+                    error = "too many colours for an indexed sprite";
+                    return false;
+                }
+                entry.Format = indexedFormat;
+                entry.PaletteSize = paletteSize;
+                asset.Data = indexed;
+            }
+            else if (format == "rle")
+            {
+                entry.Format = Assets::PixelFormat::Rle565;
+                asset.Data = rle;
+            }
+            else
+            {
+                error = "unknown sprite format " + format;
+                return false;
+            }
+            return true;
+        }
+
+        static bool CompileFont(const Image& image, const std::map<std::string, std::string>& options, CompiledAsset& asset, std::string& error)
+        {
+            uint32_t cellWidth = 0, cellHeight = 0;
+            if (!options.count("cell") || sscanf(options.at("cell").c_str(), "%ux%u", &cellWidth, &cellHeight) != 2
+                || cellWidth == 0 || cellHeight == 0 || cellWidth > 255 || cellHeight > 255)
+            {
+                error = "fonts need cell=WxH";
+                return false;
+            }
+            uint32_t columns = image.Width / cellWidth;
+            uint32_t cells = columns * (image.Height / cellHeight);
+            uint32_t first = options.count("first") ? (uint32_t)strtoul(options.at("first").c_str(), nullptr, 0) : 32;
+            uint32_t count = options.count("count") ? (uint32_t)strtoul(options.at("count").c_str(), nullptr, 0) : cells;
+            bool mono = options.count("mono") && options.at("mono") != "0";
+            if (count == 0 || count > cells || first + count > 256)
+            {
+                error = "glyph count doesn't fit the image or the character range";
+                return false;
+            }
+
+            uint32_t bytesPerRow = (cellWidth + 7) / 8;
+            std::vector<uint8_t> advances(count);
+            std::vector<uint8_t> bitmaps;
+            for (uint32_t glyph = 0; glyph < count; glyph++)
+            {
+                uint32_t originX = glyph % columns * cellWidth;
+                uint32_t originY = glyph / columns * cellHeight;
+                int32_t rightmost = -1;
+                for (uint32_t y = 0; y < cellHeight; y++)
+                {
+                    std::vector<uint8_t> row(bytesPerRow, 0);
+                    for (uint32_t x = 0; x < cellWidth; x++)
+                    {
+                        const uint8_t* rgba = image.At(originX + x, originY + y);
+                        if (rgba[3] >= 128 && rgba[0] + rgba[1] + rgba[2] >= 3 * 128)
+                        {
+                            row[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+                            rightmost = std::max(rightmost, (int32_t)x);
+                        }
+                    }
+                    bitmaps.insert(bitmaps.end(), row.begin(), row.end());
+                }
+                // Proportional: the glyph's own width plus a pixel of spacing; blank glyphs (space) get half a cell.
+                advances[glyph] = (uint8_t)(mono ? cellWidth : rightmost < 0 ? (cellWidth + 1) / 2 : rightmost + 2);
+            }
+
+            Assets::FontHeader header = { (uint8_t)first, (uint8_t)count, (uint8_t)cellWidth, (uint8_t)cellHeight };
+            asset.Data.assign((const uint8_t*)&header, (const uint8_t*)&header + sizeof(header));
+            asset.Data.insert(asset.Data.end(), advances.begin(), advances.end());
+            Pad(asset.Data);
+            asset.Data.insert(asset.Data.end(), bitmaps.begin(), bitmaps.end());
+
+            asset.Entry.Type = Assets::AssetType::Font;
+            asset.Entry.Width = (uint16_t)cellWidth;
+            asset.Entry.Height = (uint16_t)cellHeight;
+            return true;
+        }
+
+        static bool ReadFile(const std::string& path, std::vector<uint8_t>& bytes)
+        {
+            FILE* file = fopen(path.c_str(), "rb");
+            if (!file)
+                return false;
+            uint8_t chunk[4096];
+            size_t read;
+            while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+                bytes.insert(bytes.end(), chunk, chunk + read);
+            fclose(file);
+            return true;
+        }
+
+        static const char* FormatName(const Assets::AssetEntry& entry)
+        {
+            if (entry.Type == Assets::AssetType::Font)
+                return "font";
+            if (entry.Type == Assets::AssetType::Raw)
+                return "raw";
+            switch (entry.Format)
+            {
+            case Assets::PixelFormat::RGB565: return "rgb565";
+            case Assets::PixelFormat::Indexed8: return "indexed8";
+            case Assets::PixelFormat::Indexed4: return "indexed4";
+            case Assets::PixelFormat::Rle565: return "rle565";
+            default: return "?";
+            }
+        }
+
+        static int Run(const char* manifestPath, const char* outputPath)
+        {
+            FILE* manifest = fopen(manifestPath, "r");
+            if (!manifest)
+            {
+                fprintf(stderr, "assetc: can't open %s\n", manifestPath);
+                return 1;
+            }
+            std::string directory = manifestPath;
+            size_t slash = directory.find_last_of('/');
+            directory = slash == std::string::npos ? "" : directory.substr(0, slash + 1);
+
+            std::vector<CompiledAsset> assets;
+            char line[512];
+            uint32_t lineNumber = 0;
+            bool failed = false;
+            while (fgets(line, sizeof(line), manifest))
+            {
+                lineNumber++;
+                char* comment = strchr(line, '#');
+                if (comment)
+                    *comment = '\0';
+                std::istringstream fields(line);
+                std::string name, type, source;
+                if (!(fields >> name))
+                    continue;
+                if (!(fields >> type >> source))
+                {
+                    fprintf(stderr, "%s:%u: expected \"name type source\"\n", manifestPath, lineNumber);
+                    failed = true;
+                    continue;
+                }
+                std::map<std::string, std::string> options;
+                std::string option;
+                while (fields >> option)
+                {
+                    size_t equals = option.find('=');
+                    options[option.substr(0, equals)] = equals == std::string::npos ? "1" : option.substr(equals + 1);
+                }
+
+                CompiledAsset asset;
+                asset.Name = name;
+                asset.Entry.Id = Assets::HashAssetName(name.c_str());
+                std::string path = source[0] == '/' ? source : directory + source;
+                std::string error;
+                bool compiled = false;
+                if (type == "raw")
+                {
+                    asset.Entry.Type = Assets::AssetType::Raw;
+                    compiled = ReadFile(path, asset.Data);
+                    if (!compiled)
+                        error = "can't open " + path;
+                }
+                else if (type == "sprite" || type == "font")
+                {
+                    Image image;
+                    compiled = LoadImage(path, image, error);
+                    if (compiled && (image.Width > 0xFFFF || image.Height > 0xFFFF))
+                    {
+                        error = "image too large";
+                        compiled = false;
+                    }
+                    if (compiled)
+                        compiled = type == "sprite" ? CompileSprite(image, options, asset, error) : CompileFont(image, options, asset, error);
+                }
+                else
+                    error = "unknown asset type " + type;
+
+                if (!compiled)
+                {
+                    fprintf(stderr, "%s:%u: %s: %s\n", manifestPath, lineNumber, name.c_str(), error.c_str());
+                    failed = true;
+                    continue;
+                }
+                assets.push_back(std::move(asset));
+            }
+            fclose(manifest);
+            if (failed)
+                return 1;
+
+            std::sort(assets.begin(), assets.end(), [](const CompiledAsset& a, const CompiledAsset& b) { return a.Entry.Id < b.Entry.Id; });
+            for (size_t i = 1; i < assets.size(); i++)
+            {
+                if (assets[i].Entry.Id == assets[i - 1].Entry.Id)
+                {
+                    fprintf(stderr, "assetc: %s and %s have the same id, rename one\n", assets[i - 1].Name.c_str(), assets[i].Name.c_str());
+                    return 1;
+                }
+            }
+            if (assets.size() > 0xFFFF)
+            {
+                fprintf(stderr, "assetc: too many assets\n");
+                return 1;
+            }
+
+            // Header and index first, then each asset aligned.
+            std::vector<uint8_t> pack(sizeof(Assets::PackHeader) + assets.size() * sizeof(Assets::AssetEntry), 0);
+            for (CompiledAsset& asset : assets)
+            {
+                Pad(pack);
+                asset.Entry.Offset = (uint32_t)pack.size();
+                asset.Entry.Size = (uint32_t)asset.Data.size();
+                pack.insert(pack.end(), asset.Data.begin(), asset.Data.end());
+            }
+            Pad(pack);
+            for (size_t i = 0; i < assets.size(); i++)
+                memcpy(&pack[sizeof(Assets::PackHeader) + i * sizeof(Assets::AssetEntry)], &assets[i].Entry, sizeof(Assets::AssetEntry));
+
+            Assets::PackHeader header = {};
+            memcpy(header.Magic, Assets::PACK_MAGIC, sizeof(header.Magic));
+            header.Version = Assets::PACK_VERSION;
+            header.Count = (uint16_t)assets.size();
+            header.Size = (uint32_t)pack.size();
+            header.Crc = Utils::Crc32(pack.data() + sizeof(header), pack.size() - sizeof(header));
+            memcpy(pack.data(), &header, sizeof(header));
+
+            FILE* output = fopen(outputPath, "wb");
+            if (!output || fwrite(pack.data(), 1, pack.size(), output) != pack.size())
+            {
+                fprintf(stderr, "assetc: can't write %s\n", outputPath);
+                if (output)
+                    fclose(output);
+                return 1;
+            }
+            fclose(output);
+
+            for (const CompiledAsset& asset : assets)
+            {
+                printf("assetc: %-16s %-8s %4ux%-4u %7u bytes\n", asset.Name.c_str(), FormatName(asset.Entry),
+                    asset.Entry.Width, asset.Entry.Height, asset.Entry.Size);
+            }
+            printf("assetc: %zu assets, %zu bytes -> %s\n", assets.size(), pack.size(), outputPath);
+            return 0;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The pack is written in host byte order and read in place on the RP2040");
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: assetc <manifest> <output pack>\n");
+        return 2;
+    }
+    return PicoPixel::AssetCompiler::Run(argv[1], argv[2]);
+}
@@ -0,0 +1,560 @@
+#include "image.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace PicoPixel
+{
+    namespace AssetCompiler
+    {
+        // --- Inflate ---
+
+        class BitReader
+        {
+        public:
+            BitReader(const uint8_t* data, size_t size)
+             : Data(data), Size(size)
+            {
+            }
+
+            // Returns -1 past the end of the input.
+            int32_t Bits(uint32_t count)
+            {
+                while (BitCount < count)
+                {
+                    if (Position == Size)
+                        return -1;
+                    BitBuffer |= (uint32_t)Data[Position++] << BitCount;
+                    BitCount += 8;
+                }
+                int32_t value = (int32_t)(BitBuffer & ((1u << count) - 1));
+                BitBuffer >>= count;
+                BitCount -= count;
+                return value;
+            }
+
+            void AlignToByte()
+            {
+                BitBuffer = 0;
+                BitCount = 0;
+            }
+
+            bool ReadBytes(std::vector<uint8_t>& out, size_t count)
+            {
+                if (count > Size - Position)
+                    return false;
+                out.insert(out.end(), Data + Position, Data + Position + count);
+                Position += count;
+                return true;
+            }
+
+        private:
+            const uint8_t* Data;
+            size_t Size;
+            size_t Position = 0;
+            uint32_t BitBuffer = 0;
+            uint32_t BitCount = 0;
+        };
+
+        // Canonical Huffman code: how many codes of each length, and the symbols in code order.
+        struct Huffman
+        {
+            uint16_t Counts[16];
+            uint16_t Symbols[288];
+
+            bool Build(const uint8_t* lengths, uint32_t count)
+            {
+                memset(Counts, 0, sizeof(Counts));
+                for (uint32_t i = 0; i < count; i++)
+                    Counts[lengths[i]]++;
+                Counts[0] = 0;
+
+                uint16_t offsets[16];
+                offsets[1] = 0;
+                for (uint32_t length = 1; length < 15; length++)
+                    offsets[length + 1] = offsets[length] + Counts[length];
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    if (lengths[i])
+                        Symbols[offsets[lengths[i]]++] = (uint16_t)i;
+                }
+                return true;
+            }
+
+            // Codes are read a bit at a time, MSB first, walking the counts per length.
+            int32_t Decode(BitReader& reader) const
+            {
+                int32_t code = 0, first = 0, index = 0;
+                for (uint32_t length = 1; length < 16; length++)
+                {
+                    int32_t bit = reader.Bits(1);
+                    if (bit < 0)
+                        return -1;
+                    code |= bit;
+                    int32_t count = Counts[length];
+                    if (code - first < count)
+                        return Symbols[index + code - first];
+                    index += count;
+                    first = (first + count) << 1;
+                    code <<= 1;
+                }
+                return -1;
+            }
+        };
+
+        static constexpr uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static constexpr uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static constexpr uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static constexpr uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        static bool InflateCodes(BitReader& reader, const Huffman& lengthCodes, const Huffman& distanceCodes, std::vector<uint8_t>& out)
+        {
+            for (;;)
+            {
+                int32_t symbol = lengthCodes.Decode(reader);
+                if (symbol < 0)
+                    return false;
+                if (symbol < 256)
+                {
+                    out.push_back((uint8_t)symbol);
+                    continue;
+                }
+                if (symbol == 256)
+                    return true;
+
+                symbol -= 257;
+                if (symbol >= 29)
+                    return false;
+                int32_t extra = reader.Bits(LENGTH_EXTRA[symbol]);
+                int32_t distanceSymbol = distanceCodes.Decode(reader);
+                if (extra < 0 || distanceSymbol < 0 || distanceSymbol >= 30)
+                    return false;
+                uint32_t length = LENGTH_BASE[symbol] + extra;
+                int32_t distanceExtra = reader.Bits(DISTANCE_EXTRA[distanceSymbol]);
+                if (distanceExtra < 0)
+                    return false;
+                size_t distance = DISTANCE_BASE[distanceSymbol] + distanceExtra;
+                if (distance > out.size())
+                    return false;
+                // Byte by byte: the copy may overlap what it is writing.
+                size_t from = out.size() - distance;
+                for (uint32_t i = 0; i < length; i++)
+                    out.push_back(out[from + i]);
+            }
+        }
+
+        bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, std::string& error)
+        {
+            if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20))
+            {
+                error = "not a zlib stream";
+                return false;
+            }
+
+            BitReader reader(data + 2, size - 2);
+            int32_t last;
+            do
+            {
+                last = reader.Bits(1);
+                int32_t type = reader.Bits(2);
+                if (last < 0 || type < 0)
+                {
+                    error = "truncated deflate stream";
+                    return false;
+                }
+
+                if (type == 0)
+                {
+                    reader.AlignToByte();
+                    std::vector<uint8_t> lengths;
+                    if (!reader.ReadBytes(lengths, 4) || (lengths[0] | (lengths[1] << 8)) != (uint16_t)~(lengths[2] | (lengths[3] << 8))
+                        || !reader.ReadBytes(out, lengths[0] | (lengths[1] << 8)))
+                    {
+                        error = "bad stored block";
+                        return false;
+                    }
+                    continue;
+                }
+
+                Huffman lengthCodes, distanceCodes;
+                uint8_t lengths[320];
+                if (type == 1)
+                {
+                    uint32_t i = 0;
+                    for (; i < 144; i++) lengths[i] = 8;
+                    for (; i < 256; i++) lengths[i] = 9;
+                    for (; i < 280; i++) lengths[i] = 7;
+                    for (; i < 288; i++) lengths[i] = 8;
+                    lengthCodes.Build(lengths, 288);
+                    for (i = 0; i < 30; i++) lengths[i] = 5;
+                    distanceCodes.Build(lengths, 30);
+                }
+                else if (type == 2)
+                {
+                    int32_t lengthCount = reader.Bits(5) + 257;
+                    int32_t distanceCount = reader.Bits(5) + 1;
+                    int32_t codeCount = reader.Bits(4) + 4;
+                    if (lengthCount > 286 || distanceCount > 30)
+                    {
+                        error = "bad dynamic block header";
+                        return false;
+                    }
+                    static constexpr uint8_t CODE_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+                    uint8_t codeLengths[19] = {};
+                    for (int32_t i = 0; i < codeCount; i++)
+                        codeLengths[CODE_ORDER[i]] = (uint8_t)reader.Bits(3);
+                    Huffman codeCodes;
+                    codeCodes.Build(codeLengths, 19);
+
+                    int32_t i = 0;
+                    while (i < lengthCount + distanceCount)
+                    {
+                        int32_t symbol = codeCodes.Decode(reader);
+                        if (symbol < 0)
+                        {
+                            error = "bad code lengths";
+                            return false;
+                        }
+                        if (symbol < 16)
+                        {
+                            lengths[i++] = (uint8_t)symbol;
+                            continue;
+                        }
+                        uint8_t repeated = 0;
+                        int32_t repeat;
+                        if (symbol == 16)
+                        {
+                            if (i == 0)
+                            {
+                                error = "bad code lengths";
+                                return false;
+                            }
+                            repeated = lengths[i - 1];
+                            repeat = 3 + reader.Bits(2);
+                        }
+                        else if (symbol == 17)
+                            repeat = 3 + reader.Bits(3);
+                        else
+                            repeat = 11 + reader.Bits(7);
+                        if (i + repeat > lengthCount + distanceCount)
+                        {
+                            error = "bad code lengths";
+                            return false;
+                        }
+                        while (repeat--)
+                            lengths[i++] = repeated;
+                    }
+                    lengthCodes.Build(lengths, lengthCount);
+                    distanceCodes.Build(lengths + lengthCount, distanceCount);
+                }
+                else
+                {
+                    error = "bad block type";
+                    return false;
+                }
+
+                if (!InflateCodes(reader, lengthCodes, distanceCodes, out))
+                {
+                    error = "corrupt deflate data";
+                    return false;
+                }
+            } while (!last);
+            return true;
+        }
+
+        // --- PNG ---
+
+        static uint32_t ReadBigEndian(const uint8_t* p)
+        {
+            return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+
+        static uint8_t Paeth(int32_t a, int32_t b, int32_t c)
+        {
+            int32_t p = a + b - c;
+            int32_t pa = p > a ? p - a : a - p;
+            int32_t pb = p > b ? p - b : b - p;
+            int32_t pc = p > c ? p - c : c - p;
+            if (pa <= pb && pa <= pc)
+                return (uint8_t)a;
+            return (uint8_t)(pb <= pc ? b : c);
+        }
+
+        bool LoadPng(const std::vector<uint8_t>& file, Image& image, std::string& error)
+        {
+            static constexpr uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+            if (file.size() < 8 || memcmp(file.data(), SIGNATURE, 8) != 0)
+            {
+                error = "not a PNG";
+                return false;
+            }
+
+            uint32_t width = 0, height = 0;
+            uint8_t bitDepth = 0, colorType = 0, interlace = 0;
+            std::vector<uint8_t> compressed;
+            uint8_t palette[256][4];
+            for (uint32_t i = 0; i < 256; i++)
+                palette[i][0] = palette[i][1] = palette[i][2] = 0, palette[i][3] = 255;
+            int32_t transparentGrey = -1;
+            int32_t transparentRgb[3] = { -1, -1, -1 };
+
+            size_t position = 8;
+            while (position + 12 <= file.size())
+            {
+                uint32_t length = ReadBigEndian(&file[position]);
+                const uint8_t* type = &file[position + 4];
+                const uint8_t* chunk = &file[position + 8];
+                if (length > file.size() - position - 12)
+                {
+                    error = "truncated chunk";
+                    return false;
+                }
+
+                if (memcmp(type, "IHDR", 4) == 0 && length >= 13)
+                {
+                    width = ReadBigEndian(chunk);
+                    height = ReadBigEndian(chunk + 4);
+                    bitDepth = chunk[8];
+                    colorType = chunk[9];
+                    interlace = chunk[12];
+                }
+                else if (memcmp(type, "PLTE", 4) == 0)
+                {
+                    for (uint32_t i = 0; i < length / 3 && i < 256; i++)
+                    {
+                        palette[i][0] = chunk[i * 3];
+                        palette[i][1] = chunk[i * 3 + 1];
+                        palette[i][2] = chunk[i * 3 + 2];
+                    }
+                }
+                else if (memcmp(type, "tRNS", 4) == 0)
+                {
+                    if (colorType == 3)
+                    {
+                        for (uint32_t i = 0; i < length && i < 256; i++)
+                            palette[i][3] = chunk[i];
+                    }
+                    else if (colorType == 0 && length >= 2)
+                        transparentGrey = (chunk[0] << 8) | chunk[1];
+                    else if (colorType == 2 && length >= 6)
+                    {
+                        for (uint32_t c = 0; c < 3; c++)
+                            transparentRgb[c] = (chunk[c * 2] << 8) | chunk[c * 2 + 1];
+                    }
+                }
+                else if (memcmp(type, "IDAT", 4) == 0)
+                    compressed.insert(compressed.end(), chunk, chunk + length);
+                else if (memcmp(type, "IEND", 4) == 0)
+                    break;
+                position += 12 + length;
+            }
+
+            static constexpr uint8_t CHANNELS[7] = { 1, 0, 3, 1, 2, 0, 4 };
+            if (width == 0 || height == 0 || colorType > 6 || CHANNELS[colorType] == 0)
+            {
+                error = "missing or unsupported IHDR";
+                return false;
+            }
+            if (interlace != 0)
+            {
+                error = "interlaced PNGs are not supported";
+                return false;
+            }
+            if (bitDepth != 8 && !((colorType == 0 || colorType == 3) && bitDepth < 8))
+            {
+                error = "only 8-bit channels (or 1/2/4-bit palette and greyscale) are supported";
+                return false;
+            }
+
+            std::vector<uint8_t> raw;
+            if (!Inflate(compressed.data(), compressed.size(), raw, error))
+                return false;
+
+            uint32_t channels = CHANNELS[colorType];
+            uint32_t bitsPerPixel = channels * bitDepth;
+            uint32_t stride = (width * bitsPerPixel + 7) / 8;
+            uint32_t bytesPerPixel = (bitsPerPixel + 7) / 8;
+            if (raw.size() < (size_t)(stride + 1) * height)
+            {
+                error = "not enough image data";
+                return false;
+            }
+
+            // Undo the per-row filters in place.
+            std::vector<uint8_t> previous(stride, 0);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                uint8_t filter = raw[y * (stride + 1)];
+                uint8_t* row = &raw[y * (stride + 1) + 1];
+                for (uint32_t i = 0; i < stride; i++)
+                {
+                    uint8_t left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+                    uint8_t up = previous[i];
+                    uint8_t upLeft = i >= bytesPerPixel ? previous[i - bytesPerPixel] : 0;
+                    switch (filter)
+                    {
+                    case 0: break;
+                    case 1: row[i] += left; break;
+                    case 2: row[i] += up; break;
+                    case 3: row[i] += (uint8_t)((left + up) / 2); break;
+                    case 4: row[i] += Paeth(left, up, upLeft); break;
+                    default:
+                        error = "bad row filter";
+                        return false;
+                    }
+                }
+                memcpy(previous.data(), row, stride);
+            }
+
+            image.Width = width;
+            image.Height = height;
+            image.Pixels.assign((size_t)width * height * 4, 0);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const uint8_t* row = &raw[y * (stride + 1) + 1];
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint8_t* out = &image.Pixels[((size_t)y * width + x) * 4];
+                    if (bitDepth < 8)
+                    {
+                        uint32_t bit = x * bitDepth;
+                        uint32_t value = (row[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1u << bitDepth) - 1);
+                        if (colorType == 3)
+                            memcpy(out, palette[value], 4);
+                        else
+                        {
+                            uint8_t grey = (uint8_t)(value * 255 / ((1u << bitDepth) - 1));
+                            out[0] = out[1] = out[2] = grey;
+                            out[3] = (int32_t)value == transparentGrey ? 0 : 255;
+                        }
+                        continue;
+                    }
+
+                    const uint8_t* in = row + x * channels;
+                    switch (colorType)
+                    {
+                    case 0:
+                        out[0] = out[1] = out[2] = in[0];
+                        out[3] = in[0] == transparentGrey ? 0 : 255;
+                        break;
+                    case 2:
+                        memcpy(out, in, 3);
+                        out[3] = in[0] == transparentRgb[0] && in[1] == transparentRgb[1] && in[2] == transparentRgb[2] ? 0 : 255;
+                        break;
+                    case 3:
+                        memcpy(out, palette[in[0]], 4);
+                        break;
+                    case 4:
+                        out[0] = out[1] = out[2] = in[0];
+                        out[3] = in[1];
+                        break;
+                    case 6:
+                        memcpy(out, in, 4);
+                        break;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // --- BMP ---
+
+        static uint32_t ReadLittleEndian(const uint8_t* p, uint32_t bytes)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < bytes; i++)
+                value |= (uint32_t)p[i] << (i * 8);
+            return value;
+        }
+
+        bool LoadBmp(const std::vector<uint8_t>& file, Image& image, std::string& error)
+        {
+            if (file.size() < 54 || file[0] != 'B' || file[1] != 'M')
+            {
+                error = "not a BMP";
+                return false;
+            }
+
+            uint32_t dataOffset = ReadLittleEndian(&file[10], 4);
+            uint32_t headerSize = ReadLittleEndian(&file[14], 4);
+            int32_t width = (int32_t)ReadLittleEndian(&file[18], 4);
+            int32_t height = (int32_t)ReadLittleEndian(&file[22], 4);
+            uint32_t bitsPerPixel = ReadLittleEndian(&file[28], 2);
+            uint32_t compression = ReadLittleEndian(&file[30], 4);
+            uint32_t paletteCount = ReadLittleEndian(&file[46], 4);
+            // Only trust the alpha channel when the header has a mask for it; plain 32-bit BMPs often leave it at zero.
+            bool hasAlpha = bitsPerPixel == 32 && compression == 3 && headerSize >= 56 && ReadLittleEndian(&file[66], 4) == 0xFF000000;
+
+            // BI_RGB, or BI_BITFIELDS with the usual BGRA masks.
+            if ((compression != 0 && compression != 3) || (bitsPerPixel != 24 && bitsPerPixel != 32 && bitsPerPixel != 8))
+            {
+                error = "only uncompressed 8, 24 and 32-bit BMPs are supported";
+                return false;
+            }
+            bool topDown = height < 0;
+            uint32_t rows = (uint32_t)(topDown ? -height : height);
+            if (width <= 0 || rows == 0)
+            {
+                error = "bad BMP dimensions";
+                return false;
+            }
+
+            uint32_t stride = ((uint32_t)width * bitsPerPixel / 8 + 3) & ~3u;
+            if (dataOffset + (size_t)stride * rows > file.size())
+            {
+                error = "truncated BMP";
+                return false;
+            }
+            const uint8_t* palette = &file[14 + headerSize];
+            if (bitsPerPixel == 8 && paletteCount == 0)
+                paletteCount = 256;
+            if (bitsPerPixel == 8 && 14 + headerSize + paletteCount * 4 > file.size())
+            {
+                error = "truncated BMP palette";
+                return false;
+            }
+
+            image.Width = (uint32_t)width;
+            image.Height = rows;
+            image.Pixels.assign((size_t)width * rows * 4, 0);
+            for (uint32_t y = 0; y < rows; y++)
+            {
+                const uint8_t* row = &file[dataOffset + (size_t)(topDown ? y : rows - 1 - y) * stride];
+                for (uint32_t x = 0; x < (uint32_t)width; x++)
+                {
+                    uint8_t* out = &image.Pixels[((size_t)y * width + x) * 4];
+                    const uint8_t* in;
+                    if (bitsPerPixel == 8)
+                        in = row[x] < paletteCount ? palette + row[x] * 4 : palette;
+                    else
+                        in = row + x * (bitsPerPixel / 8);
+                    out[0] = in[2];
+                    out[1] = in[1];
+                    out[2] = in[0];
+                    out[3] = hasAlpha ? in[3] : 255;
+                }
+            }
+            return true;
+        }
+
+        bool LoadImage(const std::string& path, Image& image, std::string& error)
+        {
+            FILE* file = fopen(path.c_str(), "rb");
+            if (!file)
+            {
+                error = "can't open " + path;
+                return false;
+            }
+            std::vector<uint8_t> bytes;
+            uint8_t chunk[4096];
+            size_t read;
+            while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+                bytes.insert(bytes.end(), chunk, chunk + read);
+            fclose(file);
+
+            if (bytes.size() >= 2 && bytes[0] == 'B' && bytes[1] == 'M')
+                return LoadBmp(bytes, image, error);
+            return LoadPng(bytes, image, error);
+        }
+    }
+}
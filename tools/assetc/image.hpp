@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PicoPixel
+{
+    namespace AssetCompiler
+    {
+        // Decoded source image, 8-bit RGBA, rows top to bottom.
+        struct Image
+        {
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            std::vector<uint8_t> Pixels;
+
+            const uint8_t* At(uint32_t x, uint32_t y) const { return &Pixels[(y * Width + x) * 4]; }
+        };
+
+        // zlib stream (RFC 1950/1951) -> bytes. Stored, fixed and dynamic Huffman blocks; no preset dictionaries.
+        bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, std::string& error);
+
+        // Non-interlaced PNG of any colour type, 8-bit channels or 1/2/4/8-bit palettes and greyscale.
+        bool LoadPng(const std::vector<uint8_t>& file, Image& image, std::string& error);
+
+        // Uncompressed 24/32-bit BMP, or 8-bit paletted.
+        bool LoadBmp(const std::vector<uint8_t>& file, Image& image, std::string& error);
+
+        // Picks the loader from the file's signature.
+        bool LoadImage(const std::string& path, Image& image, std::string& error);
+    }
+}
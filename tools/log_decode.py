@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Decode deferred PicoPixel log records ("#PPLG" lines from PicoPixel::Log::DumpBinary()).
+
+Records only hold a pointer to a LogSite in flash plus raw 32-bit arguments, so the format string,
+file, function and line are recovered from the firmware ELF.
+
+Usage:
+    log_decode.py build/PicoPixel.elf serial.log
+    cat /dev/ttyACM0 | log_decode.py build/PicoPixel.elf -
+
+Lines that aren't deferred records are passed through untouched, so a whole serial capture can be piped in.
+Host builds must be linked with -no-pie for the addresses to resolve.
+"""
+
+import re
+import struct
+import sys
+
+LEVEL_TAGS = ["[---]", "[ERR]", "[WRN]", "[LOG]", "[DBG]", "[TRC]"]
+ARG_SIGNED, ARG_UNSIGNED, ARG_FLOAT, ARG_POINTER = range(4)
+MAX_ARGS = 4
+
+
+class Elf:
+    """Just enough ELF parsing to read bytes at a virtual address from allocated sections."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+        self.is64 = data[4] == 2
+        if data[5] != 1:
+            raise ValueError("Only little-endian ELF files are supported")
+
+        if self.is64:
+            shoff, = struct.unpack_from("<Q", data, 0x28)
+            shentsize, shnum = struct.unpack_from("<HH", data, 0x3A)
+        else:
+            shoff, = struct.unpack_from("<I", data, 0x20)
+            shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+
+        SHT_NOBITS = 8
+        SHF_ALLOC = 0x2
+        self.sections = []
+        for i in range(shnum):
+            base = shoff + i * shentsize
+            if self.is64:
+                _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from("<IIQQQQ", data, base)
+            else:
+                _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from("<IIIIII", data, base)
+            if sh_flags & SHF_ALLOC and sh_type != SHT_NOBITS and sh_size:
+                self.sections.append((sh_addr, data[sh_offset:sh_offset + sh_size]))
+
+    @property
+    def pointer_size(self):
+        return 8 if self.is64 else 4
+
+    def read(self, address, size):
+        for start, blob in self.sections:
+            if start <= address and address + size <= start + len(blob):
+                offset = address - start
+                return blob[offset:offset + size]
+        return None
+
+    def read_pointer(self, address):
+        raw = self.read(address, self.pointer_size)
+        if raw is None:
+            return None
+        return struct.unpack("<Q" if self.is64 else "<I", raw)[0]
+
+    def read_string(self, address):
+        for start, blob in self.sections:
+            if start <= address < start + len(blob):
+                offset = address - start
+                end = blob.find(b"\0", offset)
+                return blob[offset:end].decode("utf-8", "replace")
+        return None
+
+
+def read_site(elf, address):
+    """LogSite: const char* Format, File, Function; uint16_t Line; uint8_t Level."""
+    ptr = elf.pointer_size
+    raw = elf.read(address, ptr * 3 + 3)
+    if raw is None:
+        return None
+    fmt_ptr, file_ptr, func_ptr = struct.unpack_from("<QQQ" if elf.is64 else "<III", raw)
+    line, level = struct.unpack_from("<HB", raw, ptr * 3)
+    return {
+        "format": elf.read_string(fmt_ptr) or "<format?>",
+        "file": elf.read_string(file_ptr) or "<file?>",
+        "function": elf.read_string(func_ptr) or "<function?>",
+        "line": line,
+        "level": level,
+    }
+
+
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|L|q|j|z|t)?([diouxXeEfFgGaAcspn%])")
+
+
+def format_record(elf, fmt, args, types):
+    index = 0
+    out = []
+    last = 0
+    for match in SPEC.finditer(fmt):
+        out.append(fmt[last:match.start()])
+        last = match.end()
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == "%":
+            out.append("%")
+            continue
+        if index >= len(args):
+            out.append(match.group(0))
+            continue
+        value, kind = args[index], types[index]
+        index += 1
+
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+        if conversion == "s":
+            out.append((spec + "s") % (elf.read_string(value) or f"<str@0x{value:x}>"))
+        elif conversion == "p":
+            out.append(f"0x{value:x}")
+        elif conversion == "c":
+            out.append((spec + "c") % chr(value & 0xFF))
+        elif conversion in "eEfFgGaA":
+            number = struct.unpack("<f", struct.pack("<I", value & 0xFFFFFFFF))[0] if kind == ARG_FLOAT else value
+            out.append((spec + ("f" if conversion in "aA" else conversion)) % number)
+        else:
+            if kind == ARG_FLOAT:
+                number = int(struct.unpack("<f", struct.pack("<I", value & 0xFFFFFFFF))[0])
+            elif kind == ARG_SIGNED or conversion in "di":
+                number = struct.unpack("<i", struct.pack("<I", value & 0xFFFFFFFF))[0]
+            else:
+                number = value & 0xFFFFFFFF
+            out.append((spec + ("d" if conversion in "iu" else conversion)) % number)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_record(elf, blob):
+    ptr = elf.pointer_size
+    site_ptr, = struct.unpack_from("<Q" if elf.is64 else "<I", blob, 0)
+    timestamp, count, arg_types = struct.unpack_from("<IBB", blob, ptr)
+    args = list(struct.unpack_from(("<%dQ" if elf.is64 else "<%dI") % MAX_ARGS, blob, ptr + 8))[:count]
+    types = [(arg_types >> (i * 2)) & 0x3 for i in range(count)]
+
+    site = read_site(elf, site_ptr)
+    if site is None:
+        return f"[???] unknown log site 0x{site_ptr:x} +{timestamp}us\n"
+    tag = LEVEL_TAGS[site["level"]] if site["level"] < len(LEVEL_TAGS) else LEVEL_TAGS[0]
+    message = format_record(elf, site["format"], args, types)
+    return f"{tag} {site['file']}:{site['line']} {site['function']}() +{timestamp}us: {message}"
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    elf = Elf(argv[1])
+    stream = sys.stdin if argv[2] == "-" else open(argv[2], "r", errors="replace")
+    record_size = None
+    for line in stream:
+        if line.startswith("#PPLG-BEGIN"):
+            fields = line.split()
+            record_size = int(fields[1])
+            if int(fields[3]):
+                sys.stdout.write(f"[WRN] {fields[3]} deferred log records were dropped (ring full)\n")
+        elif line.startswith("#PPLG-END"):
+            record_size = None
+        elif line.startswith("#PPLG "):
+            blob = bytes.fromhex(line[6:].strip())
+            if record_size is not None and len(blob) != record_size:
+                sys.stdout.write(f"[???] malformed record ({len(blob)} bytes, expected {record_size})\n")
+                continue
+            sys.stdout.write(decode_record(elf, blob))
+        else:
+            sys.stdout.write(line)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
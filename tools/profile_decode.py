@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Decode PicoPixel profiler dumps ("#PPPF" lines from PicoPixel::Profiler::Dump()).
+
+Usage:
+    profile_decode.py serial.log                      # print per-zone stats for every dump
+    profile_decode.py serial.log --chrome trace.json  # timeline for chrome://tracing or https://ui.perfetto.dev
+    profile_decode.py serial.log --folded stacks.txt  # folded stacks for flamegraph.pl / speedscope
+
+Use "-" to read from stdin.
+"""
+
+import argparse
+import json
+import sys
+
+
+def parse(stream):
+    """Returns a list of dumps: {"time", "frame", "zones": {id: stats}, "events": [...]}."""
+    dumps = []
+    current = None
+    for line in stream:
+        line = line.strip()
+        if not line.startswith("#PPPF"):
+            continue
+        tag, _, rest = line.partition(" ")
+        fields = rest.split()
+        if tag == "#PPPF-BEGIN":
+            current = {"time": int(fields[0]), "frame": int(fields[1]), "zones": {}, "events": []}
+        elif current is None:
+            continue
+        elif tag == "#PPPF-ZONE":
+            # Parse from the right so zone names may contain spaces.
+            zone_id = int(fields[0])
+            count, min_us, avg_us, max_us, p99_us = (int(v) for v in fields[-5:])
+            current["zones"][zone_id] = {
+                "name": " ".join(fields[1:-5]),
+                "count": count, "min": min_us, "avg": avg_us, "max": max_us, "p99": p99_us,
+            }
+        elif tag == "#PPPF-EV":
+            for token in fields:
+                if len(token) != 24:
+                    continue
+                current["events"].append({
+                    "start": int(token[0:8], 16),
+                    "duration": int(token[8:16], 16),
+                    "frame": int(token[16:20], 16),
+                    "zone": int(token[20:22], 16),
+                    "depth": int(token[22:24], 16),
+                })
+        elif tag == "#PPPF-END":
+            dumps.append(current)
+            current = None
+    return dumps
+
+
+def zone_names(dumps):
+    names = {}
+    for dump in dumps:
+        for zone_id, stats in dump["zones"].items():
+            names[zone_id] = stats["name"]
+    return names
+
+
+def unique_events(dumps):
+    """Dumps overlap when fewer events than the ring size happened in between, so de-duplicate."""
+    seen = set()
+    events = []
+    for dump in dumps:
+        for event in dump["events"]:
+            key = (event["start"], event["zone"], event["depth"])
+            if key not in seen:
+                seen.add(key)
+                events.append(event)
+    events.sort(key=lambda e: (e["start"], e["depth"]))
+    return events
+
+
+def print_stats(dumps):
+    for index, dump in enumerate(dumps):
+        print(f"Dump {index} at {dump['time'] / 1e6:.3f}s, frame {dump['frame']}")
+        print(f"  {'zone':<32} {'count':>7} {'min':>8} {'avg':>8} {'max':>8} {'p99':>8}  (us)")
+        for stats in sorted(dump["zones"].values(), key=lambda s: -s["avg"] * s["count"]):
+            print(f"  {stats['name']:<32} {stats['count']:>7} {stats['min']:>8} {stats['avg']:>8} {stats['max']:>8} {stats['p99']:>8}")
+        print()
+
+
+def write_chrome(dumps, path):
+    names = zone_names(dumps)
+    trace = []
+    for event in unique_events(dumps):
+        trace.append({
+            "name": names.get(event["zone"], f"zone{event['zone']}"),
+            "ph": "X",
+            "ts": event["start"],
+            "dur": event["duration"],
+            "pid": 0,
+            "tid": 0,
+            "args": {"frame": event["frame"]},
+        })
+    with open(path, "w") as f:
+        json.dump({"traceEvents": trace, "displayTimeUnit": "ms"}, f)
+
+
+def write_folded(dumps, path):
+    """Rebuild stacks from start time and depth, and emit self time per stack."""
+    names = zone_names(dumps)
+    totals = {}
+    stack = []  # (depth, name, end, event key)
+    self_time = {}
+    for event in unique_events(dumps):
+        end = event["start"] + event["duration"]
+        while stack and (stack[-1][0] >= event["depth"] or stack[-1][2] <= event["start"]):
+            stack.pop()
+        name = names.get(event["zone"], f"zone{event['zone']}")
+        path_names = [entry[1] for entry in stack] + [name]
+        key = ";".join(path_names)
+        self_time[key] = self_time.get(key, 0) + event["duration"]
+        if stack:
+            parent = ";".join(entry[1] for entry in stack)
+            self_time[parent] = self_time.get(parent, 0) - event["duration"]
+        stack.append((event["depth"], name, end, key))
+    for key, value in self_time.items():
+        if value > 0:
+            totals[key] = value
+    with open(path, "w") as f:
+        for key in sorted(totals):
+            f.write(f"{key} {totals[key]}\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode PicoPixel profiler dumps.")
+    parser.add_argument("input", help="serial capture, or - for stdin")
+    parser.add_argument("--chrome", metavar="FILE", help="write a Chrome trace event JSON timeline")
+    parser.add_argument("--folded", metavar="FILE", help="write folded stacks for flamegraph.pl")
+    args = parser.parse_args()
+
+    stream = sys.stdin if args.input == "-" else open(args.input, "r", errors="replace")
+    dumps = parse(stream)
+    if not dumps:
+        print("No profiler dumps found", file=sys.stderr)
+        return 1
+
+    print_stats(dumps)
+    if args.chrome:
+        write_chrome(dumps, args.chrome)
+    if args.folded:
+        write_folded(dumps, args.folded)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())